@@ -0,0 +1,337 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+The harness the SyncAudio core's benchmarks run in.
+*/
+
+/*==================================================================================================
+	SyncAudioBench.c
+==================================================================================================*/
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	Self Include
+#include "SyncAudioBench.h"
+
+//	Local Includes
+#include "SyncAudioKernels.h"
+
+//	System Includes
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__linux__)
+	#include <linux/perf_event.h>
+	#include <sys/ioctl.h>
+	#include <sys/syscall.h>
+#endif
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Suites
+//==================================================================================================
+
+typedef struct SyncAudioBenchSuite
+{
+	const char*					mName;
+	SyncAudioBenchSuiteFunction	mFunction;
+} SyncAudioBenchSuite;
+
+static const SyncAudioBenchSuite	kSyncAudioBench_Suites[] =
+{
+	{ "io",		SyncAudioBench_RunIO },
+	{ "clear",	SyncAudioBench_RunClear },
+	{ "clock",	SyncAudioBench_RunClock },
+	{ "kernels",	SyncAudioBench_RunKernels },
+	{ "properties",	SyncAudioBench_RunProperties },
+	{ "resampler",	SyncAudioBench_RunResampler }
+};
+
+#define	kSyncAudioBench_SuiteCount	(sizeof(kSyncAudioBench_Suites) / sizeof(kSyncAudioBench_Suites[0]))
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Timing
+//==================================================================================================
+
+uint64_t	SyncAudioBench_Now(void)
+{
+	struct timespec theTime;
+	clock_gettime(CLOCK_MONOTONIC, &theTime);
+	return ((uint64_t)theTime.tv_sec * 1000000000ULL) + (uint64_t)theTime.tv_nsec;
+}
+
+uint32_t	SyncAudioBench_Iterations(const SyncAudioBench* inBench, uint32_t inIterations)
+{
+	uint32_t theIterations = inBench->mQuick ? (inIterations / 50) : inIterations;
+	return (theIterations > 0) ? theIterations : 1;
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Results
+//==================================================================================================
+
+static void	SyncAudioBench_BeginMember(SyncAudioBench* ioBench, const char* inKey)
+{
+	fprintf(ioBench->mOutput, "%s\"%s\": ", (ioBench->mMemberCount > 0) ? ", " : "", inKey);
+	++ioBench->mMemberCount;
+}
+
+void	SyncAudioBench_BeginResult(SyncAudioBench* ioBench, const char* inName)
+{
+	fprintf(ioBench->mOutput, "%s\n    { ", (ioBench->mResultCount > 0) ? "," : "");
+	++ioBench->mResultCount;
+	ioBench->mMemberCount = 0;
+	SyncAudioBench_AddString(ioBench, "suite", ioBench->mSuite);
+	SyncAudioBench_AddString(ioBench, "name", inName);
+}
+
+void	SyncAudioBench_AddInteger(SyncAudioBench* ioBench, const char* inKey, int64_t inValue)
+{
+	SyncAudioBench_BeginMember(ioBench, inKey);
+	fprintf(ioBench->mOutput, "%lld", (long long)inValue);
+}
+
+void	SyncAudioBench_AddNumber(SyncAudioBench* ioBench, const char* inKey, double inValue)
+{
+	//	JSON has no infinities or NaNs
+	SyncAudioBench_BeginMember(ioBench, inKey);
+	if(isfinite(inValue))
+	{
+		fprintf(ioBench->mOutput, "%.6g", inValue);
+	}
+	else
+	{
+		fprintf(ioBench->mOutput, "null");
+	}
+}
+
+void	SyncAudioBench_AddString(SyncAudioBench* ioBench, const char* inKey, const char* inValue)
+{
+	//	the strings are the harness's own names, which never need escaping
+	SyncAudioBench_BeginMember(ioBench, inKey);
+	fprintf(ioBench->mOutput, "\"%s\"", inValue);
+}
+
+void	SyncAudioBench_AddBoolean(SyncAudioBench* ioBench, const char* inKey, bool inValue)
+{
+	SyncAudioBench_BeginMember(ioBench, inKey);
+	fprintf(ioBench->mOutput, "%s", inValue ? "true" : "false");
+}
+
+static int	SyncAudioBench_CompareDurations(const void* inA, const void* inB)
+{
+	uint64_t theA = *(const uint64_t*)inA;
+	uint64_t theB = *(const uint64_t*)inB;
+	return (theA > theB) - (theA < theB);
+}
+
+void	SyncAudioBench_AddSeries(SyncAudioBench* ioBench, const char* inPrefix, SyncAudioBenchSeries* ioSeries, uint32_t inFramesPerOperation)
+{
+	//	sorting the series gives the percentile and the worst
+	uint64_t theTotal = 0;
+	for(uint32_t theIndex = 0; theIndex < ioSeries->mCount; ++theIndex)
+	{
+		theTotal += ioSeries->mDurations[theIndex];
+	}
+	qsort(ioSeries->mDurations, ioSeries->mCount, sizeof(uint64_t), SyncAudioBench_CompareDurations);
+	double theMean = (ioSeries->mCount > 0) ? ((double)theTotal / (double)ioSeries->mCount) : NAN;
+	uint64_t thePercentile = (ioSeries->mCount > 0) ? ioSeries->mDurations[(uint32_t)(((uint64_t)ioSeries->mCount * 99) / 100)] : 0;
+	uint64_t theWorst = (ioSeries->mCount > 0) ? ioSeries->mDurations[ioSeries->mCount - 1] : 0;
+
+	const char* thePrefix = (inPrefix != NULL) ? inPrefix : "";
+	char theKey[64];
+	snprintf(theKey, sizeof(theKey), "%scount", thePrefix);
+	SyncAudioBench_AddInteger(ioBench, theKey, ioSeries->mCount);
+	snprintf(theKey, sizeof(theKey), "%smean_ns", thePrefix);
+	SyncAudioBench_AddNumber(ioBench, theKey, theMean);
+	snprintf(theKey, sizeof(theKey), "%sp99_ns", thePrefix);
+	SyncAudioBench_AddInteger(ioBench, theKey, (int64_t)thePercentile);
+	snprintf(theKey, sizeof(theKey), "%sworst_ns", thePrefix);
+	SyncAudioBench_AddInteger(ioBench, theKey, (int64_t)theWorst);
+	snprintf(theKey, sizeof(theKey), "%sns_per_frame", thePrefix);
+	SyncAudioBench_AddNumber(ioBench, theKey, (inFramesPerOperation > 0) ? (theMean / (double)inFramesPerOperation) : NAN);
+}
+
+void	SyncAudioBench_EndResult(SyncAudioBench* ioBench)
+{
+	fprintf(ioBench->mOutput, " }");
+	fflush(ioBench->mOutput);
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Counters
+//==================================================================================================
+
+static int	SyncAudioBench_OpenCacheMissCounter(void)
+{
+	//	counts this thread's cache misses in user space, which most systems allow without privileges
+	int theAnswer = -1;
+#if defined(__linux__)
+	struct perf_event_attr theAttributes;
+	memset(&theAttributes, 0, sizeof(theAttributes));
+	theAttributes.type = PERF_TYPE_HARDWARE;
+	theAttributes.size = sizeof(theAttributes);
+	theAttributes.config = PERF_COUNT_HW_CACHE_MISSES;
+	theAttributes.disabled = 1;
+	theAttributes.exclude_kernel = 1;
+	theAttributes.exclude_hv = 1;
+	theAnswer = (int)syscall(__NR_perf_event_open, &theAttributes, 0, -1, -1, 0);
+#endif
+	return theAnswer;
+}
+
+void	SyncAudioBench_StartCounters(SyncAudioBench* ioBench)
+{
+#if defined(__linux__)
+	if(ioBench->mCacheMissCounter >= 0)
+	{
+		ioctl(ioBench->mCacheMissCounter, PERF_EVENT_IOC_RESET, 0);
+		ioctl(ioBench->mCacheMissCounter, PERF_EVENT_IOC_ENABLE, 0);
+	}
+#else
+	(void)ioBench;
+#endif
+}
+
+void	SyncAudioBench_StopCounters(SyncAudioBench* ioBench, uint64_t inOperationCount)
+{
+	bool theCountersAreValid = false;
+	uint64_t theCacheMisses = 0;
+#if defined(__linux__)
+	if(ioBench->mCacheMissCounter >= 0)
+	{
+		ioctl(ioBench->mCacheMissCounter, PERF_EVENT_IOC_DISABLE, 0);
+		theCountersAreValid = read(ioBench->mCacheMissCounter, &theCacheMisses, sizeof(theCacheMisses)) == (ssize_t)sizeof(theCacheMisses);
+	}
+#endif
+	SyncAudioBench_AddNumber(ioBench, "cache_misses_per_op", (theCountersAreValid && (inOperationCount > 0)) ? ((double)theCacheMisses / (double)inOperationCount) : NAN);
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Series
+//==================================================================================================
+
+void	SyncAudioBenchSeries_Initialize(SyncAudioBenchSeries* ioSeries, uint32_t inCapacity)
+{
+	ioSeries->mDurations = (uint64_t*)calloc(inCapacity, sizeof(uint64_t));
+	ioSeries->mCount = 0;
+	ioSeries->mCapacity = (ioSeries->mDurations != NULL) ? inCapacity : 0;
+}
+
+void	SyncAudioBenchSeries_Teardown(SyncAudioBenchSeries* ioSeries)
+{
+	free(ioSeries->mDurations);
+	ioSeries->mDurations = NULL;
+	ioSeries->mCount = 0;
+	ioSeries->mCapacity = 0;
+}
+
+void	SyncAudioBenchSeries_Reset(SyncAudioBenchSeries* ioSeries)
+{
+	ioSeries->mCount = 0;
+}
+
+void	SyncAudioBenchSeries_Record(SyncAudioBenchSeries* ioSeries, uint64_t inDuration)
+{
+	if(ioSeries->mCount < ioSeries->mCapacity)
+	{
+		ioSeries->mDurations[ioSeries->mCount] = inDuration;
+		++ioSeries->mCount;
+	}
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Main
+//==================================================================================================
+
+static void	SyncAudioBench_PrintUsage(void)
+{
+	fprintf(stderr, "usage: SyncAudioBench [--quick] [--output <file>] [<suite> ...]\nsuites:");
+	for(size_t theSuite = 0; theSuite < kSyncAudioBench_SuiteCount; ++theSuite)
+	{
+		fprintf(stderr, " %s", kSyncAudioBench_Suites[theSuite].mName);
+	}
+	fprintf(stderr, "\n");
+}
+
+int	main(int argc, char** argv)
+{
+	SyncAudioBench theBench = { stdout, false, 0, 0, NULL, -1 };
+	const char* theOutputPath = NULL;
+	bool theSuiteIsSelected[kSyncAudioBench_SuiteCount] = { false };
+	bool theSuitesAreSelected = false;
+	int theAnswer = 0;
+	for(int theArgument = 1; (theAnswer == 0) && (theArgument < argc); ++theArgument)
+	{
+		if(strcmp(argv[theArgument], "--quick") == 0)
+		{
+			theBench.mQuick = true;
+		}
+		else if((strcmp(argv[theArgument], "--output") == 0) && ((theArgument + 1) < argc))
+		{
+			theOutputPath = argv[++theArgument];
+		}
+		else
+		{
+			size_t theSuite = 0;
+			while((theSuite < kSyncAudioBench_SuiteCount) && (strcmp(argv[theArgument], kSyncAudioBench_Suites[theSuite].mName) != 0))
+			{
+				++theSuite;
+			}
+			if(theSuite < kSyncAudioBench_SuiteCount)
+			{
+				theSuiteIsSelected[theSuite] = true;
+				theSuitesAreSelected = true;
+			}
+			else
+			{
+				SyncAudioBench_PrintUsage();
+				theAnswer = 2;
+			}
+		}
+	}
+
+	if((theAnswer == 0) && (theOutputPath != NULL))
+	{
+		theBench.mOutput = fopen(theOutputPath, "w");
+		if(theBench.mOutput == NULL)
+		{
+			fprintf(stderr, "SyncAudioBench: can't open %s\n", theOutputPath);
+			theAnswer = 1;
+		}
+	}
+
+	if(theAnswer == 0)
+	{
+		theBench.mCacheMissCounter = SyncAudioBench_OpenCacheMissCounter();
+		fprintf(theBench.mOutput, "{ \"kernels\": \"%s\", \"quick\": %s, \"results\": [", SyncAudioKernels_Select()->mName, theBench.mQuick ? "true" : "false");
+		for(size_t theSuite = 0; theSuite < kSyncAudioBench_SuiteCount; ++theSuite)
+		{
+			if(!theSuitesAreSelected || theSuiteIsSelected[theSuite])
+			{
+				theBench.mSuite = kSyncAudioBench_Suites[theSuite].mName;
+				kSyncAudioBench_Suites[theSuite].mFunction(&theBench);
+			}
+		}
+		fprintf(theBench.mOutput, "\n] }\n");
+		if(theBench.mCacheMissCounter >= 0)
+		{
+			close(theBench.mCacheMissCounter);
+		}
+		if(theBench.mOutput != stdout)
+		{
+			fclose(theBench.mOutput);
+		}
+	}
+	return theAnswer;
+}
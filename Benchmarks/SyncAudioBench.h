@@ -0,0 +1,100 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+The harness the SyncAudio core's benchmarks run in.
+*/
+
+/*==================================================================================================
+	SyncAudioBench.h
+==================================================================================================*/
+#if !defined(__SyncAudioBench_h__)
+#define __SyncAudioBench_h__
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	System Includes
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+//==================================================================================================
+#pragma mark -
+#pragma mark SyncAudioBench
+//==================================================================================================
+
+//	SyncAudioBench runs suites of benchmarks over the SyncAudio core and writes what they measure
+//	as a single JSON document, so that the numbers of two builds can be compared by a script:
+//
+//		{ "kernels": "avx2", "quick": false, "results": [ { "suite": "io", "name": ..., ... }, ... ] }
+//
+//	Each result is a flat object. A suite adds whatever parameters it swept as members and then
+//	the measurements, which for a series of timed operations are its count, the mean, the 99th
+//	percentile and the worst time in nanoseconds and the mean in nanoseconds per frame. The cache
+//	misses come from the processor's performance counters where the system lets the process read
+//	them, which on Linux is perf_event_open, and are null everywhere else.
+//
+//	Quick runs do a small fraction of the work of a full run and are only good for checking that
+//	every suite still runs.
+
+typedef struct SyncAudioBench
+{
+	FILE*		mOutput;
+	bool		mQuick;
+	uint32_t	mResultCount;
+	uint32_t	mMemberCount;
+	const char*	mSuite;
+	int			mCacheMissCounter;
+} SyncAudioBench;
+
+//	A series of durations in nanoseconds, with room for mCapacity of them.
+typedef struct SyncAudioBenchSeries
+{
+	uint64_t*	mDurations;
+	uint32_t	mCount;
+	uint32_t	mCapacity;
+} SyncAudioBenchSeries;
+
+typedef void	(*SyncAudioBenchSuiteFunction)(SyncAudioBench* ioBench);
+
+//	The monotonic clock in nanoseconds.
+uint64_t	SyncAudioBench_Now(void);
+
+//	Scales a number of iterations down for quick runs.
+uint32_t	SyncAudioBench_Iterations(const SyncAudioBench* inBench, uint32_t inIterations);
+
+//	Results.
+void		SyncAudioBench_BeginResult(SyncAudioBench* ioBench, const char* inName);
+void		SyncAudioBench_AddInteger(SyncAudioBench* ioBench, const char* inKey, int64_t inValue);
+void		SyncAudioBench_AddNumber(SyncAudioBench* ioBench, const char* inKey, double inValue);
+void		SyncAudioBench_AddString(SyncAudioBench* ioBench, const char* inKey, const char* inValue);
+void		SyncAudioBench_AddBoolean(SyncAudioBench* ioBench, const char* inKey, bool inValue);
+
+//	Adds the count, mean, 99th percentile and worst of the series, and the mean per frame for
+//	operations of inFramesPerOperation frames, which is null when that is 0. The members' names
+//	start with inPrefix, which may be NULL.
+void		SyncAudioBench_AddSeries(SyncAudioBench* ioBench, const char* inPrefix, SyncAudioBenchSeries* ioSeries, uint32_t inFramesPerOperation);
+void		SyncAudioBench_EndResult(SyncAudioBench* ioBench);
+
+//	The performance counters. SyncAudioBench_StopCounters adds the cache misses since
+//	SyncAudioBench_StartCounters to the current result, as null when they can't be read.
+void		SyncAudioBench_StartCounters(SyncAudioBench* ioBench);
+void		SyncAudioBench_StopCounters(SyncAudioBench* ioBench, uint64_t inOperationCount);
+
+//	Series.
+void		SyncAudioBenchSeries_Initialize(SyncAudioBenchSeries* ioSeries, uint32_t inCapacity);
+void		SyncAudioBenchSeries_Teardown(SyncAudioBenchSeries* ioSeries);
+void		SyncAudioBenchSeries_Reset(SyncAudioBenchSeries* ioSeries);
+void		SyncAudioBenchSeries_Record(SyncAudioBenchSeries* ioSeries, uint64_t inDuration);
+
+//	The suites.
+void		SyncAudioBench_RunIO(SyncAudioBench* ioBench);
+void		SyncAudioBench_RunClear(SyncAudioBench* ioBench);
+void		SyncAudioBench_RunClock(SyncAudioBench* ioBench);
+void		SyncAudioBench_RunKernels(SyncAudioBench* ioBench);
+void		SyncAudioBench_RunProperties(SyncAudioBench* ioBench);
+void		SyncAudioBench_RunResampler(SyncAudioBench* ioBench);
+
+#endif	//	__SyncAudioBench_h__
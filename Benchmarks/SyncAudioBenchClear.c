@@ -0,0 +1,159 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+The benchmark of what it costs the writer to come back to the ring after a gap.
+*/
+
+/*==================================================================================================
+	SyncAudioBenchClear.c
+==================================================================================================*/
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	Self Include
+#include "SyncAudioBench.h"
+
+//	Local Includes
+#include "SyncAudioRing.h"
+
+//	System Includes
+#include <stdlib.h>
+#include <string.h>
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Clearing
+//==================================================================================================
+
+//	The "clear" suite times the writer's side of a cycle that follows a gap in the stream, which is
+//	what happens when the output is muted or has no writer for a while, for three ways of keeping
+//	stale frames from being read as audio:
+//
+//		- "ring" clears the whole ring and then writes, which is what the plug-in originally did in
+//		  every silent cycle with vDSP_vclr over its 128K float ring.
+//		- "gap" clears the frames that were skipped and then writes, which is what the ring did
+//		  before it had block tags. It costs as much as the gap, up to the whole ring.
+//		- "tags" is SyncAudioRing_Write, which leaves the skipped blocks with the tags of an earlier
+//		  lap and only clears the edges of the blocks the write starts and ends in.
+//
+//	The first two run over a plain ring of the same size as the one the plug-in used to have, with
+//	the same wrapping copies. Every cycle writes a buffer after skipping the same number of frames.
+
+#define	kSyncAudioBenchClear_FrameCapacity	(1U << 16)
+#define	kSyncAudioBenchClear_ChannelCount	2
+#define	kSyncAudioBenchClear_MaxBufferFrames	4096
+#define	kSyncAudioBenchClear_MinCycles		2048
+
+enum
+{
+	kSyncAudioBenchClear_Ring			= 0,
+	kSyncAudioBenchClear_Gap			= 1,
+	kSyncAudioBenchClear_Tags			= 2,
+	kSyncAudioBenchClear_StrategyCount	= 3
+};
+
+static const char* const	kSyncAudioBenchClear_StrategyNames[kSyncAudioBenchClear_StrategyCount] = { "ring", "gap", "tags" };
+
+static void	SyncAudioBenchClear_ClearFrames(float* ioRing, int64_t inSampleTime, uint32_t inFrameCount)
+{
+	uint32_t theStart = (uint32_t)((uint64_t)inSampleTime & (kSyncAudioBenchClear_FrameCapacity - 1));
+	uint32_t theFirstPart = kSyncAudioBenchClear_FrameCapacity - theStart;
+	if(theFirstPart > inFrameCount)
+	{
+		theFirstPart = inFrameCount;
+	}
+	memset(ioRing + (theStart * kSyncAudioBenchClear_ChannelCount), 0, theFirstPart * kSyncAudioBenchClear_ChannelCount * sizeof(float));
+	memset(ioRing, 0, (inFrameCount - theFirstPart) * kSyncAudioBenchClear_ChannelCount * sizeof(float));
+}
+
+static void	SyncAudioBenchClear_StoreFrames(float* ioRing, int64_t inSampleTime, const float* inData, uint32_t inFrameCount)
+{
+	uint32_t theStart = (uint32_t)((uint64_t)inSampleTime & (kSyncAudioBenchClear_FrameCapacity - 1));
+	uint32_t theFirstPart = kSyncAudioBenchClear_FrameCapacity - theStart;
+	if(theFirstPart > inFrameCount)
+	{
+		theFirstPart = inFrameCount;
+	}
+	memcpy(ioRing + (theStart * kSyncAudioBenchClear_ChannelCount), inData, theFirstPart * kSyncAudioBenchClear_ChannelCount * sizeof(float));
+	memcpy(ioRing, inData + (theFirstPart * kSyncAudioBenchClear_ChannelCount), (inFrameCount - theFirstPart) * kSyncAudioBenchClear_ChannelCount * sizeof(float));
+}
+
+static void	SyncAudioBenchClear_Run(SyncAudioBench* ioBench, SyncAudioRing* ioRing, float* ioPlainRing, const float* inData, uint32_t inStrategy, uint32_t inBufferFrames, uint32_t inGapFrames)
+{
+	uint32_t theCycleCount = SyncAudioBench_Iterations(ioBench, kSyncAudioBenchClear_MinCycles);
+	SyncAudioBenchSeries theCycles;
+	SyncAudioBenchSeries_Initialize(&theCycles, theCycleCount);
+	SyncAudioRing_Reset(ioRing);
+
+	int64_t theSampleTime = 0;
+	SyncAudioBench_StartCounters(ioBench);
+	for(uint32_t theCycle = 0; theCycle < theCycleCount; ++theCycle)
+	{
+		int64_t theGapStart = theSampleTime;
+		theSampleTime += inGapFrames;
+
+		uint64_t theStartTime = SyncAudioBench_Now();
+		switch(inStrategy)
+		{
+			case kSyncAudioBenchClear_Ring:
+				memset(ioPlainRing, 0, (size_t)kSyncAudioBenchClear_FrameCapacity * kSyncAudioBenchClear_ChannelCount * sizeof(float));
+				SyncAudioBenchClear_StoreFrames(ioPlainRing, theSampleTime, inData, inBufferFrames);
+				break;
+
+			case kSyncAudioBenchClear_Gap:
+				SyncAudioBenchClear_ClearFrames(ioPlainRing, theGapStart, (inGapFrames < kSyncAudioBenchClear_FrameCapacity) ? inGapFrames : kSyncAudioBenchClear_FrameCapacity);
+				SyncAudioBenchClear_StoreFrames(ioPlainRing, theSampleTime, inData, inBufferFrames);
+				break;
+
+			case kSyncAudioBenchClear_Tags:
+				SyncAudioRing_Write(ioRing, theSampleTime, inData, inBufferFrames);
+				break;
+		}
+		SyncAudioBenchSeries_Record(&theCycles, SyncAudioBench_Now() - theStartTime);
+		theSampleTime += inBufferFrames;
+	}
+
+	SyncAudioBench_BeginResult(ioBench, "write_after_gap");
+	SyncAudioBench_AddString(ioBench, "strategy", kSyncAudioBenchClear_StrategyNames[inStrategy]);
+	SyncAudioBench_AddInteger(ioBench, "buffer_frames", inBufferFrames);
+	SyncAudioBench_AddInteger(ioBench, "gap_frames", inGapFrames);
+	SyncAudioBench_StopCounters(ioBench, theCycleCount);
+	SyncAudioBench_AddSeries(ioBench, NULL, &theCycles, inBufferFrames);
+	SyncAudioBench_EndResult(ioBench);
+	SyncAudioBenchSeries_Teardown(&theCycles);
+}
+
+void	SyncAudioBench_RunClear(SyncAudioBench* ioBench)
+{
+	SyncAudioRing theRing;
+	size_t theRingSamples = (size_t)kSyncAudioBenchClear_FrameCapacity * kSyncAudioBenchClear_ChannelCount;
+	float* thePlainRing = (float*)calloc(theRingSamples, sizeof(float));
+	float* theData = (float*)malloc((size_t)kSyncAudioBenchClear_MaxBufferFrames * kSyncAudioBenchClear_ChannelCount * sizeof(float));
+	if((thePlainRing != NULL) && (theData != NULL) && SyncAudioRing_Initialize(&theRing, kSyncAudioBenchClear_FrameCapacity, kSyncAudioBenchClear_ChannelCount, 0))
+	{
+		for(size_t theSample = 0; theSample < (size_t)kSyncAudioBenchClear_MaxBufferFrames * kSyncAudioBenchClear_ChannelCount; ++theSample)
+		{
+			theData[theSample] = (float)((int32_t)(theSample * 2654435761U) >> 8) / 16777216.0f;
+		}
+
+		//	no gap, a short one, a long one and one that laps the whole ring
+		static const uint32_t kBufferFrames[] = { 64, 512, 4096 };
+		static const uint32_t kGapFrames[] = { 0, 1024, 16384, kSyncAudioBenchClear_FrameCapacity };
+		for(uint32_t theStrategy = 0; theStrategy < kSyncAudioBenchClear_StrategyCount; ++theStrategy)
+		{
+			for(uint32_t theSize = 0; theSize < (sizeof(kBufferFrames) / sizeof(kBufferFrames[0])); ++theSize)
+			{
+				for(uint32_t theGap = 0; theGap < (sizeof(kGapFrames) / sizeof(kGapFrames[0])); ++theGap)
+				{
+					SyncAudioBenchClear_Run(ioBench, &theRing, thePlainRing, theData, theStrategy, kBufferFrames[theSize], kGapFrames[theGap]);
+				}
+			}
+		}
+		SyncAudioRing_Teardown(&theRing);
+	}
+	free(thePlainRing);
+	free(theData);
+}
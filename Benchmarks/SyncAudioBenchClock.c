@@ -0,0 +1,185 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+The benchmark of getting zero time stamps while the clock is being changed.
+*/
+
+/*==================================================================================================
+	SyncAudioBenchClock.c
+==================================================================================================*/
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	Self Include
+#include "SyncAudioBench.h"
+
+//	Local Includes
+#include "SyncAudioClock.h"
+
+//	System Includes
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Contention
+//==================================================================================================
+
+//	The "clock" suite times SyncAudioClock_GetZeroTimeStamp on the reader's thread while another
+//	thread changes the clock, two ways:
+//
+//		- "seqlock" is the clock as it is, where the reader takes a snapshot of the anchor and the
+//		  rate and only retries if a writer published while it did.
+//		- "mutex" takes a lock around the same call, the way the plug-in used to take
+//		  gDevice_IOMutex, and the writer takes it around its changes.
+//
+//	The writer is either absent, "periodic", which does 50 microseconds of work to change the
+//	configuration every millisecond the way StartIO and configuration changes do, holding the lock
+//	for all of it when there is one, or "spinning", which changes the rate back and forth as fast as
+//	it can. The reader does a microsecond of other work between time stamps, as an IO cycle would.
+
+#define	kSyncAudioBenchClock_Period				4096
+#define	kSyncAudioBenchClock_MinReads			200000
+#define	kSyncAudioBenchClock_ReaderWork			1000
+#define	kSyncAudioBenchClock_WriterWork			50000
+#define	kSyncAudioBenchClock_WriterInterval		1000000
+
+enum
+{
+	kSyncAudioBenchClock_None		= 0,
+	kSyncAudioBenchClock_Periodic	= 1,
+	kSyncAudioBenchClock_Spinning	= 2,
+	kSyncAudioBenchClock_WriterCount	= 3
+};
+
+static const char* const	kSyncAudioBenchClock_WriterNames[kSyncAudioBenchClock_WriterCount] = { "none", "periodic", "spinning" };
+
+typedef struct SyncAudioBenchClock
+{
+	SyncAudioClock		mClock;
+	pthread_mutex_t		mMutex;
+	bool				mUsesMutex;
+	uint32_t			mWriter;
+	_Atomic bool		mIsDone;
+	uint64_t			mWriteCount;
+} SyncAudioBenchClock;
+
+static void	SyncAudioBenchClock_Spin(uint64_t inNanoseconds)
+{
+	uint64_t theEndTime = SyncAudioBench_Now() + inNanoseconds;
+	while(SyncAudioBench_Now() < theEndTime)
+	{
+	}
+}
+
+static void	SyncAudioBenchClock_Change(SyncAudioBenchClock* ioBenchClock)
+{
+	//	48 kHz and 44.1 kHz in nanoseconds per frame
+	bool isFirst = (ioBenchClock->mWriteCount & 1) == 0;
+	SyncAudioClock_SetHostTicksPerFrame(&ioBenchClock->mClock, isFirst ? 1000000000ULL : 10000000ULL, isFirst ? 48000 : 441);
+	++ioBenchClock->mWriteCount;
+}
+
+static void*	SyncAudioBenchClock_Writer(void* inBenchClock)
+{
+	SyncAudioBenchClock* theBenchClock = (SyncAudioBenchClock*)inBenchClock;
+	while(!atomic_load_explicit(&theBenchClock->mIsDone, memory_order_relaxed))
+	{
+		if(theBenchClock->mWriter == kSyncAudioBenchClock_Periodic)
+		{
+			struct timespec theInterval = { 0, kSyncAudioBenchClock_WriterInterval };
+			nanosleep(&theInterval, NULL);
+			if(theBenchClock->mUsesMutex)
+			{
+				pthread_mutex_lock(&theBenchClock->mMutex);
+				SyncAudioBenchClock_Spin(kSyncAudioBenchClock_WriterWork);
+				SyncAudioBenchClock_Change(theBenchClock);
+				pthread_mutex_unlock(&theBenchClock->mMutex);
+			}
+			else
+			{
+				SyncAudioBenchClock_Spin(kSyncAudioBenchClock_WriterWork);
+				SyncAudioBenchClock_Change(theBenchClock);
+			}
+		}
+		else if(theBenchClock->mUsesMutex)
+		{
+			pthread_mutex_lock(&theBenchClock->mMutex);
+			SyncAudioBenchClock_Change(theBenchClock);
+			pthread_mutex_unlock(&theBenchClock->mMutex);
+		}
+		else
+		{
+			SyncAudioBenchClock_Change(theBenchClock);
+		}
+	}
+	return NULL;
+}
+
+static void	SyncAudioBenchClock_Run(SyncAudioBench* ioBench, bool inUsesMutex, uint32_t inWriter)
+{
+	SyncAudioBenchClock theBenchClock;
+	SyncAudioClock_Initialize(&theBenchClock.mClock, kSyncAudioBenchClock_Period, 1000000000ULL, 48000);
+	SyncAudioClock_Anchor(&theBenchClock.mClock, SyncAudioBench_Now());
+	pthread_mutex_init(&theBenchClock.mMutex, NULL);
+	theBenchClock.mUsesMutex = inUsesMutex;
+	theBenchClock.mWriter = inWriter;
+	atomic_init(&theBenchClock.mIsDone, false);
+	theBenchClock.mWriteCount = 0;
+
+	pthread_t theWriter;
+	bool theWriterIsRunning = (inWriter != kSyncAudioBenchClock_None) && (pthread_create(&theWriter, NULL, SyncAudioBenchClock_Writer, &theBenchClock) == 0);
+	if((inWriter == kSyncAudioBenchClock_None) || theWriterIsRunning)
+	{
+		uint32_t theReadCount = SyncAudioBench_Iterations(ioBench, kSyncAudioBenchClock_MinReads);
+		SyncAudioBenchSeries theReads;
+		SyncAudioBenchSeries_Initialize(&theReads, theReadCount);
+		SyncAudioBench_StartCounters(ioBench);
+		for(uint32_t theRead = 0; theRead < theReadCount; ++theRead)
+		{
+			double theSampleTime = 0.0;
+			uint64_t theHostTime = 0;
+			uint64_t theSeed = 0;
+			uint64_t theStartTime = SyncAudioBench_Now();
+			if(inUsesMutex)
+			{
+				pthread_mutex_lock(&theBenchClock.mMutex);
+				SyncAudioClock_GetZeroTimeStamp(&theBenchClock.mClock, theStartTime, &theSampleTime, &theHostTime, &theSeed);
+				pthread_mutex_unlock(&theBenchClock.mMutex);
+			}
+			else
+			{
+				SyncAudioClock_GetZeroTimeStamp(&theBenchClock.mClock, theStartTime, &theSampleTime, &theHostTime, &theSeed);
+			}
+			SyncAudioBenchSeries_Record(&theReads, SyncAudioBench_Now() - theStartTime);
+			SyncAudioBenchClock_Spin(kSyncAudioBenchClock_ReaderWork);
+		}
+
+		SyncAudioBench_BeginResult(ioBench, "get_zero_time_stamp");
+		SyncAudioBench_AddString(ioBench, "method", inUsesMutex ? "mutex" : "seqlock");
+		SyncAudioBench_AddString(ioBench, "writer", kSyncAudioBenchClock_WriterNames[inWriter]);
+		SyncAudioBench_StopCounters(ioBench, theReadCount);
+		SyncAudioBench_AddSeries(ioBench, NULL, &theReads, 0);
+		SyncAudioBench_EndResult(ioBench);
+		SyncAudioBenchSeries_Teardown(&theReads);
+	}
+	if(theWriterIsRunning)
+	{
+		atomic_store(&theBenchClock.mIsDone, true);
+		pthread_join(theWriter, NULL);
+	}
+	pthread_mutex_destroy(&theBenchClock.mMutex);
+}
+
+void	SyncAudioBench_RunClock(SyncAudioBench* ioBench)
+{
+	for(uint32_t theWriter = 0; theWriter < kSyncAudioBenchClock_WriterCount; ++theWriter)
+	{
+		SyncAudioBenchClock_Run(ioBench, false, theWriter);
+		SyncAudioBenchClock_Run(ioBench, true, theWriter);
+	}
+}
@@ -0,0 +1,232 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+The benchmark of the engine calls a device's IO cycle is made of.
+*/
+
+/*==================================================================================================
+	SyncAudioBenchIO.c
+==================================================================================================*/
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	Self Include
+#include "SyncAudioBench.h"
+
+//	Local Includes
+#include "SyncAudioEngine.h"
+
+//	System Includes
+#include <stdlib.h>
+
+//==================================================================================================
+#pragma mark -
+#pragma mark IO Cycle
+//==================================================================================================
+
+//	The "io" suite times what SyncAudio_DoIOOperation does in one IO cycle, which is the engine
+//	calls it makes, since the HAL adapter itself only builds against CoreAudio. Each cycle reads
+//	the input of the buffer that starts at the cycle's sample time, as ReadInput does, and then
+//	mixes the output a buffer ahead of it, as WriteMix does, so the reads always find their frames.
+//	Extra writers mix into the same cycle, as several sources writing one device's ring would, and
+//	extra readers read the main ring again with their own gain ramps, as ProcessInput does for the
+//	clients that read it.
+//
+//	The stream starts inFirstPart frames short of a buffer boundary, so every cycle that reaches
+//	the end of the ring splits its copies into inFirstPart frames before the wrap and the rest
+//	after it. Those cycles are also reported on their own under the "wrap_" members. A first part
+//	of a whole buffer lines the buffers up with the end of the ring, so none of them split. The stream
+//	runs for at least a few laps of the ring so there are enough of them to go on, after a few
+//	cycles that aren't timed to get the caches and the branch predictors going.
+
+#define	kSyncAudioBenchIO_SampleRate		48000.0
+#define	kSyncAudioBenchIO_ChannelCount		2
+#define	kSyncAudioBenchIO_RingFrameCapacity	(1U << 18)
+#define	kSyncAudioBenchIO_MaxBufferFrames	4096
+#define	kSyncAudioBenchIO_MaxWriters		8
+#define	kSyncAudioBenchIO_MaxReaders		4
+#define	kSyncAudioBenchIO_MinCycles			2048
+#define	kSyncAudioBenchIO_Laps				4
+#define	kSyncAudioBenchIO_WarmUpCycles		256
+
+enum
+{
+	kSyncAudioBenchIO_Unity		= 0,
+	kSyncAudioBenchIO_Volume	= 1,
+	kSyncAudioBenchIO_Mute		= 2,
+	kSyncAudioBenchIO_Ramp		= 3,
+	kSyncAudioBenchIO_GainCount	= 4
+};
+
+static const char* const	kSyncAudioBenchIO_GainNames[kSyncAudioBenchIO_GainCount] = { "unity", "volume", "mute", "ramp" };
+
+typedef struct SyncAudioBenchIO
+{
+	uint64_t	mHostTime;
+	float*		mInput;
+	float*		mOutputs[kSyncAudioBenchIO_MaxWriters];
+} SyncAudioBenchIO;
+
+static uint64_t	SyncAudioBenchIO_GetHostTime(void* inContext)
+{
+	return ((const SyncAudioBenchIO*)inContext)->mHostTime;
+}
+
+static float	SyncAudioBenchIO_GetGain(uint32_t inGain, uint64_t inCycle)
+{
+	float theAnswer = 1.0f;
+	switch(inGain)
+	{
+		case kSyncAudioBenchIO_Volume:
+			theAnswer = 0.5f;
+			break;
+
+		case kSyncAudioBenchIO_Mute:
+			theAnswer = 0.0f;
+			break;
+
+		case kSyncAudioBenchIO_Ramp:
+			theAnswer = ((inCycle & 1) != 0) ? 0.25f : 0.75f;
+			break;
+	}
+	return theAnswer;
+}
+
+static void	SyncAudioBenchIO_Run(SyncAudioBench* ioBench, SyncAudioBenchIO* ioIO, uint32_t inBufferFrames, uint32_t inFirstPart, uint32_t inGain, uint32_t inWriters, uint32_t inReaders)
+{
+	SyncAudioHostClock theHostClock = { ioIO, SyncAudioBenchIO_GetHostTime, 1000000000ULL, 1 };
+	SyncAudioEngine theEngine;
+	if(SyncAudioEngine_Initialize(&theEngine, NULL, &theHostClock, kSyncAudioBenchIO_SampleRate, kSyncAudioBenchIO_SampleRate, kSyncAudioBenchIO_ChannelCount, kSyncAudioBenchIO_RingFrameCapacity, inBufferFrames, 0))
+	{
+		SyncAudioEngine_SetDelayMilliseconds(&theEngine, 0.0);
+		SyncAudioEngine_StartIO(&theEngine);
+
+		//	enough cycles for a few laps of the ring and so a few wraps
+		uint32_t theRingFrames = theEngine.mRing.mFrameCapacity;
+		uint32_t theLapCycles = theRingFrames / inBufferFrames;
+		uint32_t theCycleCount = SyncAudioBench_Iterations(ioBench, kSyncAudioBenchIO_MinCycles);
+		uint32_t theLapsCycleCount = theLapCycles * (ioBench->mQuick ? 1 : kSyncAudioBenchIO_Laps);
+		theCycleCount = (theCycleCount > theLapsCycleCount) ? theCycleCount : theLapsCycleCount;
+
+		SyncAudioBenchSeries theCycles;
+		SyncAudioBenchSeries theWrapCycles;
+		SyncAudioBenchSeries_Initialize(&theCycles, theCycleCount);
+		SyncAudioBenchSeries_Initialize(&theWrapCycles, theCycleCount);
+		float theReadGains[kSyncAudioBenchIO_MaxReaders] = { 0.0f };
+
+		//	the first buffer is written before the stream starts
+		int64_t theSampleTime = (int64_t)(inBufferFrames - inFirstPart);
+		SyncAudioEngine_WriteMix(&theEngine, theSampleTime, ioIO->mOutputs[0], inBufferFrames, 0);
+		for(uint64_t theCycle = 1; theCycle <= (theCycleCount + kSyncAudioBenchIO_WarmUpCycles); ++theCycle)
+		{
+			if(theCycle == (kSyncAudioBenchIO_WarmUpCycles + 1))
+			{
+				SyncAudioBench_StartCounters(ioBench);
+			}
+			float theGain = SyncAudioBenchIO_GetGain(inGain, theCycle);
+			ioIO->mHostTime += (uint64_t)(inBufferFrames * 1000000000.0 / kSyncAudioBenchIO_SampleRate);
+			bool isWrapping = (((uint64_t)theSampleTime % theRingFrames) + inBufferFrames) > theRingFrames;
+
+			uint64_t theStartTime = SyncAudioBench_Now();
+			SyncAudioEngine_ReadInput(&theEngine, theSampleTime, theGain, ioIO->mInput, inBufferFrames);
+			for(uint32_t theReader = 1; theReader < inReaders; ++theReader)
+			{
+				SyncAudioEngine_ReadBus(&theEngine, kSyncAudioEngine_MainBus, theSampleTime, theGain, &theReadGains[theReader], ioIO->mInput, inBufferFrames);
+			}
+			for(uint32_t theWriter = 0; theWriter < inWriters; ++theWriter)
+			{
+				SyncAudioEngine_WriteMix(&theEngine, theSampleTime + inBufferFrames, ioIO->mOutputs[theWriter], inBufferFrames, theCycle);
+			}
+			uint64_t theDuration = SyncAudioBench_Now() - theStartTime;
+
+			if(theCycle > kSyncAudioBenchIO_WarmUpCycles)
+			{
+				SyncAudioBenchSeries_Record(&theCycles, theDuration);
+				if(isWrapping)
+				{
+					SyncAudioBenchSeries_Record(&theWrapCycles, theDuration);
+				}
+			}
+			theSampleTime += inBufferFrames;
+		}
+
+		SyncAudioBench_BeginResult(ioBench, "cycle");
+		SyncAudioBench_AddInteger(ioBench, "buffer_frames", inBufferFrames);
+		SyncAudioBench_AddInteger(ioBench, "first_part_frames", inFirstPart);
+		SyncAudioBench_AddString(ioBench, "gain", kSyncAudioBenchIO_GainNames[inGain]);
+		SyncAudioBench_AddInteger(ioBench, "writers", inWriters);
+		SyncAudioBench_AddInteger(ioBench, "readers", inReaders);
+		SyncAudioBench_StopCounters(ioBench, theCycleCount);
+		SyncAudioBench_AddSeries(ioBench, NULL, &theCycles, inBufferFrames);
+		SyncAudioBench_AddSeries(ioBench, "wrap_", &theWrapCycles, inBufferFrames);
+		SyncAudioBench_EndResult(ioBench);
+
+		SyncAudioBenchSeries_Teardown(&theCycles);
+		SyncAudioBenchSeries_Teardown(&theWrapCycles);
+		SyncAudioEngine_Teardown(&theEngine);
+	}
+}
+
+void	SyncAudioBench_RunIO(SyncAudioBench* ioBench)
+{
+	SyncAudioBenchIO theIO = { 1000000000ULL, NULL, { NULL } };
+	size_t theBufferSamples = (size_t)kSyncAudioBenchIO_MaxBufferFrames * kSyncAudioBenchIO_ChannelCount;
+	theIO.mInput = (float*)calloc(theBufferSamples, sizeof(float));
+	bool theBuffersAreAllocated = theIO.mInput != NULL;
+	for(uint32_t theWriter = 0; theWriter < kSyncAudioBenchIO_MaxWriters; ++theWriter)
+	{
+		//	something that isn't silence, which some kernels could treat differently
+		theIO.mOutputs[theWriter] = (float*)malloc(theBufferSamples * sizeof(float));
+		theBuffersAreAllocated = theBuffersAreAllocated && (theIO.mOutputs[theWriter] != NULL);
+		for(size_t theSample = 0; (theIO.mOutputs[theWriter] != NULL) && (theSample < theBufferSamples); ++theSample)
+		{
+			theIO.mOutputs[theWriter][theSample] = (float)((int32_t)((theSample + theWriter) * 2654435761U) >> 8) / 16777216.0f;
+		}
+	}
+
+	if(theBuffersAreAllocated)
+	{
+		//	the wrap split at every buffer size
+		for(uint32_t theBufferFrames = 16; theBufferFrames <= kSyncAudioBenchIO_MaxBufferFrames; theBufferFrames <<= 1)
+		{
+			for(uint32_t theQuarter = 4; theQuarter > 0; --theQuarter)
+			{
+				SyncAudioBenchIO_Run(ioBench, &theIO, theBufferFrames, (theBufferFrames * theQuarter) / 4, kSyncAudioBenchIO_Unity, 1, 1);
+			}
+		}
+
+		//	the gain states at every buffer size
+		for(uint32_t theBufferFrames = 16; theBufferFrames <= kSyncAudioBenchIO_MaxBufferFrames; theBufferFrames <<= 1)
+		{
+			for(uint32_t theGain = kSyncAudioBenchIO_Volume; theGain < kSyncAudioBenchIO_GainCount; ++theGain)
+			{
+				SyncAudioBenchIO_Run(ioBench, &theIO, theBufferFrames, theBufferFrames, theGain, 1, 1);
+			}
+		}
+
+		//	the writer and reader counts at a small, a typical and a large buffer size
+		static const uint32_t kBufferFrames[] = { 64, 512, 4096 };
+		for(uint32_t theSize = 0; theSize < (sizeof(kBufferFrames) / sizeof(kBufferFrames[0])); ++theSize)
+		{
+			for(uint32_t theWriters = 1; theWriters <= kSyncAudioBenchIO_MaxWriters; theWriters <<= 1)
+			{
+				for(uint32_t theReaders = 1; theReaders <= kSyncAudioBenchIO_MaxReaders; theReaders <<= 1)
+				{
+					if((theWriters != 1) || (theReaders != 1))
+					{
+						SyncAudioBenchIO_Run(ioBench, &theIO, kBufferFrames[theSize], kBufferFrames[theSize], kSyncAudioBenchIO_Unity, theWriters, theReaders);
+					}
+				}
+			}
+		}
+	}
+
+	free(theIO.mInput);
+	for(uint32_t theWriter = 0; theWriter < kSyncAudioBenchIO_MaxWriters; ++theWriter)
+	{
+		free(theIO.mOutputs[theWriter]);
+	}
+}
@@ -0,0 +1,170 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+The benchmark of the sample processing kernels.
+*/
+
+/*==================================================================================================
+	SyncAudioBenchKernels.c
+==================================================================================================*/
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	Self Include
+#include "SyncAudioBench.h"
+
+//	Local Includes
+#include "SyncAudioKernels.h"
+
+//	System Includes
+#include <stdlib.h>
+#include <string.h>
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Copying Out of the Ring
+//==================================================================================================
+
+//	The "kernels" suite times getting a buffer out of the ring with a gain on it, with every set of
+//	kernels the processor supports and at every channel count a device can have, two ways:
+//
+//		- "two_pass" copies the frames out, in two pieces when they wrap, and then scales the
+//		  buffer in place, which is what ReadInput did with cblas_scopy and vDSP_vsmul.
+//		- "fused" scales the frames on their way out with mCopyScaled, which is what the ring does
+//		  now, so every sample is only touched once.
+//
+//	The reads walk through a ring far bigger than the caches, as the IO thread does, so the cost
+//	of going through memory twice shows up.
+//
+//	It also times the interpolation of a buffer that was just read, which is in the cache, at every
+//	channel count with the function built for any channel count, "generic", and with the one built
+//	for that count, "specialized".
+
+#define	kSyncAudioBenchKernels_RingFrameCapacity	(1U << 18)
+#define	kSyncAudioBenchKernels_MaxChannelCount		8
+#define	kSyncAudioBenchKernels_MaxBufferFrames		4096
+#define	kSyncAudioBenchKernels_MinOperations		4096
+#define	kSyncAudioBenchKernels_MaxKernels			4
+
+static void	SyncAudioBenchKernels_RunCopy(SyncAudioBench* ioBench, const SyncAudioKernels* inKernels, const float* inRing, float* outData, uint32_t inChannelCount, uint32_t inBufferFrames, bool inIsFused)
+{
+	uint32_t theOperationCount = SyncAudioBench_Iterations(ioBench, kSyncAudioBenchKernels_MinOperations);
+	SyncAudioBenchSeries theOperations;
+	SyncAudioBenchSeries_Initialize(&theOperations, theOperationCount);
+
+	//	start a little short of a buffer boundary so some of the reads wrap
+	uint32_t theStart = inBufferFrames / 2;
+	SyncAudioBench_StartCounters(ioBench);
+	for(uint32_t theOperation = 0; theOperation < theOperationCount; ++theOperation)
+	{
+		float theGain = ((theOperation & 1) != 0) ? 0.25f : 0.75f;
+		float theGainStep = (((theOperation & 1) != 0) ? 0.5f : -0.5f) / (float)(inBufferFrames * inChannelCount);
+		uint32_t theFirstPart = kSyncAudioBenchKernels_RingFrameCapacity - theStart;
+		theFirstPart = (theFirstPart < inBufferFrames) ? theFirstPart : inBufferFrames;
+		uint32_t theFirstSamples = theFirstPart * inChannelCount;
+		uint32_t theSecondSamples = (inBufferFrames - theFirstPart) * inChannelCount;
+		const float* theSource = inRing + ((size_t)theStart * inChannelCount);
+
+		uint64_t theStartTime = SyncAudioBench_Now();
+		if(inIsFused)
+		{
+			inKernels->mCopyScaled(theSource, outData, theFirstSamples, theGain, theGainStep);
+			inKernels->mCopyScaled(inRing, outData + theFirstSamples, theSecondSamples, theGain + (theGainStep * (float)theFirstSamples), theGainStep);
+		}
+		else
+		{
+			memcpy(outData, theSource, theFirstSamples * sizeof(float));
+			memcpy(outData + theFirstSamples, inRing, theSecondSamples * sizeof(float));
+			inKernels->mCopyScaled(outData, outData, theFirstSamples + theSecondSamples, theGain, theGainStep);
+		}
+		SyncAudioBenchSeries_Record(&theOperations, SyncAudioBench_Now() - theStartTime);
+		theStart = (theStart + inBufferFrames) & (kSyncAudioBenchKernels_RingFrameCapacity - 1);
+	}
+
+	SyncAudioBench_BeginResult(ioBench, "copy_scaled");
+	SyncAudioBench_AddString(ioBench, "kernels", inKernels->mName);
+	SyncAudioBench_AddString(ioBench, "method", inIsFused ? "fused" : "two_pass");
+	SyncAudioBench_AddInteger(ioBench, "channels", inChannelCount);
+	SyncAudioBench_AddInteger(ioBench, "buffer_frames", inBufferFrames);
+	SyncAudioBench_StopCounters(ioBench, theOperationCount);
+	SyncAudioBench_AddSeries(ioBench, NULL, &theOperations, inBufferFrames);
+	SyncAudioBench_EndResult(ioBench);
+	SyncAudioBenchSeries_Teardown(&theOperations);
+}
+
+static void	SyncAudioBenchKernels_RunInterpolate(SyncAudioBench* ioBench, const SyncAudioKernels* inKernels, const float* inSource, float* outData, uint32_t inChannelCount, uint32_t inBufferFrames, bool inIsSpecialized)
+{
+	uint32_t theOperationCount = SyncAudioBench_Iterations(ioBench, kSyncAudioBenchKernels_MinOperations);
+	SyncAudioBenchSeries theOperations;
+	SyncAudioBenchSeries_Initialize(&theOperations, theOperationCount);
+	SyncAudioKernelsInterpolateScaledFunction theFunction = inIsSpecialized ? SyncAudioKernels_GetInterpolateScaled(inKernels, inChannelCount) : inKernels->mInterpolateScaled;
+	float thePrevious[kSyncAudioBenchKernels_MaxChannelCount] = { 0 };
+	uint32_t theSampleCount = inBufferFrames * inChannelCount;
+
+	//	every operation starts from the same data, copied in untimed, so that it doesn't decay into
+	//	denormals
+	SyncAudioBench_StartCounters(ioBench);
+	for(uint32_t theOperation = 0; theOperation < theOperationCount; ++theOperation)
+	{
+		float theGain = ((theOperation & 1) != 0) ? 0.25f : 0.75f;
+		float theGainStep = (((theOperation & 1) != 0) ? 0.5f : -0.5f) / (float)theSampleCount;
+		memcpy(outData, inSource, theSampleCount * sizeof(float));
+		uint64_t theStartTime = SyncAudioBench_Now();
+		theFunction(outData, thePrevious, inChannelCount, theSampleCount, 0.25f, theGain, theGainStep);
+		SyncAudioBenchSeries_Record(&theOperations, SyncAudioBench_Now() - theStartTime);
+	}
+
+	SyncAudioBench_BeginResult(ioBench, "interpolate_scaled");
+	SyncAudioBench_AddString(ioBench, "kernels", inKernels->mName);
+	SyncAudioBench_AddString(ioBench, "method", inIsSpecialized ? "specialized" : "generic");
+	SyncAudioBench_AddInteger(ioBench, "channels", inChannelCount);
+	SyncAudioBench_AddInteger(ioBench, "buffer_frames", inBufferFrames);
+	SyncAudioBench_StopCounters(ioBench, theOperationCount);
+	SyncAudioBench_AddSeries(ioBench, NULL, &theOperations, inBufferFrames);
+	SyncAudioBench_EndResult(ioBench);
+	SyncAudioBenchSeries_Teardown(&theOperations);
+}
+
+void	SyncAudioBench_RunKernels(SyncAudioBench* ioBench)
+{
+	static const uint32_t kWidths[kSyncAudioKernels_WidthCount] = kSyncAudioKernels_Widths;
+	const SyncAudioKernels* theKernels[kSyncAudioBenchKernels_MaxKernels];
+	uint32_t theKernelCount = SyncAudioKernels_GetSupported(theKernels, kSyncAudioBenchKernels_MaxKernels);
+	size_t theRingSamples = (size_t)kSyncAudioBenchKernels_RingFrameCapacity * kSyncAudioBenchKernels_MaxChannelCount;
+	float* theRing = (float*)malloc(theRingSamples * sizeof(float));
+	float* theData = (float*)calloc((size_t)kSyncAudioBenchKernels_MaxBufferFrames * kSyncAudioBenchKernels_MaxChannelCount, sizeof(float));
+	if((theRing != NULL) && (theData != NULL))
+	{
+		for(size_t theSample = 0; theSample < theRingSamples; ++theSample)
+		{
+			theRing[theSample] = (float)((int32_t)(theSample * 2654435761U) >> 8) / 16777216.0f;
+		}
+		for(uint32_t theKernel = 0; theKernel < theKernelCount; ++theKernel)
+		{
+			for(uint32_t theWidth = 0; theWidth < kSyncAudioKernels_WidthCount; ++theWidth)
+			{
+				for(uint32_t theBufferFrames = 64; theBufferFrames <= kSyncAudioBenchKernels_MaxBufferFrames; theBufferFrames <<= 2)
+				{
+					SyncAudioBenchKernels_RunCopy(ioBench, theKernels[theKernel], theRing, theData, kWidths[theWidth], theBufferFrames, false);
+					SyncAudioBenchKernels_RunCopy(ioBench, theKernels[theKernel], theRing, theData, kWidths[theWidth], theBufferFrames, true);
+				}
+			}
+		}
+		for(uint32_t theKernel = 0; theKernel < theKernelCount; ++theKernel)
+		{
+			for(uint32_t theWidth = 0; theWidth < kSyncAudioKernels_WidthCount; ++theWidth)
+			{
+				for(uint32_t theBufferFrames = 64; theBufferFrames <= kSyncAudioBenchKernels_MaxBufferFrames; theBufferFrames <<= 2)
+				{
+					SyncAudioBenchKernels_RunInterpolate(ioBench, theKernels[theKernel], theRing, theData, kWidths[theWidth], theBufferFrames, false);
+					SyncAudioBenchKernels_RunInterpolate(ioBench, theKernels[theKernel], theRing, theData, kWidths[theWidth], theBufferFrames, true);
+				}
+			}
+		}
+	}
+	free(theRing);
+	free(theData);
+}
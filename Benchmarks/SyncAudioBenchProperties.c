@@ -0,0 +1,239 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+The benchmark of looking properties up the way the HAL asks for them.
+*/
+
+/*==================================================================================================
+	SyncAudioBenchProperties.c
+==================================================================================================*/
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	Self Include
+#include "SyncAudioBench.h"
+
+//	Local Includes
+#include "SyncAudioProperties.h"
+
+//	System Includes
+#include <stdlib.h>
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Lookups
+//==================================================================================================
+
+//	The "properties" suite times the lookups of a storm of property queries, like the one the HAL
+//	sends every object when it enumerates the plug-in at login, three ways:
+//
+//		- "registry" is SyncAudioPropertyRegistry_Find.
+//		- "binary" is a binary search of the entries sorted by kind and selector, which is what the
+//		  compiler makes of the nested switch statements the plug-in used to dispatch through.
+//		- "linear" walks the entries in order, which is what the switch statements cost when the
+//		  compiler doesn't turn them into a search.
+//
+//	The entries are as many per kind of object as SyncAudio.c has, 106 over 7 kinds, with four
+//	character selectors made up of lower case letters like the HAL's. The first few are shared by
+//	every kind, as kAudioObjectPropertyBaseClass and its like are. A storm asks every kind for
+//	every selector in the table, so most of the queries are for properties the object doesn't
+//	have, as they are at login, and the order of the queries is shuffled so that the branches can't
+//	be learned.
+
+#define	kSyncAudioBenchProperties_KindCount		7
+#define	kSyncAudioBenchProperties_SharedCount	6
+#define	kSyncAudioBenchProperties_MinStorms		2000
+
+enum
+{
+	kSyncAudioBenchProperties_Registry		= 0,
+	kSyncAudioBenchProperties_Binary		= 1,
+	kSyncAudioBenchProperties_Linear		= 2,
+	kSyncAudioBenchProperties_MethodCount	= 3
+};
+
+static const char* const	kSyncAudioBenchProperties_MethodNames[kSyncAudioBenchProperties_MethodCount] = { "registry", "binary", "linear" };
+static const uint32_t		kSyncAudioBenchProperties_KindSizes[kSyncAudioBenchProperties_KindCount] = { 13, 19, 33, 14, 11, 7, 9 };
+
+typedef struct SyncAudioBenchPropertiesQuery
+{
+	uint32_t	mObjectKind;
+	uint32_t	mSelector;
+} SyncAudioBenchPropertiesQuery;
+
+static uint32_t	SyncAudioBenchProperties_MakeSelector(uint64_t* ioSeed)
+{
+	uint32_t theAnswer = 0;
+	for(uint32_t theIndex = 0; theIndex < 4; ++theIndex)
+	{
+		*ioSeed = (*ioSeed * 6364136223846793005ULL) + 1442695040888963407ULL;
+		theAnswer = (theAnswer << 8) | (uint32_t)('a' + ((*ioSeed >> 33) % 26));
+	}
+	return theAnswer;
+}
+
+static int	SyncAudioBenchProperties_Compare(const void* inLeft, const void* inRight)
+{
+	const SyncAudioPropertyInfo* theLeft = (const SyncAudioPropertyInfo*)inLeft;
+	const SyncAudioPropertyInfo* theRight = (const SyncAudioPropertyInfo*)inRight;
+	int theAnswer = (theLeft->mObjectKind > theRight->mObjectKind) - (theLeft->mObjectKind < theRight->mObjectKind);
+	if(theAnswer == 0)
+	{
+		theAnswer = (theLeft->mSelector > theRight->mSelector) - (theLeft->mSelector < theRight->mSelector);
+	}
+	return theAnswer;
+}
+
+static const SyncAudioPropertyInfo*	SyncAudioBenchProperties_FindBinary(const SyncAudioPropertyInfo* inProperties, uint32_t inPropertyCount, uint32_t inObjectKind, uint32_t inSelector)
+{
+	const SyncAudioPropertyInfo* theAnswer = NULL;
+	uint32_t theLow = 0;
+	uint32_t theHigh = inPropertyCount;
+	while((theAnswer == NULL) && (theLow < theHigh))
+	{
+		uint32_t theMiddle = (theLow + theHigh) / 2;
+		const SyncAudioPropertyInfo* theInfo = &inProperties[theMiddle];
+		if((theInfo->mObjectKind < inObjectKind) || ((theInfo->mObjectKind == inObjectKind) && (theInfo->mSelector < inSelector)))
+		{
+			theLow = theMiddle + 1;
+		}
+		else if((theInfo->mObjectKind == inObjectKind) && (theInfo->mSelector == inSelector))
+		{
+			theAnswer = theInfo;
+		}
+		else
+		{
+			theHigh = theMiddle;
+		}
+	}
+	return theAnswer;
+}
+
+static const SyncAudioPropertyInfo*	SyncAudioBenchProperties_FindLinear(const SyncAudioPropertyInfo* inProperties, uint32_t inPropertyCount, uint32_t inObjectKind, uint32_t inSelector)
+{
+	const SyncAudioPropertyInfo* theAnswer = NULL;
+	for(uint32_t theIndex = 0; (theAnswer == NULL) && (theIndex < inPropertyCount); ++theIndex)
+	{
+		if((inProperties[theIndex].mObjectKind == inObjectKind) && (inProperties[theIndex].mSelector == inSelector))
+		{
+			theAnswer = &inProperties[theIndex];
+		}
+	}
+	return theAnswer;
+}
+
+void	SyncAudioBench_RunProperties(SyncAudioBench* ioBench)
+{
+	//	the entries, with every selector that isn't shared drawn afresh until it's unique
+	uint32_t thePropertyCount = 0;
+	for(uint32_t theKind = 0; theKind < kSyncAudioBenchProperties_KindCount; ++theKind)
+	{
+		thePropertyCount += kSyncAudioBenchProperties_KindSizes[theKind];
+	}
+	SyncAudioPropertyInfo* theProperties = (SyncAudioPropertyInfo*)calloc(thePropertyCount, sizeof(SyncAudioPropertyInfo));
+	uint32_t theSharedSelectors[kSyncAudioBenchProperties_SharedCount];
+	uint64_t theSeed = 1;
+	for(uint32_t theIndex = 0; theIndex < kSyncAudioBenchProperties_SharedCount; ++theIndex)
+	{
+		theSharedSelectors[theIndex] = SyncAudioBenchProperties_MakeSelector(&theSeed);
+	}
+	uint32_t theEntry = 0;
+	for(uint32_t theKind = 0; theKind < kSyncAudioBenchProperties_KindCount; ++theKind)
+	{
+		for(uint32_t theIndex = 0; theIndex < kSyncAudioBenchProperties_KindSizes[theKind]; ++theIndex)
+		{
+			uint32_t theSelector = (theIndex < kSyncAudioBenchProperties_SharedCount) ? theSharedSelectors[theIndex] : SyncAudioBenchProperties_MakeSelector(&theSeed);
+			while((theIndex >= kSyncAudioBenchProperties_SharedCount) && (SyncAudioBenchProperties_FindLinear(theProperties, theEntry, theKind + 1, theSelector) != NULL))
+			{
+				theSelector = SyncAudioBenchProperties_MakeSelector(&theSeed);
+			}
+			theProperties[theEntry].mObjectKind = theKind + 1;
+			theProperties[theEntry].mSelector = theSelector;
+			theProperties[theEntry].mDataSize = sizeof(uint32_t);
+			++theEntry;
+		}
+	}
+	SyncAudioPropertyRegistry theRegistry;
+	bool theRegistryIsValid = SyncAudioPropertyRegistry_Initialize(&theRegistry, theProperties, thePropertyCount);
+	SyncAudioPropertyInfo* theSortedProperties = (SyncAudioPropertyInfo*)malloc(thePropertyCount * sizeof(SyncAudioPropertyInfo));
+	for(uint32_t theIndex = 0; theIndex < thePropertyCount; ++theIndex)
+	{
+		theSortedProperties[theIndex] = theProperties[theIndex];
+	}
+	qsort(theSortedProperties, thePropertyCount, sizeof(SyncAudioPropertyInfo), SyncAudioBenchProperties_Compare);
+
+	//	the storm, in a shuffled order
+	uint32_t theQueryCount = kSyncAudioBenchProperties_KindCount * thePropertyCount;
+	SyncAudioBenchPropertiesQuery* theQueries = (SyncAudioBenchPropertiesQuery*)malloc(theQueryCount * sizeof(SyncAudioBenchPropertiesQuery));
+	uint32_t theHitCount = 0;
+	for(uint32_t theIndex = 0; theIndex < theQueryCount; ++theIndex)
+	{
+		theQueries[theIndex].mObjectKind = (theIndex / thePropertyCount) + 1;
+		theQueries[theIndex].mSelector = theProperties[theIndex % thePropertyCount].mSelector;
+		theHitCount += (SyncAudioBenchProperties_FindLinear(theProperties, thePropertyCount, theQueries[theIndex].mObjectKind, theQueries[theIndex].mSelector) != NULL) ? 1 : 0;
+	}
+	for(uint32_t theIndex = theQueryCount - 1; theIndex > 0; --theIndex)
+	{
+		theSeed = (theSeed * 6364136223846793005ULL) + 1442695040888963407ULL;
+		uint32_t theOther = (uint32_t)((theSeed >> 33) % (theIndex + 1));
+		SyncAudioBenchPropertiesQuery theQuery = theQueries[theIndex];
+		theQueries[theIndex] = theQueries[theOther];
+		theQueries[theOther] = theQuery;
+	}
+
+	if(theRegistryIsValid)
+	{
+		for(uint32_t theMethod = 0; theMethod < kSyncAudioBenchProperties_MethodCount; ++theMethod)
+		{
+			uint32_t theStormCount = SyncAudioBench_Iterations(ioBench, kSyncAudioBenchProperties_MinStorms);
+			uint32_t theFoundCount = 0;
+			SyncAudioBenchSeries theStorms;
+			SyncAudioBenchSeries_Initialize(&theStorms, theStormCount);
+			SyncAudioBench_StartCounters(ioBench);
+			for(uint32_t theStorm = 0; theStorm < theStormCount; ++theStorm)
+			{
+				theFoundCount = 0;
+				uint64_t theStartTime = SyncAudioBench_Now();
+				for(uint32_t theIndex = 0; theIndex < theQueryCount; ++theIndex)
+				{
+					const SyncAudioPropertyInfo* theInfo = NULL;
+					switch(theMethod)
+					{
+						case kSyncAudioBenchProperties_Registry:
+							theInfo = SyncAudioPropertyRegistry_Find(&theRegistry, theQueries[theIndex].mObjectKind, theQueries[theIndex].mSelector);
+							break;
+
+						case kSyncAudioBenchProperties_Binary:
+							theInfo = SyncAudioBenchProperties_FindBinary(theSortedProperties, thePropertyCount, theQueries[theIndex].mObjectKind, theQueries[theIndex].mSelector);
+							break;
+
+						default:
+							theInfo = SyncAudioBenchProperties_FindLinear(theProperties, thePropertyCount, theQueries[theIndex].mObjectKind, theQueries[theIndex].mSelector);
+							break;
+					}
+					theFoundCount += (theInfo != NULL) ? 1 : 0;
+				}
+				SyncAudioBenchSeries_Record(&theStorms, SyncAudioBench_Now() - theStartTime);
+			}
+
+			//	the mean per frame is the mean per query, and a method that finds a different number
+			//	of properties than there are is wrong rather than fast
+			SyncAudioBench_BeginResult(ioBench, "storm");
+			SyncAudioBench_AddString(ioBench, "method", kSyncAudioBenchProperties_MethodNames[theMethod]);
+			SyncAudioBench_AddInteger(ioBench, "properties", thePropertyCount);
+			SyncAudioBench_AddInteger(ioBench, "queries", theQueryCount);
+			SyncAudioBench_AddBoolean(ioBench, "correct", theFoundCount == theHitCount);
+			SyncAudioBench_StopCounters(ioBench, theStormCount);
+			SyncAudioBench_AddSeries(ioBench, NULL, &theStorms, theQueryCount);
+			SyncAudioBench_EndResult(ioBench);
+			SyncAudioBenchSeries_Teardown(&theStorms);
+		}
+	}
+
+	free(theQueries);
+	free(theSortedProperties);
+	free(theProperties);
+}
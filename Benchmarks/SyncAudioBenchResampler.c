@@ -0,0 +1,122 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+The benchmark of converting the sample rate of a ring as the IO thread reads it.
+*/
+
+/*==================================================================================================
+	SyncAudioBenchResampler.c
+==================================================================================================*/
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	Self Include
+#include "SyncAudioBench.h"
+
+//	Local Includes
+#include "SyncAudioResampler.h"
+
+//	System Includes
+#include <math.h>
+#include <stdlib.h>
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Conversion
+//==================================================================================================
+
+//	The "resampler" suite times SyncAudioResampler_Read of an IO buffer from a ring written at
+//	another rate, at every quality, between 48 and 44.1 kHz in both directions and at 1, 2 and 8
+//	channels. Going down stretches the filter, which works its taps out for every frame, and going
+//	up uses the tabulated phases. Each result also has "core_percent_per_channel", the share of one
+//	core that converting a channel in real time at the reader's rate takes by the mean.
+
+#define	kSyncAudioBenchResampler_RingFrameCapacity	(1U << 16)
+#define	kSyncAudioBenchResampler_BufferFrames		512
+#define	kSyncAudioBenchResampler_MinOperations		2000
+#define	kSyncAudioBenchResampler_WidthCount			3
+
+static const uint32_t		kSyncAudioBenchResampler_Widths[kSyncAudioBenchResampler_WidthCount] = { 1, 2, 8 };
+static const char* const	kSyncAudioBenchResampler_QualityNames[kSyncAudioResampler_QualityCount] = { "low", "medium", "high", "best" };
+
+static void	SyncAudioBenchResampler_Run(SyncAudioBench* ioBench, SyncAudioRing* ioRing, float* outData, uint32_t inQuality, uint32_t inChannelCount, double inSourceRate, double inReadRate)
+{
+	SyncAudioResampler theResampler;
+	if(SyncAudioResampler_Initialize(&theResampler, inQuality, inChannelCount))
+	{
+		uint32_t theOperationCount = SyncAudioBench_Iterations(ioBench, kSyncAudioBenchResampler_MinOperations);
+		SyncAudioBenchSeries theOperations;
+		SyncAudioBenchSeries_Initialize(&theOperations, theOperationCount);
+		uint64_t theStep = (uint64_t)llround((inSourceRate / inReadRate) * 4294967296.0);
+
+		//	the reads walk through the middle of the ring, starting over when they get near its end
+		uint64_t thePosition = (uint64_t)kSyncAudioResampler_MaxTapCount << 32;
+		uint64_t theEnd = (uint64_t)(kSyncAudioBenchResampler_RingFrameCapacity - (2 * kSyncAudioBenchResampler_BufferFrames) - kSyncAudioResampler_MaxTapCount) << 32;
+		uint32_t theFlags = kSyncAudioRing_NoError;
+		SyncAudioBench_StartCounters(ioBench);
+		for(uint32_t theOperation = 0; theOperation < theOperationCount; ++theOperation)
+		{
+			uint64_t theStartTime = SyncAudioBench_Now();
+			theFlags |= SyncAudioResampler_Read(&theResampler, ioRing, (int64_t)(thePosition >> 32), (uint32_t)thePosition, theStep, outData, kSyncAudioBenchResampler_BufferFrames);
+			SyncAudioBenchSeries_Record(&theOperations, SyncAudioBench_Now() - theStartTime);
+			thePosition += (uint64_t)kSyncAudioBenchResampler_BufferFrames * theStep;
+			thePosition = (thePosition < theEnd) ? thePosition : ((uint64_t)kSyncAudioResampler_MaxTapCount << 32) + (uint32_t)thePosition;
+		}
+
+		//	the mean per frame in nanoseconds, times the frames in a second, is the nanoseconds of a
+		//	core a second of audio takes
+		uint64_t theTotal = 0;
+		for(uint32_t theIndex = 0; theIndex < theOperations.mCount; ++theIndex)
+		{
+			theTotal += theOperations.mDurations[theIndex];
+		}
+		double theNanosecondsPerFrame = (theOperations.mCount > 0) ? (double)theTotal / ((double)theOperations.mCount * kSyncAudioBenchResampler_BufferFrames) : 0.0;
+
+		SyncAudioBench_BeginResult(ioBench, "read");
+		SyncAudioBench_AddString(ioBench, "quality", kSyncAudioBenchResampler_QualityNames[inQuality]);
+		SyncAudioBench_AddInteger(ioBench, "source_rate", (int64_t)inSourceRate);
+		SyncAudioBench_AddInteger(ioBench, "read_rate", (int64_t)inReadRate);
+		SyncAudioBench_AddInteger(ioBench, "channels", inChannelCount);
+		SyncAudioBench_AddInteger(ioBench, "buffer_frames", kSyncAudioBenchResampler_BufferFrames);
+		SyncAudioBench_AddBoolean(ioBench, "correct", theFlags == kSyncAudioRing_NoError);
+		SyncAudioBench_AddNumber(ioBench, "core_percent_per_channel", (theNanosecondsPerFrame * inReadRate * 100.0) / (1e9 * inChannelCount));
+		SyncAudioBench_StopCounters(ioBench, theOperationCount);
+		SyncAudioBench_AddSeries(ioBench, NULL, &theOperations, kSyncAudioBenchResampler_BufferFrames);
+		SyncAudioBench_EndResult(ioBench);
+		SyncAudioBenchSeries_Teardown(&theOperations);
+		SyncAudioResampler_Teardown(&theResampler);
+	}
+}
+
+void	SyncAudioBench_RunResampler(SyncAudioBench* ioBench)
+{
+	size_t theSampleCount = (size_t)kSyncAudioBenchResampler_RingFrameCapacity * kSyncAudioRing_MaxChannelCount;
+	float* theData = (float*)malloc(theSampleCount * sizeof(float));
+	if(theData != NULL)
+	{
+		for(size_t theSample = 0; theSample < theSampleCount; ++theSample)
+		{
+			theData[theSample] = (float)((int32_t)(theSample * 2654435761U) >> 8) / 16777216.0f;
+		}
+		for(uint32_t theWidth = 0; theWidth < kSyncAudioBenchResampler_WidthCount; ++theWidth)
+		{
+			//	a full ring of noise at this channel count
+			SyncAudioRing theRing;
+			uint32_t theChannelCount = kSyncAudioBenchResampler_Widths[theWidth];
+			if(SyncAudioRing_Initialize(&theRing, kSyncAudioBenchResampler_RingFrameCapacity, theChannelCount, 0))
+			{
+				SyncAudioRing_Write(&theRing, 0, theData, kSyncAudioBenchResampler_RingFrameCapacity);
+				for(uint32_t theQuality = 0; theQuality < kSyncAudioResampler_QualityCount; ++theQuality)
+				{
+					SyncAudioBenchResampler_Run(ioBench, &theRing, theData, theQuality, theChannelCount, 48000.0, 44100.0);
+					SyncAudioBenchResampler_Run(ioBench, &theRing, theData, theQuality, theChannelCount, 44100.0, 48000.0);
+				}
+				SyncAudioRing_Teardown(&theRing);
+			}
+		}
+	}
+	free(theData);
+}
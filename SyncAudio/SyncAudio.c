@@ -13,14 +13,19 @@ A minimal user-space driver.
 //	Includes
 //==================================================================================================
 
+//	Local Includes
+#include "SyncAudioEngine.h"
+#include "SyncAudioProperties.h"
+#include "SyncAudioRoutes.h"
+#include "SyncAudioState.h"
+#include "SyncAudioTrace.h"
+
 //	System Includes
 #include <CoreAudio/AudioServerPlugIn.h>
 #include <dispatch/dispatch.h>
-#include <mach/mach_time.h>
 #include <pthread.h>
+#include <stdatomic.h>
 #include <stdint.h>
-#include <sys/syslog.h>
-#include <Accelerate/Accelerate.h>
 
 //==================================================================================================
 #pragma mark -
@@ -76,64 +81,82 @@ A minimal user-space driver.
 #pragma mark SyncAudio State
 //==================================================================================================
 
-//	The purpose of the SyncAudio sample is to provide a bare bones implementations to
-//	illustrate the minimal set of things a driver has to do. The sample driver has the following
-//	qualities:
+//	SyncAudio is a loopback driver: what is written to a device's output comes back on its input
+//	through a delay line, and clients can be routed through buses of their own and given their own
+//	levels. The driver has the following qualities:
 //	- a plug-in
 //		- custom property with the selector kPlugIn_CustomPropertyID = 'PCst'
+//		- custom property with the selector kPlugIn_IOStatisticsPropertyID = 'PIOS' for the IO statistics
 //	- a box
-//	- a device
-//		- supports 44100 and 48000 sample rates
+//	- one or more devices, as listed in the "devices" setting, each with its own ring and clock
+//		- supports the sample rates in kDevice_SampleRates, from 44100 up to its "max sample rate", at most 192000
 //		- provides a rate scalar of 1.0 via hard coding
+//		- custom property with the selector kDevice_DelayPropertyID = 'Dlay' for the delay line
+//		- custom property with the selector kDevice_MemoryStatusPropertyID = 'DMem' for the ring's memory status
+//		- custom property with the selector kDevice_ClientRoutesPropertyID = 'DRte' for routing clients through separate buses
+//		- custom properties with the selectors kDevice_ClientVolumePropertyID = 'DCvl' and kDevice_ClientMutePropertyID = 'DCmt' for each client's output level
+//		- optionally plays back another device's output, converted to its own sample rate
 //	- a single input stream
-//		- supports 2 channels of 32 bit float LPCM samples
-//		- always produces zeros 
+//		- supports the device's 1, 2, 6 or 8 channels of 32 bit float LPCM samples
+//		- also has physical formats of 16 bit, packed 24 bit and 32 bit integer samples, which it
+//		  converts to and from itself, quantizing to 16 and 24 bits with dither
+//		- plays back what the output stream was given, behind it by the delay line and the margin
+//		  for a late writer, both of which it reports as latency
+//		- a client routed through a bus gets that bus instead of the main mix
 //	- a single output stream
-//		- supports 2 channels of 32 bit float LPCM samples
-//		- data written to it is ignored
+//		- supports the same formats as the input stream
+//		- mixes what its clients write into the device's ring at the output's sample time
+//		- a client routed through a bus has its output copied there, and diverted from the main
+//		  mix if asked, after its own level is applied
 //	- controls
-//		- master input volume
-//		- master output volume
-//		- master input mute
-//		- master output mute
+//		- master output volume and mute, which are applied, with a ramp, to what the input plays
+//		  back
+//		- master input volume and mute, which are kept and reported but don't change the data
 //		- master input data source
 //		- master output data source
 //		- master play-through data destination
-//		- all are for illustration purposes only and do not actually manipulate data
+//		- the data source and destination controls are for illustration purposes only
 
 
-//	Declare the internal object ID numbers for all the objects this driver implements. Note that
-//	this driver has a fixed set of objects that never grows or shrinks. If this were not the case,
-//	the driver would need to have a means to dynamically allocate these IDs. It's important to
-//	realize that a lot of the structure of this driver is vastly simpler when the IDs are all
-//	known a priori. Comments in the code will try to identify some of these simplifications and
-//	point out what a more complicated driver will need to do.
+//	Declare the internal object ID numbers for the plug-in and the box, which there is only ever
+//	one of. The devices are created from the settings when the driver is initialized, and each one
+//	is handed the next block of kDeviceObject_Count object IDs starting at kObjectID_FirstDevice:
+//	the device itself followed by its streams and controls in the order below. So the device an
+//	object belongs to, and which of its objects it is, are worked out from the object ID alone.
+//	The first device gets the same object IDs the driver has always used.
 enum
 {
 	kObjectID_PlugIn					= kAudioObjectPlugInObject,
 	kObjectID_Box						= 2,
-	kObjectID_Device					= 3,
-	kObjectID_Stream_Input				= 4,
-	kObjectID_Volume_Input_Master		= 5,
-	kObjectID_Mute_Input_Master			= 6,
-	kObjectID_DataSource_Input_Master	= 7,
-	kObjectID_Stream_Output				= 8,
-	kObjectID_Volume_Output_Master		= 9,
-	kObjectID_Mute_Output_Master		= 10,
-	kObjectID_DataSource_Output_Master	= 11,
-	kObjectID_DataDestination_PlayThru_Master	= 12
+	kObjectID_FirstDevice				= 3
+};
+
+enum
+{
+	kDeviceObject_Device						= 0,
+	kDeviceObject_Stream_Input					= 1,
+	kDeviceObject_Volume_Input_Master			= 2,
+	kDeviceObject_Mute_Input_Master				= 3,
+	kDeviceObject_DataSource_Input_Master		= 4,
+	kDeviceObject_Stream_Output					= 5,
+	kDeviceObject_Volume_Output_Master			= 6,
+	kDeviceObject_Mute_Output_Master			= 7,
+	kDeviceObject_DataSource_Output_Master		= 8,
+	kDeviceObject_DataDestination_PlayThru_Master	= 9,
+	kDeviceObject_Count							= 10
 };
 
-//	Declare the stuff that tracks the state of the plug-in, the device and its sub-objects.
-//	Note that we use global variables here because this driver only ever has a single device. If
-//	multiple devices were supported, this state would need to be encapsulated in one or more structs
-//	so that each object's state can be tracked individually.
-//	Note also that we share a single mutex across all objects to be thread safe for the same reason.
+//	Declare the stuff that tracks the state of the plug-in and the box, which are global, and the
+//	devices, whose state is kept in a SyncAudioDevice apiece. Each device has its own engine, and
+//	so its own ring and clock, and nothing on the IO path is shared between devices.
+//	Note that we share a single mutex across all objects to be thread safe. None of the IO
+//	functions take it.
 #define										kPlugIn_BundleID				"be.goodbrain.SyncAudio"
 static pthread_mutex_t						gPlugIn_StateMutex				= PTHREAD_MUTEX_INITIALIZER;
 static UInt32								gPlugIn_RefCount				= 0;
 static AudioServerPlugInHostRef				gPlugIn_Host					= NULL;
-static const AudioObjectPropertySelector	kPlugIn_CustomPropertyID		= 'PCst';
+#define										kPlugIn_CustomPropertyID		'PCst'
+#define										kPlugIn_IOStatisticsPropertyID	'PIOS'
 
 #define										kBox_UID						"SyncAudioBox_UID"
 static CFStringRef							gBox_Name						= NULL;
@@ -141,43 +164,212 @@ static Boolean								gBox_Acquired					= true;
 
 #define										kDevice_UID						"SyncAudioDevice_UID"
 #define										kDevice_ModelUID				"SyncAudioDevice_ModelUID"
-static pthread_mutex_t						gDevice_IOMutex					= PTHREAD_MUTEX_INITIALIZER;
-static Float64								gDevice_SampleRate				= 44100.0;
-static UInt64								gDevice_IOIsRunning				= 0;
-static const UInt32							kDevice_RingBufferSize			= 16384;
-static Float64								gDevice_HostTicksPerFrame		= 0.0;
-static UInt64								gDevice_NumberTimeStamps		= 0;
-static Float64								gDevice_AnchorSampleTime		= 0.0;
-static UInt64								gDevice_AnchorHostTime			= 0;
-
-static bool									gStream_Input_IsActive			= true;
-static bool									gStream_Output_IsActive			= true;
+static const UInt32							kDevice_ZeroTimeStampPeriod		= 4096;
+
+//	The channels of a stereo, 5.1 or 7.1 device, each of which is the start of the next, and the
+//	names of their elements. A device with one channel is mono.
+static const AudioChannelLabel				kDevice_ChannelLabels[8]		= { kAudioChannelLabel_Left, kAudioChannelLabel_Right, kAudioChannelLabel_Center, kAudioChannelLabel_LFEScreen, kAudioChannelLabel_LeftSurround, kAudioChannelLabel_RightSurround, kAudioChannelLabel_RearSurroundLeft, kAudioChannelLabel_RearSurroundRight };
+static const CFStringRef					kDevice_ChannelNames[8]			= { CFSTR("Left"), CFSTR("Right"), CFSTR("Center"), CFSTR("LFE"), CFSTR("Left Surround"), CFSTR("Right Surround"), CFSTR("Rear Surround Left"), CFSTR("Rear Surround Right") };
 
 static const Float32						kVolume_MinDB					= -96.0;
 static const Float32						kVolume_MaxDB					= 6.0;
-static Float32								gVolume_Input_Master_Value		= 0.0;
-static Float32								gVolume_Output_Master_Value		= 0.0;
-
-static bool									gMute_Input_Master_Value		= false;
-static bool									gMute_Output_Master_Value		= false;
 
 // Maybe
 static const UInt32							kDataSource_NumberItems			= 4;
 #define										kDataSource_ItemNamePattern		"Data Source Item %d"
-static UInt32								gDataSource_Input_Master_Value	= 0;
-static UInt32								gDataSource_Output_Master_Value	= 0;
-static UInt32								gDataDestination_PlayThru_Master_Value	= 0;
+
+//	The sample formats of a device's physical format, which both of its streams share. The virtual
+//	format is always 32 bit float. With an integer physical format, ReadInput leaves the main
+//	buffer in it and WriteMix takes the mix in it, and the device does the HAL's ConvertInput and
+//	ConvertOutput to get to and from the clients' floats. The input is quantized to the format's
+//	resolution, with dither, while ReadInput reads it, and the mix as ConvertOutput packs it.
+//	Integer samples are native endian and a 24 bit one is packed in 3 bytes.
+enum
+{
+	kDevice_SampleFormat_Float32	= 0,
+	kDevice_SampleFormat_Int16		= 1,
+	kDevice_SampleFormat_Int24		= 2,
+	kDevice_SampleFormat_Int32		= 3
+};
+#define										kDevice_NumberSampleFormats		4
+static const UInt32							kDevice_SampleFormatBits[kDevice_NumberSampleFormats]	= { 32, 16, 24, 32 };
+
+static const SyncAudioDeviceState			kDevice_InitialState			= { 44100.0, 0.0f, 0.0f, 0, 0, 0, kDevice_SampleFormat_Float32, false, false };
+
+//	The nominal sample rates every device supports, in ascending order. Add to or remove from the
+//	list to change them, up to kSyncAudioEngine_MaxSampleRate.
+#define										kDevice_NumberSampleRates		6
+static const Float64						kDevice_SampleRates[kDevice_NumberSampleRates]	= { 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 };
 
 // defined by AlexJean
 #define                                     kDevice_Name                    "SyncAudio"
 #define                                     kManufacturer_Name              "Be GoodBrain Inc."
-#define                                     kLatency_Frame_Size                 0
-//#define                                     kNumber_Of_Channels                 2
+#define                                     kNumber_Of_Channels                 2       // unless the device's "channels" setting says otherwise
 #define                                     kBits_Per_Channel                   32
 #define                                     kBytes_Per_Channel                  4
-#define                                     kBytes_Per_Frame                    (2 * kBytes_Per_Channel)
-#define                                     kRing_Buffer_Frame_Size             ((65536 + kLatency_Frame_Size))
-static Float32*                             gRingBuffer;
+// The ring only has to hold the deepest delay plus an IO buffer. It has nothing to do with the
+// zero time stamp period, which is kept short so the HAL tracks the clock closely, and its
+// capacity must be a power of two. This is its size at the highest sample rate, the engine uses
+// less of it at lower ones so that it always covers the same time. The engine only allocates
+// what the device's own highest rate needs, which its "max sample rate" setting picks from
+// kDevice_SampleRates, and keeps it wired for the life of the driver. Each ring, and a device
+// has one more for every bus it routes to, costs that many frames times 4 bytes per channel
+// plus a little for the block tags, and 8 more bytes per channel with kRing_Mix_In_Float64: 2 MiB
+// in stereo at 192000 and 512 KiB at 48000 without it. The device's
+// kDevice_MemoryStatusPropertyID reports what it actually holds.
+#define                                     kRing_Buffer_Frame_Size             262144
+_Static_assert((kRing_Buffer_Frame_Size & (kRing_Buffer_Frame_Size - 1)) == 0, "the ring's capacity must be a power of two");
+_Static_assert(kRing_Buffer_Frame_Size >= ((500 * 192000 / 1000) + 4096), "the ring must hold the deepest delay at the highest sample rate plus an IO buffer");
+#define                                     kRing_Mix_In_Float64                0       // sum WriteMix in double precision, for setups with many sources
+
+//	All of a device's audio work is done by its mEngine, which knows nothing about the HAL.
+//	Everything here translates between the two, and the engine's settings are kept in the host's
+//	storage through mStorage, under keys prefixed with the device's UID. The engine's control
+//	functions are serialized by gPlugIn_StateMutex.
+//
+//	The sample rate and the values of the volume, mute and data source controls are published in
+//	mState so that the property getters and the IO thread can read them without taking
+//	gPlugIn_StateMutex. The setters still take it to serialize publishing new versions.
+//
+//	mReportedJitterFrames is the engine's margin for a late writer as of the last
+//	kAudioDevicePropertyLatency notification the IO thread asked for. It is a plain field because
+//	only the IO thread reads or writes it once the device is created. StartIO doesn't reset it,
+//	since the engine keeps the margin across restarts. The notification runs on
+//	mLatencyChangedSource's queue and doesn't touch the field. The HAL then asks for the latency
+//	again, and that is read from the engine.
+//
+//	The devices are listed in the "devices" setting as an array of dictionaries, each with a
+//	"name" and a "uid" and optionally a "channels", which is 1, 2, 6 or 8 and defaults to
+//	kNumber_Of_Channels. Both of a device's streams have its number of channels, laid out as mono,
+//	stereo, 5.1 or 7.1. Without the setting, there is a single stereo device with the names the
+//	driver has always used. The devices are created in SyncAudio_Initialize and live as long as the
+//	driver, which is what lets the IO path find them without a lock.
+//
+//	A device's "max sample rate" is the highest of kDevice_SampleRates it offers, and defaults to
+//	the last of them. It is what its rings are allocated for, so a device that only ever runs at
+//	48000 can say so and wire a quarter of the memory.
+//
+//	A device's dictionary can also have a "source", which is the UID of another device with the
+//	same number of channels, to have its input play back that device's output rather than its
+//	own, converted to its sample rate. The "quality" of the conversion is 0 to 3, from the
+//	cheapest to the cleanest, and defaults to kDevice_ResamplerQuality.
+#define                                     kPlugIn_MaxNumberDevices            8
+#define                                     kPlugIn_DevicesStorageKey           "devices"
+#define                                     kDevice_ResamplerQuality            kSyncAudioResampler_QualityHigh
+
+typedef struct SyncAudioDevice
+{
+    AudioObjectID           mObjectID;
+    CFStringRef             mUID;
+    CFStringRef             mName;
+    UInt32                  mChannelCount;
+    Float64                 mMaxSampleRate;
+    UInt32                  mNumberSampleRates;
+    UInt64                  mIOIsRunning;
+    bool                    mStreamInputIsActive;
+    bool                    mStreamOutputIsActive;
+    SyncAudioStorage        mStorage;
+    SyncAudioStateCell      mState;
+    SyncAudioEngine         mEngine;
+    CFDictionaryRef         mClientRoutes;
+    SyncAudioRouteTable     mRoutes;
+    _Atomic UInt64          mIOOperations;
+    _Atomic UInt64          mIOPageFaults;
+    UInt32                  mReportedJitterFrames;
+    dispatch_source_t       mLatencyChangedSource;
+} SyncAudioDevice;
+
+static SyncAudioDevice                      gPlugIn_Devices[kPlugIn_MaxNumberDevices];
+static UInt32                               gPlugIn_NumberDevices               = 0;
+static AudioObjectID                        gPlugIn_NextObjectID                = kObjectID_FirstDevice;
+static SyncAudioHostClock                   gPlugIn_HostClock;
+
+static bool                                 SyncAudio_CreateLoopbackDevice(CFStringRef inName, CFStringRef inUID, UInt32 inChannelCount, Float64 inMaxSampleRate);
+static SyncAudioDevice*                     SyncAudio_FindDevice(AudioObjectID inObjectID, UInt32* outDeviceObject);
+static SyncAudioDevice*                     SyncAudio_FindDeviceByUID(CFStringRef inUID);
+static void                                 SyncAudio_SetDeviceSource(CFDictionaryRef inDescription);
+static UInt64                               SyncAudio_GetHostTime(void);
+static void                                 SyncAudio_GetClientRoute(const SyncAudioDevice* inDevice, const AudioServerPlugInClientInfo* inClientInfo, SyncAudioRoute* outRoute);
+static bool                                 SyncAudio_GetQualifierProcessID(UInt32 inQualifierDataSize, const void* inQualifierData, SInt32* outProcessID);
+static CFStringRef                          SyncAudio_Storage_CopyKey(const SyncAudioDevice* inDevice, const char* inKey);
+static bool                                 SyncAudio_Storage_CopyNumber(void* inContext, const char* inKey, double* outValue);
+static void                                 SyncAudio_Storage_WriteNumber(void* inContext, const char* inKey, double inValue);
+static CFDictionaryRef                      SyncAudio_CopyIOStatistics(void);
+static SyncAudioDeviceState                 SyncAudio_GetDeviceState(const SyncAudioDevice* inDevice);
+static bool                                 SyncAudio_IsSupportedSampleRate(const SyncAudioDevice* inDevice, Float64 inSampleRate);
+static void                                 SyncAudio_GetStreamFormat(const SyncAudioDevice* inDevice, Float64 inSampleRate, UInt32 inSampleFormat, AudioStreamBasicDescription* outFormat);
+static bool                                 SyncAudio_GetSampleFormat(const SyncAudioDevice* inDevice, const AudioStreamBasicDescription* inFormat, UInt32* outSampleFormat);
+static void                                 SyncAudio_Trace(UInt32 inEvent, AudioObjectID inObjectID, UInt64 inStartHostTime, UInt64 inEndHostTime, UInt64 inArgument0, UInt64 inArgument1);
+
+//	The ring is allocated, pre-faulted and locked once in SyncAudio_Initialize and only reset when
+//	IO starts, so the IO thread never touches memory that isn't already resident. The rings of the
+//	other buses are treated the same way when AddDeviceClient first routes a client through them. When
+//	SyncAudio_CountIOPageFaults is on, each IO operation samples the process's page fault count
+//	around itself and adds the difference to the device's mIOPageFaults. The count is process wide,
+//	so it is an upper bound on the faults taken by the IO path. Sampling it is a system call, which
+//	is why it is only on by default in debug builds. Both counters are published by the
+//	kDevice_MemoryStatusPropertyID property and are cleared when IO starts.
+#if !defined(SyncAudio_CountIOPageFaults)
+	#if DEBUG
+		#define	SyncAudio_CountIOPageFaults	1
+	#else
+		#define	SyncAudio_CountIOPageFaults	0
+	#endif
+#endif
+#define										kDevice_MemoryStatusPropertyID	'DMem'
+
+//	The deferred audio delay line. The loopback input is read kDevice_DelayPropertyID milliseconds
+//	behind the time the HAL asks for so that the audio lines up with the video path, which adds
+//	roughly 65ms. The device's engine keeps the depth and publishes it to the IO thread.
+#define										kDevice_DelayPropertyID			'Dlay'
+
+//	Client routing. Each device's engine has buses besides the main one that a client's audio can
+//	be routed through. kDevice_ClientRoutesPropertyID is a CFDictionary, kept in the settings under
+//	kDevice_ClientRoutesStorageKey, that maps a client's bundle ID, or its process ID as a decimal
+//	string, to a dictionary with any of these:
+//		"output bus"	the bus, from 1 to 3, that the client's output is copied to before it is mixed
+//		"divert"		true to also take the client's output out of the main mix
+//		"input bus"		the bus, from 1 to 3, that the client's input is read from
+//	So a reader can capture a single application by reading the bus the application's output goes
+//	to, or everything but that application by reading the main bus while the application is
+//	diverted. A client's route is worked out once, when the client is added, and kept in the
+//	device's mRoutes, so all the IO thread does is look the client up by its client ID. Changing
+//	the routes only affects the clients added after the change.
+#define										kDevice_ClientRoutesPropertyID	'DRte'
+#define										kDevice_ClientRoutesStorageKey	"client routes"
+
+//	Client output levels. Every client of a device is in its mRoutes, which also holds the volume
+//	and mute of the client's output. kDevice_ClientVolumePropertyID is a CFNumber from 0 to 1 and
+//	kDevice_ClientMutePropertyID a CFBoolean, and both take the client's process ID as a CFNumber
+//	for their qualifier, so they apply to all of the process's clients at once. The IO thread
+//	scales each client's output by its level, ramping across the buffer when the level changes,
+//	before it is copied to its bus or handed back for the HAL to mix. The levels only last as long
+//	as the process's clients do.
+//
+//	Only the clients with a bus of their own or a level other than unity have their output
+//	processed, and the rest are mixed by the HAL as they are and reach the ring through WriteMix
+//	alone. The HAL asks which clients need it when their IO starts, so setting the level of a
+//	client that didn't while IO is running requests a configuration change with the action
+//	kDevice_ChangeAction_ClientOperations, which does nothing but restart IO so that the HAL asks
+//	again.
+#define										kDevice_ClientVolumePropertyID	'DCvl'
+#define										kDevice_ClientMutePropertyID	'DCmt'
+#define										kDevice_ChangeAction_ClientOperations	0ULL
+
+//	The trace log. DebugMsg and syslog can block, so nothing on the IO thread can use them. When
+//	SyncAudio_TraceEvents is on, the IO operations, property changes, configuration changes and
+//	IO starts and stops are recorded in gPlugIn_Trace instead, which never blocks, and its drainer
+//	thread writes them to kPlugIn_TracePath. It is only on by default in debug builds.
+#if !defined(SyncAudio_TraceEvents)
+	#if DEBUG
+		#define	SyncAudio_TraceEvents	1
+	#else
+		#define	SyncAudio_TraceEvents	0
+	#endif
+#endif
+#define										kPlugIn_TracePath				"/tmp/SyncAudio.trace"
+static const UInt32							kPlugIn_TraceRecordCount		= 16384;
+static SyncAudioTrace						gPlugIn_Trace;
 // by AlexJean
 
 //==================================================================================================
@@ -213,32 +405,22 @@ static OSStatus		SyncAudio_DoIOOperation(AudioServerPlugInDriverRef inDriver, Au
 static OSStatus		SyncAudio_EndIOOperation(AudioServerPlugInDriverRef inDriver, AudioObjectID inDeviceObjectID, UInt32 inClientID, UInt32 inOperationID, UInt32 inIOBufferFrameSize, const AudioServerPlugInIOCycleInfo* inIOCycleInfo);
 
 //	Implementation
-static Boolean		SyncAudio_HasPlugInProperty(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress);
-static OSStatus		SyncAudio_IsPlugInPropertySettable(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, Boolean* outIsSettable);
 static OSStatus		SyncAudio_GetPlugInPropertyDataSize(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize, const void* inQualifierData, UInt32* outDataSize);
 static OSStatus		SyncAudio_GetPlugInPropertyData(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize, const void* inQualifierData, UInt32 inDataSize, UInt32* outDataSize, void* outData);
 static OSStatus		SyncAudio_SetPlugInPropertyData(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize, const void* inQualifierData, UInt32 inDataSize, const void* inData, UInt32* outNumberPropertiesChanged, AudioObjectPropertyAddress outChangedAddresses[2]);
 
-static Boolean		SyncAudio_HasBoxProperty(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress);
-static OSStatus		SyncAudio_IsBoxPropertySettable(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, Boolean* outIsSettable);
 static OSStatus		SyncAudio_GetBoxPropertyDataSize(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize, const void* inQualifierData, UInt32* outDataSize);
 static OSStatus		SyncAudio_GetBoxPropertyData(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize, const void* inQualifierData, UInt32 inDataSize, UInt32* outDataSize, void* outData);
 static OSStatus		SyncAudio_SetBoxPropertyData(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize, const void* inQualifierData, UInt32 inDataSize, const void* inData, UInt32* outNumberPropertiesChanged, AudioObjectPropertyAddress outChangedAddresses[2]);
 
-static Boolean		SyncAudio_HasDeviceProperty(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress);
-static OSStatus		SyncAudio_IsDevicePropertySettable(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, Boolean* outIsSettable);
 static OSStatus		SyncAudio_GetDevicePropertyDataSize(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize, const void* inQualifierData, UInt32* outDataSize);
 static OSStatus		SyncAudio_GetDevicePropertyData(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize, const void* inQualifierData, UInt32 inDataSize, UInt32* outDataSize, void* outData);
 static OSStatus		SyncAudio_SetDevicePropertyData(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize, const void* inQualifierData, UInt32 inDataSize, const void* inData, UInt32* outNumberPropertiesChanged, AudioObjectPropertyAddress outChangedAddresses[2]);
 
-static Boolean		SyncAudio_HasStreamProperty(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress);
-static OSStatus		SyncAudio_IsStreamPropertySettable(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, Boolean* outIsSettable);
 static OSStatus		SyncAudio_GetStreamPropertyDataSize(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize, const void* inQualifierData, UInt32* outDataSize);
 static OSStatus		SyncAudio_GetStreamPropertyData(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize, const void* inQualifierData, UInt32 inDataSize, UInt32* outDataSize, void* outData);
 static OSStatus		SyncAudio_SetStreamPropertyData(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize, const void* inQualifierData, UInt32 inDataSize, const void* inData, UInt32* outNumberPropertiesChanged, AudioObjectPropertyAddress outChangedAddresses[2]);
 
-static Boolean		SyncAudio_HasControlProperty(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress);
-static OSStatus		SyncAudio_IsControlPropertySettable(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, Boolean* outIsSettable);
 static OSStatus		SyncAudio_GetControlPropertyDataSize(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize, const void* inQualifierData, UInt32* outDataSize);
 static OSStatus		SyncAudio_GetControlPropertyData(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize, const void* inQualifierData, UInt32 inDataSize, UInt32* outDataSize, void* outData);
 static OSStatus		SyncAudio_SetControlPropertyData(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize, const void* inQualifierData, UInt32 inDataSize, const void* inData, UInt32* outNumberPropertiesChanged, AudioObjectPropertyAddress outChangedAddresses[2]);
@@ -445,12 +627,74 @@ static OSStatus	SyncAudio_Initialize(AudioServerPlugInDriverRef inDriver, AudioS
 		gBox_Name = CFSTR("SyncAudio Box");
 	}
 	
-	//	calculate the host ticks per frame
-	struct mach_timebase_info theTimeBaseInfo;
-	mach_timebase_info(&theTimeBaseInfo);
-	Float64 theHostClockFrequency = (Float64)theTimeBaseInfo.denom / (Float64)theTimeBaseInfo.numer;
-	theHostClockFrequency *= 1000000000.0;
-	gDevice_HostTicksPerFrame = theHostClockFrequency / gDevice_SampleRate;
+	//	the devices all run on the platform's host clock
+	SyncAudioPlatform_GetHostClock(&gPlugIn_HostClock);
+	
+	//	create the devices listed in the settings
+	gPlugIn_Host->CopyFromStorage(gPlugIn_Host, CFSTR(kPlugIn_DevicesStorageKey), &theSettingsData);
+	if(theSettingsData != NULL)
+	{
+		if(CFGetTypeID(theSettingsData) == CFArrayGetTypeID())
+		{
+			CFIndex theNumberDevices = CFArrayGetCount((CFArrayRef)theSettingsData);
+			for(CFIndex theDeviceIndex = 0; theDeviceIndex < theNumberDevices; ++theDeviceIndex)
+			{
+				CFDictionaryRef theDescription = (CFDictionaryRef)CFArrayGetValueAtIndex((CFArrayRef)theSettingsData, theDeviceIndex);
+				if(CFGetTypeID(theDescription) == CFDictionaryGetTypeID())
+				{
+					CFStringRef theName = (CFStringRef)CFDictionaryGetValue(theDescription, CFSTR("name"));
+					CFStringRef theUID = (CFStringRef)CFDictionaryGetValue(theDescription, CFSTR("uid"));
+					CFNumberRef theChannels = (CFNumberRef)CFDictionaryGetValue(theDescription, CFSTR("channels"));
+					SInt32 theChannelCount = kNumber_Of_Channels;
+					if((theChannels != NULL) && ((CFGetTypeID(theChannels) != CFNumberGetTypeID()) || !CFNumberGetValue(theChannels, kCFNumberSInt32Type, &theChannelCount)))
+					{
+						theChannelCount = 0;
+					}
+					CFNumberRef theMaxSampleRateNumber = (CFNumberRef)CFDictionaryGetValue(theDescription, CFSTR("max sample rate"));
+					Float64 theMaxSampleRate = kDevice_SampleRates[kDevice_NumberSampleRates - 1];
+					if((theMaxSampleRateNumber != NULL) && ((CFGetTypeID(theMaxSampleRateNumber) != CFNumberGetTypeID()) || !CFNumberGetValue(theMaxSampleRateNumber, kCFNumberFloat64Type, &theMaxSampleRate)))
+					{
+						theMaxSampleRate = 0.0;
+					}
+					if((theName != NULL) && (CFGetTypeID(theName) == CFStringGetTypeID()) && (theUID != NULL) && (CFGetTypeID(theUID) == CFStringGetTypeID()))
+					{
+						if(!SyncAudio_CreateLoopbackDevice(theName, theUID, (theChannelCount > 0) ? (UInt32)theChannelCount : 0, theMaxSampleRate))
+						{
+							DebugMsg("SyncAudio_Initialize: couldn't create a device from the settings");
+						}
+					}
+				}
+			}
+			
+			//	now that all of them exist, hook up the ones that play back another
+			for(CFIndex theDeviceIndex = 0; theDeviceIndex < theNumberDevices; ++theDeviceIndex)
+			{
+				CFDictionaryRef theDescription = (CFDictionaryRef)CFArrayGetValueAtIndex((CFArrayRef)theSettingsData, theDeviceIndex);
+				if(CFGetTypeID(theDescription) == CFDictionaryGetTypeID())
+				{
+					SyncAudio_SetDeviceSource(theDescription);
+				}
+			}
+		}
+		CFRelease(theSettingsData);
+	}
+	
+	//	fall back on the single device the driver has always had
+	if(gPlugIn_NumberDevices == 0)
+	{
+		FailWithAction(!SyncAudio_CreateLoopbackDevice(CFSTR(kDevice_Name), CFSTR(kDevice_UID), kNumber_Of_Channels, kDevice_SampleRates[kDevice_NumberSampleRates - 1]), theAnswer = kAudioHardwareUnspecifiedError, Done, "SyncAudio_Initialize: failed to create the device");
+	}
+	
+	//	start tracing, which the driver can do without
+#if SyncAudio_TraceEvents
+	if(SyncAudioTrace_Initialize(&gPlugIn_Trace, kPlugIn_TraceRecordCount))
+	{
+		if(!SyncAudioTrace_StartDrainer(&gPlugIn_Trace, kPlugIn_TracePath, gPlugIn_HostClock.mTicksPerSecondNumerator, gPlugIn_HostClock.mTicksPerSecondDenominator))
+		{
+			DebugMsg("SyncAudio_Initialize: couldn't open the trace file");
+		}
+	}
+#endif
 	
 Done:
 	return theAnswer;
@@ -461,7 +705,8 @@ static OSStatus	SyncAudio_CreateDevice(AudioServerPlugInDriverRef inDriver, CFDi
 	//	This method is used to tell a driver that implements the Transport Manager semantics to
 	//	create an AudioEndpointDevice from a set of AudioEndpoints. Since this driver is not a
 	//	Transport Manager, we just check the arguments and return
-	//	kAudioHardwareUnsupportedOperationError.
+	//	kAudioHardwareUnsupportedOperationError. This driver's devices come from its settings
+	//	instead.
 	
 	#pragma unused(inDescription, inClientInfo, outDeviceObjectID)
 	
@@ -496,18 +741,55 @@ Done:
 static OSStatus	SyncAudio_AddDeviceClient(AudioServerPlugInDriverRef inDriver, AudioObjectID inDeviceObjectID, const AudioServerPlugInClientInfo* inClientInfo)
 {
 	//	This method is used to inform the driver about a new client that is using the given device.
-	//	This allows the device to act differently depending on who the client is. This driver does
-	//	not need to track the clients using the device, so we just check the arguments and return
-	//	successfully.
-	
-	#pragma unused(inClientInfo)
+	//	This allows the device to act differently depending on who the client is. This driver
+	//	works out here which of the device's buses the client's audio goes through so that the IO
+	//	thread only has to look it up. Every client is tracked, since any of them can have its
+	//	level set, and the ones without a route use the main bus.
 	
 	//	declare the local variables
 	OSStatus theAnswer = 0;
+	SyncAudioDevice* theDevice;
+	SyncAudioRoute theRoute;
 	
 	//	check the arguments
 	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_AddDeviceClient: bad driver reference");
-	FailWithAction(inDeviceObjectID != kObjectID_Device, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_AddDeviceClient: bad device ID");
+	theDevice = SyncAudio_FindDevice(inDeviceObjectID, NULL);
+	FailWithAction((theDevice == NULL) || (theDevice->mObjectID != inDeviceObjectID), theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_AddDeviceClient: bad device ID");
+	FailWithAction(inClientInfo == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_AddDeviceClient: no client info");
+	
+	//	we need to hold the state lock
+	pthread_mutex_lock(&gPlugIn_StateMutex);
+	
+	//	look the client up, falling back on the main bus for anything that can't be allocated
+	SyncAudio_GetClientRoute(theDevice, inClientInfo, &theRoute);
+	if(!SyncAudioEngine_PrepareBus(&theDevice->mEngine, theRoute.mOutputBus))
+	{
+		theRoute.mOutputBus = kSyncAudioEngine_MainBus;
+		theRoute.mDivertOutput = false;
+	}
+	if(!SyncAudioEngine_PrepareBus(&theDevice->mEngine, theRoute.mInputBus))
+	{
+		theRoute.mInputBus = kSyncAudioEngine_MainBus;
+	}
+	
+	//	a process's clients share its output level
+	SyncAudioRoute* theProcessRoute = SyncAudioRouteTable_FindProcess(&theDevice->mRoutes, theRoute.mProcessID);
+	if(theProcessRoute != NULL)
+	{
+		theRoute.mOutputVolume = theProcessRoute->mOutputVolume;
+		theRoute.mOutputMute = theProcessRoute->mOutputMute;
+		theRoute.mOutputGain = theRoute.mOutputMute ? 0.0f : theRoute.mOutputVolume;
+		atomic_init(&theRoute.mOutputLevel, theRoute.mOutputGain);
+	}
+	
+	//	a client that doesn't fit uses the main bus at full level
+	if(!SyncAudioRouteTable_Add(&theDevice->mRoutes, inClientInfo->mClientID, &theRoute))
+	{
+		DebugMsg("SyncAudio_AddDeviceClient: too many clients, so this one uses the main bus");
+	}
+	
+	//	unlock the state lock
+	pthread_mutex_unlock(&gPlugIn_StateMutex);
 
 Done:
 	return theAnswer;
@@ -516,17 +798,22 @@ Done:
 static OSStatus	SyncAudio_RemoveDeviceClient(AudioServerPlugInDriverRef inDriver, AudioObjectID inDeviceObjectID, const AudioServerPlugInClientInfo* inClientInfo)
 {
 	//	This method is used to inform the driver about a client that is no longer using the given
-	//	device. This driver does not track clients, so we just check the arguments and return
-	//	successfully.
-	
-	#pragma unused(inClientInfo)
+	//	device. This driver only has to forget the client's route.
 	
 	//	declare the local variables
 	OSStatus theAnswer = 0;
+	SyncAudioDevice* theDevice;
 	
 	//	check the arguments
 	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_RemoveDeviceClient: bad driver reference");
-	FailWithAction(inDeviceObjectID != kObjectID_Device, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_RemoveDeviceClient: bad device ID");
+	theDevice = SyncAudio_FindDevice(inDeviceObjectID, NULL);
+	FailWithAction((theDevice == NULL) || (theDevice->mObjectID != inDeviceObjectID), theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_RemoveDeviceClient: bad device ID");
+	FailWithAction(inClientInfo == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_RemoveDeviceClient: no client info");
+	
+	//	the bus's ring stays allocated for the next client that uses it
+	pthread_mutex_lock(&gPlugIn_StateMutex);
+	SyncAudioRouteTable_Remove(&theDevice->mRoutes, inClientInfo->mClientID);
+	pthread_mutex_unlock(&gPlugIn_StateMutex);
 
 Done:
 	return theAnswer;
@@ -544,32 +831,43 @@ static OSStatus	SyncAudio_PerformDeviceConfigurationChange(AudioServerPlugInDriv
 	//	means that the only notifications that would need to be sent here would be for either
 	//	custom properties the HAL doesn't know about or for controls.
 	//
-	//	For the device implemented by this driver, only sample rate changes go through this process
-	//	as it is the only state that can be changed for the device that isn't a control. For this
-	//	change, the new sample rate is passed in the inChangeAction argument.
+	//	For the device implemented by this driver, only sample rate and sample format changes go
+	//	through this process as they are the only state that can be changed for the device that
+	//	isn't a control. For this change, the new sample rate is passed in the low 32 bits of the
+	//	inChangeAction argument and the new sample format in the high 32 bits. The other change is
+	//	kDevice_ChangeAction_ClientOperations, which has nothing to change and is only there to
+	//	restart IO so that the HAL asks again which clients' output to process.
 	
 	#pragma unused(inChangeInfo)
 
 	//	declare the local variables
 	OSStatus theAnswer = 0;
+	SyncAudioDevice* theDevice;
 	
 	//	check the arguments
 	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_PerformDeviceConfigurationChange: bad driver reference");
-	FailWithAction(inDeviceObjectID != kObjectID_Device, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_PerformDeviceConfigurationChange: bad device ID");
-	FailWithAction((inChangeAction != 44100) && (inChangeAction != 48000), theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_PerformDeviceConfigurationChange: bad sample rate");
+	theDevice = SyncAudio_FindDevice(inDeviceObjectID, NULL);
+	FailWithAction((theDevice == NULL) || (theDevice->mObjectID != inDeviceObjectID), theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_PerformDeviceConfigurationChange: bad device ID");
+	FailWithAction((inChangeAction != kDevice_ChangeAction_ClientOperations) && !SyncAudio_IsSupportedSampleRate(theDevice, (Float64)(inChangeAction & 0xFFFFFFFFULL)), theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_PerformDeviceConfigurationChange: bad sample rate");
+	FailWithAction((inChangeAction >> 32) >= kDevice_NumberSampleFormats, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_PerformDeviceConfigurationChange: bad sample format");
 	
 	//	lock the state mutex
 	pthread_mutex_lock(&gPlugIn_StateMutex);
 	
-	//	change the sample rate
-	gDevice_SampleRate = inChangeAction;
-	
-	//	recalculate the state that depends on the sample rate
-	struct mach_timebase_info theTimeBaseInfo;
-	mach_timebase_info(&theTimeBaseInfo);
-	Float64 theHostClockFrequency = (Float64)theTimeBaseInfo.denom / (Float64)theTimeBaseInfo.numer;
-	theHostClockFrequency *= 1000000000.0;
-	gDevice_HostTicksPerFrame = theHostClockFrequency / gDevice_SampleRate;
+	//	change the sample rate and format, unless the change was only asked for to restart IO
+	if(inChangeAction != kDevice_ChangeAction_ClientOperations)
+	{
+		SyncAudioDeviceState theState = SyncAudio_GetDeviceState(theDevice);
+		theState.mSampleRate = (Float64)(inChangeAction & 0xFFFFFFFFULL);
+		theState.mSampleFormat = (UInt32)(inChangeAction >> 32);
+		SyncAudioState_Publish(&theDevice->mState, &theState);
+		
+		//	recalculate the state that depends on them
+		SyncAudioEngine_SetSampleRate(&theDevice->mEngine, theState.mSampleRate);
+		SyncAudioEngine_SetPhysicalFormat(&theDevice->mEngine, (theState.mSampleFormat != kDevice_SampleFormat_Float32) ? kDevice_SampleFormatBits[theState.mSampleFormat] : 0);
+	}
+	UInt64 theHostTime = SyncAudioEngine_GetHostTime(&theDevice->mEngine);
+	SyncAudio_Trace(kSyncAudioTrace_ConfigurationChange, inDeviceObjectID, theHostTime, theHostTime, inChangeAction, 0);
 
 	//	unlock the state mutex
 	pthread_mutex_unlock(&gPlugIn_StateMutex);
@@ -589,60 +887,289 @@ static OSStatus	SyncAudio_AbortDeviceConfigurationChange(AudioServerPlugInDriver
 
 	//	declare the local variables
 	OSStatus theAnswer = 0;
+	SyncAudioDevice* theDevice;
 	
 	//	check the arguments
 	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_PerformDeviceConfigurationChange: bad driver reference");
-	FailWithAction(inDeviceObjectID != kObjectID_Device, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_PerformDeviceConfigurationChange: bad device ID");
+	theDevice = SyncAudio_FindDevice(inDeviceObjectID, NULL);
+	FailWithAction((theDevice == NULL) || (theDevice->mObjectID != inDeviceObjectID), theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_PerformDeviceConfigurationChange: bad device ID");
 
 Done:
 	return theAnswer;
 }
 
+#pragma mark Property Registry
+
+//	Every property this driver implements is listed once in kPropertyRegistry_Properties, keyed by
+//	the kind of object it belongs to and its selector. The entry says whether the property can be
+//	set, whether it is restricted to some addresses and, when it doesn't depend on the state or on
+//	the address, the size of its data. The five property entry points look the address up in the
+//	registry and only call into the object's own functions to get or set the data, or to work out
+//	a size that isn't fixed.
+//
+//	gPropertyRegistry is a SyncAudioPropertyRegistry over that table, which hashes the object kind
+//	and the selector so that a lookup touches one or two slots no matter how many properties there
+//	are. It is filled in the first time it is needed.
+
+enum
+{
+	kObjectKind_None		= 0,
+	kObjectKind_PlugIn		= 1,
+	kObjectKind_Box			= 2,
+	kObjectKind_Device		= 3,
+	kObjectKind_Stream		= 4,
+	kObjectKind_Volume		= 5,
+	kObjectKind_Mute		= 6,
+	kObjectKind_Selector	= 7,
+	kObjectKind_Count		= 8
+};
+
+enum
+{
+	kPropertyFlag_Settable			= (1 << 0),
+	kPropertyFlag_ComputedSize		= (1 << 1),	//	the object's size function works out the size
+	kPropertyFlag_DirectionalScope	= (1 << 2),	//	only in the input and output scopes
+	kPropertyFlag_ChannelElement	= (1 << 3)	//	only for the master element and the device's channels
+};
+
+typedef struct SyncAudioObjectKindOperations
+{
+	OSStatus	(*mGetPropertyDataSize)(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize, const void* inQualifierData, UInt32* outDataSize);
+	OSStatus	(*mGetPropertyData)(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize, const void* inQualifierData, UInt32 inDataSize, UInt32* outDataSize, void* outData);
+	OSStatus	(*mSetPropertyData)(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize, const void* inQualifierData, UInt32 inDataSize, const void* inData, UInt32* outNumberPropertiesChanged, AudioObjectPropertyAddress outChangedAddresses[2]);
+} SyncAudioObjectKindOperations;
+
+//	the kind of each of the objects in a device's block of object IDs
+static const UInt8	kPropertyRegistry_DeviceObjectKinds[kDeviceObject_Count] =
+{
+	[kDeviceObject_Device]							= kObjectKind_Device,
+	[kDeviceObject_Stream_Input]					= kObjectKind_Stream,
+	[kDeviceObject_Volume_Input_Master]				= kObjectKind_Volume,
+	[kDeviceObject_Mute_Input_Master]				= kObjectKind_Mute,
+	[kDeviceObject_DataSource_Input_Master]			= kObjectKind_Selector,
+	[kDeviceObject_Stream_Output]					= kObjectKind_Stream,
+	[kDeviceObject_Volume_Output_Master]			= kObjectKind_Volume,
+	[kDeviceObject_Mute_Output_Master]				= kObjectKind_Mute,
+	[kDeviceObject_DataSource_Output_Master]		= kObjectKind_Selector,
+	[kDeviceObject_DataDestination_PlayThru_Master]	= kObjectKind_Selector
+};
+
+static const SyncAudioObjectKindOperations	kPropertyRegistry_Operations[kObjectKind_Count] =
+{
+	[kObjectKind_PlugIn]	= { SyncAudio_GetPlugInPropertyDataSize, SyncAudio_GetPlugInPropertyData, SyncAudio_SetPlugInPropertyData },
+	[kObjectKind_Box]		= { SyncAudio_GetBoxPropertyDataSize, SyncAudio_GetBoxPropertyData, SyncAudio_SetBoxPropertyData },
+	[kObjectKind_Device]	= { SyncAudio_GetDevicePropertyDataSize, SyncAudio_GetDevicePropertyData, SyncAudio_SetDevicePropertyData },
+	[kObjectKind_Stream]	= { SyncAudio_GetStreamPropertyDataSize, SyncAudio_GetStreamPropertyData, SyncAudio_SetStreamPropertyData },
+	[kObjectKind_Volume]	= { NULL, SyncAudio_GetControlPropertyData, SyncAudio_SetControlPropertyData },
+	[kObjectKind_Mute]		= { NULL, SyncAudio_GetControlPropertyData, SyncAudio_SetControlPropertyData },
+	[kObjectKind_Selector]	= { SyncAudio_GetControlPropertyDataSize, SyncAudio_GetControlPropertyData, SyncAudio_SetControlPropertyData }
+};
+
+//	Note that for each object, this driver implements all the required properties plus a few
+//	extras that are useful but not required. There is more detailed commentary about each property
+//	in the object's GetPropertyData method.
+static const SyncAudioPropertyInfo	kPropertyRegistry_Properties[] =
+{
+	//	the plug-in
+	{ kObjectKind_PlugIn,	kAudioObjectPropertyBaseClass,						0,									sizeof(AudioClassID) },
+	{ kObjectKind_PlugIn,	kAudioObjectPropertyClass,							0,									sizeof(AudioClassID) },
+	{ kObjectKind_PlugIn,	kAudioObjectPropertyOwner,							0,									sizeof(AudioObjectID) },
+	{ kObjectKind_PlugIn,	kAudioObjectPropertyManufacturer,					0,									sizeof(CFStringRef) },
+	{ kObjectKind_PlugIn,	kAudioObjectPropertyOwnedObjects,					kPropertyFlag_ComputedSize,			0 },
+	{ kObjectKind_PlugIn,	kAudioPlugInPropertyBoxList,						0,									sizeof(AudioClassID) },
+	{ kObjectKind_PlugIn,	kAudioPlugInPropertyTranslateUIDToBox,				0,									sizeof(AudioObjectID) },
+	{ kObjectKind_PlugIn,	kAudioPlugInPropertyDeviceList,						kPropertyFlag_ComputedSize,			0 },
+	{ kObjectKind_PlugIn,	kAudioPlugInPropertyTranslateUIDToDevice,			0,									sizeof(AudioObjectID) },
+	{ kObjectKind_PlugIn,	kAudioPlugInPropertyResourceBundle,					0,									sizeof(CFStringRef) },
+	{ kObjectKind_PlugIn,	kAudioObjectPropertyCustomPropertyInfoList,			0,									2 * sizeof(AudioServerPlugInCustomPropertyInfo) },
+	{ kObjectKind_PlugIn,	kPlugIn_CustomPropertyID,							kPropertyFlag_Settable | kPropertyFlag_ComputedSize,	0 },
+	{ kObjectKind_PlugIn,	kPlugIn_IOStatisticsPropertyID,						0,									sizeof(CFPropertyListRef) },
+	
+	//	the box
+	{ kObjectKind_Box,		kAudioObjectPropertyBaseClass,						0,									sizeof(AudioClassID) },
+	{ kObjectKind_Box,		kAudioObjectPropertyClass,							0,									sizeof(AudioClassID) },
+	{ kObjectKind_Box,		kAudioObjectPropertyOwner,							0,									sizeof(AudioObjectID) },
+	{ kObjectKind_Box,		kAudioObjectPropertyName,							kPropertyFlag_Settable,				sizeof(CFStringRef) },
+	{ kObjectKind_Box,		kAudioObjectPropertyModelName,						0,									sizeof(CFStringRef) },
+	{ kObjectKind_Box,		kAudioObjectPropertyManufacturer,					0,									sizeof(CFStringRef) },
+	{ kObjectKind_Box,		kAudioObjectPropertyOwnedObjects,					0,									0 },
+	{ kObjectKind_Box,		kAudioObjectPropertyIdentify,						kPropertyFlag_Settable,				sizeof(UInt32) },
+	{ kObjectKind_Box,		kAudioObjectPropertySerialNumber,					0,									sizeof(CFStringRef) },
+	{ kObjectKind_Box,		kAudioObjectPropertyFirmwareVersion,				0,									sizeof(CFStringRef) },
+	{ kObjectKind_Box,		kAudioBoxPropertyBoxUID,							0,									sizeof(CFStringRef) },
+	{ kObjectKind_Box,		kAudioBoxPropertyTransportType,						0,									sizeof(UInt32) },
+	{ kObjectKind_Box,		kAudioBoxPropertyHasAudio,							0,									sizeof(UInt32) },
+	{ kObjectKind_Box,		kAudioBoxPropertyHasVideo,							0,									sizeof(UInt32) },
+	{ kObjectKind_Box,		kAudioBoxPropertyHasMIDI,							0,									sizeof(UInt32) },
+	{ kObjectKind_Box,		kAudioBoxPropertyIsProtected,						0,									sizeof(UInt32) },
+	{ kObjectKind_Box,		kAudioBoxPropertyAcquired,							kPropertyFlag_Settable,				sizeof(UInt32) },
+	{ kObjectKind_Box,		kAudioBoxPropertyAcquisitionFailed,					0,									sizeof(UInt32) },
+	{ kObjectKind_Box,		kAudioBoxPropertyDeviceList,						kPropertyFlag_ComputedSize,			0 },
+	
+	//	the device
+	{ kObjectKind_Device,	kAudioObjectPropertyBaseClass,						0,									sizeof(AudioClassID) },
+	{ kObjectKind_Device,	kAudioObjectPropertyClass,							0,									sizeof(AudioClassID) },
+	{ kObjectKind_Device,	kAudioObjectPropertyOwner,							0,									sizeof(AudioObjectID) },
+	{ kObjectKind_Device,	kAudioObjectPropertyName,							0,									sizeof(CFStringRef) },
+	{ kObjectKind_Device,	kAudioObjectPropertyManufacturer,					0,									sizeof(CFStringRef) },
+	{ kObjectKind_Device,	kAudioObjectPropertyElementName,					kPropertyFlag_ChannelElement,		sizeof(CFStringRef) },
+	{ kObjectKind_Device,	kAudioObjectPropertyOwnedObjects,					kPropertyFlag_ComputedSize,			0 },
+	{ kObjectKind_Device,	kAudioDevicePropertyDeviceUID,						0,									sizeof(CFStringRef) },
+	{ kObjectKind_Device,	kAudioDevicePropertyModelUID,						0,									sizeof(CFStringRef) },
+	{ kObjectKind_Device,	kAudioDevicePropertyTransportType,					0,									sizeof(UInt32) },
+	{ kObjectKind_Device,	kAudioDevicePropertyRelatedDevices,					0,									sizeof(AudioObjectID) },
+	{ kObjectKind_Device,	kAudioDevicePropertyClockDomain,					0,									sizeof(UInt32) },
+	{ kObjectKind_Device,	kAudioDevicePropertyDeviceIsAlive,					0,									sizeof(AudioClassID) },
+	{ kObjectKind_Device,	kAudioDevicePropertyDeviceIsRunning,				0,									sizeof(UInt32) },
+	{ kObjectKind_Device,	kAudioDevicePropertyDeviceCanBeDefaultDevice,		kPropertyFlag_DirectionalScope,		sizeof(UInt32) },
+	{ kObjectKind_Device,	kAudioDevicePropertyDeviceCanBeDefaultSystemDevice,	kPropertyFlag_DirectionalScope,		sizeof(UInt32) },
+	{ kObjectKind_Device,	kAudioDevicePropertyLatency,						kPropertyFlag_DirectionalScope,		sizeof(UInt32) },
+	{ kObjectKind_Device,	kAudioDevicePropertyStreams,						kPropertyFlag_ComputedSize,			0 },
+	{ kObjectKind_Device,	kAudioObjectPropertyControlList,					0,									7 * sizeof(AudioObjectID) },
+	{ kObjectKind_Device,	kAudioDevicePropertySafetyOffset,					kPropertyFlag_DirectionalScope,		sizeof(UInt32) },
+	{ kObjectKind_Device,	kAudioDevicePropertyNominalSampleRate,				kPropertyFlag_Settable,				sizeof(Float64) },
+	{ kObjectKind_Device,	kAudioDevicePropertyAvailableNominalSampleRates,	kPropertyFlag_ComputedSize,			0 },
+	{ kObjectKind_Device,	kAudioDevicePropertyIsHidden,						0,									sizeof(UInt32) },
+	{ kObjectKind_Device,	kAudioDevicePropertyPreferredChannelsForStereo,		kPropertyFlag_DirectionalScope,		2 * sizeof(UInt32) },
+	{ kObjectKind_Device,	kAudioDevicePropertyPreferredChannelLayout,			kPropertyFlag_DirectionalScope | kPropertyFlag_ComputedSize,	0 },
+	{ kObjectKind_Device,	kAudioDevicePropertyZeroTimeStampPeriod,			0,									sizeof(UInt32) },
+	{ kObjectKind_Device,	kAudioDevicePropertyIcon,							0,									sizeof(CFURLRef) },
+	{ kObjectKind_Device,	kAudioObjectPropertyCustomPropertyInfoList,			0,									5 * sizeof(AudioServerPlugInCustomPropertyInfo) },
+	{ kObjectKind_Device,	kDevice_DelayPropertyID,							kPropertyFlag_Settable,				sizeof(CFPropertyListRef) },
+	{ kObjectKind_Device,	kDevice_MemoryStatusPropertyID,						0,									sizeof(CFPropertyListRef) },
+	{ kObjectKind_Device,	kDevice_ClientRoutesPropertyID,						kPropertyFlag_Settable,				sizeof(CFPropertyListRef) },
+	{ kObjectKind_Device,	kDevice_ClientVolumePropertyID,						kPropertyFlag_Settable,				sizeof(CFPropertyListRef) },
+	{ kObjectKind_Device,	kDevice_ClientMutePropertyID,						kPropertyFlag_Settable,				sizeof(CFPropertyListRef) },
+	
+	//	the streams
+	{ kObjectKind_Stream,	kAudioObjectPropertyBaseClass,						0,									sizeof(AudioClassID) },
+	{ kObjectKind_Stream,	kAudioObjectPropertyClass,							0,									sizeof(AudioClassID) },
+	{ kObjectKind_Stream,	kAudioObjectPropertyOwner,							0,									sizeof(AudioObjectID) },
+	{ kObjectKind_Stream,	kAudioObjectPropertyOwnedObjects,					0,									0 },
+	{ kObjectKind_Stream,	kAudioObjectPropertyName,							0,									sizeof(CFStringRef) },
+	{ kObjectKind_Stream,	kAudioStreamPropertyIsActive,						kPropertyFlag_Settable,				sizeof(UInt32) },
+	{ kObjectKind_Stream,	kAudioStreamPropertyDirection,						0,									sizeof(UInt32) },
+	{ kObjectKind_Stream,	kAudioStreamPropertyTerminalType,					0,									sizeof(UInt32) },
+	{ kObjectKind_Stream,	kAudioStreamPropertyStartingChannel,				0,									sizeof(UInt32) },
+	{ kObjectKind_Stream,	kAudioStreamPropertyLatency,						0,									sizeof(UInt32) },
+	{ kObjectKind_Stream,	kAudioStreamPropertyVirtualFormat,					kPropertyFlag_Settable,				sizeof(AudioStreamBasicDescription) },
+	{ kObjectKind_Stream,	kAudioStreamPropertyPhysicalFormat,					kPropertyFlag_Settable,				sizeof(AudioStreamBasicDescription) },
+	{ kObjectKind_Stream,	kAudioStreamPropertyAvailableVirtualFormats,		kPropertyFlag_ComputedSize,			0 },
+	{ kObjectKind_Stream,	kAudioStreamPropertyAvailablePhysicalFormats,		kPropertyFlag_ComputedSize,			0 },
+	
+	//	the volume controls
+	{ kObjectKind_Volume,	kAudioObjectPropertyBaseClass,						0,									sizeof(AudioClassID) },
+	{ kObjectKind_Volume,	kAudioObjectPropertyClass,							0,									sizeof(AudioClassID) },
+	{ kObjectKind_Volume,	kAudioObjectPropertyOwner,							0,									sizeof(AudioObjectID) },
+	{ kObjectKind_Volume,	kAudioObjectPropertyOwnedObjects,					0,									0 },
+	{ kObjectKind_Volume,	kAudioControlPropertyScope,							0,									sizeof(AudioObjectPropertyScope) },
+	{ kObjectKind_Volume,	kAudioControlPropertyElement,						0,									sizeof(AudioObjectPropertyElement) },
+	{ kObjectKind_Volume,	kAudioLevelControlPropertyScalarValue,				kPropertyFlag_Settable,				sizeof(Float32) },
+	{ kObjectKind_Volume,	kAudioLevelControlPropertyDecibelValue,				kPropertyFlag_Settable,				sizeof(Float32) },
+	{ kObjectKind_Volume,	kAudioLevelControlPropertyDecibelRange,				0,									sizeof(AudioValueRange) },
+	{ kObjectKind_Volume,	kAudioLevelControlPropertyConvertScalarToDecibels,	0,									sizeof(Float32) },
+	{ kObjectKind_Volume,	kAudioLevelControlPropertyConvertDecibelsToScalar,	0,									sizeof(Float32) },
+	
+	//	the mute controls
+	{ kObjectKind_Mute,		kAudioObjectPropertyBaseClass,						0,									sizeof(AudioClassID) },
+	{ kObjectKind_Mute,		kAudioObjectPropertyClass,							0,									sizeof(AudioClassID) },
+	{ kObjectKind_Mute,		kAudioObjectPropertyOwner,							0,									sizeof(AudioObjectID) },
+	{ kObjectKind_Mute,		kAudioObjectPropertyOwnedObjects,					0,									0 },
+	{ kObjectKind_Mute,		kAudioControlPropertyScope,							0,									sizeof(AudioObjectPropertyScope) },
+	{ kObjectKind_Mute,		kAudioControlPropertyElement,						0,									sizeof(AudioObjectPropertyElement) },
+	{ kObjectKind_Mute,		kAudioBooleanControlPropertyValue,					kPropertyFlag_Settable,				sizeof(UInt32) },
+	
+	//	the data source and data destination controls
+	{ kObjectKind_Selector,	kAudioObjectPropertyBaseClass,						0,									sizeof(AudioClassID) },
+	{ kObjectKind_Selector,	kAudioObjectPropertyClass,							0,									sizeof(AudioClassID) },
+	{ kObjectKind_Selector,	kAudioObjectPropertyOwner,							0,									sizeof(AudioObjectID) },
+	{ kObjectKind_Selector,	kAudioObjectPropertyOwnedObjects,					0,									0 },
+	{ kObjectKind_Selector,	kAudioControlPropertyScope,							0,									sizeof(AudioObjectPropertyScope) },
+	{ kObjectKind_Selector,	kAudioControlPropertyElement,						0,									sizeof(AudioObjectPropertyElement) },
+	{ kObjectKind_Selector,	kAudioSelectorControlPropertyCurrentItem,			kPropertyFlag_Settable,				sizeof(UInt32) },
+	{ kObjectKind_Selector,	kAudioSelectorControlPropertyAvailableItems,		kPropertyFlag_ComputedSize,			0 },
+	{ kObjectKind_Selector,	kAudioSelectorControlPropertyItemName,				0,									sizeof(CFStringRef) }
+};
+
+#define	kPropertyRegistry_PropertyCount	(sizeof(kPropertyRegistry_Properties) / sizeof(kPropertyRegistry_Properties[0]))
+_Static_assert(kPropertyRegistry_PropertyCount <= kSyncAudioPropertyRegistry_MaxCount, "the property registry must stay at most half full");
+
+static SyncAudioPropertyRegistry	gPropertyRegistry;
+static pthread_once_t				gPropertyRegistry_Once	= PTHREAD_ONCE_INIT;
+
+static void	SyncAudio_PropertyRegistry_Build(void)
+{
+	//	this only fails if someone lists a property twice, which leaves every lookup failing
+	if(!SyncAudioPropertyRegistry_Initialize(&gPropertyRegistry, kPropertyRegistry_Properties, kPropertyRegistry_PropertyCount))
+	{
+		DebugMsg("SyncAudio_PropertyRegistry_Build: a property is listed twice");
+	}
+}
+
+static UInt32	SyncAudio_PropertyRegistry_GetObjectKind(AudioObjectID inObjectID)
+{
+	//	The plug-in and the box have fixed object IDs. Everything else belongs to a device and its
+	//	kind follows from where it falls in the device's block of object IDs.
+	UInt32 theAnswer = kObjectKind_None;
+	UInt32 theDeviceObject;
+	if(inObjectID == kObjectID_PlugIn)
+	{
+		theAnswer = kObjectKind_PlugIn;
+	}
+	else if(inObjectID == kObjectID_Box)
+	{
+		theAnswer = kObjectKind_Box;
+	}
+	else if(SyncAudio_FindDevice(inObjectID, &theDeviceObject) != NULL)
+	{
+		theAnswer = kPropertyRegistry_DeviceObjectKinds[theDeviceObject];
+	}
+	return theAnswer;
+}
+
+static const SyncAudioPropertyInfo*	SyncAudio_PropertyRegistry_Find(UInt32 inObjectKind, AudioObjectPropertySelector inSelector)
+{
+	//	This returns the registry's entry for the given selector on the given kind of object, or NULL
+	//	if that kind of object doesn't have that property.
+	pthread_once(&gPropertyRegistry_Once, SyncAudio_PropertyRegistry_Build);
+	return SyncAudioPropertyRegistry_Find(&gPropertyRegistry, inObjectKind, inSelector);
+}
+
+static Boolean	SyncAudio_PropertyRegistry_AppliesToAddress(const SyncAudioPropertyInfo* inInfo, AudioObjectID inObjectID, const AudioObjectPropertyAddress* inAddress)
+{
+	//	Element 0 is the master element and the rest are the channels of the object's device.
+	Boolean theAnswer = true;
+	if((inInfo->mFlags & kPropertyFlag_DirectionalScope) != 0)
+	{
+		theAnswer = (inAddress->mScope == kAudioObjectPropertyScopeInput) || (inAddress->mScope == kAudioObjectPropertyScopeOutput);
+	}
+	if((inInfo->mFlags & kPropertyFlag_ChannelElement) != 0)
+	{
+		const SyncAudioDevice* theDevice = SyncAudio_FindDevice(inObjectID, NULL);
+		theAnswer = theAnswer && (theDevice != NULL) && (inAddress->mElement <= theDevice->mChannelCount);
+	}
+	return theAnswer;
+}
+
 #pragma mark Property Operations
 
 static Boolean	SyncAudio_HasProperty(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress)
 {
 	//	This method returns whether or not the given object has the given property.
 	
+	#pragma unused(inClientProcessID)
+	
 	//	declare the local variables
 	Boolean theAnswer = false;
+	const SyncAudioPropertyInfo* theInfo;
 	
 	//	check the arguments
 	FailIf(inDriver != gAudioServerPlugInDriverRef, Done, "SyncAudio_HasProperty: bad driver reference");
 	FailIf(inAddress == NULL, Done, "SyncAudio_HasProperty: no address");
 	
-	//	Note that for each object, this driver implements all the required properties plus a few
-	//	extras that are useful but not required. There is more detailed commentary about each
-	//	property in the SyncAudio_GetPropertyData() method.
-	switch(inObjectID)
-	{
-		case kObjectID_PlugIn:
-			theAnswer = SyncAudio_HasPlugInProperty(inDriver, inObjectID, inClientProcessID, inAddress);
-			break;
-		
-		case kObjectID_Box:
-			theAnswer = SyncAudio_HasBoxProperty(inDriver, inObjectID, inClientProcessID, inAddress);
-			break;
-		
-		case kObjectID_Device:
-			theAnswer = SyncAudio_HasDeviceProperty(inDriver, inObjectID, inClientProcessID, inAddress);
-			break;
-		
-		case kObjectID_Stream_Input:
-		case kObjectID_Stream_Output:
-			theAnswer = SyncAudio_HasStreamProperty(inDriver, inObjectID, inClientProcessID, inAddress);
-			break;
-		
-		case kObjectID_Volume_Input_Master:
-		case kObjectID_Volume_Output_Master:
-		case kObjectID_Mute_Input_Master:
-		case kObjectID_Mute_Output_Master:
-		case kObjectID_DataSource_Input_Master:
-		case kObjectID_DataSource_Output_Master:
-		case kObjectID_DataDestination_PlayThru_Master:
-			theAnswer = SyncAudio_HasControlProperty(inDriver, inObjectID, inClientProcessID, inAddress);
-			break;
-	};
+	//	look the property up in the registry
+	theInfo = SyncAudio_PropertyRegistry_Find(SyncAudio_PropertyRegistry_GetObjectKind(inObjectID), inAddress->mSelector);
+	theAnswer = (theInfo != NULL) && SyncAudio_PropertyRegistry_AppliesToAddress(theInfo, inObjectID, inAddress);
 
 Done:
 	return theAnswer;
@@ -653,50 +1180,24 @@ static OSStatus	SyncAudio_IsPropertySettable(AudioServerPlugInDriverRef inDriver
 	//	This method returns whether or not the given property on the object can have its value
 	//	changed.
 	
+	#pragma unused(inClientProcessID)
+	
 	//	declare the local variables
 	OSStatus theAnswer = 0;
+	UInt32 theObjectKind;
+	const SyncAudioPropertyInfo* theInfo;
 	
 	//	check the arguments
 	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_IsPropertySettable: bad driver reference");
 	FailWithAction(inAddress == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_IsPropertySettable: no address");
 	FailWithAction(outIsSettable == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_IsPropertySettable: no place to put the return value");
 	
-	//	Note that for each object, this driver implements all the required properties plus a few
-	//	extras that are useful but not required. There is more detailed commentary about each
-	//	property in the SyncAudio_GetPropertyData() method.
-	switch(inObjectID)
-	{
-		case kObjectID_PlugIn:
-			theAnswer = SyncAudio_IsPlugInPropertySettable(inDriver, inObjectID, inClientProcessID, inAddress, outIsSettable);
-			break;
-		
-		case kObjectID_Box:
-			theAnswer = SyncAudio_IsBoxPropertySettable(inDriver, inObjectID, inClientProcessID, inAddress, outIsSettable);
-			break;
-		
-		case kObjectID_Device:
-			theAnswer = SyncAudio_IsDevicePropertySettable(inDriver, inObjectID, inClientProcessID, inAddress, outIsSettable);
-			break;
-		
-		case kObjectID_Stream_Input:
-		case kObjectID_Stream_Output:
-			theAnswer = SyncAudio_IsStreamPropertySettable(inDriver, inObjectID, inClientProcessID, inAddress, outIsSettable);
-			break;
-		
-		case kObjectID_Volume_Input_Master:
-		case kObjectID_Volume_Output_Master:
-		case kObjectID_Mute_Input_Master:
-		case kObjectID_Mute_Output_Master:
-		case kObjectID_DataSource_Input_Master:
-		case kObjectID_DataSource_Output_Master:
-		case kObjectID_DataDestination_PlayThru_Master:
-			theAnswer = SyncAudio_IsControlPropertySettable(inDriver, inObjectID, inClientProcessID, inAddress, outIsSettable);
-			break;
-				
-		default:
-			theAnswer = kAudioHardwareBadObjectError;
-			break;
-	};
+	//	look the property up in the registry
+	theObjectKind = SyncAudio_PropertyRegistry_GetObjectKind(inObjectID);
+	FailWithAction(theObjectKind == kObjectKind_None, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_IsPropertySettable: unknown object");
+	theInfo = SyncAudio_PropertyRegistry_Find(theObjectKind, inAddress->mSelector);
+	FailWithAction(theInfo == NULL, theAnswer = kAudioHardwareUnknownPropertyError, Done, "SyncAudio_IsPropertySettable: unknown property");
+	*outIsSettable = (theInfo->mFlags & kPropertyFlag_Settable) != 0;
 
 Done:
 	return theAnswer;
@@ -708,48 +1209,29 @@ static OSStatus	SyncAudio_GetPropertyDataSize(AudioServerPlugInDriverRef inDrive
 	
 	//	declare the local variables
 	OSStatus theAnswer = 0;
+	UInt32 theObjectKind;
+	const SyncAudioPropertyInfo* theInfo;
 	
 	//	check the arguments
 	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetPropertyDataSize: bad driver reference");
 	FailWithAction(inAddress == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetPropertyDataSize: no address");
 	FailWithAction(outDataSize == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetPropertyDataSize: no place to put the return value");
 	
-	//	Note that for each object, this driver implements all the required properties plus a few
-	//	extras that are useful but not required. There is more detailed commentary about each
-	//	property in the SyncAudio_GetPropertyData() method.
-	switch(inObjectID)
+	//	look the property up in the registry
+	theObjectKind = SyncAudio_PropertyRegistry_GetObjectKind(inObjectID);
+	FailWithAction(theObjectKind == kObjectKind_None, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetPropertyDataSize: unknown object");
+	theInfo = SyncAudio_PropertyRegistry_Find(theObjectKind, inAddress->mSelector);
+	FailWithAction(theInfo == NULL, theAnswer = kAudioHardwareUnknownPropertyError, Done, "SyncAudio_GetPropertyDataSize: unknown property");
+	
+	//	most sizes are fixed and come straight from the registry
+	if((theInfo->mFlags & kPropertyFlag_ComputedSize) == 0)
 	{
-		case kObjectID_PlugIn:
-			theAnswer = SyncAudio_GetPlugInPropertyDataSize(inDriver, inObjectID, inClientProcessID, inAddress, inQualifierDataSize, inQualifierData, outDataSize);
-			break;
-		
-		case kObjectID_Box:
-			theAnswer = SyncAudio_GetBoxPropertyDataSize(inDriver, inObjectID, inClientProcessID, inAddress, inQualifierDataSize, inQualifierData, outDataSize);
-			break;
-		
-		case kObjectID_Device:
-			theAnswer = SyncAudio_GetDevicePropertyDataSize(inDriver, inObjectID, inClientProcessID, inAddress, inQualifierDataSize, inQualifierData, outDataSize);
-			break;
-		
-		case kObjectID_Stream_Input:
-		case kObjectID_Stream_Output:
-			theAnswer = SyncAudio_GetStreamPropertyDataSize(inDriver, inObjectID, inClientProcessID, inAddress, inQualifierDataSize, inQualifierData, outDataSize);
-			break;
-		
-		case kObjectID_Volume_Input_Master:
-		case kObjectID_Volume_Output_Master:
-		case kObjectID_Mute_Input_Master:
-		case kObjectID_Mute_Output_Master:
-		case kObjectID_DataSource_Input_Master:
-		case kObjectID_DataSource_Output_Master:
-		case kObjectID_DataDestination_PlayThru_Master:
-			theAnswer = SyncAudio_GetControlPropertyDataSize(inDriver, inObjectID, inClientProcessID, inAddress, inQualifierDataSize, inQualifierData, outDataSize);
-			break;
-				
-		default:
-			theAnswer = kAudioHardwareBadObjectError;
-			break;
-	};
+		*outDataSize = theInfo->mDataSize;
+	}
+	else
+	{
+		theAnswer = kPropertyRegistry_Operations[theObjectKind].mGetPropertyDataSize(inDriver, inObjectID, inClientProcessID, inAddress, inQualifierDataSize, inQualifierData, outDataSize);
+	}
 
 Done:
 	return theAnswer;
@@ -759,6 +1241,7 @@ static OSStatus	SyncAudio_GetPropertyData(AudioServerPlugInDriverRef inDriver, A
 {
 	//	declare the local variables
 	OSStatus theAnswer = 0;
+	UInt32 theObjectKind;
 	
 	//	check the arguments
 	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetPropertyData: bad driver reference");
@@ -766,44 +1249,12 @@ static OSStatus	SyncAudio_GetPropertyData(AudioServerPlugInDriverRef inDriver, A
 	FailWithAction(outDataSize == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetPropertyData: no place to put the return value size");
 	FailWithAction(outData == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetPropertyData: no place to put the return value");
 	
-	//	Note that for each object, this driver implements all the required properties plus a few
-	//	extras that are useful but not required.
-	//
-	//	Also, since most of the data that will get returned is static, there are few instances where
-	//	it is necessary to lock the state mutex.
-	switch(inObjectID)
-	{
-		case kObjectID_PlugIn:
-			theAnswer = SyncAudio_GetPlugInPropertyData(inDriver, inObjectID, inClientProcessID, inAddress, inQualifierDataSize, inQualifierData, inDataSize, outDataSize, outData);
-			break;
-		
-		case kObjectID_Box:
-			theAnswer = SyncAudio_GetBoxPropertyData(inDriver, inObjectID, inClientProcessID, inAddress, inQualifierDataSize, inQualifierData, inDataSize, outDataSize, outData);
-			break;
-		
-		case kObjectID_Device:
-			theAnswer = SyncAudio_GetDevicePropertyData(inDriver, inObjectID, inClientProcessID, inAddress, inQualifierDataSize, inQualifierData, inDataSize, outDataSize, outData);
-			break;
-		
-		case kObjectID_Stream_Input:
-		case kObjectID_Stream_Output:
-			theAnswer = SyncAudio_GetStreamPropertyData(inDriver, inObjectID, inClientProcessID, inAddress, inQualifierDataSize, inQualifierData, inDataSize, outDataSize, outData);
-			break;
-		
-		case kObjectID_Volume_Input_Master:
-		case kObjectID_Volume_Output_Master:
-		case kObjectID_Mute_Input_Master:
-		case kObjectID_Mute_Output_Master:
-		case kObjectID_DataSource_Input_Master:
-		case kObjectID_DataSource_Output_Master:
-		case kObjectID_DataDestination_PlayThru_Master:
-			theAnswer = SyncAudio_GetControlPropertyData(inDriver, inObjectID, inClientProcessID, inAddress, inQualifierDataSize, inQualifierData, inDataSize, outDataSize, outData);
-			break;
-				
-		default:
-			theAnswer = kAudioHardwareBadObjectError;
-			break;
-	};
+	//	Note that since most of the data that will get returned is static, there are few instances
+	//	where it is necessary to lock the state mutex.
+	theObjectKind = SyncAudio_PropertyRegistry_GetObjectKind(inObjectID);
+	FailWithAction(theObjectKind == kObjectKind_None, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetPropertyData: unknown object");
+	FailWithAction(SyncAudio_PropertyRegistry_Find(theObjectKind, inAddress->mSelector) == NULL, theAnswer = kAudioHardwareUnknownPropertyError, Done, "SyncAudio_GetPropertyData: unknown property");
+	theAnswer = kPropertyRegistry_Operations[theObjectKind].mGetPropertyData(inDriver, inObjectID, inClientProcessID, inAddress, inQualifierDataSize, inQualifierData, inDataSize, outDataSize, outData);
 
 Done:
 	return theAnswer;
@@ -813,55 +1264,30 @@ static OSStatus	SyncAudio_SetPropertyData(AudioServerPlugInDriverRef inDriver, A
 {
 	//	declare the local variables
 	OSStatus theAnswer = 0;
+	UInt32 theObjectKind;
+	const SyncAudioPropertyInfo* theInfo;
 	UInt32 theNumberPropertiesChanged = 0;
 	AudioObjectPropertyAddress theChangedAddresses[2];
 	
 	//	check the arguments
 	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_SetPropertyData: bad driver reference");
 	FailWithAction(inAddress == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_SetPropertyData: no address");
+	UInt64 theStartHostTime = SyncAudio_GetHostTime();
 	
-	//	Note that for each object, this driver implements all the required properties plus a few
-	//	extras that are useful but not required. There is more detailed commentary about each
-	//	property in the SyncAudio_GetPropertyData() method.
-	switch(inObjectID)
-	{
-		case kObjectID_PlugIn:
-			theAnswer = SyncAudio_SetPlugInPropertyData(inDriver, inObjectID, inClientProcessID, inAddress, inQualifierDataSize, inQualifierData, inDataSize, inData, &theNumberPropertiesChanged, theChangedAddresses);
-			break;
-		
-		case kObjectID_Box:
-			theAnswer = SyncAudio_SetBoxPropertyData(inDriver, inObjectID, inClientProcessID, inAddress, inQualifierDataSize, inQualifierData, inDataSize, inData, &theNumberPropertiesChanged, theChangedAddresses);
-			break;
-		
-		case kObjectID_Device:
-			theAnswer = SyncAudio_SetDevicePropertyData(inDriver, inObjectID, inClientProcessID, inAddress, inQualifierDataSize, inQualifierData, inDataSize, inData, &theNumberPropertiesChanged, theChangedAddresses);
-			break;
-		
-		case kObjectID_Stream_Input:
-		case kObjectID_Stream_Output:
-			theAnswer = SyncAudio_SetStreamPropertyData(inDriver, inObjectID, inClientProcessID, inAddress, inQualifierDataSize, inQualifierData, inDataSize, inData, &theNumberPropertiesChanged, theChangedAddresses);
-			break;
-		
-		case kObjectID_Volume_Input_Master:
-		case kObjectID_Volume_Output_Master:
-		case kObjectID_Mute_Input_Master:
-		case kObjectID_Mute_Output_Master:
-		case kObjectID_DataSource_Input_Master:
-		case kObjectID_DataSource_Output_Master:
-		case kObjectID_DataDestination_PlayThru_Master:
-			theAnswer = SyncAudio_SetControlPropertyData(inDriver, inObjectID, inClientProcessID, inAddress, inQualifierDataSize, inQualifierData, inDataSize, inData, &theNumberPropertiesChanged, theChangedAddresses);
-			break;
-				
-		default:
-			theAnswer = kAudioHardwareBadObjectError;
-			break;
-	};
+	//	look the property up in the registry, which turns away the properties that can't be set
+	//	before they get to the object
+	theObjectKind = SyncAudio_PropertyRegistry_GetObjectKind(inObjectID);
+	FailWithAction(theObjectKind == kObjectKind_None, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_SetPropertyData: unknown object");
+	theInfo = SyncAudio_PropertyRegistry_Find(theObjectKind, inAddress->mSelector);
+	FailWithAction((theInfo == NULL) || ((theInfo->mFlags & kPropertyFlag_Settable) == 0), theAnswer = kAudioHardwareUnknownPropertyError, Done, "SyncAudio_SetPropertyData: unknown or unsettable property");
+	theAnswer = kPropertyRegistry_Operations[theObjectKind].mSetPropertyData(inDriver, inObjectID, inClientProcessID, inAddress, inQualifierDataSize, inQualifierData, inDataSize, inData, &theNumberPropertiesChanged, theChangedAddresses);
 
 	//	send any notifications
 	if(theNumberPropertiesChanged > 0)
 	{
 		gPlugIn_Host->PropertiesChanged(gPlugIn_Host, inObjectID, theNumberPropertiesChanged, theChangedAddresses);
 	}
+	SyncAudio_Trace(kSyncAudioTrace_SetProperty, inObjectID, theStartHostTime, SyncAudio_GetHostTime(), ((UInt64)inAddress->mSelector << 32) | inAddress->mScope, inAddress->mElement);
 
 Done:
 	return theAnswer;
@@ -869,170 +1295,46 @@ Done:
 
 #pragma mark PlugIn Property Operations
 
-static Boolean	SyncAudio_HasPlugInProperty(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress)
+static OSStatus	SyncAudio_GetPlugInPropertyDataSize(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize, const void* inQualifierData, UInt32* outDataSize)
 {
-	//	This method returns whether or not the plug-in object has the given property.
+	//	This method returns the byte size of the property's data.
 	
-	#pragma unused(inClientProcessID)
+	#pragma unused(inClientProcessID, inQualifierDataSize, inQualifierData)
 	
 	//	declare the local variables
-	Boolean theAnswer = false;
+	OSStatus theAnswer = 0;
 	
 	//	check the arguments
-	FailIf(inDriver != gAudioServerPlugInDriverRef, Done, "SyncAudio_HasPlugInProperty: bad driver reference");
-	FailIf(inAddress == NULL, Done, "SyncAudio_HasPlugInProperty: no address");
-	FailIf(inObjectID != kObjectID_PlugIn, Done, "SyncAudio_HasPlugInProperty: not the plug-in object");
-	
+	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetPlugInPropertyDataSize: bad driver reference");
+	FailWithAction(inAddress == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetPlugInPropertyDataSize: no address");
+	FailWithAction(outDataSize == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetPlugInPropertyDataSize: no place to put the return value");
+	FailWithAction(inObjectID != kObjectID_PlugIn, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetPlugInPropertyDataSize: not the plug-in object");
 	
-	//	Note that for each object, this driver implements all the required properties plus a few
-	//	extras that are useful but not required. There is more detailed commentary about each
-	//	property in the SyncAudio_GetPlugInPropertyData() method.
+	//	Only the properties whose size depends on the state or on the address get here. The
+	//	registry has the sizes of the rest. There is more detailed commentary about each property
+	//	in the SyncAudio_GetPlugInPropertyData() method.
 	switch(inAddress->mSelector)
 	{
-		case kAudioObjectPropertyBaseClass:
-		case kAudioObjectPropertyClass:
-		case kAudioObjectPropertyOwner:
-		case kAudioObjectPropertyManufacturer:
 		case kAudioObjectPropertyOwnedObjects:
-		case kAudioPlugInPropertyBoxList:
-		case kAudioPlugInPropertyTranslateUIDToBox:
+			if(gBox_Acquired)
+			{
+				*outDataSize = (1 + gPlugIn_NumberDevices) * sizeof(AudioClassID);
+			}
+			else
+			{
+				*outDataSize = sizeof(AudioClassID);
+			}
+			break;
+			
 		case kAudioPlugInPropertyDeviceList:
-		case kAudioPlugInPropertyTranslateUIDToDevice:
-		case kAudioPlugInPropertyResourceBundle:
-		case kAudioObjectPropertyCustomPropertyInfoList:
-		case kPlugIn_CustomPropertyID:
-			theAnswer = true;
-			break;
-	};
-
-Done:
-	return theAnswer;
-}
-
-static OSStatus	SyncAudio_IsPlugInPropertySettable(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, Boolean* outIsSettable)
-{
-	//	This method returns whether or not the given property on the plug-in object can have its
-	//	value changed.
-	
-	#pragma unused(inClientProcessID)
-	
-	//	declare the local variables
-	OSStatus theAnswer = 0;
-	
-	//	check the arguments
-	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_IsPlugInPropertySettable: bad driver reference");
-	FailWithAction(inAddress == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_IsPlugInPropertySettable: no address");
-	FailWithAction(outIsSettable == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_IsPlugInPropertySettable: no place to put the return value");
-	FailWithAction(inObjectID != kObjectID_PlugIn, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_IsPlugInPropertySettable: not the plug-in object");
-	
-	//	Note that for each object, this driver implements all the required properties plus a few
-	//	extras that are useful but not required. There is more detailed commentary about each
-	//	property in the SyncAudio_GetPlugInPropertyData() method.
-	switch(inAddress->mSelector)
-	{
-		case kAudioObjectPropertyBaseClass:
-		case kAudioObjectPropertyClass:
-		case kAudioObjectPropertyOwner:
-		case kAudioObjectPropertyManufacturer:
-		case kAudioObjectPropertyOwnedObjects:
-		case kAudioPlugInPropertyBoxList:
-		case kAudioPlugInPropertyTranslateUIDToBox:
-		case kAudioPlugInPropertyDeviceList:
-		case kAudioPlugInPropertyTranslateUIDToDevice:
-		case kAudioPlugInPropertyResourceBundle:
-		case kAudioObjectPropertyCustomPropertyInfoList:
-			*outIsSettable = false;
-			break;
-		
-		case kPlugIn_CustomPropertyID:
-			*outIsSettable = true;
-			break;
-		
-		default:
-			theAnswer = kAudioHardwareUnknownPropertyError;
-			break;
-	};
-
-Done:
-	return theAnswer;
-}
-
-static OSStatus	SyncAudio_GetPlugInPropertyDataSize(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize, const void* inQualifierData, UInt32* outDataSize)
-{
-	//	This method returns the byte size of the property's data.
-	
-	#pragma unused(inClientProcessID, inQualifierDataSize, inQualifierData)
-	
-	//	declare the local variables
-	OSStatus theAnswer = 0;
-	
-	//	check the arguments
-	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetPlugInPropertyDataSize: bad driver reference");
-	FailWithAction(inAddress == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetPlugInPropertyDataSize: no address");
-	FailWithAction(outDataSize == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetPlugInPropertyDataSize: no place to put the return value");
-	FailWithAction(inObjectID != kObjectID_PlugIn, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetPlugInPropertyDataSize: not the plug-in object");
-	
-	//	Note that for each object, this driver implements all the required properties plus a few
-	//	extras that are useful but not required. There is more detailed commentary about each
-	//	property in the SyncAudio_GetPlugInPropertyData() method.
-	switch(inAddress->mSelector)
-	{
-		case kAudioObjectPropertyBaseClass:
-			*outDataSize = sizeof(AudioClassID);
-			break;
-			
-		case kAudioObjectPropertyClass:
-			*outDataSize = sizeof(AudioClassID);
-			break;
-			
-		case kAudioObjectPropertyOwner:
-			*outDataSize = sizeof(AudioObjectID);
-			break;
-			
-		case kAudioObjectPropertyManufacturer:
-			*outDataSize = sizeof(CFStringRef);
-			break;
-			
-		case kAudioObjectPropertyOwnedObjects:
-			if(gBox_Acquired)
-			{
-				*outDataSize = 2 * sizeof(AudioClassID);
-			}
-			else
-			{
-				*outDataSize = sizeof(AudioClassID);
-			}
-			break;
-			
-		case kAudioPlugInPropertyBoxList:
-			*outDataSize = sizeof(AudioClassID);
-			break;
-			
-		case kAudioPlugInPropertyTranslateUIDToBox:
-			*outDataSize = sizeof(AudioObjectID);
-			break;
-			
-		case kAudioPlugInPropertyDeviceList:
-			if(gBox_Acquired)
-			{
-				*outDataSize = sizeof(AudioClassID);
-			}
-			else
-			{
-				*outDataSize = 0;
-			}
-			break;
-			
-		case kAudioPlugInPropertyTranslateUIDToDevice:
-			*outDataSize = sizeof(AudioObjectID);
-			break;
-			
-		case kAudioPlugInPropertyResourceBundle:
-			*outDataSize = sizeof(CFStringRef);
-			break;
-			
-		case kAudioObjectPropertyCustomPropertyInfoList:
-			*outDataSize = sizeof(AudioServerPlugInCustomPropertyInfo);
+			if(gBox_Acquired)
+			{
+				*outDataSize = gPlugIn_NumberDevices * sizeof(AudioClassID);
+			}
+			else
+			{
+				*outDataSize = 0;
+			}
 			break;
 			
 		case kPlugIn_CustomPropertyID:
@@ -1059,6 +1361,8 @@ static OSStatus	SyncAudio_GetPlugInPropertyData(AudioServerPlugInDriverRef inDri
 	//	declare the local variables
 	OSStatus theAnswer = 0;
 	UInt32 theNumberItemsToFetch;
+	UInt32 theNumberDevices;
+	UInt32 theItemIndex;
 	
 	//	check the arguments
 	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetPlugInPropertyData: bad driver reference");
@@ -1108,21 +1412,22 @@ static OSStatus	SyncAudio_GetPlugInPropertyData(AudioServerPlugInDriverRef inDri
 			//	case, only that number of items will be returned
 			theNumberItemsToFetch = inDataSize / sizeof(AudioObjectID);
 			
-			//	Clamp that to the number of boxes this driver implements (which is just 1)
-			if(theNumberItemsToFetch > (gBox_Acquired ? 2 : 1))
+			//	Clamp that to the number of objects the plug-in owns, which is the box plus its
+			//	devices if the box has been acquired
+			theNumberDevices = gBox_Acquired ? gPlugIn_NumberDevices : 0;
+			if(theNumberItemsToFetch > (1 + theNumberDevices))
 			{
-				theNumberItemsToFetch = (gBox_Acquired ? 2 : 1);
+				theNumberItemsToFetch = 1 + theNumberDevices;
 			}
 			
-			//	Write the devices' object IDs into the return value
-			if(theNumberItemsToFetch > 1)
+			//	Write the box's and the devices' object IDs into the return value
+			if(theNumberItemsToFetch > 0)
 			{
 				((AudioObjectID*)outData)[0] = kObjectID_Box;
-				((AudioObjectID*)outData)[0] = kObjectID_Device;
 			}
-			else if(theNumberItemsToFetch > 0)
+			for(theItemIndex = 1; theItemIndex < theNumberItemsToFetch; ++theItemIndex)
 			{
-				((AudioObjectID*)outData)[0] = kObjectID_Box;
+				((AudioObjectID*)outData)[theItemIndex] = gPlugIn_Devices[theItemIndex - 1].mObjectID;
 			}
 			
 			//	Return how many bytes we wrote to
@@ -1177,17 +1482,18 @@ static OSStatus	SyncAudio_GetPlugInPropertyData(AudioServerPlugInDriverRef inDri
 			//	case, only that number of items will be returned
 			theNumberItemsToFetch = inDataSize / sizeof(AudioObjectID);
 			
-			//	Clamp that to the number of devices this driver implements (which is just 1 if the
-			//	box has been acquired)
-			if(theNumberItemsToFetch > (gBox_Acquired ? 1 : 0))
+			//	Clamp that to the number of devices this driver implements (which is none unless
+			//	the box has been acquired)
+			theNumberDevices = gBox_Acquired ? gPlugIn_NumberDevices : 0;
+			if(theNumberItemsToFetch > theNumberDevices)
 			{
-				theNumberItemsToFetch = (gBox_Acquired ? 1 : 0);
+				theNumberItemsToFetch = theNumberDevices;
 			}
 			
 			//	Write the devices' object IDs into the return value
-			if(theNumberItemsToFetch > 0)
+			for(theItemIndex = 0; theItemIndex < theNumberItemsToFetch; ++theItemIndex)
 			{
-				((AudioObjectID*)outData)[0] = kObjectID_Device;
+				((AudioObjectID*)outData)[theItemIndex] = gPlugIn_Devices[theItemIndex].mObjectID;
 			}
 			
 			//	Return how many bytes we wrote to
@@ -1196,20 +1502,20 @@ static OSStatus	SyncAudio_GetPlugInPropertyData(AudioServerPlugInDriverRef inDri
 			
 		case kAudioPlugInPropertyTranslateUIDToDevice:
 			//	This property takes the CFString passed in the qualifier and converts that
-			//	to the object ID of the device it corresponds to. For this driver, there is
-			//	just the one device. Note that it is not an error if the string in the
-			//	qualifier doesn't match any devices. In such case, kAudioObjectUnknown is
-			//	the object ID to return.
+			//	to the object ID of the device it corresponds to. Note that it is not an error
+			//	if the string in the qualifier doesn't match any devices. In such case,
+			//	kAudioObjectUnknown is the object ID to return.
 			FailWithAction(inDataSize < sizeof(AudioObjectID), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetPlugInPropertyData: not enough space for the return value of kAudioPlugInPropertyTranslateUIDToDevice");
 			FailWithAction(inQualifierDataSize != sizeof(CFStringRef), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetPlugInPropertyData: the qualifier is the wrong size for kAudioPlugInPropertyTranslateUIDToDevice");
 			FailWithAction(inQualifierData == NULL, theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetPlugInPropertyData: no qualifier for kAudioPlugInPropertyTranslateUIDToDevice");
-			if(CFStringCompare(*((CFStringRef*)inQualifierData), CFSTR(kDevice_UID), 0) == kCFCompareEqualTo)
-			{
-				*((AudioObjectID*)outData) = kObjectID_Device;
-			}
-			else
+			*((AudioObjectID*)outData) = kAudioObjectUnknown;
+			for(theItemIndex = 0; theItemIndex < gPlugIn_NumberDevices; ++theItemIndex)
 			{
-				*((AudioObjectID*)outData) = kAudioObjectUnknown;
+				if(CFStringCompare(*((CFStringRef*)inQualifierData), gPlugIn_Devices[theItemIndex].mUID, 0) == kCFCompareEqualTo)
+				{
+					*((AudioObjectID*)outData) = gPlugIn_Devices[theItemIndex].mObjectID;
+					break;
+				}
 			}
 			*outDataSize = sizeof(AudioObjectID);
 			break;
@@ -1226,13 +1532,23 @@ static OSStatus	SyncAudio_GetPlugInPropertyData(AudioServerPlugInDriverRef inDri
 		case kAudioObjectPropertyCustomPropertyInfoList:
 			//	This property returns an array of AudioServerPlugInCustomPropertyInfo's that
 			//	describe the type of data used by any custom properties. For this example,
-			//	the plug-in supports a single property whose data type is a CFString and
-			//	whose qualifier is a CFString.
-			FailWithAction(inDataSize < sizeof(AudioServerPlugInCustomPropertyInfo), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetPlugInPropertyData: not enough space for the return value of kAudioObjectPropertyCustomPropertyInfoList");
-			((AudioServerPlugInCustomPropertyInfo*)outData)->mSelector = kPlugIn_CustomPropertyID;
-			((AudioServerPlugInCustomPropertyInfo*)outData)->mPropertyDataType = kAudioServerPlugInCustomPropertyDataTypeCFString;
-			((AudioServerPlugInCustomPropertyInfo*)outData)->mQualifierDataType = kAudioServerPlugInCustomPropertyDataTypeCFPropertyList;
-			*outDataSize = sizeof(AudioServerPlugInCustomPropertyInfo);
+			//	the plug-in supports a property whose data type is a CFString and whose
+			//	qualifier is a CFString, along with the read only IO statistics, which are a
+			//	CFDictionary and take no qualifier.
+			{
+				AudioServerPlugInCustomPropertyInfo theInfo[2] =
+				{
+					{ kPlugIn_CustomPropertyID, kAudioServerPlugInCustomPropertyDataTypeCFString, kAudioServerPlugInCustomPropertyDataTypeCFPropertyList },
+					{ kPlugIn_IOStatisticsPropertyID, kAudioServerPlugInCustomPropertyDataTypeCFPropertyList, kAudioServerPlugInCustomPropertyDataTypeNone }
+				};
+				theNumberItemsToFetch = inDataSize / sizeof(AudioServerPlugInCustomPropertyInfo);
+				if(theNumberItemsToFetch > 2)
+				{
+					theNumberItemsToFetch = 2;
+				}
+				memcpy(outData, theInfo, theNumberItemsToFetch * sizeof(AudioServerPlugInCustomPropertyInfo));
+				*outDataSize = theNumberItemsToFetch * sizeof(AudioServerPlugInCustomPropertyInfo);
+			}
 			break;
 			
 		case kPlugIn_CustomPropertyID:
@@ -1245,6 +1561,14 @@ static OSStatus	SyncAudio_GetPlugInPropertyData(AudioServerPlugInDriverRef inDri
 			*outDataSize = sizeof(CFStringRef);
 			break;
 			
+		case kPlugIn_IOStatisticsPropertyID:
+			//	This returns a CFDictionary with the device's IO statistics. It only reads
+			//	counters, so it's cheap enough to poll.
+			FailWithAction(inDataSize < sizeof(CFPropertyListRef), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetPlugInPropertyData: not enough space for the return value of kPlugIn_IOStatisticsPropertyID");
+			*((CFPropertyListRef*)outData) = SyncAudio_CopyIOStatistics();
+			*outDataSize = sizeof(CFPropertyListRef);
+			break;
+			
 		default:
 			theAnswer = kAudioHardwareUnknownPropertyError;
 			break;
@@ -1297,99 +1621,34 @@ Done:
 
 #pragma mark Box Property Operations
 
-static Boolean	SyncAudio_HasBoxProperty(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress)
-{
-	//	This method returns whether or not the box object has the given property.
-	
-	#pragma unused(inClientProcessID)
-	
-	//	declare the local variables
-	Boolean theAnswer = false;
-	
-	//	check the arguments
-	FailIf(inDriver != gAudioServerPlugInDriverRef, Done, "SyncAudio_HasBoxProperty: bad driver reference");
-	FailIf(inAddress == NULL, Done, "SyncAudio_HasBoxProperty: no address");
-	FailIf(inObjectID != kObjectID_Box, Done, "SyncAudio_HasBoxProperty: not the box object");
-	
-	
-	//	Note that for each object, this driver implements all the required properties plus a few
-	//	extras that are useful but not required. There is more detailed commentary about each
-	//	property in the SyncAudio_GetBoxPropertyData() method.
-	switch(inAddress->mSelector)
-	{
-		case kAudioObjectPropertyBaseClass:
-		case kAudioObjectPropertyClass:
-		case kAudioObjectPropertyOwner:
-		case kAudioObjectPropertyName:
-		case kAudioObjectPropertyModelName:
-		case kAudioObjectPropertyManufacturer:
-		case kAudioObjectPropertyOwnedObjects:
-		case kAudioObjectPropertyIdentify:
-		case kAudioObjectPropertySerialNumber:
-		case kAudioObjectPropertyFirmwareVersion:
-		case kAudioBoxPropertyBoxUID:
-		case kAudioBoxPropertyTransportType:
-		case kAudioBoxPropertyHasAudio:
-		case kAudioBoxPropertyHasVideo:
-		case kAudioBoxPropertyHasMIDI:
-		case kAudioBoxPropertyIsProtected:
-		case kAudioBoxPropertyAcquired:
-		case kAudioBoxPropertyAcquisitionFailed:
-		case kAudioBoxPropertyDeviceList:
-			theAnswer = true;
-			break;
-	};
-
-Done:
-	return theAnswer;
-}
-
-static OSStatus	SyncAudio_IsBoxPropertySettable(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, Boolean* outIsSettable)
+static OSStatus	SyncAudio_GetBoxPropertyDataSize(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize, const void* inQualifierData, UInt32* outDataSize)
 {
-	//	This method returns whether or not the given property on the plug-in object can have its
-	//	value changed.
+	//	This method returns the byte size of the property's data.
 	
-	#pragma unused(inClientProcessID)
+	#pragma unused(inClientProcessID, inQualifierDataSize, inQualifierData)
 	
 	//	declare the local variables
 	OSStatus theAnswer = 0;
 	
 	//	check the arguments
-	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_IsBoxPropertySettable: bad driver reference");
-	FailWithAction(inAddress == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_IsBoxPropertySettable: no address");
-	FailWithAction(outIsSettable == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_IsBoxPropertySettable: no place to put the return value");
-	FailWithAction(inObjectID != kObjectID_Box, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_IsBoxPropertySettable: not the plug-in object");
+	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetBoxPropertyDataSize: bad driver reference");
+	FailWithAction(inAddress == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetBoxPropertyDataSize: no address");
+	FailWithAction(outDataSize == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetBoxPropertyDataSize: no place to put the return value");
+	FailWithAction(inObjectID != kObjectID_Box, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetBoxPropertyDataSize: not the plug-in object");
 	
-	//	Note that for each object, this driver implements all the required properties plus a few
-	//	extras that are useful but not required. There is more detailed commentary about each
-	//	property in the SyncAudio_GetBoxPropertyData() method.
+	//	Only the properties whose size depends on the state or on the address get here. The
+	//	registry has the sizes of the rest. There is more detailed commentary about each property
+	//	in the SyncAudio_GetBoxPropertyData() method.
 	switch(inAddress->mSelector)
 	{
-		case kAudioObjectPropertyBaseClass:
-		case kAudioObjectPropertyClass:
-		case kAudioObjectPropertyOwner:
-		case kAudioObjectPropertyModelName:
-		case kAudioObjectPropertyManufacturer:
-		case kAudioObjectPropertyOwnedObjects:
-		case kAudioObjectPropertySerialNumber:
-		case kAudioObjectPropertyFirmwareVersion:
-		case kAudioBoxPropertyBoxUID:
-		case kAudioBoxPropertyTransportType:
-		case kAudioBoxPropertyHasAudio:
-		case kAudioBoxPropertyHasVideo:
-		case kAudioBoxPropertyHasMIDI:
-		case kAudioBoxPropertyIsProtected:
-		case kAudioBoxPropertyAcquisitionFailed:
 		case kAudioBoxPropertyDeviceList:
-			*outIsSettable = false;
-			break;
-		
-		case kAudioObjectPropertyName:
-		case kAudioObjectPropertyIdentify:
-		case kAudioBoxPropertyAcquired:
-			*outIsSettable = true;
+			{
+				pthread_mutex_lock(&gPlugIn_StateMutex);
+				*outDataSize = gBox_Acquired ? (gPlugIn_NumberDevices * sizeof(AudioObjectID)) : 0;
+				pthread_mutex_unlock(&gPlugIn_StateMutex);
+			}
 			break;
-		
+			
 		default:
 			theAnswer = kAudioHardwareUnknownPropertyError;
 			break;
@@ -1399,154 +1658,45 @@ Done:
 	return theAnswer;
 }
 
-static OSStatus	SyncAudio_GetBoxPropertyDataSize(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize, const void* inQualifierData, UInt32* outDataSize)
+static OSStatus	SyncAudio_GetBoxPropertyData(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize, const void* inQualifierData, UInt32 inDataSize, UInt32* outDataSize, void* outData)
 {
-	//	This method returns the byte size of the property's data.
-	
 	#pragma unused(inClientProcessID, inQualifierDataSize, inQualifierData)
 	
 	//	declare the local variables
 	OSStatus theAnswer = 0;
 	
 	//	check the arguments
-	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetBoxPropertyDataSize: bad driver reference");
-	FailWithAction(inAddress == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetBoxPropertyDataSize: no address");
-	FailWithAction(outDataSize == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetBoxPropertyDataSize: no place to put the return value");
-	FailWithAction(inObjectID != kObjectID_Box, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetBoxPropertyDataSize: not the plug-in object");
+	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetBoxPropertyData: bad driver reference");
+	FailWithAction(inAddress == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetBoxPropertyData: no address");
+	FailWithAction(outDataSize == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetBoxPropertyData: no place to put the return value size");
+	FailWithAction(outData == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetBoxPropertyData: no place to put the return value");
+	FailWithAction(inObjectID != kObjectID_Box, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetBoxPropertyData: not the plug-in object");
 	
 	//	Note that for each object, this driver implements all the required properties plus a few
-	//	extras that are useful but not required. There is more detailed commentary about each
-	//	property in the SyncAudio_GetBoxPropertyData() method.
+	//	extras that are useful but not required.
+	//
+	//	Also, since most of the data that will get returned is static, there are few instances where
+	//	it is necessary to lock the state mutex.
 	switch(inAddress->mSelector)
 	{
 		case kAudioObjectPropertyBaseClass:
+			//	The base class for kAudioBoxClassID is kAudioObjectClassID
+			FailWithAction(inDataSize < sizeof(AudioClassID), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetBoxPropertyData: not enough space for the return value of kAudioObjectPropertyBaseClass for the box");
+			*((AudioClassID*)outData) = kAudioObjectClassID;
 			*outDataSize = sizeof(AudioClassID);
 			break;
 			
 		case kAudioObjectPropertyClass:
+			//	The class is always kAudioBoxClassID for regular drivers
+			FailWithAction(inDataSize < sizeof(AudioClassID), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetBoxPropertyData: not enough space for the return value of kAudioObjectPropertyClass for the box");
+			*((AudioClassID*)outData) = kAudioBoxClassID;
 			*outDataSize = sizeof(AudioClassID);
 			break;
 			
 		case kAudioObjectPropertyOwner:
-			*outDataSize = sizeof(AudioObjectID);
-			break;
-			
-		case kAudioObjectPropertyName:
-			*outDataSize = sizeof(CFStringRef);
-			break;
-			
-		case kAudioObjectPropertyModelName:
-			*outDataSize = sizeof(CFStringRef);
-			break;
-			
-		case kAudioObjectPropertyManufacturer:
-			*outDataSize = sizeof(CFStringRef);
-			break;
-			
-		case kAudioObjectPropertyOwnedObjects:
-			*outDataSize = 0;
-			break;
-			
-		case kAudioObjectPropertyIdentify:
-			*outDataSize = sizeof(UInt32);
-			break;
-			
-		case kAudioObjectPropertySerialNumber:
-			*outDataSize = sizeof(CFStringRef);
-			break;
-			
-		case kAudioObjectPropertyFirmwareVersion:
-			*outDataSize = sizeof(CFStringRef);
-			break;
-			
-		case kAudioBoxPropertyBoxUID:
-			*outDataSize = sizeof(CFStringRef);
-			break;
-			
-		case kAudioBoxPropertyTransportType:
-			*outDataSize = sizeof(UInt32);
-			break;
-			
-		case kAudioBoxPropertyHasAudio:
-			*outDataSize = sizeof(UInt32);
-			break;
-			
-		case kAudioBoxPropertyHasVideo:
-			*outDataSize = sizeof(UInt32);
-			break;
-			
-		case kAudioBoxPropertyHasMIDI:
-			*outDataSize = sizeof(UInt32);
-			break;
-			
-		case kAudioBoxPropertyIsProtected:
-			*outDataSize = sizeof(UInt32);
-			break;
-			
-		case kAudioBoxPropertyAcquired:
-			*outDataSize = sizeof(UInt32);
-			break;
-			
-		case kAudioBoxPropertyAcquisitionFailed:
-			*outDataSize = sizeof(UInt32);
-			break;
-			
-		case kAudioBoxPropertyDeviceList:
-			{
-				pthread_mutex_lock(&gPlugIn_StateMutex);
-				*outDataSize = gBox_Acquired ? sizeof(AudioObjectID) : 0;
-				pthread_mutex_unlock(&gPlugIn_StateMutex);
-			}
-			break;
-			
-		default:
-			theAnswer = kAudioHardwareUnknownPropertyError;
-			break;
-	};
-
-Done:
-	return theAnswer;
-}
-
-static OSStatus	SyncAudio_GetBoxPropertyData(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize, const void* inQualifierData, UInt32 inDataSize, UInt32* outDataSize, void* outData)
-{
-	#pragma unused(inClientProcessID, inQualifierDataSize, inQualifierData)
-	
-	//	declare the local variables
-	OSStatus theAnswer = 0;
-	
-	//	check the arguments
-	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetBoxPropertyData: bad driver reference");
-	FailWithAction(inAddress == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetBoxPropertyData: no address");
-	FailWithAction(outDataSize == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetBoxPropertyData: no place to put the return value size");
-	FailWithAction(outData == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetBoxPropertyData: no place to put the return value");
-	FailWithAction(inObjectID != kObjectID_Box, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetBoxPropertyData: not the plug-in object");
-	
-	//	Note that for each object, this driver implements all the required properties plus a few
-	//	extras that are useful but not required.
-	//
-	//	Also, since most of the data that will get returned is static, there are few instances where
-	//	it is necessary to lock the state mutex.
-	switch(inAddress->mSelector)
-	{
-		case kAudioObjectPropertyBaseClass:
-			//	The base class for kAudioBoxClassID is kAudioObjectClassID
-			FailWithAction(inDataSize < sizeof(AudioClassID), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetBoxPropertyData: not enough space for the return value of kAudioObjectPropertyBaseClass for the box");
-			*((AudioClassID*)outData) = kAudioObjectClassID;
-			*outDataSize = sizeof(AudioClassID);
-			break;
-			
-		case kAudioObjectPropertyClass:
-			//	The class is always kAudioBoxClassID for regular drivers
-			FailWithAction(inDataSize < sizeof(AudioClassID), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetBoxPropertyData: not enough space for the return value of kAudioObjectPropertyClass for the box");
-			*((AudioClassID*)outData) = kAudioBoxClassID;
-			*outDataSize = sizeof(AudioClassID);
-			break;
-			
-		case kAudioObjectPropertyOwner:
-			//	The owner is the plug-in object
-			FailWithAction(inDataSize < sizeof(AudioObjectID), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetBoxPropertyData: not enough space for the return value of kAudioObjectPropertyOwner for the box");
-			*((AudioObjectID*)outData) = kObjectID_PlugIn;
+			//	The owner is the plug-in object
+			FailWithAction(inDataSize < sizeof(AudioObjectID), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetBoxPropertyData: not enough space for the return value of kAudioObjectPropertyOwner for the box");
+			*((AudioObjectID*)outData) = kObjectID_PlugIn;
 			*outDataSize = sizeof(AudioObjectID);
 			break;
 			
@@ -1663,19 +1813,22 @@ static OSStatus	SyncAudio_GetBoxPropertyData(AudioServerPlugInDriverRef inDriver
 			break;
 			
 		case kAudioBoxPropertyDeviceList:
-			//	This is used to indicate which devices came from this box
-			pthread_mutex_lock(&gPlugIn_StateMutex);
-			if(gBox_Acquired)
-			{
-				FailWithAction(inDataSize < sizeof(AudioObjectID), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetBoxPropertyData: not enough space for the return value of kAudioBoxPropertyDeviceList for the box");
-				*((AudioObjectID*)outData) = kObjectID_Device;
-				*outDataSize = sizeof(AudioObjectID);
-			}
-			else
+			//	This is used to indicate which devices came from this box. As with the plug-in's
+			//	device list, only as many items as there is room for are returned.
 			{
-				*outDataSize = 0;
+				pthread_mutex_lock(&gPlugIn_StateMutex);
+				UInt32 theNumberItemsToFetch = gBox_Acquired ? gPlugIn_NumberDevices : 0;
+				pthread_mutex_unlock(&gPlugIn_StateMutex);
+				if(theNumberItemsToFetch > (inDataSize / sizeof(AudioObjectID)))
+				{
+					theNumberItemsToFetch = inDataSize / sizeof(AudioObjectID);
+				}
+				for(UInt32 theItemIndex = 0; theItemIndex < theNumberItemsToFetch; ++theItemIndex)
+				{
+					((AudioObjectID*)outData)[theItemIndex] = gPlugIn_Devices[theItemIndex].mObjectID;
+				}
+				*outDataSize = theNumberItemsToFetch * sizeof(AudioObjectID);
 			}
-			pthread_mutex_unlock(&gPlugIn_StateMutex);
 			break;
 			
 		default:
@@ -1739,7 +1892,8 @@ static OSStatus	SyncAudio_SetBoxPropertyData(AudioServerPlugInDriverRef inDriver
 			//	of this property should only send the notificaiton if the hardware wants the app to
 			//	flash it's UI for the device.
 			{
-				syslog(LOG_NOTICE, "The identify property has been set on the Box implemented by the SyncAudio driver.");
+				UInt64 theHostTime = SyncAudio_GetHostTime();
+				SyncAudio_Trace(kSyncAudioTrace_Identify, kObjectID_Box, theHostTime, theHostTime, 0, 0);
 				FailWithAction(inDataSize != sizeof(UInt32), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_SetBoxPropertyData: wrong size for the data for kAudioObjectPropertyIdentify");
 				dispatch_after(dispatch_time(0, 2ULL * 1000ULL * 1000ULL * 1000ULL), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0),	^()
 																																		{
@@ -1791,59 +1945,73 @@ Done:
 
 #pragma mark Device Property Operations
 
-static Boolean	SyncAudio_HasDeviceProperty(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress)
+static OSStatus	SyncAudio_GetDevicePropertyDataSize(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize, const void* inQualifierData, UInt32* outDataSize)
 {
-	//	This method returns whether or not the given object has the given property.
+	//	This method returns the byte size of the property's data.
 	
-	#pragma unused(inClientProcessID)
+	#pragma unused(inClientProcessID, inQualifierDataSize, inQualifierData)
 	
 	//	declare the local variables
-	Boolean theAnswer = false;
+	OSStatus theAnswer = 0;
+	SyncAudioDevice* theDevice;
+	UInt32 theDeviceObject = kDeviceObject_Count;
 	
 	//	check the arguments
-	FailIf(inDriver != gAudioServerPlugInDriverRef, Done, "SyncAudio_HasDeviceProperty: bad driver reference");
-	FailIf(inAddress == NULL, Done, "SyncAudio_HasDeviceProperty: no address");
-	FailIf(inObjectID != kObjectID_Device, Done, "SyncAudio_HasDeviceProperty: not the device object");
+	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetDevicePropertyDataSize: bad driver reference");
+	FailWithAction(inAddress == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetDevicePropertyDataSize: no address");
+	FailWithAction(outDataSize == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetDevicePropertyDataSize: no place to put the return value");
+	theDevice = SyncAudio_FindDevice(inObjectID, &theDeviceObject);
+	FailWithAction((theDevice == NULL) || (theDeviceObject != kDeviceObject_Device), theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetDevicePropertyDataSize: not the device object");
 	
-	//	Note that for each object, this driver implements all the required properties plus a few
-	//	extras that are useful but not required. There is more detailed commentary about each
-	//	property in the SyncAudio_GetDevicePropertyData() method.
+	//	Only the properties whose size depends on the state or on the address get here. The
+	//	registry has the sizes of the rest. There is more detailed commentary about each property
+	//	in the SyncAudio_GetDevicePropertyData() method.
 	switch(inAddress->mSelector)
 	{
-		case kAudioObjectPropertyBaseClass:
-		case kAudioObjectPropertyClass:
-		case kAudioObjectPropertyOwner:
-		case kAudioObjectPropertyName:
-		case kAudioObjectPropertyManufacturer:
 		case kAudioObjectPropertyOwnedObjects:
-		case kAudioDevicePropertyDeviceUID:
-		case kAudioDevicePropertyModelUID:
-		case kAudioDevicePropertyTransportType:
-		case kAudioDevicePropertyRelatedDevices:
-		case kAudioDevicePropertyClockDomain:
-		case kAudioDevicePropertyDeviceIsAlive:
-		case kAudioDevicePropertyDeviceIsRunning:
-		case kAudioObjectPropertyControlList:
-		case kAudioDevicePropertyNominalSampleRate:
-		case kAudioDevicePropertyAvailableNominalSampleRates:
-		case kAudioDevicePropertyIsHidden:
-		case kAudioDevicePropertyZeroTimeStampPeriod:
-		case kAudioDevicePropertyIcon:
+			switch(inAddress->mScope)
+			{
+				case kAudioObjectPropertyScopeGlobal:
+					*outDataSize = 8 * sizeof(AudioObjectID);
+					break;
+					
+				case kAudioObjectPropertyScopeInput:
+					*outDataSize = 4 * sizeof(AudioObjectID);
+					break;
+					
+				case kAudioObjectPropertyScopeOutput:
+					*outDataSize = 4 * sizeof(AudioObjectID);
+					break;
+			};
+			break;
+
 		case kAudioDevicePropertyStreams:
-			theAnswer = true;
+			switch(inAddress->mScope)
+			{
+				case kAudioObjectPropertyScopeGlobal:
+					*outDataSize = 2 * sizeof(AudioObjectID);
+					break;
+					
+				case kAudioObjectPropertyScopeInput:
+					*outDataSize = 1 * sizeof(AudioObjectID);
+					break;
+					
+				case kAudioObjectPropertyScopeOutput:
+					*outDataSize = 1 * sizeof(AudioObjectID);
+					break;
+			};
 			break;
-			
-		case kAudioDevicePropertyDeviceCanBeDefaultDevice:
-		case kAudioDevicePropertyDeviceCanBeDefaultSystemDevice:
-		case kAudioDevicePropertyLatency:
-		case kAudioDevicePropertySafetyOffset:
-		case kAudioDevicePropertyPreferredChannelsForStereo:
+
+		case kAudioDevicePropertyAvailableNominalSampleRates:
+			*outDataSize = theDevice->mNumberSampleRates * sizeof(AudioValueRange);
+			break;
+
 		case kAudioDevicePropertyPreferredChannelLayout:
-			theAnswer = (inAddress->mScope == kAudioObjectPropertyScopeInput) || (inAddress->mScope == kAudioObjectPropertyScopeOutput);
+			*outDataSize = offsetof(AudioChannelLayout, mChannelDescriptions) + (theDevice->mChannelCount * sizeof(AudioChannelDescription));
 			break;
-		
-		case kAudioObjectPropertyElementName:
-			theAnswer = inAddress->mElement <= 2;
+
+		default:
+			theAnswer = kAudioHardwareUnknownPropertyError;
 			break;
 	};
 
@@ -1851,546 +2019,326 @@ Done:
 	return theAnswer;
 }
 
-static OSStatus	SyncAudio_IsDevicePropertySettable(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, Boolean* outIsSettable)
+static OSStatus	SyncAudio_GetDevicePropertyData(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize, const void* inQualifierData, UInt32 inDataSize, UInt32* outDataSize, void* outData)
 {
-	//	This method returns whether or not the given property on the object can have its value
-	//	changed.
-	
 	#pragma unused(inClientProcessID)
 	
 	//	declare the local variables
 	OSStatus theAnswer = 0;
+	SyncAudioDevice* theDevice;
+	UInt32 theDeviceObject = kDeviceObject_Count;
+	UInt32 theNumberItemsToFetch;
+	UInt32 theItemIndex;
 	
 	//	check the arguments
-	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_IsDevicePropertySettable: bad driver reference");
-	FailWithAction(inAddress == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_IsDevicePropertySettable: no address");
-	FailWithAction(outIsSettable == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_IsDevicePropertySettable: no place to put the return value");
-	FailWithAction(inObjectID != kObjectID_Device, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_IsDevicePropertySettable: not the device object");
+	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetDevicePropertyData: bad driver reference");
+	FailWithAction(inAddress == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetDevicePropertyData: no address");
+	FailWithAction(outDataSize == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetDevicePropertyData: no place to put the return value size");
+	FailWithAction(outData == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetDevicePropertyData: no place to put the return value");
+	theDevice = SyncAudio_FindDevice(inObjectID, &theDeviceObject);
+	FailWithAction((theDevice == NULL) || (theDeviceObject != kDeviceObject_Device), theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetDevicePropertyData: not the device object");
 	
 	//	Note that for each object, this driver implements all the required properties plus a few
-	//	extras that are useful but not required. There is more detailed commentary about each
-	//	property in the SyncAudio_GetDevicePropertyData() method.
+	//	extras that are useful but not required.
+	//
+	//	Also, since most of the data that will get returned is static, there are few instances where
+	//	it is necessary to lock the state mutex.
 	switch(inAddress->mSelector)
 	{
 		case kAudioObjectPropertyBaseClass:
+			//	The base class for kAudioDeviceClassID is kAudioObjectClassID
+			FailWithAction(inDataSize < sizeof(AudioClassID), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kAudioObjectPropertyBaseClass for the device");
+			*((AudioClassID*)outData) = kAudioObjectClassID;
+			*outDataSize = sizeof(AudioClassID);
+			break;
+			
 		case kAudioObjectPropertyClass:
+			//	The class is always kAudioDeviceClassID for devices created by drivers
+			FailWithAction(inDataSize < sizeof(AudioClassID), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kAudioObjectPropertyClass for the device");
+			*((AudioClassID*)outData) = kAudioDeviceClassID;
+			*outDataSize = sizeof(AudioClassID);
+			break;
+			
 		case kAudioObjectPropertyOwner:
+			//	The device's owner is the plug-in object
+			FailWithAction(inDataSize < sizeof(AudioObjectID), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kAudioObjectPropertyOwner for the device");
+			*((AudioObjectID*)outData) = kObjectID_PlugIn;
+			*outDataSize = sizeof(AudioObjectID);
+			break;
+			
 		case kAudioObjectPropertyName:
+			//	This is the human readable name of the device.
+			FailWithAction(inDataSize < sizeof(CFStringRef), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kAudioObjectPropertyName for the device");
+			*((CFStringRef*)outData) = theDevice->mName;
+			CFRetain(theDevice->mName);
+			*outDataSize = sizeof(CFStringRef);
+			break;
+			
 		case kAudioObjectPropertyManufacturer:
+			//	This is the human readable name of the maker of the plug-in.
+			FailWithAction(inDataSize < sizeof(CFStringRef), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kAudioObjectPropertyManufacturer for the device");
+			*((CFStringRef*)outData) = CFSTR(kManufacturer_Name);
+			*outDataSize = sizeof(CFStringRef);
+			break;
+			
 		case kAudioObjectPropertyElementName:
+			//	This is the human readable name of an element. The channels are named after their
+			//	labels in the device's channel layout, so they match kAudioDevicePropertyPreferredChannelLayout.
+			FailWithAction(inDataSize < sizeof(CFStringRef), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kAudioObjectPropertyElementName for the device");
+			FailWithAction(inAddress->mElement > theDevice->mChannelCount, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetDevicePropertyData: no such element for kAudioObjectPropertyElementName for the device");
+			if(inAddress->mElement == 0)
+			{
+				*((CFStringRef*)outData) = CFSTR("MasterElementName");
+			}
+			else
+			{
+				*((CFStringRef*)outData) = (theDevice->mChannelCount > 1) ? kDevice_ChannelNames[inAddress->mElement - 1] : CFSTR("Mono");
+			}
+			*outDataSize = sizeof(CFStringRef);
+			break;
+			
 		case kAudioObjectPropertyOwnedObjects:
-		case kAudioDevicePropertyDeviceUID:
-		case kAudioDevicePropertyModelUID:
-		case kAudioDevicePropertyTransportType:
-		case kAudioDevicePropertyRelatedDevices:
-		case kAudioDevicePropertyClockDomain:
-		case kAudioDevicePropertyDeviceIsAlive:
-		case kAudioDevicePropertyDeviceIsRunning:
-		case kAudioDevicePropertyDeviceCanBeDefaultDevice:
-		case kAudioDevicePropertyDeviceCanBeDefaultSystemDevice:
-		case kAudioDevicePropertyLatency:
-		case kAudioDevicePropertyStreams:
-		case kAudioObjectPropertyControlList:
-		case kAudioDevicePropertySafetyOffset:
-		case kAudioDevicePropertyAvailableNominalSampleRates:
-		case kAudioDevicePropertyIsHidden:
-		case kAudioDevicePropertyPreferredChannelsForStereo:
-		case kAudioDevicePropertyPreferredChannelLayout:
-		case kAudioDevicePropertyZeroTimeStampPeriod:
-		case kAudioDevicePropertyIcon:
-			*outIsSettable = false;
-			break;
-		
-		case kAudioDevicePropertyNominalSampleRate:
-			*outIsSettable = true;
-			break;
-		
-		default:
-			theAnswer = kAudioHardwareUnknownPropertyError;
-			break;
-	};
-
-Done:
-	return theAnswer;
-}
-
-static OSStatus	SyncAudio_GetDevicePropertyDataSize(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize, const void* inQualifierData, UInt32* outDataSize)
-{
-	//	This method returns the byte size of the property's data.
-	
-	#pragma unused(inClientProcessID, inQualifierDataSize, inQualifierData)
-	
-	//	declare the local variables
-	OSStatus theAnswer = 0;
-	
-	//	check the arguments
-	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetDevicePropertyDataSize: bad driver reference");
-	FailWithAction(inAddress == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetDevicePropertyDataSize: no address");
-	FailWithAction(outDataSize == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetDevicePropertyDataSize: no place to put the return value");
-	FailWithAction(inObjectID != kObjectID_Device, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetDevicePropertyDataSize: not the device object");
-	
-	//	Note that for each object, this driver implements all the required properties plus a few
-	//	extras that are useful but not required. There is more detailed commentary about each
-	//	property in the SyncAudio_GetDevicePropertyData() method.
-	switch(inAddress->mSelector)
-	{
-		case kAudioObjectPropertyBaseClass:
-			*outDataSize = sizeof(AudioClassID);
-			break;
-			
-		case kAudioObjectPropertyClass:
-			*outDataSize = sizeof(AudioClassID);
-			break;
-			
-		case kAudioObjectPropertyOwner:
-			*outDataSize = sizeof(AudioObjectID);
-			break;
-			
-		case kAudioObjectPropertyName:
-			*outDataSize = sizeof(CFStringRef);
-			break;
-			
-		case kAudioObjectPropertyManufacturer:
-			*outDataSize = sizeof(CFStringRef);
-			break;
-			
-		case kAudioObjectPropertyElementName:
-			*outDataSize = sizeof(CFStringRef);
-			break;
+			//	Calculate the number of items that have been requested. Note that this
+			//	number is allowed to be smaller than the actual size of the list. In such
+			//	case, only that number of items will be returned
+			theNumberItemsToFetch = inDataSize / sizeof(AudioObjectID);
 			
-		case kAudioObjectPropertyOwnedObjects:
+			//	The device owns its streams and controls. Note that what is returned here
+			//	depends on the scope requested.
 			switch(inAddress->mScope)
 			{
 				case kAudioObjectPropertyScopeGlobal:
-					*outDataSize = 8 * sizeof(AudioObjectID);
+					//	global scope means return all objects
+					if(theNumberItemsToFetch > 9)
+					{
+						theNumberItemsToFetch = 9;
+					}
+					
+					//	fill out the list with as many objects as requested, which is everything
+					for(theItemIndex = 0; theItemIndex < theNumberItemsToFetch; ++theItemIndex)
+					{
+						((AudioObjectID*)outData)[theItemIndex] = theDevice->mObjectID + kDeviceObject_Stream_Input + theItemIndex;
+					}
 					break;
 					
 				case kAudioObjectPropertyScopeInput:
-					*outDataSize = 4 * sizeof(AudioObjectID);
+					//	input scope means just the objects on the input side
+					if(theNumberItemsToFetch > 4)
+					{
+						theNumberItemsToFetch = 4;
+					}
+					
+					//	fill out the list with the right objects
+					for(theItemIndex = 0; theItemIndex < theNumberItemsToFetch; ++theItemIndex)
+					{
+						((AudioObjectID*)outData)[theItemIndex] = theDevice->mObjectID + kDeviceObject_Stream_Input + theItemIndex;
+					}
 					break;
 					
 				case kAudioObjectPropertyScopeOutput:
-					*outDataSize = 4 * sizeof(AudioObjectID);
+					//	output scope means just the objects on the output side
+					if(theNumberItemsToFetch > 4)
+					{
+						theNumberItemsToFetch = 4;
+					}
+					
+					//	fill out the list with the right objects
+					for(theItemIndex = 0; theItemIndex < theNumberItemsToFetch; ++theItemIndex)
+					{
+						((AudioObjectID*)outData)[theItemIndex] = theDevice->mObjectID + kDeviceObject_Stream_Output + theItemIndex;
+					}
 					break;
 			};
+			
+			//	report how much we wrote
+			*outDataSize = theNumberItemsToFetch * sizeof(AudioObjectID);
 			break;
 
 		case kAudioDevicePropertyDeviceUID:
+			//	This is a CFString that is a persistent token that can identify the same
+			//	audio device across boot sessions. Note that two instances of the same
+			//	device must have different values for this property.
+			FailWithAction(inDataSize < sizeof(CFStringRef), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kAudioDevicePropertyDeviceUID for the device");
+			*((CFStringRef*)outData) = theDevice->mUID;
+			CFRetain(theDevice->mUID);
 			*outDataSize = sizeof(CFStringRef);
 			break;
 
 		case kAudioDevicePropertyModelUID:
+			//	This is a CFString that is a persistent token that can identify audio
+			//	devices that are the same kind of device. Note that two instances of the
+			//	save device must have the same value for this property.
+			FailWithAction(inDataSize < sizeof(CFStringRef), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kAudioDevicePropertyModelUID for the device");
+			*((CFStringRef*)outData) = CFSTR(kDevice_ModelUID);
 			*outDataSize = sizeof(CFStringRef);
 			break;
 
 		case kAudioDevicePropertyTransportType:
+			//	This value represents how the device is attached to the system. This can be
+			//	any 32 bit integer, but common values for this property are defined in
+			//	<CoreAudio/AudioHardwareBase.h>
+			FailWithAction(inDataSize < sizeof(UInt32), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kAudioDevicePropertyTransportType for the device");
+			*((UInt32*)outData) = kAudioDeviceTransportTypeVirtual;
 			*outDataSize = sizeof(UInt32);
 			break;
 
 		case kAudioDevicePropertyRelatedDevices:
-			*outDataSize = sizeof(AudioObjectID);
+			//	The related devices property identifys device objects that are very closely
+			//	related. Generally, this is for relating devices that are packaged together
+			//	in the hardware such as when the input side and the output side of a piece
+			//	of hardware can be clocked separately and therefore need to be represented
+			//	as separate AudioDevice objects. In such case, both devices would report
+			//	that they are related to each other. Note that at minimum, a device is
+			//	related to itself, so this list will always be at least one item long.
+
+			//	Calculate the number of items that have been requested. Note that this
+			//	number is allowed to be smaller than the actual size of the list. In such
+			//	case, only that number of items will be returned
+			theNumberItemsToFetch = inDataSize / sizeof(AudioObjectID);
+			
+			//	we only have the one device...
+			if(theNumberItemsToFetch > 1)
+			{
+				theNumberItemsToFetch = 1;
+			}
+			
+			//	Write the devices' object IDs into the return value
+			if(theNumberItemsToFetch > 0)
+			{
+				((AudioObjectID*)outData)[0] = theDevice->mObjectID;
+			}
+			
+			//	report how much we wrote
+			*outDataSize = theNumberItemsToFetch * sizeof(AudioObjectID);
 			break;
 
 		case kAudioDevicePropertyClockDomain:
+			//	This property allows the device to declare what other devices it is
+			//	synchronized with in hardware. The way it works is that if two devices have
+			//	the same value for this property and the value is not zero, then the two
+			//	devices are synchronized in hardware. Note that a device that either can't
+			//	be synchronized with others or doesn't know should return 0 for this
+			//	property.
+			FailWithAction(inDataSize < sizeof(UInt32), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kAudioDevicePropertyClockDomain for the device");
+			*((UInt32*)outData) = 0;
 			*outDataSize = sizeof(UInt32);
 			break;
 
 		case kAudioDevicePropertyDeviceIsAlive:
-			*outDataSize = sizeof(AudioClassID);
+			//	This property returns whether or not the device is alive. Note that it is
+			//	note uncommon for a device to be dead but still momentarily availble in the
+			//	device list. In the case of this device, it will always be alive.
+			FailWithAction(inDataSize < sizeof(UInt32), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kAudioDevicePropertyDeviceIsAlive for the device");
+			*((UInt32*)outData) = 1;
+			*outDataSize = sizeof(UInt32);
 			break;
 
 		case kAudioDevicePropertyDeviceIsRunning:
+			//	This property returns whether or not IO is running for the device. Note that
+			//	we need to take both the state lock to check this value for thread safety.
+			FailWithAction(inDataSize < sizeof(UInt32), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kAudioDevicePropertyDeviceIsRunning for the device");
+			pthread_mutex_lock(&gPlugIn_StateMutex);
+			*((UInt32*)outData) = ((theDevice->mIOIsRunning > 0) > 0) ? 1 : 0;
+			pthread_mutex_unlock(&gPlugIn_StateMutex);
 			*outDataSize = sizeof(UInt32);
 			break;
 
 		case kAudioDevicePropertyDeviceCanBeDefaultDevice:
+			//	This property returns whether or not the device wants to be able to be the
+			//	default device for content. This is the device that iTunes and QuickTime
+			//	will use to play their content on and FaceTime will use as it's microhphone.
+			//	Nearly all devices should allow for this.
+			FailWithAction(inDataSize < sizeof(UInt32), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kAudioDevicePropertyDeviceCanBeDefaultDevice for the device");
+			*((UInt32*)outData) = 1;
 			*outDataSize = sizeof(UInt32);
 			break;
 
 		case kAudioDevicePropertyDeviceCanBeDefaultSystemDevice:
+			//	This property returns whether or not the device wants to be the system
+			//	default device. This is the device that is used to play interface sounds and
+			//	other incidental or UI-related sounds on. Most devices should allow this
+			//	although devices with lots of latency may not want to.
+			FailWithAction(inDataSize < sizeof(UInt32), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kAudioDevicePropertyDeviceCanBeDefaultSystemDevice for the device");
+			*((UInt32*)outData) = 1;
 			*outDataSize = sizeof(UInt32);
 			break;
 
 		case kAudioDevicePropertyLatency:
+			//	This property returns the presentation latency of the device. The output side
+			//	has none. The input side is read through the delay line, so its latency is the
+			//	delay depth rounded up to the next whole frame, plus the margin the engine keeps
+			//	for a late writer. The margin is the engine's own and isn't reported as the
+			//	safety offset, which would have the HAL move the input time back by it again.
+			FailWithAction(inDataSize < sizeof(UInt32), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kAudioDevicePropertyLatency for the device");
+			if(inAddress->mScope == kAudioObjectPropertyScopeInput)
+			{
+				*((UInt32*)outData) = SyncAudioEngine_GetInputLatency(&theDevice->mEngine);
+			}
+			else
+			{
+				*((UInt32*)outData) = 0;
+			}
 			*outDataSize = sizeof(UInt32);
 			break;
 
 		case kAudioDevicePropertyStreams:
+			//	Calculate the number of items that have been requested. Note that this
+			//	number is allowed to be smaller than the actual size of the list. In such
+			//	case, only that number of items will be returned
+			theNumberItemsToFetch = inDataSize / sizeof(AudioObjectID);
+			
+			//	Note that what is returned here depends on the scope requested.
 			switch(inAddress->mScope)
 			{
 				case kAudioObjectPropertyScopeGlobal:
-					*outDataSize = 2 * sizeof(AudioObjectID);
+					//	global scope means return all streams
+					if(theNumberItemsToFetch > 2)
+					{
+						theNumberItemsToFetch = 2;
+					}
+					
+					//	fill out the list with as many objects as requested
+					if(theNumberItemsToFetch > 0)
+					{
+						((AudioObjectID*)outData)[0] = (theDevice->mObjectID + kDeviceObject_Stream_Input);
+					}
+					if(theNumberItemsToFetch > 1)
+					{
+						((AudioObjectID*)outData)[1] = (theDevice->mObjectID + kDeviceObject_Stream_Output);
+					}
 					break;
 					
 				case kAudioObjectPropertyScopeInput:
-					*outDataSize = 1 * sizeof(AudioObjectID);
+					//	input scope means just the objects on the input side
+					if(theNumberItemsToFetch > 1)
+					{
+						theNumberItemsToFetch = 1;
+					}
+					
+					//	fill out the list with as many objects as requested
+					if(theNumberItemsToFetch > 0)
+					{
+						((AudioObjectID*)outData)[0] = (theDevice->mObjectID + kDeviceObject_Stream_Input);
+					}
 					break;
 					
 				case kAudioObjectPropertyScopeOutput:
-					*outDataSize = 1 * sizeof(AudioObjectID);
+					//	output scope means just the objects on the output side
+					if(theNumberItemsToFetch > 1)
+					{
+						theNumberItemsToFetch = 1;
+					}
+					
+					//	fill out the list with as many objects as requested
+					if(theNumberItemsToFetch > 0)
+					{
+						((AudioObjectID*)outData)[0] = (theDevice->mObjectID + kDeviceObject_Stream_Output);
+					}
 					break;
 			};
-			break;
-
-		case kAudioObjectPropertyControlList:
-			*outDataSize = 7 * sizeof(AudioObjectID);
-			break;
-
-		case kAudioDevicePropertySafetyOffset:
-			*outDataSize = sizeof(UInt32);
-			break;
-
-		case kAudioDevicePropertyNominalSampleRate:
-			*outDataSize = sizeof(Float64);
-			break;
-
-		case kAudioDevicePropertyAvailableNominalSampleRates:
-			*outDataSize = 2 * sizeof(AudioValueRange);
-			break;
-		
-		case kAudioDevicePropertyIsHidden:
-			*outDataSize = sizeof(UInt32);
-			break;
-
-		case kAudioDevicePropertyPreferredChannelsForStereo:
-			*outDataSize = 2 * sizeof(UInt32);
-			break;
-
-		case kAudioDevicePropertyPreferredChannelLayout:
-			*outDataSize = offsetof(AudioChannelLayout, mChannelDescriptions) + (2 * sizeof(AudioChannelDescription));
-			break;
-
-		case kAudioDevicePropertyZeroTimeStampPeriod:
-			*outDataSize = sizeof(UInt32);
-			break;
-
-		case kAudioDevicePropertyIcon:
-			*outDataSize = sizeof(CFURLRef);
-			break;
-
-		default:
-			theAnswer = kAudioHardwareUnknownPropertyError;
-			break;
-	};
-
-Done:
-	return theAnswer;
-}
-
-static OSStatus	SyncAudio_GetDevicePropertyData(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize, const void* inQualifierData, UInt32 inDataSize, UInt32* outDataSize, void* outData)
-{
-	#pragma unused(inClientProcessID, inQualifierDataSize, inQualifierData)
-	
-	//	declare the local variables
-	OSStatus theAnswer = 0;
-	UInt32 theNumberItemsToFetch;
-	UInt32 theItemIndex;
-	
-	//	check the arguments
-	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetDevicePropertyData: bad driver reference");
-	FailWithAction(inAddress == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetDevicePropertyData: no address");
-	FailWithAction(outDataSize == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetDevicePropertyData: no place to put the return value size");
-	FailWithAction(outData == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetDevicePropertyData: no place to put the return value");
-	FailWithAction(inObjectID != kObjectID_Device, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetDevicePropertyData: not the device object");
-	
-	//	Note that for each object, this driver implements all the required properties plus a few
-	//	extras that are useful but not required.
-	//
-	//	Also, since most of the data that will get returned is static, there are few instances where
-	//	it is necessary to lock the state mutex.
-	switch(inAddress->mSelector)
-	{
-		case kAudioObjectPropertyBaseClass:
-			//	The base class for kAudioDeviceClassID is kAudioObjectClassID
-			FailWithAction(inDataSize < sizeof(AudioClassID), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kAudioObjectPropertyBaseClass for the device");
-			*((AudioClassID*)outData) = kAudioObjectClassID;
-			*outDataSize = sizeof(AudioClassID);
-			break;
-			
-		case kAudioObjectPropertyClass:
-			//	The class is always kAudioDeviceClassID for devices created by drivers
-			FailWithAction(inDataSize < sizeof(AudioClassID), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kAudioObjectPropertyClass for the device");
-			*((AudioClassID*)outData) = kAudioDeviceClassID;
-			*outDataSize = sizeof(AudioClassID);
-			break;
-			
-		case kAudioObjectPropertyOwner:
-			//	The device's owner is the plug-in object
-			FailWithAction(inDataSize < sizeof(AudioObjectID), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kAudioObjectPropertyOwner for the device");
-			*((AudioObjectID*)outData) = kObjectID_PlugIn;
-			*outDataSize = sizeof(AudioObjectID);
-			break;
-			
-		case kAudioObjectPropertyName:
-			//	This is the human readable name of the device.
-			FailWithAction(inDataSize < sizeof(CFStringRef), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kAudioObjectPropertyName for the device");
-			*((CFStringRef*)outData) = CFSTR(kDevice_Name);
-			*outDataSize = sizeof(CFStringRef);
-			break;
-			
-		case kAudioObjectPropertyManufacturer:
-			//	This is the human readable name of the maker of the plug-in.
-			FailWithAction(inDataSize < sizeof(CFStringRef), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kAudioObjectPropertyManufacturer for the device");
-			*((CFStringRef*)outData) = CFSTR(kManufacturer_Name);
-			*outDataSize = sizeof(CFStringRef);
-			break;
-			
-		case kAudioObjectPropertyElementName:
-			//	This is the human readable name of the maker of the plug-in.
-			FailWithAction(inDataSize < sizeof(CFStringRef), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kAudioObjectPropertyElementName for the device");
-			switch(inAddress->mElement)
-			{
-				case 0:
-					*((CFStringRef*)outData) = CFSTR("MasterElementName");
-					break;
-				
-				case 1:
-					*((CFStringRef*)outData) = CFSTR("LeftChannel");
-					break;
-				
-				case 2:
-					*((CFStringRef*)outData) = CFSTR("RightChannel");
-					break;
-				
-				default:
-					*((CFStringRef*)outData) = CFSTR("unknown");
-					break;
-				
-			};
-			*outDataSize = sizeof(CFStringRef);
-			break;
-			
-		case kAudioObjectPropertyOwnedObjects:
-			//	Calculate the number of items that have been requested. Note that this
-			//	number is allowed to be smaller than the actual size of the list. In such
-			//	case, only that number of items will be returned
-			theNumberItemsToFetch = inDataSize / sizeof(AudioObjectID);
-			
-			//	The device owns its streams and controls. Note that what is returned here
-			//	depends on the scope requested.
-			switch(inAddress->mScope)
-			{
-				case kAudioObjectPropertyScopeGlobal:
-					//	global scope means return all objects
-					if(theNumberItemsToFetch > 9)
-					{
-						theNumberItemsToFetch = 9;
-					}
-					
-					//	fill out the list with as many objects as requested, which is everything
-					for(theItemIndex = 0; theItemIndex < theNumberItemsToFetch; ++theItemIndex)
-					{
-						((AudioObjectID*)outData)[theItemIndex] = kObjectID_Stream_Input + theItemIndex;
-					}
-					break;
-					
-				case kAudioObjectPropertyScopeInput:
-					//	input scope means just the objects on the input side
-					if(theNumberItemsToFetch > 4)
-					{
-						theNumberItemsToFetch = 4;
-					}
-					
-					//	fill out the list with the right objects
-					for(theItemIndex = 0; theItemIndex < theNumberItemsToFetch; ++theItemIndex)
-					{
-						((AudioObjectID*)outData)[theItemIndex] = kObjectID_Stream_Input + theItemIndex;
-					}
-					break;
-					
-				case kAudioObjectPropertyScopeOutput:
-					//	output scope means just the objects on the output side
-					if(theNumberItemsToFetch > 4)
-					{
-						theNumberItemsToFetch = 4;
-					}
-					
-					//	fill out the list with the right objects
-					for(theItemIndex = 0; theItemIndex < theNumberItemsToFetch; ++theItemIndex)
-					{
-						((AudioObjectID*)outData)[theItemIndex] = kObjectID_Stream_Output + theItemIndex;
-					}
-					break;
-			};
-			
-			//	report how much we wrote
-			*outDataSize = theNumberItemsToFetch * sizeof(AudioObjectID);
-			break;
-
-		case kAudioDevicePropertyDeviceUID:
-			//	This is a CFString that is a persistent token that can identify the same
-			//	audio device across boot sessions. Note that two instances of the same
-			//	device must have different values for this property.
-			FailWithAction(inDataSize < sizeof(CFStringRef), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kAudioDevicePropertyDeviceUID for the device");
-			*((CFStringRef*)outData) = CFSTR(kDevice_UID);
-			*outDataSize = sizeof(CFStringRef);
-			break;
-
-		case kAudioDevicePropertyModelUID:
-			//	This is a CFString that is a persistent token that can identify audio
-			//	devices that are the same kind of device. Note that two instances of the
-			//	save device must have the same value for this property.
-			FailWithAction(inDataSize < sizeof(CFStringRef), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kAudioDevicePropertyModelUID for the device");
-			*((CFStringRef*)outData) = CFSTR(kDevice_ModelUID);
-			*outDataSize = sizeof(CFStringRef);
-			break;
-
-		case kAudioDevicePropertyTransportType:
-			//	This value represents how the device is attached to the system. This can be
-			//	any 32 bit integer, but common values for this property are defined in
-			//	<CoreAudio/AudioHardwareBase.h>
-			FailWithAction(inDataSize < sizeof(UInt32), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kAudioDevicePropertyTransportType for the device");
-			*((UInt32*)outData) = kAudioDeviceTransportTypeVirtual;
-			*outDataSize = sizeof(UInt32);
-			break;
-
-		case kAudioDevicePropertyRelatedDevices:
-			//	The related devices property identifys device objects that are very closely
-			//	related. Generally, this is for relating devices that are packaged together
-			//	in the hardware such as when the input side and the output side of a piece
-			//	of hardware can be clocked separately and therefore need to be represented
-			//	as separate AudioDevice objects. In such case, both devices would report
-			//	that they are related to each other. Note that at minimum, a device is
-			//	related to itself, so this list will always be at least one item long.
-
-			//	Calculate the number of items that have been requested. Note that this
-			//	number is allowed to be smaller than the actual size of the list. In such
-			//	case, only that number of items will be returned
-			theNumberItemsToFetch = inDataSize / sizeof(AudioObjectID);
-			
-			//	we only have the one device...
-			if(theNumberItemsToFetch > 1)
-			{
-				theNumberItemsToFetch = 1;
-			}
-			
-			//	Write the devices' object IDs into the return value
-			if(theNumberItemsToFetch > 0)
-			{
-				((AudioObjectID*)outData)[0] = kObjectID_Device;
-			}
-			
-			//	report how much we wrote
-			*outDataSize = theNumberItemsToFetch * sizeof(AudioObjectID);
-			break;
-
-		case kAudioDevicePropertyClockDomain:
-			//	This property allows the device to declare what other devices it is
-			//	synchronized with in hardware. The way it works is that if two devices have
-			//	the same value for this property and the value is not zero, then the two
-			//	devices are synchronized in hardware. Note that a device that either can't
-			//	be synchronized with others or doesn't know should return 0 for this
-			//	property.
-			FailWithAction(inDataSize < sizeof(UInt32), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kAudioDevicePropertyClockDomain for the device");
-			*((UInt32*)outData) = 0;
-			*outDataSize = sizeof(UInt32);
-			break;
-
-		case kAudioDevicePropertyDeviceIsAlive:
-			//	This property returns whether or not the device is alive. Note that it is
-			//	note uncommon for a device to be dead but still momentarily availble in the
-			//	device list. In the case of this device, it will always be alive.
-			FailWithAction(inDataSize < sizeof(UInt32), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kAudioDevicePropertyDeviceIsAlive for the device");
-			*((UInt32*)outData) = 1;
-			*outDataSize = sizeof(UInt32);
-			break;
-
-		case kAudioDevicePropertyDeviceIsRunning:
-			//	This property returns whether or not IO is running for the device. Note that
-			//	we need to take both the state lock to check this value for thread safety.
-			FailWithAction(inDataSize < sizeof(UInt32), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kAudioDevicePropertyDeviceIsRunning for the device");
-			pthread_mutex_lock(&gPlugIn_StateMutex);
-			*((UInt32*)outData) = ((gDevice_IOIsRunning > 0) > 0) ? 1 : 0;
-			pthread_mutex_unlock(&gPlugIn_StateMutex);
-			*outDataSize = sizeof(UInt32);
-			break;
-
-		case kAudioDevicePropertyDeviceCanBeDefaultDevice:
-			//	This property returns whether or not the device wants to be able to be the
-			//	default device for content. This is the device that iTunes and QuickTime
-			//	will use to play their content on and FaceTime will use as it's microhphone.
-			//	Nearly all devices should allow for this.
-			FailWithAction(inDataSize < sizeof(UInt32), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kAudioDevicePropertyDeviceCanBeDefaultDevice for the device");
-			*((UInt32*)outData) = 1;
-			*outDataSize = sizeof(UInt32);
-			break;
-
-		case kAudioDevicePropertyDeviceCanBeDefaultSystemDevice:
-			//	This property returns whether or not the device wants to be the system
-			//	default device. This is the device that is used to play interface sounds and
-			//	other incidental or UI-related sounds on. Most devices should allow this
-			//	although devices with lots of latency may not want to.
-			FailWithAction(inDataSize < sizeof(UInt32), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kAudioDevicePropertyDeviceCanBeDefaultSystemDevice for the device");
-			*((UInt32*)outData) = 1;
-			*outDataSize = sizeof(UInt32);
-			break;
-
-		case kAudioDevicePropertyLatency:
-			//	This property returns the presentation latency of the device. For this,
-			//--	device, the value is 0 due to the fact that it always vends silence.
-			FailWithAction(inDataSize < sizeof(UInt32), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kAudioDevicePropertyLatency for the device");
-			*((UInt32*)outData) = 0;
-			*outDataSize = sizeof(UInt32);
-			break;
-
-		case kAudioDevicePropertyStreams:
-			//	Calculate the number of items that have been requested. Note that this
-			//	number is allowed to be smaller than the actual size of the list. In such
-			//	case, only that number of items will be returned
-			theNumberItemsToFetch = inDataSize / sizeof(AudioObjectID);
-			
-			//	Note that what is returned here depends on the scope requested.
-			switch(inAddress->mScope)
-			{
-				case kAudioObjectPropertyScopeGlobal:
-					//	global scope means return all streams
-					if(theNumberItemsToFetch > 2)
-					{
-						theNumberItemsToFetch = 2;
-					}
-					
-					//	fill out the list with as many objects as requested
-					if(theNumberItemsToFetch > 0)
-					{
-						((AudioObjectID*)outData)[0] = kObjectID_Stream_Input;
-					}
-					if(theNumberItemsToFetch > 1)
-					{
-						((AudioObjectID*)outData)[1] = kObjectID_Stream_Output;
-					}
-					break;
-					
-				case kAudioObjectPropertyScopeInput:
-					//	input scope means just the objects on the input side
-					if(theNumberItemsToFetch > 1)
-					{
-						theNumberItemsToFetch = 1;
-					}
-					
-					//	fill out the list with as many objects as requested
-					if(theNumberItemsToFetch > 0)
-					{
-						((AudioObjectID*)outData)[0] = kObjectID_Stream_Input;
-					}
-					break;
-					
-				case kAudioObjectPropertyScopeOutput:
-					//	output scope means just the objects on the output side
-					if(theNumberItemsToFetch > 1)
-					{
-						theNumberItemsToFetch = 1;
-					}
-					
-					//	fill out the list with as many objects as requested
-					if(theNumberItemsToFetch > 0)
-					{
-						((AudioObjectID*)outData)[0] = kObjectID_Stream_Output;
-					}
-					break;
-			};
-			
-			//	report how much we wrote
-			*outDataSize = theNumberItemsToFetch * sizeof(AudioObjectID);
+			
+			//	report how much we wrote
+			*outDataSize = theNumberItemsToFetch * sizeof(AudioObjectID);
 			break;
 
 		case kAudioObjectPropertyControlList:
@@ -2408,11 +2356,11 @@ static OSStatus	SyncAudio_GetDevicePropertyData(AudioServerPlugInDriverRef inDri
 			{
 				if(theItemIndex < 3)
 				{
-					((AudioObjectID*)outData)[theItemIndex] = kObjectID_Volume_Input_Master + theItemIndex;
+					((AudioObjectID*)outData)[theItemIndex] = theDevice->mObjectID + kDeviceObject_Volume_Input_Master + theItemIndex;
 				}
 				else
 				{
-					((AudioObjectID*)outData)[theItemIndex] = kObjectID_Volume_Output_Master + (theItemIndex - 3);
+					((AudioObjectID*)outData)[theItemIndex] = theDevice->mObjectID + kDeviceObject_Volume_Output_Master + (theItemIndex - 3);
 				}
 			}
 			
@@ -2421,20 +2369,23 @@ static OSStatus	SyncAudio_GetDevicePropertyData(AudioServerPlugInDriverRef inDri
 			break;
 
 		case kAudioDevicePropertySafetyOffset:
-			//	This property returns the how close to now the HAL can read and write. For
-			//--	this, device, the value is 0 due to the fact that it always vends silence.
+			//	This property returns how close to now the HAL can read and write. The device's
+			//	audio only ever moves through memory, so there is no hardware to stay ahead of and
+			//	this is 0. The margin the engine keeps for a late writer is reported as part of
+			//	kAudioDevicePropertyLatency instead. The HAL moves the input time back by the
+			//	safety offset before ReadInput, and ReadInput already reads behind it by the
+			//	margin, so reporting the margin here too would count it twice. It also changes
+			//	while IO runs, and the latency is the property the device notifies about then.
 			FailWithAction(inDataSize < sizeof(UInt32), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kAudioDevicePropertySafetyOffset for the device");
 			*((UInt32*)outData) = 0;
 			*outDataSize = sizeof(UInt32);
 			break;
 
 		case kAudioDevicePropertyNominalSampleRate:
-			//	This property returns the nominal sample rate of the device. Note that we
-			//	only need to take the state lock to get this value.
+			//	This property returns the nominal sample rate of the device, which is read
+			//	from the published state without taking the state lock.
 			FailWithAction(inDataSize < sizeof(Float64), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kAudioDevicePropertyNominalSampleRate for the device");
-			pthread_mutex_lock(&gPlugIn_StateMutex);
-			*((Float64*)outData) = gDevice_SampleRate;
-			pthread_mutex_unlock(&gPlugIn_StateMutex);
+			*((Float64*)outData) = SyncAudio_GetDeviceState(theDevice).mSampleRate;
 			*outDataSize = sizeof(Float64);
 			break;
 
@@ -2449,21 +2400,16 @@ static OSStatus	SyncAudio_GetDevicePropertyData(AudioServerPlugInDriverRef inDri
 			theNumberItemsToFetch = inDataSize / sizeof(AudioValueRange);
 			
 			//	clamp it to the number of items we have
-			if(theNumberItemsToFetch > 2)
+			if(theNumberItemsToFetch > theDevice->mNumberSampleRates)
 			{
-				theNumberItemsToFetch = 2;
+				theNumberItemsToFetch = theDevice->mNumberSampleRates;
 			}
 			
 			//	fill out the return array
-			if(theNumberItemsToFetch > 0)
-			{
-				((AudioValueRange*)outData)[0].mMinimum = 44100.0;
-				((AudioValueRange*)outData)[0].mMaximum = 44100.0;
-			}
-			if(theNumberItemsToFetch > 1)
+			for(theItemIndex = 0; theItemIndex < theNumberItemsToFetch; ++theItemIndex)
 			{
-				((AudioValueRange*)outData)[1].mMinimum = 48000.0;
-				((AudioValueRange*)outData)[1].mMaximum = 48000.0;
+				((AudioValueRange*)outData)[theItemIndex].mMinimum = kDevice_SampleRates[theItemIndex];
+				((AudioValueRange*)outData)[theItemIndex].mMaximum = kDevice_SampleRates[theItemIndex];
 			}
 			
 			//	report how much we wrote
@@ -2479,26 +2425,28 @@ static OSStatus	SyncAudio_GetDevicePropertyData(AudioServerPlugInDriverRef inDri
 
 		case kAudioDevicePropertyPreferredChannelsForStereo:
 			//	This property returns which two channesl to use as left/right for stereo
-			//	data by default. Note that the channel numbers are 1-based.xz
+			//	data by default. Note that the channel numbers are 1-based. A mono device
+			//	plays both sides on its only channel.
 			FailWithAction(inDataSize < (2 * sizeof(UInt32)), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kAudioDevicePropertyPreferredChannelsForStereo for the device");
 			((UInt32*)outData)[0] = 1;
-			((UInt32*)outData)[1] = 2;
+			((UInt32*)outData)[1] = (theDevice->mChannelCount > 1) ? 2 : 1;
 			*outDataSize = 2 * sizeof(UInt32);
 			break;
 
 		case kAudioDevicePropertyPreferredChannelLayout:
 			//	This property returns the default AudioChannelLayout to use for the device
-			//	by default. For this device, we return a stereo ACL.
+			//	by default. For this device, we return a mono, stereo, 5.1 or 7.1 ACL
+			//	depending on its number of channels.
 			{
 				//	calcualte how big the
-				UInt32 theACLSize = offsetof(AudioChannelLayout, mChannelDescriptions) + (2 * sizeof(AudioChannelDescription));
+				UInt32 theACLSize = offsetof(AudioChannelLayout, mChannelDescriptions) + (theDevice->mChannelCount * sizeof(AudioChannelDescription));
 				FailWithAction(inDataSize < theACLSize, theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kAudioDevicePropertyPreferredChannelLayout for the device");
 				((AudioChannelLayout*)outData)->mChannelLayoutTag = kAudioChannelLayoutTag_UseChannelDescriptions;
 				((AudioChannelLayout*)outData)->mChannelBitmap = 0;
-				((AudioChannelLayout*)outData)->mNumberChannelDescriptions = 2;
-				for(theItemIndex = 0; theItemIndex < 2; ++theItemIndex)
+				((AudioChannelLayout*)outData)->mNumberChannelDescriptions = theDevice->mChannelCount;
+				for(theItemIndex = 0; theItemIndex < theDevice->mChannelCount; ++theItemIndex)
 				{
-					((AudioChannelLayout*)outData)->mChannelDescriptions[theItemIndex].mChannelLabel = kAudioChannelLabel_Left + theItemIndex;
+					((AudioChannelLayout*)outData)->mChannelDescriptions[theItemIndex].mChannelLabel = (theDevice->mChannelCount > 1) ? kDevice_ChannelLabels[theItemIndex] : kAudioChannelLabel_Mono;
 					((AudioChannelLayout*)outData)->mChannelDescriptions[theItemIndex].mChannelFlags = 0;
 					((AudioChannelLayout*)outData)->mChannelDescriptions[theItemIndex].mCoordinates[0] = 0;
 					((AudioChannelLayout*)outData)->mChannelDescriptions[theItemIndex].mCoordinates[1] = 0;
@@ -2507,12 +2455,12 @@ static OSStatus	SyncAudio_GetDevicePropertyData(AudioServerPlugInDriverRef inDri
 				*outDataSize = theACLSize;
 			}
 			break;
-        //++ need redesign
 		case kAudioDevicePropertyZeroTimeStampPeriod:
 			//	This property returns how many frames the HAL should expect to see between
-			//	successive sample times in the zero time stamps this device provides.
+			//	successive sample times in the zero time stamps this device provides. It is
+			//	independent of the size of the loopback ring.
 			FailWithAction(inDataSize < sizeof(UInt32), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kAudioDevicePropertyZeroTimeStampPeriod for the device");
-			*((UInt32*)outData) = kDevice_RingBufferSize;
+			*((UInt32*)outData) = kDevice_ZeroTimeStampPeriod;
 			*outDataSize = sizeof(UInt32);
 			break;
         //++ change the "DeviceIcon.icns"
@@ -2528,6 +2476,128 @@ static OSStatus	SyncAudio_GetDevicePropertyData(AudioServerPlugInDriverRef inDri
 				*outDataSize = sizeof(CFURLRef);
 			}
 			break;
+
+		case kAudioObjectPropertyCustomPropertyInfoList:
+			//	The device has five custom properties. The first is the delay line depth, whose
+			//	data is a CFNumber holding the delay in milliseconds. The second is the read only
+			//	memory status of the ring. The third is the dictionary of client routes. The last
+			//	two are the output volume and mute of a process's clients, which take the process
+			//	ID as their qualifier.
+			{
+				AudioServerPlugInCustomPropertyInfo theInfo[5] =
+				{
+					{ kDevice_DelayPropertyID, kAudioServerPlugInCustomPropertyDataTypeCFPropertyList, kAudioServerPlugInCustomPropertyDataTypeNone },
+					{ kDevice_MemoryStatusPropertyID, kAudioServerPlugInCustomPropertyDataTypeCFPropertyList, kAudioServerPlugInCustomPropertyDataTypeNone },
+					{ kDevice_ClientRoutesPropertyID, kAudioServerPlugInCustomPropertyDataTypeCFPropertyList, kAudioServerPlugInCustomPropertyDataTypeNone },
+					{ kDevice_ClientVolumePropertyID, kAudioServerPlugInCustomPropertyDataTypeCFPropertyList, kAudioServerPlugInCustomPropertyDataTypeCFPropertyList },
+					{ kDevice_ClientMutePropertyID, kAudioServerPlugInCustomPropertyDataTypeCFPropertyList, kAudioServerPlugInCustomPropertyDataTypeCFPropertyList }
+				};
+				theNumberItemsToFetch = inDataSize / sizeof(AudioServerPlugInCustomPropertyInfo);
+				if(theNumberItemsToFetch > 5)
+				{
+					theNumberItemsToFetch = 5;
+				}
+				memcpy(outData, theInfo, theNumberItemsToFetch * sizeof(AudioServerPlugInCustomPropertyInfo));
+				*outDataSize = theNumberItemsToFetch * sizeof(AudioServerPlugInCustomPropertyInfo);
+			}
+			break;
+
+		case kDevice_DelayPropertyID:
+			//	This returns the delay line depth in milliseconds as a CFNumber. Note that we
+			//	need to take the state lock to examine the value.
+			{
+				FailWithAction(inDataSize < sizeof(CFPropertyListRef), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kDevice_DelayPropertyID for the device");
+				pthread_mutex_lock(&gPlugIn_StateMutex);
+				Float64 theDelayMilliseconds = SyncAudioEngine_GetDelayMilliseconds(&theDevice->mEngine);
+				pthread_mutex_unlock(&gPlugIn_StateMutex);
+				*((CFPropertyListRef*)outData) = CFNumberCreate(NULL, kCFNumberFloat64Type, &theDelayMilliseconds);
+				*outDataSize = sizeof(CFPropertyListRef);
+			}
+			break;
+			
+		case kDevice_MemoryStatusPropertyID:
+			//	This returns a CFDictionary describing the ring's storage along with the number
+			//	of IO operations since IO last started and the page faults counted during them.
+			//	"ring bytes" is the main ring and "wired bytes" adds every bus's ring to it, all
+			//	of them sized for "max sample rate".
+			{
+				FailWithAction(inDataSize < sizeof(CFPropertyListRef), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kDevice_MemoryStatusPropertyID for the device");
+				SInt64 theRingBytes = (SInt64)theDevice->mEngine.mRing.mBufferByteSize;
+				SInt64 theWiredBytes = (SInt64)SyncAudioEngine_GetRingByteSize(&theDevice->mEngine);
+				SInt64 theIOOperations = (SInt64)atomic_load_explicit(&theDevice->mIOOperations, memory_order_relaxed);
+				SInt64 theIOPageFaults = (SInt64)atomic_load_explicit(&theDevice->mIOPageFaults, memory_order_relaxed);
+				CFMutableDictionaryRef theStatus = CFDictionaryCreateMutable(NULL, 7, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks);
+				CFNumberRef theNumber = CFNumberCreate(NULL, kCFNumberSInt64Type, &theRingBytes);
+				CFDictionarySetValue(theStatus, CFSTR("ring bytes"), theNumber);
+				CFRelease(theNumber);
+				theNumber = CFNumberCreate(NULL, kCFNumberSInt64Type, &theWiredBytes);
+				CFDictionarySetValue(theStatus, CFSTR("wired bytes"), theNumber);
+				CFRelease(theNumber);
+				theNumber = CFNumberCreate(NULL, kCFNumberFloat64Type, &theDevice->mMaxSampleRate);
+				CFDictionarySetValue(theStatus, CFSTR("max sample rate"), theNumber);
+				CFRelease(theNumber);
+				CFDictionarySetValue(theStatus, CFSTR("ring locked"), theDevice->mEngine.mRing.mBufferIsLocked ? kCFBooleanTrue : kCFBooleanFalse);
+				CFDictionarySetValue(theStatus, CFSTR("page faults counted"), SyncAudio_CountIOPageFaults ? kCFBooleanTrue : kCFBooleanFalse);
+				theNumber = CFNumberCreate(NULL, kCFNumberSInt64Type, &theIOOperations);
+				CFDictionarySetValue(theStatus, CFSTR("io operations"), theNumber);
+				CFRelease(theNumber);
+				theNumber = CFNumberCreate(NULL, kCFNumberSInt64Type, &theIOPageFaults);
+				CFDictionarySetValue(theStatus, CFSTR("io page faults"), theNumber);
+				CFRelease(theNumber);
+				*((CFPropertyListRef*)outData) = theStatus;
+				*outDataSize = sizeof(CFPropertyListRef);
+			}
+			break;
+			
+		case kDevice_ClientRoutesPropertyID:
+			//	This returns the client routes as a CFDictionary, which is empty if there aren't
+			//	any. Note that we need to take the state lock to examine the value.
+			{
+				FailWithAction(inDataSize < sizeof(CFPropertyListRef), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of kDevice_ClientRoutesPropertyID for the device");
+				pthread_mutex_lock(&gPlugIn_StateMutex);
+				if(theDevice->mClientRoutes != NULL)
+				{
+					*((CFPropertyListRef*)outData) = CFRetain(theDevice->mClientRoutes);
+				}
+				else
+				{
+					*((CFPropertyListRef*)outData) = CFDictionaryCreateMutable(NULL, 0, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks);
+				}
+				pthread_mutex_unlock(&gPlugIn_StateMutex);
+				*outDataSize = sizeof(CFPropertyListRef);
+			}
+			break;
+			
+		case kDevice_ClientVolumePropertyID:
+		case kDevice_ClientMutePropertyID:
+			//	This returns the output volume as a CFNumber or the mute as a CFBoolean of the
+			//	clients of the process in the qualifier. A process without any clients is at full
+			//	volume and not muted. Note that we need to take the state lock to examine the value.
+			{
+				FailWithAction(inDataSize < sizeof(CFPropertyListRef), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: not enough space for the return value of the client level for the device");
+				SInt32 theProcessID;
+				FailWithAction(!SyncAudio_GetQualifierProcessID(inQualifierDataSize, inQualifierData, &theProcessID), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetDevicePropertyData: the qualifier of the client level is not a process ID");
+				Float32 theVolume = 1.0f;
+				Boolean theMute = false;
+				pthread_mutex_lock(&gPlugIn_StateMutex);
+				SyncAudioRoute* theRoute = SyncAudioRouteTable_FindProcess(&theDevice->mRoutes, theProcessID);
+				if(theRoute != NULL)
+				{
+					theVolume = theRoute->mOutputVolume;
+					theMute = theRoute->mOutputMute;
+				}
+				pthread_mutex_unlock(&gPlugIn_StateMutex);
+				if(inAddress->mSelector == kDevice_ClientVolumePropertyID)
+				{
+					*((CFPropertyListRef*)outData) = CFNumberCreate(NULL, kCFNumberFloat32Type, &theVolume);
+				}
+				else
+				{
+					*((CFPropertyListRef*)outData) = CFRetain(theMute ? kCFBooleanTrue : kCFBooleanFalse);
+				}
+				*outDataSize = sizeof(CFPropertyListRef);
+			}
+			break;
 			
 		default:
 			theAnswer = kAudioHardwareUnknownPropertyError;
@@ -2540,10 +2610,13 @@ Done:
 
 static OSStatus	SyncAudio_SetDevicePropertyData(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize, const void* inQualifierData, UInt32 inDataSize, const void* inData, UInt32* outNumberPropertiesChanged, AudioObjectPropertyAddress outChangedAddresses[2])
 {
-	#pragma unused(inClientProcessID, inQualifierDataSize, inQualifierData)
+	#pragma unused(inClientProcessID)
 	
 	//	declare the local variables
 	OSStatus theAnswer = 0;
+	SyncAudioDevice* theDevice;
+	UInt32 theDeviceObject = kDeviceObject_Count;
+	SyncAudioDeviceState theState;
 	Float64 theOldSampleRate;
 	UInt64 theNewSampleRate;
 	
@@ -2552,7 +2625,8 @@ static OSStatus	SyncAudio_SetDevicePropertyData(AudioServerPlugInDriverRef inDri
 	FailWithAction(inAddress == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_SetDevicePropertyData: no address");
 	FailWithAction(outNumberPropertiesChanged == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_SetDevicePropertyData: no place to return the number of properties that changed");
 	FailWithAction(outChangedAddresses == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_SetDevicePropertyData: no place to return the properties that changed");
-	FailWithAction(inObjectID != kObjectID_Device, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_SetDevicePropertyData: not the device object");
+	theDevice = SyncAudio_FindDevice(inObjectID, &theDeviceObject);
+	FailWithAction((theDevice == NULL) || (theDeviceObject != kDeviceObject_Device), theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_SetDevicePropertyData: not the device object");
 	
 	//	initialize the returned number of changed properties
 	*outNumberPropertiesChanged = 0;
@@ -2568,22 +2642,132 @@ static OSStatus	SyncAudio_SetDevicePropertyData(AudioServerPlugInDriverRef inDri
 
 			//	check the arguments
 			FailWithAction(inDataSize != sizeof(Float64), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_SetDevicePropertyData: wrong size for the data for kAudioDevicePropertyNominalSampleRate");
-			FailWithAction((*((const Float64*)inData) != 44100.0) && (*((const Float64*)inData) != 48000.0), theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_SetDevicePropertyData: unsupported value for kAudioDevicePropertyNominalSampleRate");
+			FailWithAction(!SyncAudio_IsSupportedSampleRate(theDevice, *((const Float64*)inData)), theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_SetDevicePropertyData: unsupported value for kAudioDevicePropertyNominalSampleRate");
 			
 			//	make sure that the new value is different than the old value
-			pthread_mutex_lock(&gPlugIn_StateMutex);
-			theOldSampleRate = gDevice_SampleRate;
-			pthread_mutex_unlock(&gPlugIn_StateMutex);
+			theState = SyncAudio_GetDeviceState(theDevice);
+			theOldSampleRate = theState.mSampleRate;
 			if(*((const Float64*)inData) != theOldSampleRate)
 			{
 				*outNumberPropertiesChanged = 1;
-				outChangedAddresses[0].mSelector = kAudioDevicePropertyNominalSampleRate;
+				outChangedAddresses[0].mSelector = kAudioDevicePropertyNominalSampleRate;
+				outChangedAddresses[0].mScope = kAudioObjectPropertyScopeGlobal;
+				outChangedAddresses[0].mElement = kAudioObjectPropertyElementMain;
+				//	we dispatch this so that the change can happen asynchronously, keeping the
+				//	sample format as it is
+				theOldSampleRate = *((const Float64*)inData);
+				theNewSampleRate = ((UInt64)theState.mSampleFormat << 32) | (UInt64)theOldSampleRate;
+				dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{ gPlugIn_Host->RequestDeviceConfigurationChange(gPlugIn_Host, theDevice->mObjectID, theNewSampleRate, NULL); });
+			}
+			break;
+		
+		case kDevice_DelayPropertyID:
+			//	The delay line depth can be changed while IO is running. We clamp the new value
+			//	to the supported range and the IO thread picks it up on its next cycle. Note
+			//	that changing the delay changes the input latency too.
+			{
+				FailWithAction(inDataSize != sizeof(CFPropertyListRef), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_SetDevicePropertyData: wrong size for the data for kDevice_DelayPropertyID");
+				FailWithAction(*((const CFPropertyListRef*)inData) == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_SetDevicePropertyData: no data for kDevice_DelayPropertyID");
+				FailWithAction(CFGetTypeID(*((const CFPropertyListRef*)inData)) != CFNumberGetTypeID(), theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_SetDevicePropertyData: the data for kDevice_DelayPropertyID is not a CFNumber");
+				Float64 theNewDelay = 0.0;
+				CFNumberGetValue(*((const CFNumberRef*)inData), kCFNumberFloat64Type, &theNewDelay);
+				pthread_mutex_lock(&gPlugIn_StateMutex);
+				if(SyncAudioEngine_SetDelayMilliseconds(&theDevice->mEngine, theNewDelay))
+				{
+					*outNumberPropertiesChanged = 2;
+					outChangedAddresses[0].mSelector = kDevice_DelayPropertyID;
+					outChangedAddresses[0].mScope = kAudioObjectPropertyScopeGlobal;
+					outChangedAddresses[0].mElement = kAudioObjectPropertyElementMain;
+					outChangedAddresses[1].mSelector = kAudioDevicePropertyLatency;
+					outChangedAddresses[1].mScope = kAudioObjectPropertyScopeInput;
+					outChangedAddresses[1].mElement = kAudioObjectPropertyElementMain;
+				}
+				pthread_mutex_unlock(&gPlugIn_StateMutex);
+			}
+			break;
+		
+		case kDevice_ClientRoutesPropertyID:
+			//	The new routes are saved in the settings and used for the clients that are added
+			//	from now on. The clients already using the device keep the routes they were given.
+			{
+				FailWithAction(inDataSize != sizeof(CFPropertyListRef), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_SetDevicePropertyData: wrong size for the data for kDevice_ClientRoutesPropertyID");
+				FailWithAction(*((const CFPropertyListRef*)inData) == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_SetDevicePropertyData: no data for kDevice_ClientRoutesPropertyID");
+				FailWithAction(CFGetTypeID(*((const CFPropertyListRef*)inData)) != CFDictionaryGetTypeID(), theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_SetDevicePropertyData: the data for kDevice_ClientRoutesPropertyID is not a CFDictionary");
+				CFDictionaryRef theNewRoutes = (CFDictionaryRef)CFRetain(*((const CFPropertyListRef*)inData));
+				pthread_mutex_lock(&gPlugIn_StateMutex);
+				CFDictionaryRef theOldRoutes = theDevice->mClientRoutes;
+				theDevice->mClientRoutes = theNewRoutes;
+				pthread_mutex_unlock(&gPlugIn_StateMutex);
+				if(theOldRoutes != NULL)
+				{
+					CFRelease(theOldRoutes);
+				}
+				CFStringRef theKey = SyncAudio_Storage_CopyKey(theDevice, kDevice_ClientRoutesStorageKey);
+				if(theKey != NULL)
+				{
+					gPlugIn_Host->WriteToStorage(gPlugIn_Host, theKey, theNewRoutes);
+					CFRelease(theKey);
+				}
+				*outNumberPropertiesChanged = 1;
+				outChangedAddresses[0].mSelector = kDevice_ClientRoutesPropertyID;
+				outChangedAddresses[0].mScope = kAudioObjectPropertyScopeGlobal;
+				outChangedAddresses[0].mElement = kAudioObjectPropertyElementMain;
+			}
+			break;
+		
+		case kDevice_ClientVolumePropertyID:
+		case kDevice_ClientMutePropertyID:
+			//	The new level applies to all of the clients of the process in the qualifier, which
+			//	has to have at least one. The IO thread ramps to it in the next buffer each client
+			//	writes.
+			{
+				FailWithAction(inDataSize != sizeof(CFPropertyListRef), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_SetDevicePropertyData: wrong size for the data for the client level");
+				SInt32 theProcessID;
+				FailWithAction(!SyncAudio_GetQualifierProcessID(inQualifierDataSize, inQualifierData, &theProcessID), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_SetDevicePropertyData: the qualifier of the client level is not a process ID");
+				CFPropertyListRef theValue = *((const CFPropertyListRef*)inData);
+				FailWithAction(theValue == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_SetDevicePropertyData: no data for the client level");
+				Float32 theVolume = 1.0f;
+				Boolean theMute = false;
+				if(inAddress->mSelector == kDevice_ClientVolumePropertyID)
+				{
+					FailWithAction(CFGetTypeID(theValue) != CFNumberGetTypeID(), theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_SetDevicePropertyData: the data for kDevice_ClientVolumePropertyID is not a CFNumber");
+					CFNumberGetValue((CFNumberRef)theValue, kCFNumberFloat32Type, &theVolume);
+					FailWithAction(!((theVolume >= 0.0f) && (theVolume <= 1.0f)), theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_SetDevicePropertyData: the data for kDevice_ClientVolumePropertyID is out of range");
+				}
+				else
+				{
+					FailWithAction(CFGetTypeID(theValue) != CFBooleanGetTypeID(), theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_SetDevicePropertyData: the data for kDevice_ClientMutePropertyID is not a CFBoolean");
+					theMute = CFBooleanGetValue((CFBooleanRef)theValue);
+				}
+				pthread_mutex_lock(&gPlugIn_StateMutex);
+				SyncAudioRoute* theRoute = SyncAudioRouteTable_FindProcess(&theDevice->mRoutes, theProcessID);
+				if(theRoute != NULL)
+				{
+					//	only the one that is being set changes
+					if(inAddress->mSelector == kDevice_ClientVolumePropertyID)
+					{
+						theMute = theRoute->mOutputMute;
+					}
+					else
+					{
+						theVolume = theRoute->mOutputVolume;
+					}
+					SyncAudioRouteTable_SetOutputLevel(&theDevice->mRoutes, theProcessID, theVolume, theMute);
+					
+					//	a client the HAL mixes as it is while IO is running only gets its level
+					//	applied once the HAL asks again
+					if((theDevice->mIOIsRunning > 0) && SyncAudioRouteTable_HasUnprocessedOutput(&theDevice->mRoutes, theProcessID))
+					{
+						AudioObjectID theDeviceObjectID = theDevice->mObjectID;
+						dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{ gPlugIn_Host->RequestDeviceConfigurationChange(gPlugIn_Host, theDeviceObjectID, kDevice_ChangeAction_ClientOperations, NULL); });
+					}
+				}
+				pthread_mutex_unlock(&gPlugIn_StateMutex);
+				FailWithAction(theRoute == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_SetDevicePropertyData: the process has no clients");
+				*outNumberPropertiesChanged = 1;
+				outChangedAddresses[0].mSelector = inAddress->mSelector;
 				outChangedAddresses[0].mScope = kAudioObjectPropertyScopeGlobal;
 				outChangedAddresses[0].mElement = kAudioObjectPropertyElementMain;
-				//	we dispatch this so that the change can happen asynchronously
-				theOldSampleRate = *((const Float64*)inData);
-				theNewSampleRate = (UInt64)theOldSampleRate;
-				dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{ gPlugIn_Host->RequestDeviceConfigurationChange(gPlugIn_Host, kObjectID_Device, theNewSampleRate, NULL); });
 			}
 			break;
 		
@@ -2596,169 +2780,475 @@ Done:
 	return theAnswer;
 }
 
-#pragma mark Stream Property Operations
+#pragma mark Storage Operations
 
-static Boolean	SyncAudio_HasStreamProperty(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress)
+static CFStringRef	SyncAudio_Storage_CopyKey(const SyncAudioDevice* inDevice, const char* inKey)
 {
-	//	This method returns whether or not the given object has the given property.
-	
-	#pragma unused(inClientProcessID)
+	//	Each device's settings are kept under its UID so that the devices don't share them. The
+	//	first device keeps the keys the driver used before it had more than one.
+	CFStringRef theAnswer;
+	if(inDevice == &gPlugIn_Devices[0])
+	{
+		theAnswer = CFStringCreateWithCString(NULL, inKey, kCFStringEncodingUTF8);
+	}
+	else
+	{
+		theAnswer = CFStringCreateWithFormat(NULL, NULL, CFSTR("%@ %s"), inDevice->mUID, inKey);
+	}
+	return theAnswer;
+}
+
+static bool	SyncAudio_Storage_CopyNumber(void* inContext, const char* inKey, double* outValue)
+{
+	//	This backs the engine's storage with the host's. The keys become CFStrings and the values
+	//	CFNumbers. The context is the device.
 	
 	//	declare the local variables
-	Boolean theAnswer = false;
-	
-	//	check the arguments
-	FailIf(inDriver != gAudioServerPlugInDriverRef, Done, "SyncAudio_HasStreamProperty: bad driver reference");
-	FailIf(inAddress == NULL, Done, "SyncAudio_HasStreamProperty: no address");
-	FailIf((inObjectID != kObjectID_Stream_Input) && (inObjectID != kObjectID_Stream_Output), Done, "SyncAudio_HasStreamProperty: not a stream object");
+	bool theAnswer = false;
+	CFPropertyListRef theSettingsData = NULL;
 	
-	//	Note that for each object, this driver implements all the required properties plus a few
-	//	extras that are useful but not required. There is more detailed commentary about each
-	//	property in the SyncAudio_GetStreamPropertyData() method.
-	switch(inAddress->mSelector)
+	CFStringRef theKey = SyncAudio_Storage_CopyKey((const SyncAudioDevice*)inContext, inKey);
+	FailIf(theKey == NULL, Done, "SyncAudio_Storage_CopyNumber: couldn't make the key");
+	gPlugIn_Host->CopyFromStorage(gPlugIn_Host, theKey, &theSettingsData);
+	CFRelease(theKey);
+	if(theSettingsData != NULL)
 	{
-		case kAudioObjectPropertyBaseClass:
-		case kAudioObjectPropertyClass:
-		case kAudioObjectPropertyOwner:
-		case kAudioObjectPropertyOwnedObjects:
-		case kAudioObjectPropertyName:
-		case kAudioStreamPropertyIsActive:
-		case kAudioStreamPropertyDirection:
-		case kAudioStreamPropertyTerminalType:
-		case kAudioStreamPropertyStartingChannel:
-		case kAudioStreamPropertyLatency:
-		case kAudioStreamPropertyVirtualFormat:
-		case kAudioStreamPropertyPhysicalFormat:
-		case kAudioStreamPropertyAvailableVirtualFormats:
-		case kAudioStreamPropertyAvailablePhysicalFormats:
-			theAnswer = true;
-			break;
-	};
+		if(CFGetTypeID(theSettingsData) == CFNumberGetTypeID())
+		{
+			theAnswer = CFNumberGetValue((CFNumberRef)theSettingsData, kCFNumberFloat64Type, outValue);
+		}
+		CFRelease(theSettingsData);
+	}
 
 Done:
 	return theAnswer;
 }
 
-static OSStatus	SyncAudio_IsStreamPropertySettable(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, Boolean* outIsSettable)
+static void	SyncAudio_Storage_WriteNumber(void* inContext, const char* inKey, double inValue)
 {
-	//	This method returns whether or not the given property on the object can have its value
-	//	changed.
-	
-	#pragma unused(inClientProcessID)
+	CFStringRef theKey = SyncAudio_Storage_CopyKey((const SyncAudioDevice*)inContext, inKey);
+	CFNumberRef theSettingsData = CFNumberCreate(NULL, kCFNumberFloat64Type, &inValue);
+	if((theKey != NULL) && (theSettingsData != NULL))
+	{
+		gPlugIn_Host->WriteToStorage(gPlugIn_Host, theKey, theSettingsData);
+	}
+	if(theSettingsData != NULL)
+	{
+		CFRelease(theSettingsData);
+	}
+	if(theKey != NULL)
+	{
+		CFRelease(theKey);
+	}
+}
+
+#pragma mark Statistics Operations
+
+static void	SyncAudio_SetDictionaryNumber(CFMutableDictionaryRef ioDictionary, CFStringRef inKey, UInt64 inValue)
+{
+	SInt64 theValue = (SInt64)inValue;
+	CFNumberRef theNumber = CFNumberCreate(NULL, kCFNumberSInt64Type, &theValue);
+	CFDictionarySetValue(ioDictionary, inKey, theNumber);
+	CFRelease(theNumber);
+}
+
+static CFDictionaryRef	SyncAudio_CopyHistogram(const SyncAudioHistogram* inHistogram)
+{
+	//	The buckets are an array of counts where bucket i counts the values from 2^(i-1) up to
+	//	2^i nanoseconds, except that bucket 0 counts zeros and the last one everything above it.
+	//	Empty buckets at the top are left off.
+	CFMutableDictionaryRef theHistogram = CFDictionaryCreateMutable(NULL, 4, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks);
+	SyncAudio_SetDictionaryNumber(theHistogram, CFSTR("count"), atomic_load_explicit(&inHistogram->mCount, memory_order_relaxed));
+	SyncAudio_SetDictionaryNumber(theHistogram, CFSTR("sum"), atomic_load_explicit(&inHistogram->mSum, memory_order_relaxed));
+	SyncAudio_SetDictionaryNumber(theHistogram, CFSTR("maximum"), atomic_load_explicit(&inHistogram->mMaximum, memory_order_relaxed));
+	UInt32 theNumberBuckets = kSyncAudioHistogram_BucketCount;
+	while((theNumberBuckets > 0) && (atomic_load_explicit(&inHistogram->mBuckets[theNumberBuckets - 1], memory_order_relaxed) == 0))
+	{
+		--theNumberBuckets;
+	}
+	CFMutableArrayRef theBuckets = CFArrayCreateMutable(NULL, theNumberBuckets, &kCFTypeArrayCallBacks);
+	for(UInt32 theBucket = 0; theBucket < theNumberBuckets; ++theBucket)
+	{
+		SInt64 theCount = (SInt64)atomic_load_explicit(&inHistogram->mBuckets[theBucket], memory_order_relaxed);
+		CFNumberRef theNumber = CFNumberCreate(NULL, kCFNumberSInt64Type, &theCount);
+		CFArrayAppendValue(theBuckets, theNumber);
+		CFRelease(theNumber);
+	}
+	CFDictionarySetValue(theHistogram, CFSTR("buckets"), theBuckets);
+	CFRelease(theBuckets);
+	return theHistogram;
+}
+
+static CFDictionaryRef	SyncAudio_CopyDeviceIOStatistics(const SyncAudioDevice* inDevice)
+{
+	//	This gathers the device's engine's statistics into a CFDictionary. Everything in it is read
+	//	with relaxed loads while IO may be running, so it never holds up the IO thread.
+	static const char* const kOperationNames[kSyncAudioEngine_OperationCount] = { "read input", "write mix", "process input", "process output" };
+	const SyncAudioEngine* theEngine = &inDevice->mEngine;
+	CFMutableDictionaryRef theStatistics = CFDictionaryCreateMutable(NULL, 4, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks);
+	for(UInt32 theOperation = 0; theOperation < kSyncAudioEngine_OperationCount; ++theOperation)
+	{
+		CFMutableDictionaryRef theOperationStatistics = CFDictionaryCreateMutable(NULL, 2, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks);
+		CFDictionaryRef theHistogram = SyncAudio_CopyHistogram(&theEngine->mOperationStats[theOperation].mDuration);
+		CFDictionarySetValue(theOperationStatistics, CFSTR("duration"), theHistogram);
+		CFRelease(theHistogram);
+		theHistogram = SyncAudio_CopyHistogram(&theEngine->mOperationStats[theOperation].mJitter);
+		CFDictionarySetValue(theOperationStatistics, CFSTR("jitter"), theHistogram);
+		CFRelease(theHistogram);
+		CFStringRef theKey = CFStringCreateWithCString(NULL, kOperationNames[theOperation], kCFStringEncodingUTF8);
+		CFDictionarySetValue(theStatistics, theKey, theOperationStatistics);
+		CFRelease(theKey);
+		CFRelease(theOperationStatistics);
+	}
+	SyncAudio_SetDictionaryNumber(theStatistics, CFSTR("underruns"), atomic_load_explicit(&theEngine->mRing.mUnderrunCount, memory_order_relaxed));
+	SyncAudio_SetDictionaryNumber(theStatistics, CFSTR("overruns"), atomic_load_explicit(&theEngine->mRing.mOverrunCount, memory_order_relaxed));
+	if(theEngine->mSource != NULL)
+	{
+		//	how fast the input is being read relative to the source's clock, in parts per billion,
+		//	and how many times it had to re-anchor to it
+		SyncAudio_SetDictionaryNumber(theStatistics, CFSTR("drift ppb"), (UInt64)atomic_load_explicit(&theEngine->mDrift.mPublishedCorrection, memory_order_relaxed));
+		SyncAudio_SetDictionaryNumber(theStatistics, CFSTR("resyncs"), atomic_load_explicit(&theEngine->mDrift.mResyncCount, memory_order_relaxed));
+	}
+	else
+	{
+		//	the margin the input is read with for a late writer
+		SyncAudio_SetDictionaryNumber(theStatistics, CFSTR("jitter frames"), atomic_load_explicit(&theEngine->mJitterFrames, memory_order_relaxed));
+	}
+	return theStatistics;
+}
+
+static CFDictionaryRef	SyncAudio_CopyIOStatistics(void)
+{
+	//	This gathers the statistics of every device into a CFDictionary keyed by the device's UID.
+	CFMutableDictionaryRef theStatistics = CFDictionaryCreateMutable(NULL, gPlugIn_NumberDevices, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks);
+	for(UInt32 theDeviceIndex = 0; theDeviceIndex < gPlugIn_NumberDevices; ++theDeviceIndex)
+	{
+		CFDictionaryRef theDeviceStatistics = SyncAudio_CopyDeviceIOStatistics(&gPlugIn_Devices[theDeviceIndex]);
+		CFDictionarySetValue(theStatistics, gPlugIn_Devices[theDeviceIndex].mUID, theDeviceStatistics);
+		CFRelease(theDeviceStatistics);
+	}
+	return theStatistics;
+}
+
+#pragma mark Trace Operations
+
+static void	SyncAudio_Trace(UInt32 inEvent, AudioObjectID inObjectID, UInt64 inStartHostTime, UInt64 inEndHostTime, UInt64 inArgument0, UInt64 inArgument1)
+{
+	//	This records an event in the trace log. It never blocks, so it can be called from the IO
+	//	thread, and it compiles away when tracing is off.
+#if SyncAudio_TraceEvents
+	SyncAudioTraceRecord theRecord = { inStartHostTime, inEndHostTime - inStartHostTime, inEvent, inObjectID, inArgument0, inArgument1 };
+	SyncAudioTrace_Record(&gPlugIn_Trace, &theRecord);
+#else
+	#pragma unused(inEvent, inObjectID, inStartHostTime, inEndHostTime, inArgument0, inArgument1)
+#endif
+}
+
+#pragma mark Device Operations
+
+static bool	SyncAudio_CreateLoopbackDevice(CFStringRef inName, CFStringRef inUID, UInt32 inChannelCount, Float64 inMaxSampleRate)
+{
+	//	This creates a device with the next block of object IDs. It is only called from
+	//	SyncAudio_Initialize, before the HAL knows about any devices, which is why the device list
+	//	can grow without taking the state lock.
 	
 	//	declare the local variables
-	OSStatus theAnswer = 0;
+	bool theAnswer = false;
+	SyncAudioDevice* theDevice = NULL;
 	
 	//	check the arguments
-	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_IsStreamPropertySettable: bad driver reference");
-	FailWithAction(inAddress == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_IsStreamPropertySettable: no address");
-	FailWithAction(outIsSettable == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_IsStreamPropertySettable: no place to put the return value");
-	FailWithAction((inObjectID != kObjectID_Stream_Input) && (inObjectID != kObjectID_Stream_Output), theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_IsStreamPropertySettable: not a stream object");
+	FailIf(gPlugIn_NumberDevices >= kPlugIn_MaxNumberDevices, Done, "SyncAudio_CreateLoopbackDevice: too many devices");
+	FailIf((inChannelCount != 1) && (inChannelCount != 2) && (inChannelCount != 6) && (inChannelCount != 8), Done, "SyncAudio_CreateLoopbackDevice: unsupported number of channels");
+	FailIf(SyncAudio_FindDeviceByUID(inUID) != NULL, Done, "SyncAudio_CreateLoopbackDevice: the UID is taken");
+	FailIf(!SyncAudio_IsSupportedSampleRate(NULL, inMaxSampleRate) || (inMaxSampleRate < kDevice_InitialState.mSampleRate), Done, "SyncAudio_CreateLoopbackDevice: unsupported highest sample rate");
+	
+	//	fill out the device
+	theDevice = &gPlugIn_Devices[gPlugIn_NumberDevices];
+	theDevice->mObjectID = gPlugIn_NextObjectID;
+	theDevice->mUID = (CFStringRef)CFRetain(inUID);
+	theDevice->mName = (CFStringRef)CFRetain(inName);
+	theDevice->mChannelCount = inChannelCount;
+	theDevice->mMaxSampleRate = inMaxSampleRate;
+	theDevice->mNumberSampleRates = 0;
+	while((theDevice->mNumberSampleRates < kDevice_NumberSampleRates) && (kDevice_SampleRates[theDevice->mNumberSampleRates] <= inMaxSampleRate))
+	{
+		++theDevice->mNumberSampleRates;
+	}
+	theDevice->mIOIsRunning = 0;
+	theDevice->mStreamInputIsActive = true;
+	theDevice->mStreamOutputIsActive = true;
+	theDevice->mStorage = (SyncAudioStorage){ theDevice, SyncAudio_Storage_CopyNumber, SyncAudio_Storage_WriteNumber };
+	SyncAudioState_Initialize(&theDevice->mState, &kDevice_InitialState);
+	atomic_init(&theDevice->mIOOperations, 0);
+	atomic_init(&theDevice->mIOPageFaults, 0);
+	theDevice->mReportedJitterFrames = 0;
+	
+	//	The engine grows and shrinks the input's margin for a late writer on the IO thread, which
+	//	must not call the host. So the IO thread merges into a dispatch source, which never blocks
+	//	or allocates, and the source's handler tells the HAL that the input's latency changed.
+	theDevice->mLatencyChangedSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_DATA_OR, 0, 0, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0));
+	if(theDevice->mLatencyChangedSource != NULL)
+	{
+		AudioObjectID theObjectID = theDevice->mObjectID;
+		dispatch_source_set_event_handler(theDevice->mLatencyChangedSource,	^()
+																			{
+																				AudioObjectPropertyAddress theAddress = { kAudioDevicePropertyLatency, kAudioObjectPropertyScopeInput, kAudioObjectPropertyElementMain };
+																				gPlugIn_Host->PropertiesChanged(gPlugIn_Host, theObjectID, 1, &theAddress);
+																			});
+		dispatch_resume(theDevice->mLatencyChangedSource);
+	}
 	
-	//	Note that for each object, this driver implements all the required properties plus a few
-	//	extras that are useful but not required. There is more detailed commentary about each
-	//	property in the SyncAudio_GetStreamPropertyData() method.
-	switch(inAddress->mSelector)
+	//	set up the engine, which loads its settings from the host's storage and allocates the
+	//	device's ring, for its highest sample rate, for the lifetime of the driver
+	if(!SyncAudioEngine_Initialize(&theDevice->mEngine, &theDevice->mStorage, &gPlugIn_HostClock, kDevice_InitialState.mSampleRate, inMaxSampleRate, inChannelCount, kRing_Buffer_Frame_Size, kDevice_ZeroTimeStampPeriod, kRing_Mix_In_Float64 ? kSyncAudioRing_MixInFloat64 : 0))
 	{
-		case kAudioObjectPropertyBaseClass:
-		case kAudioObjectPropertyClass:
-		case kAudioObjectPropertyOwner:
-		case kAudioObjectPropertyOwnedObjects:
-		case kAudioObjectPropertyName:
-		case kAudioStreamPropertyDirection:
-		case kAudioStreamPropertyTerminalType:
-		case kAudioStreamPropertyStartingChannel:
-		case kAudioStreamPropertyLatency:
-		case kAudioStreamPropertyAvailableVirtualFormats:
-		case kAudioStreamPropertyAvailablePhysicalFormats:
-			*outIsSettable = false;
-			break;
-		
-		case kAudioStreamPropertyIsActive:
-		case kAudioStreamPropertyVirtualFormat:
-		case kAudioStreamPropertyPhysicalFormat:
-			*outIsSettable = true;
-			break;
-		
-		default:
-			theAnswer = kAudioHardwareUnknownPropertyError;
-			break;
-	};
+		if(theDevice->mLatencyChangedSource != NULL)
+		{
+			dispatch_source_cancel(theDevice->mLatencyChangedSource);
+			dispatch_release(theDevice->mLatencyChangedSource);
+		}
+		CFRelease(theDevice->mUID);
+		CFRelease(theDevice->mName);
+		DebugMsg("SyncAudio_CreateLoopbackDevice: failed to allocate the ring buffer");
+		goto Done;
+	}
+	
+	//	load the client routes, which the device does fine without
+	theDevice->mClientRoutes = NULL;
+	SyncAudioRouteTable_Initialize(&theDevice->mRoutes);
+	CFStringRef theRoutesKey = SyncAudio_Storage_CopyKey(theDevice, kDevice_ClientRoutesStorageKey);
+	if(theRoutesKey != NULL)
+	{
+		CFPropertyListRef theSettingsData = NULL;
+		gPlugIn_Host->CopyFromStorage(gPlugIn_Host, theRoutesKey, &theSettingsData);
+		if(theSettingsData != NULL)
+		{
+			if(CFGetTypeID(theSettingsData) == CFDictionaryGetTypeID())
+			{
+				theDevice->mClientRoutes = (CFDictionaryRef)CFRetain(theSettingsData);
+			}
+			CFRelease(theSettingsData);
+		}
+		CFRelease(theRoutesKey);
+	}
+	
+	//	publish it
+	gPlugIn_NextObjectID += kDeviceObject_Count;
+	++gPlugIn_NumberDevices;
+	theAnswer = true;
 
 Done:
 	return theAnswer;
 }
 
-static OSStatus	SyncAudio_GetStreamPropertyDataSize(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize, const void* inQualifierData, UInt32* outDataSize)
+static SyncAudioDevice*	SyncAudio_FindDevice(AudioObjectID inObjectID, UInt32* outDeviceObject)
 {
-	//	This method returns the byte size of the property's data.
-	
-	#pragma unused(inClientProcessID, inQualifierDataSize, inQualifierData)
-	
-	//	declare the local variables
-	OSStatus theAnswer = 0;
-	
-	//	check the arguments
-	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetStreamPropertyDataSize: bad driver reference");
-	FailWithAction(inAddress == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetStreamPropertyDataSize: no address");
-	FailWithAction(outDataSize == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetStreamPropertyDataSize: no place to put the return value");
-	FailWithAction((inObjectID != kObjectID_Stream_Input) && (inObjectID != kObjectID_Stream_Output), theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetStreamPropertyDataSize: not a stream object");
-	
-	//	Note that for each object, this driver implements all the required properties plus a few
-	//	extras that are useful but not required. There is more detailed commentary about each
-	//	property in the SyncAudio_GetStreamPropertyData() method.
-	switch(inAddress->mSelector)
+	//	This returns the device the given object belongs to, or NULL if it doesn't belong to one,
+	//	along with which of the device's objects it is. It never blocks, so it's safe to call from
+	//	any thread.
+	SyncAudioDevice* theAnswer = NULL;
+	if(inObjectID >= kObjectID_FirstDevice)
 	{
-		case kAudioObjectPropertyBaseClass:
-			*outDataSize = sizeof(AudioClassID);
-			break;
+		UInt32 theDeviceIndex = (inObjectID - kObjectID_FirstDevice) / kDeviceObject_Count;
+		if(theDeviceIndex < gPlugIn_NumberDevices)
+		{
+			theAnswer = &gPlugIn_Devices[theDeviceIndex];
+			if(outDeviceObject != NULL)
+			{
+				*outDeviceObject = inObjectID - theAnswer->mObjectID;
+			}
+		}
+	}
+	return theAnswer;
+}
 
-		case kAudioObjectPropertyClass:
-			*outDataSize = sizeof(AudioClassID);
-			break;
+static SyncAudioDevice*	SyncAudio_FindDeviceByUID(CFStringRef inUID)
+{
+	SyncAudioDevice* theAnswer = NULL;
+	for(UInt32 theDeviceIndex = 0; (theAnswer == NULL) && (theDeviceIndex < gPlugIn_NumberDevices); ++theDeviceIndex)
+	{
+		if(CFStringCompare(gPlugIn_Devices[theDeviceIndex].mUID, inUID, 0) == kCFCompareEqualTo)
+		{
+			theAnswer = &gPlugIn_Devices[theDeviceIndex];
+		}
+	}
+	return theAnswer;
+}
 
-		case kAudioObjectPropertyOwner:
-			*outDataSize = sizeof(AudioObjectID);
-			break;
+static void	SyncAudio_SetDeviceSource(CFDictionaryRef inDescription)
+{
+	//	This points the input of the device described by inDescription at the device named by its
+	//	"source", if it has one. Like SyncAudio_CreateLoopbackDevice, it is only called from
+	//	SyncAudio_Initialize, before any IO can be running.
+	CFStringRef theUID = (CFStringRef)CFDictionaryGetValue(inDescription, CFSTR("uid"));
+	CFStringRef theSourceUID = (CFStringRef)CFDictionaryGetValue(inDescription, CFSTR("source"));
+	CFNumberRef theQualityNumber = (CFNumberRef)CFDictionaryGetValue(inDescription, CFSTR("quality"));
+	if((theUID != NULL) && (CFGetTypeID(theUID) == CFStringGetTypeID()) && (theSourceUID != NULL) && (CFGetTypeID(theSourceUID) == CFStringGetTypeID()))
+	{
+		SyncAudioDevice* theDevice = SyncAudio_FindDeviceByUID(theUID);
+		SyncAudioDevice* theSource = SyncAudio_FindDeviceByUID(theSourceUID);
+		SInt32 theQuality = kDevice_ResamplerQuality;
+		if((theQualityNumber != NULL) && ((CFGetTypeID(theQualityNumber) != CFNumberGetTypeID()) || !CFNumberGetValue(theQualityNumber, kCFNumberSInt32Type, &theQuality) || (theQuality < 0) || (theQuality >= kSyncAudioResampler_QualityCount)))
+		{
+			theQuality = kDevice_ResamplerQuality;
+		}
+		if((theDevice == NULL) || (theSource == NULL) || !SyncAudioEngine_SetSource(&theDevice->mEngine, &theSource->mEngine, (uint32_t)theQuality))
+		{
+			DebugMsg("SyncAudio_SetDeviceSource: couldn't play back the source");
+		}
+	}
+}
 
-		case kAudioObjectPropertyOwnedObjects:
-			*outDataSize = 0 * sizeof(AudioObjectID);
-			break;
+static UInt64	SyncAudio_GetHostTime(void)
+{
+	return gPlugIn_HostClock.mGetHostTime(gPlugIn_HostClock.mContext);
+}
 
-		case kAudioObjectPropertyName:
-			*outDataSize = sizeof(CFStringRef);
-			break;
+static UInt32	SyncAudio_GetRouteBus(CFDictionaryRef inRoute, CFStringRef inKey)
+{
+	//	anything that isn't the number of one of the other buses means the main bus
+	UInt32 theAnswer = kSyncAudioEngine_MainBus;
+	CFNumberRef theBus = (CFNumberRef)CFDictionaryGetValue(inRoute, inKey);
+	SInt32 theValue = 0;
+	if((theBus != NULL) && (CFGetTypeID(theBus) == CFNumberGetTypeID()) && CFNumberGetValue(theBus, kCFNumberSInt32Type, &theValue) && (theValue > 0) && (theValue < kSyncAudioEngine_MaxBusCount))
+	{
+		theAnswer = (UInt32)theValue;
+	}
+	return theAnswer;
+}
 
-		case kAudioStreamPropertyIsActive:
-			*outDataSize = sizeof(UInt32);
-			break;
+static void	SyncAudio_GetClientRoute(const SyncAudioDevice* inDevice, const AudioServerPlugInClientInfo* inClientInfo, SyncAudioRoute* outRoute)
+{
+	//	This looks the client up in the device's routes, first by its bundle ID and then by its
+	//	process ID, and fills out its route. A client that isn't listed uses the main bus both ways,
+	//	and so does a diverted client without an output bus. Its output starts at full level. The
+	//	caller holds the state lock.
+	CFDictionaryRef theRoute = NULL;
+	*outRoute = (SyncAudioRoute){ (int32_t)inClientInfo->mProcessID, kSyncAudioEngine_MainBus, kSyncAudioEngine_MainBus, false, false, 1.0f, 1.0f, 1.0f, 0.0f, false };
+	if(inDevice->mClientRoutes != NULL)
+	{
+		if(inClientInfo->mBundleID != NULL)
+		{
+			theRoute = (CFDictionaryRef)CFDictionaryGetValue(inDevice->mClientRoutes, inClientInfo->mBundleID);
+		}
+		if(theRoute == NULL)
+		{
+			CFStringRef theProcessID = CFStringCreateWithFormat(NULL, NULL, CFSTR("%d"), (int)inClientInfo->mProcessID);
+			if(theProcessID != NULL)
+			{
+				theRoute = (CFDictionaryRef)CFDictionaryGetValue(inDevice->mClientRoutes, theProcessID);
+				CFRelease(theProcessID);
+			}
+		}
+	}
+	if((theRoute != NULL) && (CFGetTypeID(theRoute) == CFDictionaryGetTypeID()))
+	{
+		CFBooleanRef theDivert = (CFBooleanRef)CFDictionaryGetValue(theRoute, CFSTR("divert"));
+		outRoute->mOutputBus = SyncAudio_GetRouteBus(theRoute, CFSTR("output bus"));
+		outRoute->mInputBus = SyncAudio_GetRouteBus(theRoute, CFSTR("input bus"));
+		outRoute->mDivertOutput = (outRoute->mOutputBus != kSyncAudioEngine_MainBus) && (theDivert != NULL) && (CFGetTypeID(theDivert) == CFBooleanGetTypeID()) && CFBooleanGetValue(theDivert);
+	}
+}
 
-		case kAudioStreamPropertyDirection:
-			*outDataSize = sizeof(UInt32);
-			break;
+static bool	SyncAudio_GetQualifierProcessID(UInt32 inQualifierDataSize, const void* inQualifierData, SInt32* outProcessID)
+{
+	//	the client level properties are qualified by a CFNumber holding the process ID
+	CFNumberRef theProcessID = NULL;
+	if((inQualifierDataSize == sizeof(CFPropertyListRef)) && (inQualifierData != NULL))
+	{
+		theProcessID = *((const CFNumberRef*)inQualifierData);
+	}
+	return (theProcessID != NULL) && (CFGetTypeID(theProcessID) == CFNumberGetTypeID()) && CFNumberGetValue(theProcessID, kCFNumberSInt32Type, outProcessID);
+}
 
-		case kAudioStreamPropertyTerminalType:
-			*outDataSize = sizeof(UInt32);
-			break;
+static bool	SyncAudio_IsSupportedSampleRate(const SyncAudioDevice* inDevice, Float64 inSampleRate)
+{
+	//	a device without one yet is being created, and can have any rate in the list as its highest
+	UInt32 theNumberSampleRates = (inDevice != NULL) ? inDevice->mNumberSampleRates : kDevice_NumberSampleRates;
+	for(UInt32 theIndex = 0; theIndex < theNumberSampleRates; ++theIndex)
+	{
+		if(kDevice_SampleRates[theIndex] == inSampleRate)
+		{
+			return true;
+		}
+	}
+	return false;
+}
 
-		case kAudioStreamPropertyStartingChannel:
-			*outDataSize = sizeof(UInt32);
-			break;
-		
-		case kAudioStreamPropertyLatency:
-			*outDataSize = sizeof(UInt32);
-			break;
+static void	SyncAudio_GetStreamFormat(const SyncAudioDevice* inDevice, Float64 inSampleRate, UInt32 inSampleFormat, AudioStreamBasicDescription* outFormat)
+{
+	//	Every format is packed native endian linear PCM in the device's own number of channels.
+	UInt32 theBitsPerChannel = kDevice_SampleFormatBits[inSampleFormat];
+	outFormat->mSampleRate = inSampleRate;
+	outFormat->mFormatID = kAudioFormatLinearPCM;
+	outFormat->mFormatFlags = ((inSampleFormat == kDevice_SampleFormat_Float32) ? kAudioFormatFlagIsFloat : kAudioFormatFlagIsSignedInteger) | kAudioFormatFlagsNativeEndian | kAudioFormatFlagIsPacked;
+	outFormat->mBytesPerPacket = inDevice->mChannelCount * (theBitsPerChannel / 8);
+	outFormat->mFramesPerPacket = 1;
+	outFormat->mBytesPerFrame = inDevice->mChannelCount * (theBitsPerChannel / 8);
+	outFormat->mChannelsPerFrame = inDevice->mChannelCount;
+	outFormat->mBitsPerChannel = theBitsPerChannel;
+	outFormat->mReserved = 0;
+}
 
-		case kAudioStreamPropertyVirtualFormat:
-		case kAudioStreamPropertyPhysicalFormat:
-			*outDataSize = sizeof(AudioStreamBasicDescription);
-			break;
+static bool	SyncAudio_GetSampleFormat(const SyncAudioDevice* inDevice, const AudioStreamBasicDescription* inFormat, UInt32* outSampleFormat)
+{
+	//	This finds the sample format that inFormat is in, ignoring its sample rate, and returns
+	//	false if it isn't one of the device's formats.
+	AudioStreamBasicDescription theFormat;
+	for(UInt32 theSampleFormat = 0; theSampleFormat < kDevice_NumberSampleFormats; ++theSampleFormat)
+	{
+		SyncAudio_GetStreamFormat(inDevice, inFormat->mSampleRate, theSampleFormat, &theFormat);
+		if((inFormat->mFormatID == theFormat.mFormatID) && (inFormat->mFormatFlags == theFormat.mFormatFlags) && (inFormat->mBytesPerPacket == theFormat.mBytesPerPacket) && (inFormat->mFramesPerPacket == theFormat.mFramesPerPacket) && (inFormat->mBytesPerFrame == theFormat.mBytesPerFrame) && (inFormat->mChannelsPerFrame == theFormat.mChannelsPerFrame) && (inFormat->mBitsPerChannel == theFormat.mBitsPerChannel))
+		{
+			*outSampleFormat = theSampleFormat;
+			return true;
+		}
+	}
+	return false;
+}
+
+static SyncAudioDeviceState	SyncAudio_GetDeviceState(const SyncAudioDevice* inDevice)
+{
+	//	This returns a copy of the current state of the device. It never blocks, so it's safe to
+	//	call from any thread.
+	SyncAudioDeviceState theState;
+	SyncAudioState_Load(&inDevice->mState, &theState);
+	return theState;
+}
+
+#pragma mark Stream Property Operations
 
+static OSStatus	SyncAudio_GetStreamPropertyDataSize(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize, const void* inQualifierData, UInt32* outDataSize)
+{
+	//	This method returns the byte size of the property's data.
+	
+	#pragma unused(inClientProcessID, inQualifierDataSize, inQualifierData)
+	
+	//	declare the local variables
+	OSStatus theAnswer = 0;
+	SyncAudioDevice* theDevice;
+	UInt32 theDeviceObject = kDeviceObject_Count;
+	
+	//	check the arguments
+	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetStreamPropertyDataSize: bad driver reference");
+	FailWithAction(inAddress == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetStreamPropertyDataSize: no address");
+	FailWithAction(outDataSize == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetStreamPropertyDataSize: no place to put the return value");
+	theDevice = SyncAudio_FindDevice(inObjectID, &theDeviceObject);
+	FailWithAction((theDevice == NULL) || ((theDeviceObject != kDeviceObject_Stream_Input) && (theDeviceObject != kDeviceObject_Stream_Output)), theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetStreamPropertyDataSize: not a stream object");
+	
+	//	Only the properties whose size depends on the device get here. The registry has the sizes
+	//	of the rest. There is more detailed commentary about each property in the
+	//	SyncAudio_GetStreamPropertyData() method.
+	switch(inAddress->mSelector)
+	{
 		case kAudioStreamPropertyAvailableVirtualFormats:
+			*outDataSize = theDevice->mNumberSampleRates * sizeof(AudioStreamRangedDescription);
+			break;
+			
 		case kAudioStreamPropertyAvailablePhysicalFormats:
-			*outDataSize = 2 * sizeof(AudioStreamRangedDescription);
+			*outDataSize = theDevice->mNumberSampleRates * kDevice_NumberSampleFormats * sizeof(AudioStreamRangedDescription);
 			break;
-
+			
 		default:
 			theAnswer = kAudioHardwareUnknownPropertyError;
 			break;
@@ -2774,14 +3264,20 @@ static OSStatus	SyncAudio_GetStreamPropertyData(AudioServerPlugInDriverRef inDri
 	
 	//	declare the local variables
 	OSStatus theAnswer = 0;
+	SyncAudioDevice* theDevice;
+	UInt32 theDeviceObject = kDeviceObject_Count;
+	SyncAudioDeviceState theState;
+	UInt32 theNumberItems;
 	UInt32 theNumberItemsToFetch;
+	UInt32 theItemIndex;
 	
 	//	check the arguments
 	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetStreamPropertyData: bad driver reference");
 	FailWithAction(inAddress == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetStreamPropertyData: no address");
 	FailWithAction(outDataSize == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetStreamPropertyData: no place to put the return value size");
 	FailWithAction(outData == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetStreamPropertyData: no place to put the return value");
-	FailWithAction((inObjectID != kObjectID_Stream_Input) && (inObjectID != kObjectID_Stream_Output), theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetStreamPropertyData: not a stream object");
+	theDevice = SyncAudio_FindDevice(inObjectID, &theDeviceObject);
+	FailWithAction((theDevice == NULL) || ((theDeviceObject != kDeviceObject_Stream_Input) && (theDeviceObject != kDeviceObject_Stream_Output)), theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetStreamPropertyData: not a stream object");
 	
 	//	Note that for each object, this driver implements all the required properties plus a few
 	//	extras that are useful but not required.
@@ -2807,7 +3303,7 @@ static OSStatus	SyncAudio_GetStreamPropertyData(AudioServerPlugInDriverRef inDri
 		case kAudioObjectPropertyOwner:
 			//	The stream's owner is the device object
 			FailWithAction(inDataSize < sizeof(AudioObjectID), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetStreamPropertyData: not enough space for the return value of kAudioObjectPropertyOwner for the stream");
-			*((AudioObjectID*)outData) = kObjectID_Device;
+			*((AudioObjectID*)outData) = theDevice->mObjectID;
 			*outDataSize = sizeof(AudioObjectID);
 			break;
 			
@@ -2819,7 +3315,7 @@ static OSStatus	SyncAudio_GetStreamPropertyData(AudioServerPlugInDriverRef inDri
 		case kAudioObjectPropertyName:
 			//	This is the human readable name of the stream
 			FailWithAction(inDataSize < sizeof(CFStringRef), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetStreamPropertyData: not enough space for the return value of kAudioObjectPropertyName for the stream");
-			*((CFStringRef*)outData) = (inObjectID == kObjectID_Stream_Input) ? CFSTR("InputStreamName") : CFSTR("OutputStreamName");
+			*((CFStringRef*)outData) = (theDeviceObject == kDeviceObject_Stream_Input) ? CFSTR("InputStreamName") : CFSTR("OutputStreamName");
 			*outDataSize = sizeof(CFStringRef);
 			break;
 
@@ -2829,7 +3325,7 @@ static OSStatus	SyncAudio_GetStreamPropertyData(AudioServerPlugInDriverRef inDri
 			//	value.
 			FailWithAction(inDataSize < sizeof(UInt32), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetStreamPropertyData: not enough space for the return value of kAudioStreamPropertyIsActive for the stream");
 			pthread_mutex_lock(&gPlugIn_StateMutex);
-			*((UInt32*)outData) = (inObjectID == kObjectID_Stream_Input) ? gStream_Input_IsActive : gStream_Output_IsActive;
+			*((UInt32*)outData) = (theDeviceObject == kDeviceObject_Stream_Input) ? theDevice->mStreamInputIsActive : theDevice->mStreamOutputIsActive;
 			pthread_mutex_unlock(&gPlugIn_StateMutex);
 			*outDataSize = sizeof(UInt32);
 			break;
@@ -2837,7 +3333,7 @@ static OSStatus	SyncAudio_GetStreamPropertyData(AudioServerPlugInDriverRef inDri
 		case kAudioStreamPropertyDirection:
 			//	This returns whether the stream is an input stream or an output stream.
 			FailWithAction(inDataSize < sizeof(UInt32), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetStreamPropertyData: not enough space for the return value of kAudioStreamPropertyDirection for the stream");
-			*((UInt32*)outData) = (inObjectID == kObjectID_Stream_Input) ? 1 : 0;
+			*((UInt32*)outData) = (theDeviceObject == kDeviceObject_Stream_Input) ? 1 : 0;
 			*outDataSize = sizeof(UInt32);
 			break;
 
@@ -2846,7 +3342,7 @@ static OSStatus	SyncAudio_GetStreamPropertyData(AudioServerPlugInDriverRef inDri
 			//	such as a speaker or headphones, or a microphone. Values for this property
 			//	are defined in <CoreAudio/AudioHardwareBase.h>
 			FailWithAction(inDataSize < sizeof(UInt32), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetStreamPropertyData: not enough space for the return value of kAudioStreamPropertyTerminalType for the stream");
-			*((UInt32*)outData) = (inObjectID == kObjectID_Stream_Input) ? kAudioStreamTerminalTypeMicrophone : kAudioStreamTerminalTypeSpeaker;
+			*((UInt32*)outData) = (theDeviceObject == kDeviceObject_Stream_Input) ? kAudioStreamTerminalTypeMicrophone : kAudioStreamTerminalTypeSpeaker;
 			*outDataSize = sizeof(UInt32);
 			break;
 
@@ -2870,28 +3366,21 @@ static OSStatus	SyncAudio_GetStreamPropertyData(AudioServerPlugInDriverRef inDri
 		case kAudioStreamPropertyVirtualFormat:
 		case kAudioStreamPropertyPhysicalFormat:
 			//	This returns the current format of the stream in an
-			//	AudioStreamBasicDescription. Note that we need to hold the state lock to get
-			//	this value.
-			//	Note that for devices that don't override the mix operation, the virtual
-			//	format has to be the same as the physical format.
+			//	AudioStreamBasicDescription. The sample rate and format are read from the
+			//	published state without taking the state lock. The virtual format is always
+			//	32 bit float, whatever the physical format is.
 			FailWithAction(inDataSize < sizeof(AudioStreamBasicDescription), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetStreamPropertyData: not enough space for the return value of kAudioStreamPropertyVirtualFormat for the stream");
-			pthread_mutex_lock(&gPlugIn_StateMutex);
-			((AudioStreamBasicDescription*)outData)->mSampleRate = gDevice_SampleRate;
-			((AudioStreamBasicDescription*)outData)->mFormatID = kAudioFormatLinearPCM;
-			((AudioStreamBasicDescription*)outData)->mFormatFlags = kAudioFormatFlagIsFloat | kAudioFormatFlagsNativeEndian | kAudioFormatFlagIsPacked;
-			((AudioStreamBasicDescription*)outData)->mBytesPerPacket = 8;
-			((AudioStreamBasicDescription*)outData)->mFramesPerPacket = 1;
-			((AudioStreamBasicDescription*)outData)->mBytesPerFrame = 8;
-			((AudioStreamBasicDescription*)outData)->mChannelsPerFrame = 2;
-			((AudioStreamBasicDescription*)outData)->mBitsPerChannel = 32;
-			pthread_mutex_unlock(&gPlugIn_StateMutex);
+			theState = SyncAudio_GetDeviceState(theDevice);
+			SyncAudio_GetStreamFormat(theDevice, theState.mSampleRate, (inAddress->mSelector == kAudioStreamPropertyPhysicalFormat) ? theState.mSampleFormat : kDevice_SampleFormat_Float32, (AudioStreamBasicDescription*)outData);
 			*outDataSize = sizeof(AudioStreamBasicDescription);
 			break;
 
 		case kAudioStreamPropertyAvailableVirtualFormats:
 		case kAudioStreamPropertyAvailablePhysicalFormats:
 			//	This returns an array of AudioStreamRangedDescriptions that describe what
-			//	formats are supported.
+			//	formats are supported. The virtual formats are every sample rate the device
+			//	goes up to in 32 bit float and the physical ones are every one of those sample
+			//	rates in every sample format.
 
 			//	Calculate the number of items that have been requested. Note that this
 			//	number is allowed to be smaller than the actual size of the list. In such
@@ -2899,322 +3388,26 @@ static OSStatus	SyncAudio_GetStreamPropertyData(AudioServerPlugInDriverRef inDri
 			theNumberItemsToFetch = inDataSize / sizeof(AudioStreamRangedDescription);
 			
 			//	clamp it to the number of items we have
-			if(theNumberItemsToFetch > 2)
+			theNumberItems = (inAddress->mSelector == kAudioStreamPropertyAvailablePhysicalFormats) ? (theDevice->mNumberSampleRates * kDevice_NumberSampleFormats) : theDevice->mNumberSampleRates;
+			if(theNumberItemsToFetch > theNumberItems)
 			{
-				theNumberItemsToFetch = 2;
+				theNumberItemsToFetch = theNumberItems;
 			}
 			
 			//	fill out the return array
-			if(theNumberItemsToFetch > 0)
-			{
-				((AudioStreamRangedDescription*)outData)[0].mFormat.mSampleRate = 44100.0;
-				((AudioStreamRangedDescription*)outData)[0].mFormat.mFormatID = kAudioFormatLinearPCM;
-				((AudioStreamRangedDescription*)outData)[0].mFormat.mFormatFlags = kAudioFormatFlagIsFloat | kAudioFormatFlagsNativeEndian | kAudioFormatFlagIsPacked;
-				((AudioStreamRangedDescription*)outData)[0].mFormat.mBytesPerPacket = 8;
-				((AudioStreamRangedDescription*)outData)[0].mFormat.mFramesPerPacket = 1;
-				((AudioStreamRangedDescription*)outData)[0].mFormat.mBytesPerFrame = 8;
-				((AudioStreamRangedDescription*)outData)[0].mFormat.mChannelsPerFrame = 2;
-				((AudioStreamRangedDescription*)outData)[0].mFormat.mBitsPerChannel = 32;
-				((AudioStreamRangedDescription*)outData)[0].mSampleRateRange.mMinimum = 44100.0;
-				((AudioStreamRangedDescription*)outData)[0].mSampleRateRange.mMaximum = 44100.0;
-			}
-			if(theNumberItemsToFetch > 1)
+			for(theItemIndex = 0; theItemIndex < theNumberItemsToFetch; ++theItemIndex)
 			{
-				((AudioStreamRangedDescription*)outData)[1].mFormat.mSampleRate = 48000.0;
-				((AudioStreamRangedDescription*)outData)[1].mFormat.mFormatID = kAudioFormatLinearPCM;
-				((AudioStreamRangedDescription*)outData)[1].mFormat.mFormatFlags = kAudioFormatFlagIsFloat | kAudioFormatFlagsNativeEndian | kAudioFormatFlagIsPacked;
-				((AudioStreamRangedDescription*)outData)[1].mFormat.mBytesPerPacket = 8;
-				((AudioStreamRangedDescription*)outData)[1].mFormat.mFramesPerPacket = 1;
-				((AudioStreamRangedDescription*)outData)[1].mFormat.mBytesPerFrame = 8;
-				((AudioStreamRangedDescription*)outData)[1].mFormat.mChannelsPerFrame = 2;
-				((AudioStreamRangedDescription*)outData)[1].mFormat.mBitsPerChannel = 32;
-				((AudioStreamRangedDescription*)outData)[1].mSampleRateRange.mMinimum = 48000.0;
-				((AudioStreamRangedDescription*)outData)[1].mSampleRateRange.mMaximum = 48000.0;
+				SyncAudio_GetStreamFormat(theDevice, kDevice_SampleRates[theItemIndex % theDevice->mNumberSampleRates], theItemIndex / theDevice->mNumberSampleRates, &((AudioStreamRangedDescription*)outData)[theItemIndex].mFormat);
+				((AudioStreamRangedDescription*)outData)[theItemIndex].mSampleRateRange.mMinimum = kDevice_SampleRates[theItemIndex % theDevice->mNumberSampleRates];
+				((AudioStreamRangedDescription*)outData)[theItemIndex].mSampleRateRange.mMaximum = kDevice_SampleRates[theItemIndex % theDevice->mNumberSampleRates];
 			}
 			
 			//	report how much we wrote
 			*outDataSize = theNumberItemsToFetch * sizeof(AudioStreamRangedDescription);
 			break;
-
-		default:
-			theAnswer = kAudioHardwareUnknownPropertyError;
-			break;
-	};
-
-Done:
-	return theAnswer;
-}
-
-static OSStatus	SyncAudio_SetStreamPropertyData(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize, const void* inQualifierData, UInt32 inDataSize, const void* inData, UInt32* outNumberPropertiesChanged, AudioObjectPropertyAddress outChangedAddresses[2])
-{
-	#pragma unused(inClientProcessID, inQualifierDataSize, inQualifierData)
-	
-	//	declare the local variables
-	OSStatus theAnswer = 0;
-	Float64 theOldSampleRate;
-	UInt64 theNewSampleRate;
-	
-	//	check the arguments
-	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_SetStreamPropertyData: bad driver reference");
-	FailWithAction(inAddress == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_SetStreamPropertyData: no address");
-	FailWithAction(outNumberPropertiesChanged == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_SetStreamPropertyData: no place to return the number of properties that changed");
-	FailWithAction(outChangedAddresses == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_SetStreamPropertyData: no place to return the properties that changed");
-	FailWithAction((inObjectID != kObjectID_Stream_Input) && (inObjectID != kObjectID_Stream_Output), theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_SetStreamPropertyData: not a stream object");
-	
-	//	initialize the returned number of changed properties
-	*outNumberPropertiesChanged = 0;
-	
-	//	Note that for each object, this driver implements all the required properties plus a few
-	//	extras that are useful but not required. There is more detailed commentary about each
-	//	property in the SyncAudio_GetStreamPropertyData() method.
-	switch(inAddress->mSelector)
-	{
-		case kAudioStreamPropertyIsActive:
-			//	Changing the active state of a stream doesn't affect IO or change the structure
-			//	so we can just save the state and send the notification.
-			FailWithAction(inDataSize != sizeof(UInt32), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_SetStreamPropertyData: wrong size for the data for kAudioDevicePropertyNominalSampleRate");
-			pthread_mutex_lock(&gPlugIn_StateMutex);
-			if(inObjectID == kObjectID_Stream_Input)
-			{
-				if(gStream_Input_IsActive != (*((const UInt32*)inData) != 0))
-				{
-					gStream_Input_IsActive = *((const UInt32*)inData) != 0;
-					*outNumberPropertiesChanged = 1;
-					outChangedAddresses[0].mSelector = kAudioStreamPropertyIsActive;
-					outChangedAddresses[0].mScope = kAudioObjectPropertyScopeGlobal;
-					outChangedAddresses[0].mElement = kAudioObjectPropertyElementMain;
-				}
-			}
-			else
-			{
-				if(gStream_Output_IsActive != (*((const UInt32*)inData) != 0))
-				{
-					gStream_Output_IsActive = *((const UInt32*)inData) != 0;
-					*outNumberPropertiesChanged = 1;
-					outChangedAddresses[0].mSelector = kAudioStreamPropertyIsActive;
-					outChangedAddresses[0].mScope = kAudioObjectPropertyScopeGlobal;
-					outChangedAddresses[0].mElement = kAudioObjectPropertyElementMain;
-				}
-			}
-			pthread_mutex_unlock(&gPlugIn_StateMutex);
-			break;
-			
-		case kAudioStreamPropertyVirtualFormat:
-		case kAudioStreamPropertyPhysicalFormat:
-			//	Changing the stream format needs to be handled via the
-			//	RequestConfigChange/PerformConfigChange machinery. Note that because this
-			//	device only supports 2 channel 32 bit float data, the only thing that can
-			//	change is the sample rate.
-			FailWithAction(inDataSize != sizeof(AudioStreamBasicDescription), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_SetStreamPropertyData: wrong size for the data for kAudioStreamPropertyPhysicalFormat");
-			FailWithAction(((const AudioStreamBasicDescription*)inData)->mFormatID != kAudioFormatLinearPCM, theAnswer = kAudioDeviceUnsupportedFormatError, Done, "SyncAudio_SetStreamPropertyData: unsupported format ID for kAudioStreamPropertyPhysicalFormat");
-			FailWithAction(((const AudioStreamBasicDescription*)inData)->mFormatFlags != (kAudioFormatFlagIsFloat | kAudioFormatFlagsNativeEndian | kAudioFormatFlagIsPacked), theAnswer = kAudioDeviceUnsupportedFormatError, Done, "SyncAudio_SetStreamPropertyData: unsupported format flags for kAudioStreamPropertyPhysicalFormat");
-			FailWithAction(((const AudioStreamBasicDescription*)inData)->mBytesPerPacket != 8, theAnswer = kAudioDeviceUnsupportedFormatError, Done, "SyncAudio_SetStreamPropertyData: unsupported bytes per packet for kAudioStreamPropertyPhysicalFormat");
-			FailWithAction(((const AudioStreamBasicDescription*)inData)->mFramesPerPacket != 1, theAnswer = kAudioDeviceUnsupportedFormatError, Done, "SyncAudio_SetStreamPropertyData: unsupported frames per packet for kAudioStreamPropertyPhysicalFormat");
-			FailWithAction(((const AudioStreamBasicDescription*)inData)->mBytesPerFrame != 8, theAnswer = kAudioDeviceUnsupportedFormatError, Done, "SyncAudio_SetStreamPropertyData: unsupported bytes per frame for kAudioStreamPropertyPhysicalFormat");
-			FailWithAction(((const AudioStreamBasicDescription*)inData)->mChannelsPerFrame != 2, theAnswer = kAudioDeviceUnsupportedFormatError, Done, "SyncAudio_SetStreamPropertyData: unsupported channels per frame for kAudioStreamPropertyPhysicalFormat");
-			FailWithAction(((const AudioStreamBasicDescription*)inData)->mBitsPerChannel != 32, theAnswer = kAudioDeviceUnsupportedFormatError, Done, "SyncAudio_SetStreamPropertyData: unsupported bits per channel for kAudioStreamPropertyPhysicalFormat");
-			FailWithAction((((const AudioStreamBasicDescription*)inData)->mSampleRate != 44100.0) && (((const AudioStreamBasicDescription*)inData)->mSampleRate != 48000.0), theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_SetStreamPropertyData: unsupported sample rate for kAudioStreamPropertyPhysicalFormat");
-			
-			//	If we made it this far, the requested format is something we support, so make sure the sample rate is actually different
-			pthread_mutex_lock(&gPlugIn_StateMutex);
-			theOldSampleRate = gDevice_SampleRate;
-			pthread_mutex_unlock(&gPlugIn_StateMutex);
-			if(((const AudioStreamBasicDescription*)inData)->mSampleRate != theOldSampleRate)
-			{
-				//	we dispatch this so that the change can happen asynchronously
-				theOldSampleRate = ((const AudioStreamBasicDescription*)inData)->mSampleRate;
-				theNewSampleRate = (UInt64)theOldSampleRate;
-				dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{ gPlugIn_Host->RequestDeviceConfigurationChange(gPlugIn_Host, kObjectID_Device, theNewSampleRate, NULL); });
-			}
-			break;
-		
-		default:
-			theAnswer = kAudioHardwareUnknownPropertyError;
-			break;
-	};
-
-Done:
-	return theAnswer;
-}
-
-#pragma mark Control Property Operations
-
-static Boolean	SyncAudio_HasControlProperty(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress)
-{
-	//	This method returns whether or not the given object has the given property.
-	
-	#pragma unused(inClientProcessID)
-	
-	//	declare the local variables
-	Boolean theAnswer = false;
-	
-	//	check the arguments
-	FailIf(inDriver != gAudioServerPlugInDriverRef, Done, "SyncAudio_HasControlProperty: bad driver reference");
-	FailIf(inAddress == NULL, Done, "SyncAudio_HasControlProperty: no address");
-	
-	//	Note that for each object, this driver implements all the required properties plus a few
-	//	extras that are useful but not required. There is more detailed commentary about each
-	//	property in the SyncAudio_GetControlPropertyData() method.
-	switch(inObjectID)
-	{
-		case kObjectID_Volume_Input_Master:
-		case kObjectID_Volume_Output_Master:
-			switch(inAddress->mSelector)
-			{
-				case kAudioObjectPropertyBaseClass:
-				case kAudioObjectPropertyClass:
-				case kAudioObjectPropertyOwner:
-				case kAudioObjectPropertyOwnedObjects:
-				case kAudioControlPropertyScope:
-				case kAudioControlPropertyElement:
-				case kAudioLevelControlPropertyScalarValue:
-				case kAudioLevelControlPropertyDecibelValue:
-				case kAudioLevelControlPropertyDecibelRange:
-				case kAudioLevelControlPropertyConvertScalarToDecibels:
-				case kAudioLevelControlPropertyConvertDecibelsToScalar:
-					theAnswer = true;
-					break;
-			};
-			break;
-		
-		case kObjectID_Mute_Input_Master:
-		case kObjectID_Mute_Output_Master:
-			switch(inAddress->mSelector)
-			{
-				case kAudioObjectPropertyBaseClass:
-				case kAudioObjectPropertyClass:
-				case kAudioObjectPropertyOwner:
-				case kAudioObjectPropertyOwnedObjects:
-				case kAudioControlPropertyScope:
-				case kAudioControlPropertyElement:
-				case kAudioBooleanControlPropertyValue:
-					theAnswer = true;
-					break;
-			};
-			break;
-		
-		case kObjectID_DataSource_Input_Master:
-		case kObjectID_DataSource_Output_Master:
-		case kObjectID_DataDestination_PlayThru_Master:
-			switch(inAddress->mSelector)
-			{
-				case kAudioObjectPropertyBaseClass:
-				case kAudioObjectPropertyClass:
-				case kAudioObjectPropertyOwner:
-				case kAudioObjectPropertyOwnedObjects:
-				case kAudioControlPropertyScope:
-				case kAudioControlPropertyElement:
-				case kAudioSelectorControlPropertyCurrentItem:
-				case kAudioSelectorControlPropertyAvailableItems:
-				case kAudioSelectorControlPropertyItemName:
-					theAnswer = true;
-					break;
-			};
-			break;
-	};
-
-Done:
-	return theAnswer;
-}
-
-static OSStatus	SyncAudio_IsControlPropertySettable(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, Boolean* outIsSettable)
-{
-	//	This method returns whether or not the given property on the object can have its value
-	//	changed.
-	
-	#pragma unused(inClientProcessID)
-	
-	//	declare the local variables
-	OSStatus theAnswer = 0;
-	
-	//	check the arguments
-	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_IsControlPropertySettable: bad driver reference");
-	FailWithAction(inAddress == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_IsControlPropertySettable: no address");
-	FailWithAction(outIsSettable == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_IsControlPropertySettable: no place to put the return value");
-	
-	//	Note that for each object, this driver implements all the required properties plus a few
-	//	extras that are useful but not required. There is more detailed commentary about each
-	//	property in the SyncAudio_GetControlPropertyData() method.
-	switch(inObjectID)
-	{
-		case kObjectID_Volume_Input_Master:
-		case kObjectID_Volume_Output_Master:
-			switch(inAddress->mSelector)
-			{
-				case kAudioObjectPropertyBaseClass:
-				case kAudioObjectPropertyClass:
-				case kAudioObjectPropertyOwner:
-				case kAudioObjectPropertyOwnedObjects:
-				case kAudioControlPropertyScope:
-				case kAudioControlPropertyElement:
-				case kAudioLevelControlPropertyDecibelRange:
-				case kAudioLevelControlPropertyConvertScalarToDecibels:
-				case kAudioLevelControlPropertyConvertDecibelsToScalar:
-					*outIsSettable = false;
-					break;
-				
-				case kAudioLevelControlPropertyScalarValue:
-				case kAudioLevelControlPropertyDecibelValue:
-					*outIsSettable = true;
-					break;
-				
-				default:
-					theAnswer = kAudioHardwareUnknownPropertyError;
-					break;
-			};
-			break;
-		
-		case kObjectID_Mute_Input_Master:
-		case kObjectID_Mute_Output_Master:
-			switch(inAddress->mSelector)
-			{
-				case kAudioObjectPropertyBaseClass:
-				case kAudioObjectPropertyClass:
-				case kAudioObjectPropertyOwner:
-				case kAudioObjectPropertyOwnedObjects:
-				case kAudioControlPropertyScope:
-				case kAudioControlPropertyElement:
-					*outIsSettable = false;
-					break;
-				
-				case kAudioBooleanControlPropertyValue:
-					*outIsSettable = true;
-					break;
-				
-				default:
-					theAnswer = kAudioHardwareUnknownPropertyError;
-					break;
-			};
-			break;
-		
-		case kObjectID_DataSource_Input_Master:
-		case kObjectID_DataSource_Output_Master:
-		case kObjectID_DataDestination_PlayThru_Master:
-			switch(inAddress->mSelector)
-			{
-				case kAudioObjectPropertyBaseClass:
-				case kAudioObjectPropertyClass:
-				case kAudioObjectPropertyOwner:
-				case kAudioObjectPropertyOwnedObjects:
-				case kAudioControlPropertyScope:
-				case kAudioControlPropertyElement:
-				case kAudioSelectorControlPropertyAvailableItems:
-				case kAudioSelectorControlPropertyItemName:
-					*outIsSettable = false;
-					break;
-				
-				case kAudioSelectorControlPropertyCurrentItem:
-					*outIsSettable = true;
-					break;
-				
-				default:
-					theAnswer = kAudioHardwareUnknownPropertyError;
-					break;
-			};
-			break;
-				
+
 		default:
-			theAnswer = kAudioHardwareBadObjectError;
+			theAnswer = kAudioHardwareUnknownPropertyError;
 			break;
 	};
 
@@ -3222,166 +3415,133 @@ Done:
 	return theAnswer;
 }
 
-static OSStatus	SyncAudio_GetControlPropertyDataSize(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize, const void* inQualifierData, UInt32* outDataSize)
+static OSStatus	SyncAudio_SetStreamPropertyData(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize, const void* inQualifierData, UInt32 inDataSize, const void* inData, UInt32* outNumberPropertiesChanged, AudioObjectPropertyAddress outChangedAddresses[2])
 {
-	//	This method returns the byte size of the property's data.
-	
 	#pragma unused(inClientProcessID, inQualifierDataSize, inQualifierData)
 	
 	//	declare the local variables
 	OSStatus theAnswer = 0;
+	SyncAudioDevice* theDevice;
+	UInt32 theDeviceObject = kDeviceObject_Count;
+	SyncAudioDeviceState theState;
+	Float64 theOldSampleRate;
+	UInt32 theNewSampleFormat;
+	UInt64 theNewSampleRate;
 	
 	//	check the arguments
-	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetControlPropertyDataSize: bad driver reference");
-	FailWithAction(inAddress == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetControlPropertyDataSize: no address");
-	FailWithAction(outDataSize == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetControlPropertyDataSize: no place to put the return value");
+	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_SetStreamPropertyData: bad driver reference");
+	FailWithAction(inAddress == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_SetStreamPropertyData: no address");
+	FailWithAction(outNumberPropertiesChanged == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_SetStreamPropertyData: no place to return the number of properties that changed");
+	FailWithAction(outChangedAddresses == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_SetStreamPropertyData: no place to return the properties that changed");
+	theDevice = SyncAudio_FindDevice(inObjectID, &theDeviceObject);
+	FailWithAction((theDevice == NULL) || ((theDeviceObject != kDeviceObject_Stream_Input) && (theDeviceObject != kDeviceObject_Stream_Output)), theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_SetStreamPropertyData: not a stream object");
+	
+	//	initialize the returned number of changed properties
+	*outNumberPropertiesChanged = 0;
 	
 	//	Note that for each object, this driver implements all the required properties plus a few
 	//	extras that are useful but not required. There is more detailed commentary about each
-	//	property in the SyncAudio_GetControlPropertyData() method.
-	switch(inObjectID)
+	//	property in the SyncAudio_GetStreamPropertyData() method.
+	switch(inAddress->mSelector)
 	{
-		case kObjectID_Volume_Input_Master:
-		case kObjectID_Volume_Output_Master:
-			switch(inAddress->mSelector)
+		case kAudioStreamPropertyIsActive:
+			//	Changing the active state of a stream doesn't affect IO or change the structure
+			//	so we can just save the state and send the notification.
+			FailWithAction(inDataSize != sizeof(UInt32), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_SetStreamPropertyData: wrong size for the data for kAudioDevicePropertyNominalSampleRate");
+			pthread_mutex_lock(&gPlugIn_StateMutex);
+			if(theDeviceObject == kDeviceObject_Stream_Input)
 			{
-				case kAudioObjectPropertyBaseClass:
-					*outDataSize = sizeof(AudioClassID);
-					break;
-
-				case kAudioObjectPropertyClass:
-					*outDataSize = sizeof(AudioClassID);
-					break;
-
-				case kAudioObjectPropertyOwner:
-					*outDataSize = sizeof(AudioObjectID);
-					break;
-
-				case kAudioObjectPropertyOwnedObjects:
-					*outDataSize = 0 * sizeof(AudioObjectID);
-					break;
-
-				case kAudioControlPropertyScope:
-					*outDataSize = sizeof(AudioObjectPropertyScope);
-					break;
-
-				case kAudioControlPropertyElement:
-					*outDataSize = sizeof(AudioObjectPropertyElement);
-					break;
-
-				case kAudioLevelControlPropertyScalarValue:
-					*outDataSize = sizeof(Float32);
-					break;
-
-				case kAudioLevelControlPropertyDecibelValue:
-					*outDataSize = sizeof(Float32);
-					break;
-
-				case kAudioLevelControlPropertyDecibelRange:
-					*outDataSize = sizeof(AudioValueRange);
-					break;
-
-				case kAudioLevelControlPropertyConvertScalarToDecibels:
-					*outDataSize = sizeof(Float32);
-					break;
-
-				case kAudioLevelControlPropertyConvertDecibelsToScalar:
-					*outDataSize = sizeof(Float32);
-					break;
-
-				default:
-					theAnswer = kAudioHardwareUnknownPropertyError;
-					break;
-			};
+				if(theDevice->mStreamInputIsActive != (*((const UInt32*)inData) != 0))
+				{
+					theDevice->mStreamInputIsActive = *((const UInt32*)inData) != 0;
+					*outNumberPropertiesChanged = 1;
+					outChangedAddresses[0].mSelector = kAudioStreamPropertyIsActive;
+					outChangedAddresses[0].mScope = kAudioObjectPropertyScopeGlobal;
+					outChangedAddresses[0].mElement = kAudioObjectPropertyElementMain;
+				}
+			}
+			else
+			{
+				if(theDevice->mStreamOutputIsActive != (*((const UInt32*)inData) != 0))
+				{
+					theDevice->mStreamOutputIsActive = *((const UInt32*)inData) != 0;
+					*outNumberPropertiesChanged = 1;
+					outChangedAddresses[0].mSelector = kAudioStreamPropertyIsActive;
+					outChangedAddresses[0].mScope = kAudioObjectPropertyScopeGlobal;
+					outChangedAddresses[0].mElement = kAudioObjectPropertyElementMain;
+				}
+			}
+			pthread_mutex_unlock(&gPlugIn_StateMutex);
 			break;
-		
-		case kObjectID_Mute_Input_Master:
-		case kObjectID_Mute_Output_Master:
-			switch(inAddress->mSelector)
+			
+		case kAudioStreamPropertyVirtualFormat:
+		case kAudioStreamPropertyPhysicalFormat:
+			//	Changing the stream format needs to be handled via the
+			//	RequestConfigChange/PerformConfigChange machinery. Note that because this
+			//	device only supports its own number of channels and a 32 bit float virtual
+			//	format, setting the virtual format can only change the sample rate, while
+			//	setting the physical format can also change the sample format.
+			FailWithAction(inDataSize != sizeof(AudioStreamBasicDescription), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_SetStreamPropertyData: wrong size for the data for kAudioStreamPropertyPhysicalFormat");
+			FailWithAction(!SyncAudio_GetSampleFormat(theDevice, (const AudioStreamBasicDescription*)inData, &theNewSampleFormat), theAnswer = kAudioDeviceUnsupportedFormatError, Done, "SyncAudio_SetStreamPropertyData: unsupported format for kAudioStreamPropertyPhysicalFormat");
+			FailWithAction((inAddress->mSelector == kAudioStreamPropertyVirtualFormat) && (theNewSampleFormat != kDevice_SampleFormat_Float32), theAnswer = kAudioDeviceUnsupportedFormatError, Done, "SyncAudio_SetStreamPropertyData: unsupported format for kAudioStreamPropertyVirtualFormat");
+			FailWithAction(!SyncAudio_IsSupportedSampleRate(theDevice, ((const AudioStreamBasicDescription*)inData)->mSampleRate), theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_SetStreamPropertyData: unsupported sample rate for kAudioStreamPropertyPhysicalFormat");
+			
+			//	If we made it this far, the requested format is something we support, so make sure it is actually different
+			theState = SyncAudio_GetDeviceState(theDevice);
+			if(inAddress->mSelector == kAudioStreamPropertyVirtualFormat)
 			{
-				case kAudioObjectPropertyBaseClass:
-					*outDataSize = sizeof(AudioClassID);
-					break;
-
-				case kAudioObjectPropertyClass:
-					*outDataSize = sizeof(AudioClassID);
-					break;
-
-				case kAudioObjectPropertyOwner:
-					*outDataSize = sizeof(AudioObjectID);
-					break;
-
-				case kAudioObjectPropertyOwnedObjects:
-					*outDataSize = 0 * sizeof(AudioObjectID);
-					break;
-
-				case kAudioControlPropertyScope:
-					*outDataSize = sizeof(AudioObjectPropertyScope);
-					break;
-
-				case kAudioControlPropertyElement:
-					*outDataSize = sizeof(AudioObjectPropertyElement);
-					break;
-
-				case kAudioBooleanControlPropertyValue:
-					*outDataSize = sizeof(UInt32);
-					break;
-
-				default:
-					theAnswer = kAudioHardwareUnknownPropertyError;
-					break;
-			};
+				theNewSampleFormat = theState.mSampleFormat;
+			}
+			theOldSampleRate = theState.mSampleRate;
+			if((((const AudioStreamBasicDescription*)inData)->mSampleRate != theOldSampleRate) || (theNewSampleFormat != theState.mSampleFormat))
+			{
+				//	we dispatch this so that the change can happen asynchronously
+				theOldSampleRate = ((const AudioStreamBasicDescription*)inData)->mSampleRate;
+				theNewSampleRate = ((UInt64)theNewSampleFormat << 32) | (UInt64)theOldSampleRate;
+				dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{ gPlugIn_Host->RequestDeviceConfigurationChange(gPlugIn_Host, theDevice->mObjectID, theNewSampleRate, NULL); });
+			}
 			break;
 		
-		case kObjectID_DataSource_Input_Master:
-		case kObjectID_DataSource_Output_Master:
-		case kObjectID_DataDestination_PlayThru_Master:
-			switch(inAddress->mSelector)
-			{
-				case kAudioObjectPropertyBaseClass:
-					*outDataSize = sizeof(AudioClassID);
-					break;
-
-				case kAudioObjectPropertyClass:
-					*outDataSize = sizeof(AudioClassID);
-					break;
-
-				case kAudioObjectPropertyOwner:
-					*outDataSize = sizeof(AudioObjectID);
-					break;
-
-				case kAudioObjectPropertyOwnedObjects:
-					*outDataSize = 0 * sizeof(AudioObjectID);
-					break;
-
-				case kAudioControlPropertyScope:
-					*outDataSize = sizeof(AudioObjectPropertyScope);
-					break;
-
-				case kAudioControlPropertyElement:
-					*outDataSize = sizeof(AudioObjectPropertyElement);
-					break;
-
-				case kAudioSelectorControlPropertyCurrentItem:
-					*outDataSize = sizeof(UInt32);
-					break;
+		default:
+			theAnswer = kAudioHardwareUnknownPropertyError;
+			break;
+	};
 
-				case kAudioSelectorControlPropertyAvailableItems:
-					*outDataSize = kDataSource_NumberItems * sizeof(UInt32);
-					break;
+Done:
+	return theAnswer;
+}
 
-				case kAudioSelectorControlPropertyItemName:
-					*outDataSize = sizeof(CFStringRef);
-					break;
+#pragma mark Control Property Operations
 
-				default:
-					theAnswer = kAudioHardwareUnknownPropertyError;
-					break;
-			};
+static OSStatus	SyncAudio_GetControlPropertyDataSize(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID, const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize, const void* inQualifierData, UInt32* outDataSize)
+{
+	//	This method returns the byte size of the property's data.
+	
+	#pragma unused(inClientProcessID, inQualifierDataSize, inQualifierData)
+	
+	//	declare the local variables
+	OSStatus theAnswer = 0;
+	SyncAudioDevice* theDevice;
+	UInt32 theDeviceObject = kDeviceObject_Count;
+	
+	//	check the arguments
+	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetControlPropertyDataSize: bad driver reference");
+	FailWithAction(inAddress == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetControlPropertyDataSize: no address");
+	FailWithAction(outDataSize == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetControlPropertyDataSize: no place to put the return value");
+	theDevice = SyncAudio_FindDevice(inObjectID, &theDeviceObject);
+	FailWithAction((theDevice == NULL) || (theDeviceObject < kDeviceObject_Volume_Input_Master) || (theDeviceObject == kDeviceObject_Stream_Output), theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetControlPropertyDataSize: not a control object");
+	
+	//	Only the properties whose size depends on the state or on the address get here. The
+	//	registry has the sizes of the rest. There is more detailed commentary about each property
+	//	in the SyncAudio_GetControlPropertyData() method.
+	switch(inAddress->mSelector)
+	{
+		case kAudioSelectorControlPropertyAvailableItems:
+			*outDataSize = kDataSource_NumberItems * sizeof(UInt32);
 			break;
-				
+			
 		default:
-			theAnswer = kAudioHardwareBadObjectError;
+			theAnswer = kAudioHardwareUnknownPropertyError;
 			break;
 	};
 
@@ -3395,24 +3555,29 @@ static OSStatus	SyncAudio_GetControlPropertyData(AudioServerPlugInDriverRef inDr
 	
 	//	declare the local variables
 	OSStatus theAnswer = 0;
+	SyncAudioDevice* theDevice;
+	UInt32 theDeviceObject = kDeviceObject_Count;
 	UInt32 theNumberItemsToFetch;
 	UInt32 theItemIndex;
+	SyncAudioDeviceState theState;
 	
 	//	check the arguments
 	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetControlPropertyData: bad driver reference");
 	FailWithAction(inAddress == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetControlPropertyData: no address");
 	FailWithAction(outDataSize == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetControlPropertyData: no place to put the return value size");
 	FailWithAction(outData == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_GetControlPropertyData: no place to put the return value");
+	theDevice = SyncAudio_FindDevice(inObjectID, &theDeviceObject);
+	FailWithAction((theDevice == NULL) || (theDeviceObject < kDeviceObject_Volume_Input_Master) || (theDeviceObject == kDeviceObject_Stream_Output), theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetControlPropertyData: not a control object");
 	
 	//	Note that for each object, this driver implements all the required properties plus a few
 	//	extras that are useful but not required.
 	//
 	//	Also, since most of the data that will get returned is static, there are few instances where
 	//	it is necessary to lock the state mutex.
-	switch(inObjectID)
+	switch(theDeviceObject)
 	{
-		case kObjectID_Volume_Input_Master:
-		case kObjectID_Volume_Output_Master:
+		case kDeviceObject_Volume_Input_Master:
+		case kDeviceObject_Volume_Output_Master:
 			switch(inAddress->mSelector)
 			{
 				case kAudioObjectPropertyBaseClass:
@@ -3432,7 +3597,7 @@ static OSStatus	SyncAudio_GetControlPropertyData(AudioServerPlugInDriverRef inDr
 				case kAudioObjectPropertyOwner:
 					//	The control's owner is the device object
 					FailWithAction(inDataSize < sizeof(AudioObjectID), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetControlPropertyData: not enough space for the return value of kAudioObjectPropertyOwner for the volume control");
-					*((AudioObjectID*)outData) = kObjectID_Device;
+					*((AudioObjectID*)outData) = theDevice->mObjectID;
 					*outDataSize = sizeof(AudioObjectID);
 					break;
 					
@@ -3444,7 +3609,7 @@ static OSStatus	SyncAudio_GetControlPropertyData(AudioServerPlugInDriverRef inDr
 				case kAudioControlPropertyScope:
 					//	This property returns the scope that the control is attached to.
 					FailWithAction(inDataSize < sizeof(AudioObjectPropertyScope), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetControlPropertyData: not enough space for the return value of kAudioControlPropertyScope for the volume control");
-					*((AudioObjectPropertyScope*)outData) = (inObjectID == kObjectID_Volume_Input_Master) ? kAudioObjectPropertyScopeInput : kAudioObjectPropertyScopeOutput;
+					*((AudioObjectPropertyScope*)outData) = (theDeviceObject == kDeviceObject_Volume_Input_Master) ? kAudioObjectPropertyScopeInput : kAudioObjectPropertyScopeOutput;
 					*outDataSize = sizeof(AudioObjectPropertyScope);
 					break;
 
@@ -3457,21 +3622,17 @@ static OSStatus	SyncAudio_GetControlPropertyData(AudioServerPlugInDriverRef inDr
 
 				case kAudioLevelControlPropertyScalarValue:
 					//	This returns the value of the control in the normalized range of 0 to 1.
-					//	Note that we need to take the state lock to examine the value.
 					FailWithAction(inDataSize < sizeof(Float32), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetControlPropertyData: not enough space for the return value of kAudioLevelControlPropertyScalarValue for the volume control");
-					pthread_mutex_lock(&gPlugIn_StateMutex);
-					*((Float32*)outData) = (inObjectID == kObjectID_Volume_Input_Master) ? gVolume_Input_Master_Value : gVolume_Output_Master_Value;
-					pthread_mutex_unlock(&gPlugIn_StateMutex);
+					theState = SyncAudio_GetDeviceState(theDevice);
+					*((Float32*)outData) = (theDeviceObject == kDeviceObject_Volume_Input_Master) ? theState.mInputVolume : theState.mOutputVolume;
 					*outDataSize = sizeof(Float32);
 					break;
 
 				case kAudioLevelControlPropertyDecibelValue:
 					//	This returns the dB value of the control.
-					//	Note that we need to take the state lock to examine the value.
 					FailWithAction(inDataSize < sizeof(Float32), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetControlPropertyData: not enough space for the return value of kAudioLevelControlPropertyDecibelValue for the volume control");
-					pthread_mutex_lock(&gPlugIn_StateMutex);
-					*((Float32*)outData) = (inObjectID == kObjectID_Volume_Input_Master) ? gVolume_Input_Master_Value : gVolume_Output_Master_Value;
-					pthread_mutex_unlock(&gPlugIn_StateMutex);
+					theState = SyncAudio_GetDeviceState(theDevice);
+					*((Float32*)outData) = (theDeviceObject == kDeviceObject_Volume_Input_Master) ? theState.mInputVolume : theState.mOutputVolume;
 					
 					//	Note that we square the scalar value before converting to dB so as to
 					//	provide a better curve for the slider
@@ -3543,8 +3704,8 @@ static OSStatus	SyncAudio_GetControlPropertyData(AudioServerPlugInDriverRef inDr
 			};
 			break;
 		
-		case kObjectID_Mute_Input_Master:
-		case kObjectID_Mute_Output_Master:
+		case kDeviceObject_Mute_Input_Master:
+		case kDeviceObject_Mute_Output_Master:
 			switch(inAddress->mSelector)
 			{
 				case kAudioObjectPropertyBaseClass:
@@ -3564,7 +3725,7 @@ static OSStatus	SyncAudio_GetControlPropertyData(AudioServerPlugInDriverRef inDr
 				case kAudioObjectPropertyOwner:
 					//	The control's owner is the device object
 					FailWithAction(inDataSize < sizeof(AudioObjectID), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetControlPropertyData: not enough space for the return value of kAudioObjectPropertyOwner for the mute control");
-					*((AudioObjectID*)outData) = kObjectID_Device;
+					*((AudioObjectID*)outData) = theDevice->mObjectID;
 					*outDataSize = sizeof(AudioObjectID);
 					break;
 					
@@ -3576,7 +3737,7 @@ static OSStatus	SyncAudio_GetControlPropertyData(AudioServerPlugInDriverRef inDr
 				case kAudioControlPropertyScope:
 					//	This property returns the scope that the control is attached to.
 					FailWithAction(inDataSize < sizeof(AudioObjectPropertyScope), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetControlPropertyData: not enough space for the return value of kAudioControlPropertyScope for the mute control");
-					*((AudioObjectPropertyScope*)outData) = (inObjectID == kObjectID_Mute_Input_Master) ? kAudioObjectPropertyScopeInput : kAudioObjectPropertyScopeOutput;
+					*((AudioObjectPropertyScope*)outData) = (theDeviceObject == kDeviceObject_Mute_Input_Master) ? kAudioObjectPropertyScopeInput : kAudioObjectPropertyScopeOutput;
 					*outDataSize = sizeof(AudioObjectPropertyScope);
 					break;
 
@@ -3590,11 +3751,9 @@ static OSStatus	SyncAudio_GetControlPropertyData(AudioServerPlugInDriverRef inDr
 				case kAudioBooleanControlPropertyValue:
 					//	This returns the value of the mute control where 0 means that mute is off
 					//	and audio can be heard and 1 means that mute is on and audio cannot be heard.
-					//	Note that we need to take the state lock to examine this value.
 					FailWithAction(inDataSize < sizeof(UInt32), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetControlPropertyData: not enough space for the return value of kAudioBooleanControlPropertyValue for the mute control");
-					pthread_mutex_lock(&gPlugIn_StateMutex);
-					*((UInt32*)outData) = (inObjectID == kObjectID_Mute_Input_Master) ? (gMute_Input_Master_Value ? 1 : 0) : (gMute_Output_Master_Value ? 1 : 0);
-					pthread_mutex_unlock(&gPlugIn_StateMutex);
+					theState = SyncAudio_GetDeviceState(theDevice);
+					*((UInt32*)outData) = (theDeviceObject == kDeviceObject_Mute_Input_Master) ? (theState.mInputMute ? 1 : 0) : (theState.mOutputMute ? 1 : 0);
 					*outDataSize = sizeof(UInt32);
 					break;
 
@@ -3604,9 +3763,9 @@ static OSStatus	SyncAudio_GetControlPropertyData(AudioServerPlugInDriverRef inDr
 			};
 			break;
 		
-		case kObjectID_DataSource_Input_Master:
-		case kObjectID_DataSource_Output_Master:
-		case kObjectID_DataDestination_PlayThru_Master:
+		case kDeviceObject_DataSource_Input_Master:
+		case kDeviceObject_DataSource_Output_Master:
+		case kDeviceObject_DataDestination_PlayThru_Master:
 			switch(inAddress->mSelector)
 			{
 				case kAudioObjectPropertyBaseClass:
@@ -3620,14 +3779,14 @@ static OSStatus	SyncAudio_GetControlPropertyData(AudioServerPlugInDriverRef inDr
 					//	Data Source controls are of the class, kAudioDataSourceControlClassID
 					FailWithAction(inDataSize < sizeof(AudioClassID), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetControlPropertyData: not enough space for the return value of kAudioObjectPropertyClass for the data source control");
 					*((AudioClassID*)outData) = kAudioDataSourceControlClassID;
-					switch(inObjectID)
+					switch(theDeviceObject)
 					{
-						case kObjectID_DataSource_Input_Master:
-						case kObjectID_DataSource_Output_Master:
+						case kDeviceObject_DataSource_Input_Master:
+						case kDeviceObject_DataSource_Output_Master:
 							*((AudioClassID*)outData) = kAudioDataSourceControlClassID;
 							break;
 							
-						case kObjectID_DataDestination_PlayThru_Master:
+						case kDeviceObject_DataDestination_PlayThru_Master:
 							*((AudioClassID*)outData) = kAudioDataDestinationControlClassID;
 							break;
 							
@@ -3638,7 +3797,7 @@ static OSStatus	SyncAudio_GetControlPropertyData(AudioServerPlugInDriverRef inDr
 				case kAudioObjectPropertyOwner:
 					//	The control's owner is the device object
 					FailWithAction(inDataSize < sizeof(AudioObjectID), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetControlPropertyData: not enough space for the return value of kAudioObjectPropertyOwner for the data source control");
-					*((AudioObjectID*)outData) = kObjectID_Device;
+					*((AudioObjectID*)outData) = theDevice->mObjectID;
 					*outDataSize = sizeof(AudioObjectID);
 					break;
 					
@@ -3650,17 +3809,17 @@ static OSStatus	SyncAudio_GetControlPropertyData(AudioServerPlugInDriverRef inDr
 				case kAudioControlPropertyScope:
 					//	This property returns the scope that the control is attached to.
 					FailWithAction(inDataSize < sizeof(AudioObjectPropertyScope), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetControlPropertyData: not enough space for the return value of kAudioControlPropertyScope for the data source control");
-					switch(inObjectID)
+					switch(theDeviceObject)
 					{
-						case kObjectID_DataSource_Input_Master:
+						case kDeviceObject_DataSource_Input_Master:
 							*((AudioObjectPropertyScope*)outData) = kAudioObjectPropertyScopeInput;
 							break;
 							
-						case kObjectID_DataSource_Output_Master:
+						case kDeviceObject_DataSource_Output_Master:
 							*((AudioObjectPropertyScope*)outData) = kAudioObjectPropertyScopeOutput;
 							break;
 							
-						case kObjectID_DataDestination_PlayThru_Master:
+						case kDeviceObject_DataDestination_PlayThru_Master:
 							*((AudioObjectPropertyScope*)outData) = kAudioObjectPropertyScopePlayThrough;
 							break;
 							
@@ -3677,25 +3836,23 @@ static OSStatus	SyncAudio_GetControlPropertyData(AudioServerPlugInDriverRef inDr
 
 				case kAudioSelectorControlPropertyCurrentItem:
 					//	This returns the value of the data source selector.
-					//	Note that we need to take the state lock to examine this value.
 					FailWithAction(inDataSize < sizeof(UInt32), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_GetControlPropertyData: not enough space for the return value of kAudioSelectorControlPropertyCurrentItem for the data source control");
-					pthread_mutex_lock(&gPlugIn_StateMutex);
-					switch(inObjectID)
+					theState = SyncAudio_GetDeviceState(theDevice);
+					switch(theDeviceObject)
 					{
-						case kObjectID_DataSource_Input_Master:
-							*((UInt32*)outData) = gDataSource_Input_Master_Value;
+						case kDeviceObject_DataSource_Input_Master:
+							*((UInt32*)outData) = theState.mInputDataSource;
 							break;
 							
-						case kObjectID_DataSource_Output_Master:
-							*((UInt32*)outData) = gDataSource_Output_Master_Value;
+						case kDeviceObject_DataSource_Output_Master:
+							*((UInt32*)outData) = theState.mOutputDataSource;
 							break;
 							
-						case kObjectID_DataDestination_PlayThru_Master:
-							*((UInt32*)outData) = gDataDestination_PlayThru_Master_Value;
+						case kDeviceObject_DataDestination_PlayThru_Master:
+							*((UInt32*)outData) = theState.mPlayThruDestination;
 							break;
 							
 					};
-					pthread_mutex_unlock(&gPlugIn_StateMutex);
 					*outDataSize = sizeof(UInt32);
 					break;
 
@@ -3753,13 +3910,18 @@ static OSStatus	SyncAudio_SetControlPropertyData(AudioServerPlugInDriverRef inDr
 	
 	//	declare the local variables
 	OSStatus theAnswer = 0;
+	SyncAudioDevice* theDevice;
+	UInt32 theDeviceObject = kDeviceObject_Count;
 	Float32 theNewVolume;
+	SyncAudioDeviceState theState;
 	
 	//	check the arguments
 	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_SetControlPropertyData: bad driver reference");
 	FailWithAction(inAddress == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_SetControlPropertyData: no address");
 	FailWithAction(outNumberPropertiesChanged == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_SetControlPropertyData: no place to return the number of properties that changed");
 	FailWithAction(outChangedAddresses == NULL, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_SetControlPropertyData: no place to return the properties that changed");
+	theDevice = SyncAudio_FindDevice(inObjectID, &theDeviceObject);
+	FailWithAction((theDevice == NULL) || (theDeviceObject < kDeviceObject_Volume_Input_Master) || (theDeviceObject == kDeviceObject_Stream_Output), theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_SetControlPropertyData: not a control object");
 	
 	//	initialize the returned number of changed properties
 	*outNumberPropertiesChanged = 0;
@@ -3767,10 +3929,10 @@ static OSStatus	SyncAudio_SetControlPropertyData(AudioServerPlugInDriverRef inDr
 	//	Note that for each object, this driver implements all the required properties plus a few
 	//	extras that are useful but not required. There is more detailed commentary about each
 	//	property in the SyncAudio_GetControlPropertyData() method.
-	switch(inObjectID)
+	switch(theDeviceObject)
 	{
-		case kObjectID_Volume_Input_Master:
-		case kObjectID_Volume_Output_Master:
+		case kDeviceObject_Volume_Input_Master:
+		case kDeviceObject_Volume_Output_Master:
 			switch(inAddress->mSelector)
 			{
 				case kAudioLevelControlPropertyScalarValue:
@@ -3787,11 +3949,13 @@ static OSStatus	SyncAudio_SetControlPropertyData(AudioServerPlugInDriverRef inDr
 						theNewVolume = 1.0;
 					}
 					pthread_mutex_lock(&gPlugIn_StateMutex);
-					if(inObjectID == kObjectID_Volume_Input_Master)
+					theState = SyncAudio_GetDeviceState(theDevice);
+					if(theDeviceObject == kDeviceObject_Volume_Input_Master)
 					{
-						if(gVolume_Input_Master_Value != theNewVolume)
+						if(theState.mInputVolume != theNewVolume)
 						{
-							gVolume_Input_Master_Value = theNewVolume;
+							theState.mInputVolume = theNewVolume;
+							SyncAudioState_Publish(&theDevice->mState, &theState);
 							*outNumberPropertiesChanged = 2;
 							outChangedAddresses[0].mSelector = kAudioLevelControlPropertyScalarValue;
 							outChangedAddresses[0].mScope = kAudioObjectPropertyScopeGlobal;
@@ -3803,9 +3967,10 @@ static OSStatus	SyncAudio_SetControlPropertyData(AudioServerPlugInDriverRef inDr
 					}
 					else
 					{
-						if(gVolume_Output_Master_Value != theNewVolume)
+						if(theState.mOutputVolume != theNewVolume)
 						{
-							gVolume_Output_Master_Value = theNewVolume;
+							theState.mOutputVolume = theNewVolume;
+							SyncAudioState_Publish(&theDevice->mState, &theState);
 							*outNumberPropertiesChanged = 2;
 							outChangedAddresses[0].mSelector = kAudioLevelControlPropertyScalarValue;
 							outChangedAddresses[0].mScope = kAudioObjectPropertyScopeGlobal;
@@ -3838,11 +4003,13 @@ static OSStatus	SyncAudio_SetControlPropertyData(AudioServerPlugInDriverRef inDr
 					theNewVolume /= kVolume_MaxDB - kVolume_MinDB;
 					theNewVolume = sqrtf(theNewVolume);
 					pthread_mutex_lock(&gPlugIn_StateMutex);
-					if(inObjectID == kObjectID_Volume_Input_Master)
+					theState = SyncAudio_GetDeviceState(theDevice);
+					if(theDeviceObject == kDeviceObject_Volume_Input_Master)
 					{
-						if(gVolume_Input_Master_Value != theNewVolume)
+						if(theState.mInputVolume != theNewVolume)
 						{
-							gVolume_Input_Master_Value = theNewVolume;
+							theState.mInputVolume = theNewVolume;
+							SyncAudioState_Publish(&theDevice->mState, &theState);
 							*outNumberPropertiesChanged = 2;
 							outChangedAddresses[0].mSelector = kAudioLevelControlPropertyScalarValue;
 							outChangedAddresses[0].mScope = kAudioObjectPropertyScopeGlobal;
@@ -3854,9 +4021,10 @@ static OSStatus	SyncAudio_SetControlPropertyData(AudioServerPlugInDriverRef inDr
 					}
 					else
 					{
-						if(gVolume_Output_Master_Value != theNewVolume)
+						if(theState.mOutputVolume != theNewVolume)
 						{
-							gVolume_Output_Master_Value = theNewVolume;
+							theState.mOutputVolume = theNewVolume;
+							SyncAudioState_Publish(&theDevice->mState, &theState);
 							*outNumberPropertiesChanged = 2;
 							outChangedAddresses[0].mSelector = kAudioLevelControlPropertyScalarValue;
 							outChangedAddresses[0].mScope = kAudioObjectPropertyScopeGlobal;
@@ -3875,18 +4043,20 @@ static OSStatus	SyncAudio_SetControlPropertyData(AudioServerPlugInDriverRef inDr
 			};
 			break;
 		
-		case kObjectID_Mute_Input_Master:
-		case kObjectID_Mute_Output_Master:
+		case kDeviceObject_Mute_Input_Master:
+		case kDeviceObject_Mute_Output_Master:
 			switch(inAddress->mSelector)
 			{
 				case kAudioBooleanControlPropertyValue:
 					FailWithAction(inDataSize != sizeof(UInt32), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_SetControlPropertyData: wrong size for the data for kAudioBooleanControlPropertyValue");
 					pthread_mutex_lock(&gPlugIn_StateMutex);
-					if(inObjectID == kObjectID_Mute_Input_Master)
+					theState = SyncAudio_GetDeviceState(theDevice);
+					if(theDeviceObject == kDeviceObject_Mute_Input_Master)
 					{
-						if(gMute_Input_Master_Value != (*((const UInt32*)inData) != 0))
+						if(theState.mInputMute != (*((const UInt32*)inData) != 0))
 						{
-							gMute_Input_Master_Value = *((const UInt32*)inData) != 0;
+							theState.mInputMute = *((const UInt32*)inData) != 0;
+							SyncAudioState_Publish(&theDevice->mState, &theState);
 							*outNumberPropertiesChanged = 1;
 							outChangedAddresses[0].mSelector = kAudioBooleanControlPropertyValue;
 							outChangedAddresses[0].mScope = kAudioObjectPropertyScopeGlobal;
@@ -3895,9 +4065,10 @@ static OSStatus	SyncAudio_SetControlPropertyData(AudioServerPlugInDriverRef inDr
 					}
 					else
 					{
-						if(gMute_Output_Master_Value != (*((const UInt32*)inData) != 0))
+						if(theState.mOutputMute != (*((const UInt32*)inData) != 0))
 						{
-							gMute_Output_Master_Value = *((const UInt32*)inData) != 0;
+							theState.mOutputMute = *((const UInt32*)inData) != 0;
+							SyncAudioState_Publish(&theDevice->mState, &theState);
 							*outNumberPropertiesChanged = 1;
 							outChangedAddresses[0].mSelector = kAudioBooleanControlPropertyValue;
 							outChangedAddresses[0].mScope = kAudioObjectPropertyScopeGlobal;
@@ -3913,9 +4084,9 @@ static OSStatus	SyncAudio_SetControlPropertyData(AudioServerPlugInDriverRef inDr
 			};
 			break;
 		
-		case kObjectID_DataSource_Input_Master:
-		case kObjectID_DataSource_Output_Master:
-		case kObjectID_DataDestination_PlayThru_Master:
+		case kDeviceObject_DataSource_Input_Master:
+		case kDeviceObject_DataSource_Output_Master:
+		case kDeviceObject_DataDestination_PlayThru_Master:
 			switch(inAddress->mSelector)
 			{
 				case kAudioSelectorControlPropertyCurrentItem:
@@ -3924,13 +4095,15 @@ static OSStatus	SyncAudio_SetControlPropertyData(AudioServerPlugInDriverRef inDr
 					FailWithAction(inDataSize != sizeof(UInt32), theAnswer = kAudioHardwareBadPropertySizeError, Done, "SyncAudio_SetControlPropertyData: wrong size for the data for kAudioSelectorControlPropertyCurrentItem");
 					FailWithAction(*((const UInt32*)inData) >= kDataSource_NumberItems, theAnswer = kAudioHardwareIllegalOperationError, Done, "SyncAudio_SetControlPropertyData: requested item not in available items list for kAudioSelectorControlPropertyCurrentItem");
 					pthread_mutex_lock(&gPlugIn_StateMutex);
-					switch(inObjectID)
+					theState = SyncAudio_GetDeviceState(theDevice);
+					switch(theDeviceObject)
 					{
-						case kObjectID_DataSource_Input_Master:
+						case kDeviceObject_DataSource_Input_Master:
 							{
-								if(gDataSource_Input_Master_Value != *((const UInt32*)inData))
+								if(theState.mInputDataSource != *((const UInt32*)inData))
 								{
-									gDataSource_Input_Master_Value = *((const UInt32*)inData);
+									theState.mInputDataSource = *((const UInt32*)inData);
+									SyncAudioState_Publish(&theDevice->mState, &theState);
 									*outNumberPropertiesChanged = 1;
 									outChangedAddresses[0].mSelector = kAudioSelectorControlPropertyCurrentItem;
 									outChangedAddresses[0].mScope = kAudioObjectPropertyScopeGlobal;
@@ -3939,11 +4112,12 @@ static OSStatus	SyncAudio_SetControlPropertyData(AudioServerPlugInDriverRef inDr
 							}
 							break;
 							
-						case kObjectID_DataSource_Output_Master:
+						case kDeviceObject_DataSource_Output_Master:
 							{
-								if(gDataSource_Output_Master_Value != *((const UInt32*)inData))
+								if(theState.mOutputDataSource != *((const UInt32*)inData))
 								{
-									gDataSource_Output_Master_Value = *((const UInt32*)inData);
+									theState.mOutputDataSource = *((const UInt32*)inData);
+									SyncAudioState_Publish(&theDevice->mState, &theState);
 									*outNumberPropertiesChanged = 1;
 									outChangedAddresses[0].mSelector = kAudioSelectorControlPropertyCurrentItem;
 									outChangedAddresses[0].mScope = kAudioObjectPropertyScopeGlobal;
@@ -3952,11 +4126,12 @@ static OSStatus	SyncAudio_SetControlPropertyData(AudioServerPlugInDriverRef inDr
 							}
 							break;
 							
-						case kObjectID_DataDestination_PlayThru_Master:
+						case kDeviceObject_DataDestination_PlayThru_Master:
 							{
-								if(gDataDestination_PlayThru_Master_Value != *((const UInt32*)inData))
+								if(theState.mPlayThruDestination != *((const UInt32*)inData))
 								{
-									gDataDestination_PlayThru_Master_Value = *((const UInt32*)inData);
+									theState.mPlayThruDestination = *((const UInt32*)inData);
+									SyncAudioState_Publish(&theDevice->mState, &theState);
 									*outNumberPropertiesChanged = 1;
 									outChangedAddresses[0].mSelector = kAudioSelectorControlPropertyCurrentItem;
 									outChangedAddresses[0].mScope = kAudioObjectPropertyScopeGlobal;
@@ -3997,38 +4172,44 @@ static OSStatus	SyncAudio_StartIO(AudioServerPlugInDriverRef inDriver, AudioObje
 	
 	//	declare the local variables
 	OSStatus theAnswer = 0;
+	SyncAudioDevice* theDevice;
 	
 	//	check the arguments
 	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_StartIO: bad driver reference");
-	FailWithAction(inDeviceObjectID != kObjectID_Device, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_StartIO: bad device ID");
+	theDevice = SyncAudio_FindDevice(inDeviceObjectID, NULL);
+	FailWithAction((theDevice == NULL) || (theDevice->mObjectID != inDeviceObjectID), theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_StartIO: bad device ID");
 
 	//	we need to hold the state lock
 	pthread_mutex_lock(&gPlugIn_StateMutex);
 	
 	//	figure out what we need to do
-	if(gDevice_IOIsRunning == UINT64_MAX)
+	if(theDevice->mIOIsRunning == UINT64_MAX)
 	{
 		//	overflowing is an error
 		theAnswer = kAudioHardwareIllegalOperationError;
 	}
-	else if(gDevice_IOIsRunning == 0)
+	else if(theDevice->mIOIsRunning == 0)
 	{
 		//	We need to start the hardware, which in this case is just anchoring the time line.
-		gDevice_IOIsRunning = 1;
-		gDevice_NumberTimeStamps = 0;
-		gDevice_AnchorSampleTime = 0;
-		gDevice_AnchorHostTime = mach_absolute_time();
-        gRingBuffer = calloc(kRing_Buffer_Frame_Size * 2, sizeof(Float32));
+		theDevice->mIOIsRunning = 1;
+		SyncAudioEngine_StartIO(&theDevice->mEngine);
+        atomic_store_explicit(&theDevice->mIOOperations, 0, memory_order_relaxed);
+        atomic_store_explicit(&theDevice->mIOPageFaults, 0, memory_order_relaxed);
 	}
 	else
 	{
 		//	IO is already running, so just bump the counter
-		++gDevice_IOIsRunning;
+		++theDevice->mIOIsRunning;
 	}
 	
+	UInt64 theNumberClients = theDevice->mIOIsRunning;
+	
 	//	unlock the state lock
 	pthread_mutex_unlock(&gPlugIn_StateMutex);
 	
+	UInt64 theHostTime = SyncAudioEngine_GetHostTime(&theDevice->mEngine);
+	SyncAudio_Trace(kSyncAudioTrace_StartIO, inDeviceObjectID, theHostTime, theHostTime, theNumberClients, 0);
+	
 Done:
 	return theAnswer;
 }
@@ -4042,35 +4223,41 @@ static OSStatus	SyncAudio_StopIO(AudioServerPlugInDriverRef inDriver, AudioObjec
 	
 	//	declare the local variables
 	OSStatus theAnswer = 0;
+	SyncAudioDevice* theDevice;
 	
 	//	check the arguments
 	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_StopIO: bad driver reference");
-	FailWithAction(inDeviceObjectID != kObjectID_Device, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_StopIO: bad device ID");
+	theDevice = SyncAudio_FindDevice(inDeviceObjectID, NULL);
+	FailWithAction((theDevice == NULL) || (theDevice->mObjectID != inDeviceObjectID), theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_StopIO: bad device ID");
 
 	//	we need to hold the state lock
 	pthread_mutex_lock(&gPlugIn_StateMutex);
 	
 	//	figure out what we need to do
-	if(gDevice_IOIsRunning == 0)
+	if(theDevice->mIOIsRunning == 0)
 	{
 		//	underflowing is an error
 		theAnswer = kAudioHardwareIllegalOperationError;
 	}
-	else if(gDevice_IOIsRunning == 1)
+	else if(theDevice->mIOIsRunning == 1)
 	{
 		//	We need to stop the hardware, which in this case means that there's nothing to do.
-		gDevice_IOIsRunning = 0;
-        free(gRingBuffer);
+		theDevice->mIOIsRunning = 0;
 	}
 	else
 	{
 		//	IO is still running, so just bump the counter
-		--gDevice_IOIsRunning;
+		--theDevice->mIOIsRunning;
 	}
 	
+	UInt64 theNumberClients = theDevice->mIOIsRunning;
+	
 	//	unlock the state lock
 	pthread_mutex_unlock(&gPlugIn_StateMutex);
 	
+	UInt64 theHostTime = SyncAudioEngine_GetHostTime(&theDevice->mEngine);
+	SyncAudio_Trace(kSyncAudioTrace_StopIO, inDeviceObjectID, theHostTime, theHostTime, theNumberClients, 0);
+	
 Done:
 	return theAnswer;
 }
@@ -4083,46 +4270,25 @@ static OSStatus	SyncAudio_GetZeroTimeStamp(AudioServerPlugInDriverRef inDriver,
 	//	kAudioDevicePropertyZeroTimeStampPeriod apart. This is often modeled using a ring buffer
 	//	where the zero time stamp is updated when wrapping around the ring buffer.
 	//
-	//	For this device, the zero time stamps' sample time increments every kDevice_RingBufferSize
-	//	frames and the host time increments by kDevice_RingBufferSize * gDevice_HostTicksPerFrame.
+	//	For this device, the zero time stamps' sample time increments every kDevice_ZeroTimeStampPeriod
+	//	frames and the host time increments by kDevice_ZeroTimeStampPeriod host ticks per frame, all of
+	//	which the device's engine works out without taking a lock. The seed changes whenever the
+	//	time line starts over, which is when IO starts and when the IO thread has fallen so far
+	//	behind that the time stamps skip ahead to catch up, so that the HAL re-anchors to it.
 	
 	#pragma unused(inClientID)
 	
 	//	declare the local variables
 	OSStatus theAnswer = 0;
-	UInt64 theCurrentHostTime;
-	Float64 theHostTicksPerRingBuffer;
-	Float64 theHostTickOffset;
-	UInt64 theNextHostTime;
+	SyncAudioDevice* theDevice;
 	
 	//	check the arguments
 	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetZeroTimeStamp: bad driver reference");
-	FailWithAction(inDeviceObjectID != kObjectID_Device, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetZeroTimeStamp: bad device ID");
+	theDevice = SyncAudio_FindDevice(inDeviceObjectID, NULL);
+	FailWithAction((theDevice == NULL) || (theDevice->mObjectID != inDeviceObjectID), theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_GetZeroTimeStamp: bad device ID");
 
-	//	we need to hold the locks
-	pthread_mutex_lock(&gDevice_IOMutex);
-	
-	//	get the current host time
-	theCurrentHostTime = mach_absolute_time();
-	
-	//	calculate the next host time
-	theHostTicksPerRingBuffer = gDevice_HostTicksPerFrame * ((Float64)kDevice_RingBufferSize);
-	theHostTickOffset = ((Float64)(gDevice_NumberTimeStamps + 1)) * theHostTicksPerRingBuffer;
-	theNextHostTime = gDevice_AnchorHostTime + ((UInt64)theHostTickOffset);
-	
-	//	go to the next time if the next host time is less than the current time
-	if(theNextHostTime <= theCurrentHostTime)
-	{
-		++gDevice_NumberTimeStamps;
-	}
-	
 	//	set the return values
-	*outSampleTime = gDevice_NumberTimeStamps * kDevice_RingBufferSize;
-	*outHostTime = gDevice_AnchorHostTime + (((Float64)gDevice_NumberTimeStamps) * theHostTicksPerRingBuffer);
-	*outSeed = 1;
-	
-	//	unlock the state lock
-	pthread_mutex_unlock(&gDevice_IOMutex);
+	SyncAudioEngine_GetZeroTimeStamp(&theDevice->mEngine, outSampleTime, outHostTime, outSeed);
 	
 Done:
 	return theAnswer;
@@ -4131,16 +4297,19 @@ Done:
 static OSStatus	SyncAudio_WillDoIOOperation(AudioServerPlugInDriverRef inDriver, AudioObjectID inDeviceObjectID, UInt32 inClientID, UInt32 inOperationID, Boolean* outWillDo, Boolean* outWillDoInPlace)
 {
 	//	This method returns whether or not the device will do a given IO operation. For this device,
-	//	we only support reading input data and writing output data.
-	
-	#pragma unused(inClientID)
+	//	we support reading input data and writing output data, plus processing the input and output
+	//	of the clients that are routed through another bus. With an integer physical format, we
+	//	also claim the conversions to and from it, which have nothing left to do.
 	
 	//	declare the local variables
 	OSStatus theAnswer = 0;
+	SyncAudioDevice* theDevice;
+	SyncAudioRoute* theRoute;
 	
 	//	check the arguments
 	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_WillDoIOOperation: bad driver reference");
-	FailWithAction(inDeviceObjectID != kObjectID_Device, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_WillDoIOOperation: bad device ID");
+	theDevice = SyncAudio_FindDevice(inDeviceObjectID, NULL);
+	FailWithAction((theDevice == NULL) || (theDevice->mObjectID != inDeviceObjectID), theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_WillDoIOOperation: bad device ID");
 
 	//	figure out if we support the operation
 	bool willDo = false;
@@ -4157,6 +4326,32 @@ static OSStatus	SyncAudio_WillDoIOOperation(AudioServerPlugInDriverRef inDriver,
 			willDoInPlace = true;
 			break;
 			
+		case kAudioServerPlugInIOOperationProcessInput:
+			theRoute = SyncAudioRouteTable_Find(&theDevice->mRoutes, inClientID);
+			willDo = (theRoute != NULL) && (theRoute->mInputBus != kSyncAudioEngine_MainBus);
+			willDoInPlace = true;
+			break;
+			
+		case kAudioServerPlugInIOOperationProcessOutput:
+			//	only the clients with a bus of their own or a level to apply, and the answer is kept
+			//	so that a level set later knows whether the HAL has to ask again
+			theRoute = SyncAudioRouteTable_Find(&theDevice->mRoutes, inClientID);
+			if(theRoute != NULL)
+			{
+				willDo = SyncAudioRoute_NeedsOutputProcessing(theRoute);
+				atomic_store_explicit(&theRoute->mProcessesOutput, willDo, memory_order_relaxed);
+			}
+			willDoInPlace = true;
+			break;
+			
+		case kAudioServerPlugInIOOperationConvertInput:
+		case kAudioServerPlugInIOOperationConvertOutput:
+			//	ReadInput leaves the input and WriteMix takes the mix in the physical format, so an
+			//	integer format has to be converted to and from the clients' floats
+			willDo = SyncAudio_GetDeviceState(theDevice).mSampleFormat != kDevice_SampleFormat_Float32;
+			willDoInPlace = true;
+			break;
+			
 	};
 	
 	//	fill out the return values
@@ -4182,10 +4377,12 @@ static OSStatus	SyncAudio_BeginIOOperation(AudioServerPlugInDriverRef inDriver,
 	
 	//	declare the local variables
 	OSStatus theAnswer = 0;
+	SyncAudioDevice* theDevice;
 	
 	//	check the arguments
 	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_BeginIOOperation: bad driver reference");
-	FailWithAction(inDeviceObjectID != kObjectID_Device, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_BeginIOOperation: bad device ID");
+	theDevice = SyncAudio_FindDevice(inDeviceObjectID, NULL);
+	FailWithAction((theDevice == NULL) || (theDevice->mObjectID != inDeviceObjectID), theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_BeginIOOperation: bad device ID");
 
 Done:
 	return theAnswer;
@@ -4193,70 +4390,118 @@ Done:
 
 static OSStatus	SyncAudio_DoIOOperation(AudioServerPlugInDriverRef inDriver, AudioObjectID inDeviceObjectID, AudioObjectID inStreamObjectID, UInt32 inClientID, UInt32 inOperationID, UInt32 inIOBufferFrameSize, const AudioServerPlugInIOCycleInfo* inIOCycleInfo, void* ioMainBuffer, void* ioSecondaryBuffer)
 {
-	//	This is called to actuall perform a given operation.
-    //-- For this device, all we need to do is	clear the buffer for the ReadInput operation.
-	//++ Alex will add defered audio here
-	#pragma unused(inClientID, inIOCycleInfo, ioSecondaryBuffer)
+	//	This is called to actuall perform a given operation. Data written by WriteMix is stored in
+	//	the ring at its output sample time and ReadInput plays it back through the delay line.
+	//	ProcessOutput and ProcessInput do the same for the clients routed through another bus.
+	//	ReadInput and WriteMix work in the physical format, and ConvertInput and ConvertOutput
+	//	convert between it and the clients' floats in place. ReadInput quantizes the input to the
+	//	physical format's resolution while it reads it, so packing it afterwards loses nothing.
+	#pragma unused(inIOCycleInfo, ioSecondaryBuffer)
 	
 	//	declare the local variables
 	OSStatus theAnswer = 0;
+	SyncAudioDevice* theDevice;
 	
 	//	check the arguments
 	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_DoIOOperation: bad driver reference");
-	FailWithAction(inDeviceObjectID != kObjectID_Device, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_DoIOOperation: bad device ID");
-	FailWithAction((inStreamObjectID != kObjectID_Stream_Input) && (inStreamObjectID != kObjectID_Stream_Output), theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_DoIOOperation: bad stream ID");
+	theDevice = SyncAudio_FindDevice(inDeviceObjectID, NULL);
+	FailWithAction((theDevice == NULL) || (theDevice->mObjectID != inDeviceObjectID), theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_DoIOOperation: bad device ID");
+	FailWithAction((inStreamObjectID != (theDevice->mObjectID + kDeviceObject_Stream_Input)) && (inStreamObjectID != (theDevice->mObjectID + kDeviceObject_Stream_Output)), theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_DoIOOperation: bad stream ID");
     
-    // Calculate the ring buffer offsets and splits.
-    UInt64 sampleTime;
-    if (inOperationID == kAudioServerPlugInIOOperationReadInput)
-         sampleTime = inIOCycleInfo->mInputTime.mSampleTime;
-    else sampleTime = inIOCycleInfo->mOutputTime.mSampleTime;
-
-    // we are always dealing with a 2 channel 32 bit float buffer
-    UInt32 ringStart = (sampleTime % kRing_Buffer_Frame_Size) * 2;
-    UInt32 ringBufferSize = kRing_Buffer_Frame_Size * 2;
-    UInt32 firstPartSize  = ringBufferSize - ringStart;
-    UInt32 secondPartSize = 0;
-    UInt32 inBufferSize   = inIOBufferFrameSize * 2;
-
-    if ( firstPartSize >= inBufferSize)
-         firstPartSize  = inBufferSize;
-    else secondPartSize = inBufferSize - firstPartSize;
+#if SyncAudio_CountIOPageFaults
+    UInt64 theStartPageFaults = SyncAudioPlatform_GetPageFaultCount();
+#endif
+    UInt64 theStartHostTime = SyncAudioEngine_GetHostTime(&theDevice->mEngine);
     
-    // Keep track of last outputSampleTime and the  bufferCleared status.
-    static Float64 lastOutputSampleTime = 0;
-    static Boolean bufferCleared = true;
     // SyncAudio to App
     if(inOperationID == kAudioServerPlugInIOOperationReadInput)
-    {   // If mute  just clear the buffer or if there's no apps outputing audio
-        if (gMute_Output_Master_Value ||
-            lastOutputSampleTime - inIOBufferFrameSize < inIOCycleInfo->mInputTime.mSampleTime)
-        {   // Clear the ioMainBuffer
-            vDSP_vclr(ioMainBuffer, 1, inBufferSize);
-            // Clear the ring buffer.
-            if (!bufferCleared)
-            {
-                vDSP_vclr(gRingBuffer, 1, ringBufferSize);
-                bufferCleared = true;
-            }
-        }
-        else
-        {   // Copy the buffers.
-            cblas_scopy(firstPartSize , gRingBuffer + ringStart, 1, ioMainBuffer, 1);
-            cblas_scopy(secondPartSize, gRingBuffer, 1         , (Float32*)ioMainBuffer + firstPartSize, 1);
-            // apply the output volume to the buffer.
-            vDSP_vsmul(ioMainBuffer, 1, &gVolume_Output_Master_Value, ioMainBuffer, 1, inBufferSize);
+    {   // Read behind the HAL's sample time by the depth of the delay line and the margin for a
+        // late writer. Anything the writer hasn't produced, or has already overwritten, comes back
+        // as silence. The output volume and mute are applied while reading.
+        SyncAudioDeviceState theState;
+        SyncAudioState_Load(&theDevice->mState, &theState);
+        Float32 theGain = theState.mOutputMute ? 0.0f : theState.mOutputVolume;
+        SyncAudioEngine_ReadInput(&theDevice->mEngine, (SInt64)inIOCycleInfo->mInputTime.mSampleTime, theGain, ioMainBuffer, inIOBufferFrameSize);
+        UInt32 theJitterFrames = atomic_load_explicit(&theDevice->mEngine.mJitterFrames, memory_order_relaxed);
+        // The margin is part of the latency the HAL reports, so a change of it has to be sent on.
+        // Sending it from the IO thread is acceptable because it only happens when the margin
+        // changes, which is once when a late writer is caught and then only once every
+        // kSyncAudioEngine_JitterSettleSeconds of clean reads as it comes back down, never on
+        // an ordinary cycle. dispatch_source_merge_data itself only ors into the source's pending
+        // data and wakes its queue, and the property notification, which allocates and calls
+        // into the host, runs there rather than here.
+        if((theJitterFrames != theDevice->mReportedJitterFrames) && (theDevice->mLatencyChangedSource != NULL))
+        {
+            theDevice->mReportedJitterFrames = theJitterFrames;
+            dispatch_source_merge_data(theDevice->mLatencyChangedSource, 1);
         }
+        UInt64 theEndHostTime = SyncAudioEngine_GetHostTime(&theDevice->mEngine);
+        SyncAudioEngine_RecordOperation(&theDevice->mEngine, kSyncAudioEngine_ReadInputOperation, theStartHostTime, theEndHostTime, inIOCycleInfo->mInputTime.mHostTime);
+        SyncAudio_Trace(kSyncAudioTrace_IOOperation, inStreamObjectID, theStartHostTime, theEndHostTime, ((UInt64)inOperationID << 32) | inIOBufferFrameSize, (UInt64)(SInt64)inIOCycleInfo->mInputTime.mSampleTime);
     }
     // App to SyncAudio
     else if(inOperationID == kAudioServerPlugInIOOperationWriteMix)
-    {   // Save the last output time.
-        lastOutputSampleTime= inIOCycleInfo->mOutputTime.mSampleTime;
-        bufferCleared = false;
-        // Copy the buffers.
-        cblas_scopy(firstPartSize , ioMainBuffer                          , 1, gRingBuffer + ringStart, 1);
-        cblas_scopy(secondPartSize, (Float32*)ioMainBuffer + firstPartSize, 1, gRingBuffer            , 1);
+    {
+        // Mix rather than store so that everything written for the same cycle adds up.
+        SyncAudioEngine_WriteMix(&theDevice->mEngine, (SInt64)inIOCycleInfo->mOutputTime.mSampleTime, ioMainBuffer, inIOBufferFrameSize, inIOCycleInfo->mIOCycleCounter);
+        UInt64 theEndHostTime = SyncAudioEngine_GetHostTime(&theDevice->mEngine);
+        SyncAudioEngine_RecordOperation(&theDevice->mEngine, kSyncAudioEngine_WriteMixOperation, theStartHostTime, theEndHostTime, inIOCycleInfo->mOutputTime.mHostTime);
+        SyncAudio_Trace(kSyncAudioTrace_IOOperation, inStreamObjectID, theStartHostTime, theEndHostTime, ((UInt64)inOperationID << 32) | inIOBufferFrameSize, (UInt64)(SInt64)inIOCycleInfo->mOutputTime.mSampleTime);
+    }
+    // The physical format to the clients' floats and back, which the HAL only asks for when the
+    // physical format is an integer one
+    else if(inOperationID == kAudioServerPlugInIOOperationConvertInput)
+    {
+        SyncAudioEngine_ConvertInput(&theDevice->mEngine, ioMainBuffer, inIOBufferFrameSize);
+    }
+    else if(inOperationID == kAudioServerPlugInIOOperationConvertOutput)
+    {
+        SyncAudioEngine_ConvertOutput(&theDevice->mEngine, ioMainBuffer, inIOBufferFrameSize);
+    }
+    // One app to its bus
+    else if(inOperationID == kAudioServerPlugInIOOperationProcessOutput)
+    {   // The client's own output, before the HAL mixes it. Scale it by the client's level, copy
+        // it to the client's bus, and silence it if it is diverted so that it doesn't reach the
+        // main ring too.
+        SyncAudioRoute* theRoute = SyncAudioRouteTable_Find(&theDevice->mRoutes, inClientID);
+        if(theRoute != NULL)
+        {
+            Float32 theLevel = atomic_load_explicit(&theRoute->mOutputLevel, memory_order_relaxed);
+            SyncAudioEngine_ScaleOutput(&theDevice->mEngine, ioMainBuffer, inIOBufferFrameSize, theLevel, &theRoute->mOutputGain);
+        }
+        if((theRoute != NULL) && (theRoute->mOutputBus != kSyncAudioEngine_MainBus))
+        {
+            SyncAudioEngine_WriteBus(&theDevice->mEngine, theRoute->mOutputBus, (SInt64)inIOCycleInfo->mOutputTime.mSampleTime, ioMainBuffer, inIOBufferFrameSize, inIOCycleInfo->mIOCycleCounter);
+            if(theRoute->mDivertOutput)
+            {
+                memset(ioMainBuffer, 0, (size_t)inIOBufferFrameSize * theDevice->mEngine.mRing.mChannelCount * sizeof(Float32));
+            }
+        }
+        UInt64 theEndHostTime = SyncAudioEngine_GetHostTime(&theDevice->mEngine);
+        SyncAudioEngine_RecordOperation(&theDevice->mEngine, kSyncAudioEngine_ProcessOutputOperation, theStartHostTime, theEndHostTime, inIOCycleInfo->mOutputTime.mHostTime);
+        SyncAudio_Trace(kSyncAudioTrace_IOOperation, inStreamObjectID, theStartHostTime, theEndHostTime, ((UInt64)inOperationID << 32) | inIOBufferFrameSize, (UInt64)(SInt64)inIOCycleInfo->mOutputTime.mSampleTime);
     }
+    // A bus to one app
+    else if(inOperationID == kAudioServerPlugInIOOperationProcessInput)
+    {   // The client's own copy of what ReadInput produced. Replace it with the client's bus,
+        // read through the same delay line and gain.
+        SyncAudioRoute* theRoute = SyncAudioRouteTable_Find(&theDevice->mRoutes, inClientID);
+        if((theRoute != NULL) && (theRoute->mInputBus != kSyncAudioEngine_MainBus))
+        {
+            SyncAudioDeviceState theState;
+            SyncAudioState_Load(&theDevice->mState, &theState);
+            Float32 theGain = theState.mOutputMute ? 0.0f : theState.mOutputVolume;
+            SyncAudioEngine_ReadBus(&theDevice->mEngine, theRoute->mInputBus, (SInt64)inIOCycleInfo->mInputTime.mSampleTime, theGain, &theRoute->mInputGain, ioMainBuffer, inIOBufferFrameSize);
+        }
+        UInt64 theEndHostTime = SyncAudioEngine_GetHostTime(&theDevice->mEngine);
+        SyncAudioEngine_RecordOperation(&theDevice->mEngine, kSyncAudioEngine_ProcessInputOperation, theStartHostTime, theEndHostTime, inIOCycleInfo->mInputTime.mHostTime);
+        SyncAudio_Trace(kSyncAudioTrace_IOOperation, inStreamObjectID, theStartHostTime, theEndHostTime, ((UInt64)inOperationID << 32) | inIOBufferFrameSize, (UInt64)(SInt64)inIOCycleInfo->mInputTime.mSampleTime);
+    }
+    
+#if SyncAudio_CountIOPageFaults
+    atomic_fetch_add_explicit(&theDevice->mIOPageFaults, SyncAudioPlatform_GetPageFaultCount() - theStartPageFaults, memory_order_relaxed);
+#endif
+    atomic_fetch_add_explicit(&theDevice->mIOOperations, 1, memory_order_relaxed);
 
 Done:
 	return theAnswer;
@@ -4271,10 +4516,12 @@ static OSStatus	SyncAudio_EndIOOperation(AudioServerPlugInDriverRef inDriver, Au
 	
 	//	declare the local variables
 	OSStatus theAnswer = 0;
+	SyncAudioDevice* theDevice;
 	
 	//	check the arguments
 	FailWithAction(inDriver != gAudioServerPlugInDriverRef, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_EndIOOperation: bad driver reference");
-	FailWithAction(inDeviceObjectID != kObjectID_Device, theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_EndIOOperation: bad device ID");
+	theDevice = SyncAudio_FindDevice(inDeviceObjectID, NULL);
+	FailWithAction((theDevice == NULL) || (theDevice->mObjectID != inDeviceObjectID), theAnswer = kAudioHardwareBadObjectError, Done, "SyncAudio_EndIOOperation: bad device ID");
 
 Done:
 	return theAnswer;
@@ -0,0 +1,209 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+The device clock that produces the zero time stamps.
+*/
+
+/*==================================================================================================
+	SyncAudioClock.c
+==================================================================================================*/
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	Self Include
+#include "SyncAudioClock.h"
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Sequence Lock
+//==================================================================================================
+
+typedef struct SyncAudioClockSnapshot
+{
+	uint64_t	mGeneration;
+	uint64_t	mAnchorHostTime;
+	uint64_t	mHostTicksNumerator;
+	uint64_t	mHostTicksDenominator;
+} SyncAudioClockSnapshot;
+
+static void	SyncAudioClock_Publish(SyncAudioClock* ioClock, const SyncAudioClockSnapshot* inSnapshot)
+{
+	//	make the sequence odd while the fields are inconsistent
+	uint32_t theSequence = atomic_load_explicit(&ioClock->mSequence, memory_order_relaxed);
+	atomic_store_explicit(&ioClock->mSequence, theSequence + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+
+	atomic_store_explicit(&ioClock->mGeneration, inSnapshot->mGeneration, memory_order_relaxed);
+	atomic_store_explicit(&ioClock->mAnchorHostTime, inSnapshot->mAnchorHostTime, memory_order_relaxed);
+	atomic_store_explicit(&ioClock->mHostTicksNumerator, inSnapshot->mHostTicksNumerator, memory_order_relaxed);
+	atomic_store_explicit(&ioClock->mHostTicksDenominator, inSnapshot->mHostTicksDenominator, memory_order_relaxed);
+
+	//	and even again once they are all stored
+	atomic_store_explicit(&ioClock->mSequence, theSequence + 2, memory_order_release);
+}
+
+static void	SyncAudioClock_Load(const SyncAudioClock* inClock, SyncAudioClockSnapshot* outSnapshot)
+{
+	uint32_t theSequence;
+	do
+	{
+		theSequence = atomic_load_explicit(&inClock->mSequence, memory_order_acquire);
+		outSnapshot->mGeneration = atomic_load_explicit(&inClock->mGeneration, memory_order_relaxed);
+		outSnapshot->mAnchorHostTime = atomic_load_explicit(&inClock->mAnchorHostTime, memory_order_relaxed);
+		outSnapshot->mHostTicksNumerator = atomic_load_explicit(&inClock->mHostTicksNumerator, memory_order_relaxed);
+		outSnapshot->mHostTicksDenominator = atomic_load_explicit(&inClock->mHostTicksDenominator, memory_order_relaxed);
+		atomic_thread_fence(memory_order_acquire);
+	}
+	while(((theSequence & 1) != 0) || (theSequence != atomic_load_explicit(&inClock->mSequence, memory_order_relaxed)));
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Rational Arithmetic
+//==================================================================================================
+
+static uint64_t	SyncAudioClock_GreatestCommonDivisor(uint64_t inA, uint64_t inB)
+{
+	while(inB != 0)
+	{
+		uint64_t theRemainder = inA % inB;
+		inA = inB;
+		inB = theRemainder;
+	}
+	return inA;
+}
+
+static void	SyncAudioClock_Reduce(uint64_t* ioNumerator, uint64_t* ioDenominator)
+{
+	uint64_t theDivisor = SyncAudioClock_GreatestCommonDivisor(*ioNumerator, *ioDenominator);
+	if(theDivisor > 1)
+	{
+		*ioNumerator /= theDivisor;
+		*ioDenominator /= theDivisor;
+	}
+}
+
+//	The host ticks from the anchor to the given frame, rounded down. The product can't overflow
+//	128 bits and, for any time line that fits in 64 bit host time, neither can the quotient.
+static inline uint64_t	SyncAudioClock_HostTicksForFrames(const SyncAudioClockSnapshot* inSnapshot, uint64_t inFrames)
+{
+	unsigned __int128 theTicks = (unsigned __int128)inFrames * inSnapshot->mHostTicksNumerator;
+	return (uint64_t)(theTicks / inSnapshot->mHostTicksDenominator);
+}
+
+//	Positions can be before the anchor, so they are divided rounding down rather than toward zero.
+static inline __int128	SyncAudioClock_DivideRoundingDown(__int128 inDividend, uint64_t inDivisor)
+{
+	__int128 theQuotient = inDividend / (__int128)inDivisor;
+	if((inDividend % (__int128)inDivisor) < 0)
+	{
+		--theQuotient;
+	}
+	return theQuotient;
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Operations
+//==================================================================================================
+
+void	SyncAudioClock_Initialize(SyncAudioClock* ioClock, uint32_t inPeriod, uint64_t inHostTicksNumerator, uint64_t inHostTicksDenominator)
+{
+	SyncAudioClock_Reduce(&inHostTicksNumerator, &inHostTicksDenominator);
+	ioClock->mPeriod = inPeriod;
+	atomic_init(&ioClock->mSequence, 0);
+	atomic_init(&ioClock->mGeneration, 0);
+	atomic_init(&ioClock->mAnchorHostTime, 0);
+	atomic_init(&ioClock->mHostTicksNumerator, inHostTicksNumerator);
+	atomic_init(&ioClock->mHostTicksDenominator, inHostTicksDenominator);
+	ioClock->mReaderGeneration = 0;
+	ioClock->mNumberTimeStamps = 0;
+	ioClock->mSeed = 1;
+}
+
+void	SyncAudioClock_SetHostTicksPerFrame(SyncAudioClock* ioClock, uint64_t inHostTicksNumerator, uint64_t inHostTicksDenominator)
+{
+	SyncAudioClockSnapshot theSnapshot;
+	SyncAudioClock_Load(ioClock, &theSnapshot);
+	SyncAudioClock_Reduce(&inHostTicksNumerator, &inHostTicksDenominator);
+	theSnapshot.mHostTicksNumerator = inHostTicksNumerator;
+	theSnapshot.mHostTicksDenominator = inHostTicksDenominator;
+	SyncAudioClock_Publish(ioClock, &theSnapshot);
+}
+
+void	SyncAudioClock_Anchor(SyncAudioClock* ioClock, uint64_t inHostTime)
+{
+	SyncAudioClockSnapshot theSnapshot;
+	SyncAudioClock_Load(ioClock, &theSnapshot);
+	theSnapshot.mGeneration += 1;
+	theSnapshot.mAnchorHostTime = inHostTime;
+	SyncAudioClock_Publish(ioClock, &theSnapshot);
+}
+
+void	SyncAudioClock_GetZeroTimeStamp(SyncAudioClock* ioClock, uint64_t inCurrentHostTime, double* outSampleTime, uint64_t* outHostTime, uint64_t* outSeed)
+{
+	SyncAudioClockSnapshot theSnapshot;
+	SyncAudioClock_Load(ioClock, &theSnapshot);
+
+	//	a new anchor starts the count over on a new time line
+	if(theSnapshot.mGeneration != ioClock->mReaderGeneration)
+	{
+		ioClock->mReaderGeneration = theSnapshot.mGeneration;
+		ioClock->mNumberTimeStamps = 0;
+		++ioClock->mSeed;
+	}
+
+	//	go to the next time stamp if its host time has already passed
+	uint64_t theNextHostTime = theSnapshot.mAnchorHostTime + SyncAudioClock_HostTicksForFrames(&theSnapshot, (ioClock->mNumberTimeStamps + 1) * ioClock->mPeriod);
+	if(theNextHostTime <= inCurrentHostTime)
+	{
+		++ioClock->mNumberTimeStamps;
+
+		//	If the one after that has passed too, the reader stopped asking for a while and the
+		//	time line has run off without it. Catching up a period at a time would leave every
+		//	time stamp until then in the past, so the count jumps to where the time line is now
+		//	and the seed tells the HAL to re-anchor to it.
+		uint64_t theFollowingHostTime = theSnapshot.mAnchorHostTime + SyncAudioClock_HostTicksForFrames(&theSnapshot, (ioClock->mNumberTimeStamps + 1) * ioClock->mPeriod);
+		if(theFollowingHostTime <= inCurrentHostTime)
+		{
+			unsigned __int128 theFrames = ((unsigned __int128)(inCurrentHostTime - theSnapshot.mAnchorHostTime) * theSnapshot.mHostTicksDenominator) / theSnapshot.mHostTicksNumerator;
+			ioClock->mNumberTimeStamps = (uint64_t)(theFrames / ioClock->mPeriod);
+			++ioClock->mSeed;
+		}
+	}
+
+	//	the sample time is exact in a double for many thousands of years
+	uint64_t theSampleTime = ioClock->mNumberTimeStamps * ioClock->mPeriod;
+	*outSampleTime = (double)theSampleTime;
+	*outHostTime = theSnapshot.mAnchorHostTime + SyncAudioClock_HostTicksForFrames(&theSnapshot, theSampleTime);
+	*outSeed = ioClock->mSeed;
+}
+
+bool	SyncAudioClock_MapPosition(const SyncAudioClock* inFrom, const SyncAudioClock* inTo, int64_t inSampleTime, uint32_t inFraction, int64_t* outSampleTime, uint32_t* outFraction, uint64_t* outStep)
+{
+	SyncAudioClockSnapshot theFrom;
+	SyncAudioClockSnapshot theTo;
+	SyncAudioClock_Load(inFrom, &theFrom);
+	SyncAudioClock_Load(inTo, &theTo);
+	bool theAnswer = (theFrom.mGeneration != 0) && (theTo.mGeneration != 0);
+	if(theAnswer)
+	{
+		//	Everything is in units of 2^-32 so that the fraction carries through. The position is
+		//	turned into host ticks since inFrom's anchor, moved to inTo's anchor and turned into
+		//	inTo's frames. For a time line of weeks, the products stay well inside 128 bits.
+		__int128 thePosition = ((__int128)inSampleTime * 4294967296LL) + inFraction;
+		__int128 theTicks = SyncAudioClock_DivideRoundingDown(thePosition * (__int128)theFrom.mHostTicksNumerator, theFrom.mHostTicksDenominator);
+		theTicks += ((__int128)theFrom.mAnchorHostTime - (__int128)theTo.mAnchorHostTime) * 4294967296LL;
+		thePosition = SyncAudioClock_DivideRoundingDown(theTicks * (__int128)theTo.mHostTicksDenominator, theTo.mHostTicksNumerator);
+		*outSampleTime = (int64_t)(thePosition >> 32);
+		*outFraction = (uint32_t)(thePosition & 0xFFFFFFFF);
+
+		//	the ratio of the two rates
+		unsigned __int128 theStep = ((unsigned __int128)theFrom.mHostTicksNumerator * theTo.mHostTicksDenominator) << 32;
+		*outStep = (uint64_t)(theStep / ((unsigned __int128)theFrom.mHostTicksDenominator * theTo.mHostTicksNumerator));
+	}
+	return theAnswer;
+}
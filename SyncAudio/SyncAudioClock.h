@@ -0,0 +1,82 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+The device clock that produces the zero time stamps.
+*/
+
+/*==================================================================================================
+	SyncAudioClock.h
+==================================================================================================*/
+#if !defined(__SyncAudioClock_h__)
+#define __SyncAudioClock_h__
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	System Includes
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+//==================================================================================================
+#pragma mark -
+#pragma mark SyncAudioClock
+//==================================================================================================
+
+//	SyncAudioClock models the device's time line as a series of zero time stamps mPeriod frames
+//	apart, starting from an anchor host time. Host times are passed in rather than read so that it
+//	has no dependency on the platform's clock.
+//
+//	The rate is the exact ratio of host ticks per frame, mHostTicksNumerator over
+//	mHostTicksDenominator, and the host time of each zero time stamp is worked out from the anchor
+//	in integer arithmetic with a 128 bit intermediate. So the time stamps don't drift away from
+//	the model no matter how long the device runs, and the same time stamp is always computed the
+//	same way.
+//
+//	The anchor and the rate are published through a sequence lock. The writers, which are
+//	StartIO and configuration changes, must be serialized by the caller, and they make
+//	mSequence odd while they change the fields. SyncAudioClock_GetZeroTimeStamp takes a snapshot of
+//	the fields and retries if mSequence moved while it did, so it never waits on a lock held by a
+//	lower priority thread. Every anchor starts a new generation, which tells the reader to start
+//	counting zero time stamps over.
+//
+//	The count of zero time stamps is owned by the reader. The HAL only asks for zero time stamps
+//	from the device's IO thread, so it doesn't need to be shared. So is mSeed, which changes
+//	whenever the time stamps stop following on from the ones before: when a new generation starts
+//	and when the reader has fallen more than a period behind the time line and skips ahead to it.
+//
+//	Two clocks on the same host clock can be related through the host time, which is what
+//	SyncAudioClock_MapPosition does for a device that plays back another device's time line. A
+//	position on a time line is a sample time and a fraction of a frame in units of 2^-32 frames.
+
+typedef struct SyncAudioClock
+{
+	uint32_t			mPeriod;
+	_Atomic uint32_t	mSequence;
+	_Atomic uint64_t	mGeneration;
+	_Atomic uint64_t	mAnchorHostTime;
+	_Atomic uint64_t	mHostTicksNumerator;
+	_Atomic uint64_t	mHostTicksDenominator;
+	uint64_t			mReaderGeneration;
+	uint64_t			mNumberTimeStamps;
+	uint64_t			mSeed;
+} SyncAudioClock;
+
+void	SyncAudioClock_Initialize(SyncAudioClock* ioClock, uint32_t inPeriod, uint64_t inHostTicksNumerator, uint64_t inHostTicksDenominator);
+
+//	Writers. The caller serializes these.
+void	SyncAudioClock_SetHostTicksPerFrame(SyncAudioClock* ioClock, uint64_t inHostTicksNumerator, uint64_t inHostTicksDenominator);
+void	SyncAudioClock_Anchor(SyncAudioClock* ioClock, uint64_t inHostTime);
+
+//	Reader. Returns the most recent zero time stamp at inCurrentHostTime and the seed of the
+//	time line it is on.
+void	SyncAudioClock_GetZeroTimeStamp(SyncAudioClock* ioClock, uint64_t inCurrentHostTime, double* outSampleTime, uint64_t* outHostTime, uint64_t* outSeed);
+
+//	Finds the position on inTo's time line that has the same host time as inSampleTime plus
+//	inFraction on inFrom's, and how far inTo's time line moves per frame of inFrom's, in 2^-32
+//	frames. Returns false if either clock was never anchored. Safe from any thread.
+bool	SyncAudioClock_MapPosition(const SyncAudioClock* inFrom, const SyncAudioClock* inTo, int64_t inSampleTime, uint32_t inFraction, int64_t* outSampleTime, uint32_t* outFraction, uint64_t* outStep);
+
+#endif	//	__SyncAudioClock_h__
@@ -0,0 +1,148 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+The tracker that keeps a reader a steady distance behind the writer of another time line.
+*/
+
+/*==================================================================================================
+	SyncAudioDrift.c
+==================================================================================================*/
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	Self Include
+#include "SyncAudioDrift.h"
+
+//	System Includes
+#include <math.h>
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Helpers
+//==================================================================================================
+
+//	The distance from the second position to the first, in frames.
+static inline double	SyncAudioDrift_Distance(int64_t inSampleTime, uint32_t inFraction, int64_t inFromSampleTime, uint32_t inFromFraction)
+{
+	return (double)(inSampleTime - inFromSampleTime) + (((double)inFraction - (double)inFromFraction) / 4294967296.0);
+}
+
+static inline double	SyncAudioDrift_Clamp(double inValue, double inLimit)
+{
+	return (inValue < -inLimit) ? -inLimit : ((inValue > inLimit) ? inLimit : inValue);
+}
+
+static void	SyncAudioDrift_Snap(SyncAudioDrift* ioDrift, int64_t inSampleTime, uint32_t inFraction)
+{
+	//	start over from the nominal position with the loop at rest
+	ioDrift->mIsLocked = true;
+	ioDrift->mIsSettled = false;
+	ioDrift->mSampleTime = inSampleTime;
+	ioDrift->mFraction = inFraction;
+	ioDrift->mSettledFrames = 0.0;
+	ioDrift->mIntegral = 0.0;
+	ioDrift->mCorrection = 0.0;
+	atomic_store_explicit(&ioDrift->mPublishedCorrection, 0, memory_order_relaxed);
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Operations
+//==================================================================================================
+
+void	SyncAudioDrift_Reset(SyncAudioDrift* ioDrift, double inTimeConstant)
+{
+	ioDrift->mTimeConstant = inTimeConstant;
+	ioDrift->mIsLocked = false;
+	ioDrift->mIsSettled = false;
+	ioDrift->mNextSampleTime = 0;
+	ioDrift->mSampleTime = 0;
+	ioDrift->mFraction = 0;
+	ioDrift->mLastWriteTime = 0;
+	ioDrift->mSettledFrames = 0.0;
+	ioDrift->mLead = 0.0;
+	ioDrift->mTargetLead = 0.0;
+	ioDrift->mIntegral = 0.0;
+	ioDrift->mCorrection = 0.0;
+	atomic_store_explicit(&ioDrift->mPublishedCorrection, 0, memory_order_relaxed);
+	atomic_store_explicit(&ioDrift->mResyncCount, 0, memory_order_relaxed);
+}
+
+void	SyncAudioDrift_Update(SyncAudioDrift* ioDrift, int64_t inReaderSampleTime, uint32_t inFrameCount, int64_t inSampleTime, uint32_t inFraction, uint64_t inStep, int64_t inWriteTime, int64_t* outSampleTime, uint32_t* outFraction, uint64_t* outStep)
+{
+	//	a read that doesn't follow on from the last one, or a cursor that has wandered off, starts
+	//	over, and only the latter is a jump worth counting
+	bool isContinuous = ioDrift->mIsLocked && (inReaderSampleTime == ioDrift->mNextSampleTime);
+	if(!isContinuous || (fabs(SyncAudioDrift_Distance(ioDrift->mSampleTime, ioDrift->mFraction, inSampleTime, inFraction)) > kSyncAudioDrift_ResyncFrames))
+	{
+		if(isContinuous)
+		{
+			atomic_fetch_add_explicit(&ioDrift->mResyncCount, 1, memory_order_relaxed);
+		}
+		SyncAudioDrift_Snap(ioDrift, inSampleTime, inFraction);
+		ioDrift->mLastWriteTime = inWriteTime;
+	}
+
+	//	The lead only says something when the writer has moved since the last read, otherwise it
+	//	is just the reader catching up with a writer that has stopped or hasn't come around yet.
+	double theFrameCount = (double)inFrameCount;
+	if(inWriteTime != ioDrift->mLastWriteTime)
+	{
+		double theLead = SyncAudioDrift_Distance(inWriteTime, 0, ioDrift->mSampleTime, ioDrift->mFraction) - (theFrameCount * (double)inStep / 4294967296.0);
+		if(!ioDrift->mIsSettled && (ioDrift->mSettledFrames == 0.0))
+		{
+			ioDrift->mLead = theLead;
+		}
+		else
+		{
+			//	the writer moves a buffer at a time, so the lead is smoothed before it's used, which
+			//	is the third pole of the loop
+			double theSmoothing = theFrameCount / (ioDrift->mTimeConstant / 3.0);
+			ioDrift->mLead += (theLead - ioDrift->mLead) * ((theSmoothing < 1.0) ? theSmoothing : 1.0);
+		}
+
+		if(!ioDrift->mIsSettled)
+		{
+			ioDrift->mSettledFrames += theFrameCount;
+			if(ioDrift->mSettledFrames >= ioDrift->mTimeConstant)
+			{
+				ioDrift->mIsSettled = true;
+				ioDrift->mTargetLead = ioDrift->mLead;
+			}
+		}
+		else
+		{
+			double theError = ioDrift->mLead - ioDrift->mTargetLead;
+			if(fabs(theError) > kSyncAudioDrift_ResyncFrames)
+			{
+				//	the writer jumped
+				atomic_fetch_add_explicit(&ioDrift->mResyncCount, 1, memory_order_relaxed);
+				SyncAudioDrift_Snap(ioDrift, inSampleTime, inFraction);
+			}
+			else
+			{
+				//	A writer ahead of the target means reading faster. The gains put all three poles
+				//	at the time constant, given the smoothing's, and the integral is limited to what
+				//	the correction can use so that it doesn't wind up.
+				double theTimeConstant = ioDrift->mTimeConstant;
+				ioDrift->mIntegral = SyncAudioDrift_Clamp(ioDrift->mIntegral + (theError * theFrameCount), kSyncAudioDrift_MaxCorrection * 3.0 * theTimeConstant * theTimeConstant);
+				ioDrift->mCorrection = SyncAudioDrift_Clamp((theError / theTimeConstant) + (ioDrift->mIntegral / (3.0 * theTimeConstant * theTimeConstant)), kSyncAudioDrift_MaxCorrection);
+				atomic_store_explicit(&ioDrift->mPublishedCorrection, (int64_t)llround(ioDrift->mCorrection * 1e9), memory_order_relaxed);
+			}
+		}
+		ioDrift->mLastWriteTime = inWriteTime;
+	}
+
+	//	read from the cursor with the corrected step and move the cursor past what was read
+	uint64_t theStep = (uint64_t)((int64_t)inStep + (int64_t)llround((double)inStep * ioDrift->mCorrection));
+	*outSampleTime = ioDrift->mSampleTime;
+	*outFraction = ioDrift->mFraction;
+	*outStep = theStep;
+	uint64_t theOffset = (uint64_t)ioDrift->mFraction + ((uint64_t)inFrameCount * theStep);
+	ioDrift->mSampleTime += (int64_t)(theOffset >> 32);
+	ioDrift->mFraction = (uint32_t)theOffset;
+	ioDrift->mNextSampleTime = inReaderSampleTime + inFrameCount;
+}
@@ -0,0 +1,85 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+The tracker that keeps a reader a steady distance behind the writer of another time line.
+*/
+
+/*==================================================================================================
+	SyncAudioDrift.h
+==================================================================================================*/
+#if !defined(__SyncAudioDrift_h__)
+#define __SyncAudioDrift_h__
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	System Includes
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+//==================================================================================================
+#pragma mark -
+#pragma mark SyncAudioDrift
+//==================================================================================================
+
+//	SyncAudioDrift decides where a reader that converts another time line's ring reads from. The
+//	clocks give the nominal position, which is where the reader's frames fall on the writer's
+//	time line by the host time, but what matters to the reader is how far behind the writer's
+//	cursor it is, its lead, and the writer's cursor moves with whatever the writer's IO thread
+//	actually does. So the reader keeps its own cursor, which it starts at the nominal position,
+//	and watches the lead: it takes the lead it settles on over the first mTimeConstant frames as
+//	the target and then steers the step it reads with by up to kSyncAudioDrift_MaxCorrection
+//	to hold the lead there, through a proportional and integral loop. The writer's cursor moves a
+//	buffer at a time, so the lead the loop works from is smoothed with a time constant of a third
+//	of mTimeConstant, and the gains are sized for the loop with the smoothing in it: the
+//	proportional gain is 1 / mTimeConstant and the integral gain 1 / (3 mTimeConstant^2), which
+//	puts all three of its poles at 1 / mTimeConstant, so it is critically damped and settles
+//	without ringing. The correction is small enough to be inaudible, and it comes out as the
+//	resampler reading a hair faster or slower.
+//
+//	A large jump can't be steered out. When the reader's frames don't follow on from its last
+//	read, when its cursor is more than kSyncAudioDrift_ResyncFrames away from the nominal
+//	position, or when the lead is that far from the target, the cursor snaps back to the nominal
+//	position and the loop starts over. The snaps that happen while reading continuously are
+//	counted in mResyncCount.
+//
+//	Everything is owned by the reader's IO thread except mPublishedCorrection, which is
+//	mCorrection in parts per billion, and mResyncCount, which are published with relaxed stores
+//	for anyone to read.
+//	SyncAudioDrift_Reset must not race the reader.
+
+#define	kSyncAudioDrift_MaxCorrection	0.001
+#define	kSyncAudioDrift_ResyncFrames	2048
+
+typedef struct SyncAudioDrift
+{
+	double				mTimeConstant;
+	bool				mIsLocked;
+	bool				mIsSettled;
+	int64_t				mNextSampleTime;
+	int64_t				mSampleTime;
+	uint32_t			mFraction;
+	int64_t				mLastWriteTime;
+	double				mSettledFrames;
+	double				mLead;
+	double				mTargetLead;
+	double				mIntegral;
+	double				mCorrection;
+	_Atomic int64_t		mPublishedCorrection;
+	_Atomic uint64_t	mResyncCount;
+} SyncAudioDrift;
+
+//	Unlocks the tracker, so that the next read starts at the nominal position, and clears the
+//	count. inTimeConstant is in the reader's frames.
+void	SyncAudioDrift_Reset(SyncAudioDrift* ioDrift, double inTimeConstant);
+
+//	Called by the reader before reading inFrameCount frames for inReaderSampleTime, whose nominal
+//	position on the writer's time line is inSampleTime plus inFraction, with inStep between
+//	frames, both in units of 2^-32 frames. inWriteTime is the writer's cursor. Returns the
+//	position and the step to read with.
+void	SyncAudioDrift_Update(SyncAudioDrift* ioDrift, int64_t inReaderSampleTime, uint32_t inFrameCount, int64_t inSampleTime, uint32_t inFraction, uint64_t inStep, int64_t inWriteTime, int64_t* outSampleTime, uint32_t* outFraction, uint64_t* outStep);
+
+#endif	//	__SyncAudioDrift_h__
@@ -0,0 +1,637 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+The loopback device's audio engine, independent of the HAL.
+*/
+
+/*==================================================================================================
+	SyncAudioEngine.c
+==================================================================================================*/
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	Self Include
+#include "SyncAudioEngine.h"
+
+//	System Includes
+#include <math.h>
+#include <string.h>
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Helpers
+//==================================================================================================
+
+static void	SyncAudioEngine_GetHostTicksPerFrame(const SyncAudioEngine* inEngine, double inSampleRate, uint64_t* outNumerator, uint64_t* outDenominator)
+{
+	//	the exact ratio of the host clock frequency to the sample rate
+	*outNumerator = inEngine->mHostClock.mTicksPerSecondNumerator;
+	*outDenominator = inEngine->mHostClock.mTicksPerSecondDenominator * (uint64_t)inSampleRate;
+}
+
+static uint64_t	SyncAudioEngine_HostTicksToNanoseconds(const SyncAudioEngine* inEngine, uint64_t inHostTicks)
+{
+	unsigned __int128 theNanoseconds = (unsigned __int128)inHostTicks * 1000000000ULL * inEngine->mHostClock.mTicksPerSecondDenominator;
+	return (uint64_t)(theNanoseconds / inEngine->mHostClock.mTicksPerSecondNumerator);
+}
+
+static void	SyncAudioEngine_ResetStats(SyncAudioEngine* ioEngine)
+{
+	for(uint32_t theOperation = 0; theOperation < kSyncAudioEngine_OperationCount; ++theOperation)
+	{
+		SyncAudioHistogram_Reset(&ioEngine->mOperationStats[theOperation].mDuration);
+		SyncAudioHistogram_Reset(&ioEngine->mOperationStats[theOperation].mJitter);
+		ioEngine->mOperationStats[theOperation].mLastHostTime = 0;
+		ioEngine->mOperationStats[theOperation].mLastTimeStampHostTime = 0;
+	}
+}
+
+static SyncAudioRing*	SyncAudioEngine_GetBusRing(SyncAudioEngine* ioEngine, uint32_t inBus)
+{
+	return (inBus == kSyncAudioEngine_MainBus) ? &ioEngine->mRing : &ioEngine->mBusRings[inBus - 1];
+}
+
+static uint32_t	SyncAudioEngine_GetRingFrameCapacity(uint32_t inRingFrameCapacity, double inSampleRate)
+{
+	//	the smallest power of two that covers the span inRingFrameCapacity covers at the highest rate
+	double theFrames = (double)inRingFrameCapacity * inSampleRate / kSyncAudioEngine_MaxSampleRate;
+	uint32_t theAnswer = kSyncAudioRing_BlockFrameCount;
+	while((theAnswer < inRingFrameCapacity) && ((double)theAnswer < theFrames))
+	{
+		theAnswer <<= 1;
+	}
+	return theAnswer;
+}
+
+static void	SyncAudioEngine_UpdateDelayFrames(SyncAudioEngine* ioEngine)
+{
+	//	convert the delay from milliseconds to frames at the current sample rate and publish it to
+	//	the IO thread as 32.32 fixed point
+	double theDelayFrames = ioEngine->mDelayMilliseconds * ioEngine->mSampleRate / 1000.0;
+	atomic_store_explicit(&ioEngine->mDelayFrames, (uint64_t)llround(theDelayFrames * 4294967296.0), memory_order_relaxed);
+}
+
+static inline uint64_t	SyncAudioEngine_GetReadDelay(const SyncAudioEngine* inEngine)
+{
+	//	the delay line plus the margin for a late writer, in 32.32 fixed point
+	uint64_t theDelay = atomic_load_explicit(&inEngine->mDelayFrames, memory_order_relaxed);
+	return theDelay + ((uint64_t)atomic_load_explicit(&inEngine->mJitterFrames, memory_order_relaxed) << 32);
+}
+
+static void	SyncAudioEngine_UpdateJitter(SyncAudioEngine* ioEngine, int64_t inWriteTime, int64_t inReadTime, uint32_t inReadResult, uint32_t inFrameCount)
+{
+	//	Called after each read of the main ring with where the writer was before it and where the
+	//	read ended. The end comes from the read itself rather than the ring's mReadTime, which is
+	//	the ring's to publish.
+	uint32_t theReadJitterFrames = atomic_load_explicit(&ioEngine->mJitterFrames, memory_order_relaxed);
+	uint32_t theJitterFrames = theReadJitterFrames;
+	int64_t theReadTime = inReadTime;
+	bool hasWritten = inWriteTime != ioEngine->mJitterWriteTime;
+	ioEngine->mJitterWriteTime = inWriteTime;
+
+	//	A read that came up short is only down to a late writer once the writer has gone on to
+	//	write what it was missing. A writer that has stopped never does, and one that skipped ahead
+	//	past the first missing frame didn't write them, so neither counts.
+	if(ioEngine->mJitterLateFrames != 0)
+	{
+		if(ioEngine->mJitterSkipTime > (ioEngine->mJitterLateTime - (int64_t)ioEngine->mJitterLateFrames))
+		{
+			ioEngine->mJitterLateFrames = 0;
+		}
+		else if(inWriteTime >= ioEngine->mJitterLateTime)
+		{
+			theJitterFrames += ioEngine->mJitterLateFrames;
+			if(theJitterFrames > ioEngine->mMaxJitterFrames)
+			{
+				theJitterFrames = ioEngine->mMaxJitterFrames;
+			}
+			ioEngine->mJitterLateFrames = 0;
+			ioEngine->mJitterStableFrames = 0;
+		}
+		else if(!hasWritten)
+		{
+			ioEngine->mJitterLateFrames = 0;
+		}
+	}
+
+	if(((inReadResult & kSyncAudioRing_Underrun) != 0) && (theReadTime > inWriteTime))
+	{
+		//	Remember how far short it came to see whether the writer catches up. The read was made
+		//	with the margin from before anything was just added to it, which covers that much of it.
+		int64_t theMissingFrames = theReadTime - inWriteTime - (int64_t)(theJitterFrames - theReadJitterFrames);
+		if((ioEngine->mJitterLateFrames == 0) && (theMissingFrames > 0))
+		{
+			ioEngine->mJitterLateTime = theReadTime;
+			ioEngine->mJitterLateFrames = (theMissingFrames < (int64_t)inFrameCount) ? (uint32_t)theMissingFrames : inFrameCount;
+		}
+		ioEngine->mJitterStableFrames = 0;
+	}
+	else if(hasWritten)
+	{
+		//	a stretch of reads that all found their frames lets the margin come down again
+		ioEngine->mJitterStableFrames += inFrameCount;
+		if((double)ioEngine->mJitterStableFrames >= (kSyncAudioEngine_JitterSettleSeconds * ioEngine->mSampleRate))
+		{
+			uint32_t theStep = (uint32_t)(ioEngine->mSampleRate / 1000.0);
+			theJitterFrames = (theJitterFrames > theStep) ? (theJitterFrames - theStep) : 0;
+			ioEngine->mJitterStableFrames = 0;
+		}
+	}
+	atomic_store_explicit(&ioEngine->mJitterFrames, theJitterFrames, memory_order_relaxed);
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Control
+//==================================================================================================
+
+bool	SyncAudioEngine_Initialize(SyncAudioEngine* ioEngine, const SyncAudioStorage* inStorage, const SyncAudioHostClock* inHostClock, double inSampleRate, double inMaxSampleRate, uint32_t inChannelCount, uint32_t inRingFrameCapacity, uint32_t inZeroTimeStampPeriod, uint32_t inRingOptions)
+{
+	if(inStorage != NULL)
+	{
+		ioEngine->mStorage = *inStorage;
+	}
+	else
+	{
+		ioEngine->mStorage = (SyncAudioStorage){ NULL, NULL, NULL };
+	}
+	if(inHostClock != NULL)
+	{
+		ioEngine->mHostClock = *inHostClock;
+	}
+	else
+	{
+		SyncAudioPlatform_GetHostClock(&ioEngine->mHostClock);
+	}
+	ioEngine->mSampleRate = inSampleRate;
+	ioEngine->mMaxSampleRate = inMaxSampleRate;
+	ioEngine->mRingFrameCapacity = inRingFrameCapacity;
+	ioEngine->mReadGain = 0.0f;
+	ioEngine->mQuantizeScale = 0.0f;
+	ioEngine->mSampleBits = 0;
+	for(uint32_t theLane = 0; theLane < kSyncAudioKernels_DitherLaneCount; ++theLane)
+	{
+		//	any seed but zero will do, as long as the lanes don't share one
+		ioEngine->mDither[theLane] = 0x9E3779B9U * (theLane + 1);
+	}
+	atomic_init(&ioEngine->mJitterFrames, 0);
+	ioEngine->mMaxJitterFrames = (uint32_t)(kSyncAudioEngine_MaxJitterMilliseconds * inSampleRate / 1000.0);
+	ioEngine->mJitterStableFrames = 0;
+	ioEngine->mJitterWriteTime = 0;
+	ioEngine->mJitterLateTime = 0;
+	ioEngine->mJitterLateFrames = 0;
+	ioEngine->mJitterSkipTime = 0;
+	ioEngine->mSource = NULL;
+	SyncAudioDrift_Reset(&ioEngine->mDrift, kSyncAudioEngine_DriftSeconds * inSampleRate);
+	ioEngine->mRingOptions = inRingOptions;
+	atomic_init(&ioEngine->mBusMask, 0);
+	SyncAudioEngine_ResetStats(ioEngine);
+
+	//	load the delay, ignoring anything out of range
+	double theDelayMilliseconds = 0.0;
+	if(!SyncAudioStorage_CopyNumber(&ioEngine->mStorage, kSyncAudioEngine_DelayStorageKey, &theDelayMilliseconds) || !((theDelayMilliseconds >= 0.0) && (theDelayMilliseconds <= kSyncAudioEngine_MaxDelayMilliseconds)))
+	{
+		theDelayMilliseconds = 0.0;
+	}
+	ioEngine->mDelayMilliseconds = theDelayMilliseconds;
+	atomic_init(&ioEngine->mDelayFrames, 0);
+	SyncAudioEngine_UpdateDelayFrames(ioEngine);
+
+	uint64_t theTicksNumerator;
+	uint64_t theTicksDenominator;
+	SyncAudioEngine_GetHostTicksPerFrame(ioEngine, inSampleRate, &theTicksNumerator, &theTicksDenominator);
+	SyncAudioClock_Initialize(&ioEngine->mClock, inZeroTimeStampPeriod, theTicksNumerator, theTicksDenominator);
+
+	//	the storage only has to cover the highest rate the engine will run at
+	bool theAnswer = SyncAudioRing_Initialize(&ioEngine->mRing, SyncAudioEngine_GetRingFrameCapacity(inRingFrameCapacity, inMaxSampleRate), inChannelCount, inRingOptions);
+	if(theAnswer)
+	{
+		SyncAudioRing_SetFrameCapacity(&ioEngine->mRing, SyncAudioEngine_GetRingFrameCapacity(inRingFrameCapacity, inSampleRate));
+		atomic_store_explicit(&ioEngine->mBusMask, 1U << kSyncAudioEngine_MainBus, memory_order_release);
+	}
+	return theAnswer;
+}
+
+void	SyncAudioEngine_Teardown(SyncAudioEngine* ioEngine)
+{
+	SyncAudioEngine_SetSource(ioEngine, NULL, 0);
+	uint32_t theBusMask = atomic_exchange_explicit(&ioEngine->mBusMask, 0, memory_order_acq_rel);
+	for(uint32_t theBus = 0; theBus < kSyncAudioEngine_MaxBusCount; ++theBus)
+	{
+		if((theBusMask & (1U << theBus)) != 0)
+		{
+			SyncAudioRing_Teardown(SyncAudioEngine_GetBusRing(ioEngine, theBus));
+		}
+	}
+}
+
+void	SyncAudioEngine_SetSampleRate(SyncAudioEngine* ioEngine, double inSampleRate)
+{
+	//	the margin covers the same time at the new rate
+	uint32_t theJitterFrames = atomic_load_explicit(&ioEngine->mJitterFrames, memory_order_relaxed);
+	theJitterFrames = (uint32_t)((double)theJitterFrames * inSampleRate / ioEngine->mSampleRate);
+	ioEngine->mMaxJitterFrames = (uint32_t)(kSyncAudioEngine_MaxJitterMilliseconds * inSampleRate / 1000.0);
+	atomic_store_explicit(&ioEngine->mJitterFrames, (theJitterFrames < ioEngine->mMaxJitterFrames) ? theJitterFrames : ioEngine->mMaxJitterFrames, memory_order_relaxed);
+	ioEngine->mSampleRate = inSampleRate;
+
+	uint64_t theTicksNumerator;
+	uint64_t theTicksDenominator;
+	SyncAudioEngine_GetHostTicksPerFrame(ioEngine, inSampleRate, &theTicksNumerator, &theTicksDenominator);
+	SyncAudioClock_SetHostTicksPerFrame(&ioEngine->mClock, theTicksNumerator, theTicksDenominator);
+	SyncAudioEngine_UpdateDelayFrames(ioEngine);
+
+	//	all the rings have the same storage, so they all end up the same size
+	uint32_t theFrameCapacity = SyncAudioEngine_GetRingFrameCapacity(ioEngine->mRingFrameCapacity, inSampleRate);
+	uint32_t theBusMask = atomic_load_explicit(&ioEngine->mBusMask, memory_order_relaxed);
+	for(uint32_t theBus = 0; theBus < kSyncAudioEngine_MaxBusCount; ++theBus)
+	{
+		if((theBusMask & (1U << theBus)) != 0)
+		{
+			SyncAudioRing_SetFrameCapacity(SyncAudioEngine_GetBusRing(ioEngine, theBus), theFrameCapacity);
+		}
+	}
+}
+
+double	SyncAudioEngine_GetDelayMilliseconds(const SyncAudioEngine* inEngine)
+{
+	return inEngine->mDelayMilliseconds;
+}
+
+size_t	SyncAudioEngine_GetRingByteSize(const SyncAudioEngine* inEngine)
+{
+	size_t theAnswer = 0;
+	uint32_t theBusMask = atomic_load_explicit(&inEngine->mBusMask, memory_order_acquire);
+	for(uint32_t theBus = 0; theBus < kSyncAudioEngine_MaxBusCount; ++theBus)
+	{
+		if((theBusMask & (1U << theBus)) != 0)
+		{
+			theAnswer += SyncAudioEngine_GetBusRing((SyncAudioEngine*)inEngine, theBus)->mBufferByteSize;
+		}
+	}
+	return theAnswer;
+}
+
+void	SyncAudioEngine_SetPhysicalFormat(SyncAudioEngine* ioEngine, uint32_t inBits)
+{
+	//	32 bit integers and floats hold every bit of a float sample already
+	ioEngine->mQuantizeScale = ((inBits == 16) || (inBits == 24)) ? (float)(1U << (inBits - 1)) : 0.0f;
+	ioEngine->mSampleBits = ((inBits == 16) || (inBits == 24) || (inBits == 32)) ? inBits : 0;
+}
+
+uint32_t	SyncAudioEngine_GetPhysicalBytesPerSample(const SyncAudioEngine* inEngine)
+{
+	return (inEngine->mSampleBits != 0) ? (inEngine->mSampleBits / 8) : (uint32_t)sizeof(float);
+}
+
+bool	SyncAudioEngine_SetSource(SyncAudioEngine* ioEngine, SyncAudioEngine* inSource, uint32_t inQuality)
+{
+	bool theAnswer = (inSource == NULL) || ((inSource != ioEngine) && (inSource->mRing.mChannelCount == ioEngine->mRing.mChannelCount));
+	if(theAnswer && (inSource != NULL))
+	{
+		//	set the new resampler up before letting go of the old one
+		SyncAudioResampler theResampler;
+		theAnswer = SyncAudioResampler_Initialize(&theResampler, inQuality, ioEngine->mRing.mChannelCount);
+		if(theAnswer)
+		{
+			if(ioEngine->mSource != NULL)
+			{
+				SyncAudioResampler_Teardown(&ioEngine->mResampler);
+			}
+			ioEngine->mResampler = theResampler;
+			ioEngine->mSource = inSource;
+			SyncAudioDrift_Reset(&ioEngine->mDrift, kSyncAudioEngine_DriftSeconds * ioEngine->mSampleRate);
+		}
+	}
+	else if(theAnswer && (ioEngine->mSource != NULL))
+	{
+		SyncAudioResampler_Teardown(&ioEngine->mResampler);
+		ioEngine->mSource = NULL;
+	}
+	return theAnswer;
+}
+
+bool	SyncAudioEngine_SetDelayMilliseconds(SyncAudioEngine* ioEngine, double inDelayMilliseconds)
+{
+	if(!(inDelayMilliseconds > 0.0))
+	{
+		inDelayMilliseconds = 0.0;
+	}
+	else if(inDelayMilliseconds > kSyncAudioEngine_MaxDelayMilliseconds)
+	{
+		inDelayMilliseconds = kSyncAudioEngine_MaxDelayMilliseconds;
+	}
+
+	bool theDelayChanged = ioEngine->mDelayMilliseconds != inDelayMilliseconds;
+	if(theDelayChanged)
+	{
+		ioEngine->mDelayMilliseconds = inDelayMilliseconds;
+		SyncAudioEngine_UpdateDelayFrames(ioEngine);
+		SyncAudioStorage_WriteNumber(&ioEngine->mStorage, kSyncAudioEngine_DelayStorageKey, inDelayMilliseconds);
+	}
+	return theDelayChanged;
+}
+
+void	SyncAudioEngine_StartIO(SyncAudioEngine* ioEngine)
+{
+	SyncAudioClock_Anchor(&ioEngine->mClock, SyncAudioEngine_GetHostTime(ioEngine));
+	uint32_t theBusMask = atomic_load_explicit(&ioEngine->mBusMask, memory_order_relaxed);
+	for(uint32_t theBus = 0; theBus < kSyncAudioEngine_MaxBusCount; ++theBus)
+	{
+		if((theBusMask & (1U << theBus)) != 0)
+		{
+			SyncAudioRing_Reset(SyncAudioEngine_GetBusRing(ioEngine, theBus));
+		}
+	}
+	SyncAudioDrift_Reset(&ioEngine->mDrift, kSyncAudioEngine_DriftSeconds * ioEngine->mSampleRate);
+	ioEngine->mJitterStableFrames = 0;
+	ioEngine->mJitterWriteTime = 0;
+	ioEngine->mJitterLateTime = 0;
+	ioEngine->mJitterLateFrames = 0;
+	ioEngine->mJitterSkipTime = 0;
+	SyncAudioEngine_ResetStats(ioEngine);
+}
+
+bool	SyncAudioEngine_PrepareBus(SyncAudioEngine* ioEngine, uint32_t inBus)
+{
+	bool theAnswer = false;
+	if(inBus < kSyncAudioEngine_MaxBusCount)
+	{
+		uint32_t theBusMask = atomic_load_explicit(&ioEngine->mBusMask, memory_order_relaxed);
+		theAnswer = (theBusMask & (1U << inBus)) != 0;
+		if(!theAnswer)
+		{
+			//	a new ring starts out empty, so nothing has to wait for IO to restart to use it
+			SyncAudioRing* theRing = SyncAudioEngine_GetBusRing(ioEngine, inBus);
+			theAnswer = SyncAudioRing_Initialize(theRing, ioEngine->mRing.mMaxFrameCapacity, ioEngine->mRing.mChannelCount, ioEngine->mRingOptions);
+			if(theAnswer)
+			{
+				SyncAudioRing_SetFrameCapacity(theRing, atomic_load_explicit(&ioEngine->mRing.mFrameCapacity, memory_order_relaxed));
+				atomic_store_explicit(&ioEngine->mBusMask, theBusMask | (1U << inBus), memory_order_release);
+			}
+		}
+	}
+	return theAnswer;
+}
+
+uint32_t	SyncAudioEngine_GetInputLatency(const SyncAudioEngine* inEngine)
+{
+	return (uint32_t)((SyncAudioEngine_GetReadDelay(inEngine) + 0xFFFFFFFFULL) >> 32);
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark IO
+//==================================================================================================
+
+uint64_t	SyncAudioEngine_GetHostTime(const SyncAudioEngine* inEngine)
+{
+	return inEngine->mHostClock.mGetHostTime(inEngine->mHostClock.mContext);
+}
+
+void	SyncAudioEngine_GetZeroTimeStamp(SyncAudioEngine* ioEngine, double* outSampleTime, uint64_t* outHostTime, uint64_t* outSeed)
+{
+	SyncAudioClock_GetZeroTimeStamp(&ioEngine->mClock, SyncAudioEngine_GetHostTime(ioEngine), outSampleTime, outHostTime, outSeed);
+}
+
+static inline float	SyncAudioEngine_GetQuantizeScale(const SyncAudioEngine* inEngine, float inStartGain, float inEndGain)
+{
+	//	a buffer that is silent all the way through, as a muted one is, is already exact in any
+	//	format, so it isn't dithered
+	return ((inStartGain == 0.0f) && (inEndGain == 0.0f)) ? 0.0f : inEngine->mQuantizeScale;
+}
+
+static void	SyncAudioEngine_PackSamples(const SyncAudioEngine* inEngine, void* ioData, uint32_t inFrameCount)
+{
+	//	Rounds the floats in ioData to the nearest integer sample, saturating at full scale, and
+	//	packs them in place. A packed sample never reaches past the float it came from, so going
+	//	from front to back reads every float before anything is written over it. The samples are
+	//	moved with memcpy since the two views of the buffer alias.
+	uint32_t theBits = inEngine->mSampleBits;
+	if(theBits != 0)
+	{
+		uint8_t* theData = (uint8_t*)ioData;
+		uint32_t theBytesPerSample = theBits / 8;
+		uint32_t theSampleCount = inFrameCount * inEngine->mRing.mChannelCount;
+		double theScale = (double)(1ULL << (theBits - 1));
+		for(uint32_t theIndex = 0; theIndex < theSampleCount; ++theIndex)
+		{
+			float theSample;
+			memcpy(&theSample, theData + (theIndex * sizeof(float)), sizeof(float));
+			double theValue = rint(fmin(fmax((double)theSample * theScale, -theScale), theScale - 1.0));
+			int32_t theInteger = (int32_t)theValue;
+			uint8_t* theDest = theData + (theIndex * theBytesPerSample);
+			if(theBits == 16)
+			{
+				int16_t theShort = (int16_t)theInteger;
+				memcpy(theDest, &theShort, sizeof(theShort));
+			}
+			else if(theBits == 24)
+			{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+				theDest[0] = (uint8_t)(theInteger >> 16);
+				theDest[1] = (uint8_t)(theInteger >> 8);
+				theDest[2] = (uint8_t)theInteger;
+#else
+				theDest[0] = (uint8_t)theInteger;
+				theDest[1] = (uint8_t)(theInteger >> 8);
+				theDest[2] = (uint8_t)(theInteger >> 16);
+#endif
+			}
+			else
+			{
+				memcpy(theDest, &theInteger, sizeof(theInteger));
+			}
+		}
+	}
+}
+
+static uint32_t	SyncAudioEngine_ReadRing(SyncAudioEngine* ioEngine, SyncAudioRing* ioRing, int64_t inSampleTime, float inGain, float* ioReadGain, float* outData, uint32_t inFrameCount, int64_t* outReadTime)
+{
+	//	read behind the requested time by the depth of the delay line and the margin, ramp the
+	//	gain across the buffer from where the last read ended so that changing it doesn't click,
+	//	and quantize to the input's resolution in the same pass, then say where on the ring's time
+	//	line the read ended
+	uint64_t theDelay = SyncAudioEngine_GetReadDelay(ioEngine);
+	int64_t theSampleTime = inSampleTime - (int64_t)(theDelay >> 32);
+	float theFraction = (float)((double)(theDelay & 0xFFFFFFFFULL) / 4294967296.0);
+	float theGainStep = (inFrameCount > 0) ? (inGain - *ioReadGain) / (float)(inFrameCount * ioRing->mChannelCount) : 0.0f;
+	float theQuantizeScale = SyncAudioEngine_GetQuantizeScale(ioEngine, *ioReadGain, inGain);
+	uint32_t theResult = SyncAudioRing_ReadQuantized(ioRing, theSampleTime, theFraction, *ioReadGain, theGainStep, theQuantizeScale, ioEngine->mDither, outData, inFrameCount);
+	*ioReadGain = inGain;
+	*outReadTime = theSampleTime + inFrameCount;
+	return theResult;
+}
+
+static uint32_t	SyncAudioEngine_ReadSource(SyncAudioEngine* ioEngine, int64_t inSampleTime, float inGain, float* outData, uint32_t inFrameCount)
+{
+	//	find where the time behind the requested one by the depth of the delay line falls on the
+	//	source's time line, and how fast it moves there
+	uint32_t theResult = kSyncAudioRing_Underrun;
+	uint64_t theDelay = atomic_load_explicit(&ioEngine->mDelayFrames, memory_order_relaxed);
+	int64_t theSampleTime = inSampleTime - (int64_t)(theDelay >> 32);
+	uint32_t theFraction = (uint32_t)(theDelay & 0xFFFFFFFFULL);
+	if(theFraction != 0)
+	{
+		theSampleTime -= 1;
+		theFraction = (uint32_t)(0x100000000ULL - theFraction);
+	}
+	int64_t theSourceSampleTime;
+	uint32_t theSourceFraction;
+	uint64_t theStep;
+	if(SyncAudioClock_MapPosition(&ioEngine->mClock, &ioEngine->mSource->mClock, theSampleTime, theFraction, &theSourceSampleTime, &theSourceFraction, &theStep))
+	{
+		//	then let the drift tracker decide where to actually read from
+		int64_t theWriteTime = atomic_load_explicit(&ioEngine->mSource->mRing.mWriteTime, memory_order_acquire);
+		SyncAudioDrift_Update(&ioEngine->mDrift, theSampleTime, inFrameCount, theSourceSampleTime, theSourceFraction, theStep, theWriteTime, &theSourceSampleTime, &theSourceFraction, &theStep);
+		theResult = SyncAudioResampler_Read(&ioEngine->mResampler, &ioEngine->mSource->mRing, theSourceSampleTime, theSourceFraction, theStep, outData, inFrameCount);
+	}
+	else
+	{
+		//	the source has never run, so there is nothing to play
+		memset(outData, 0, (size_t)inFrameCount * ioEngine->mRing.mChannelCount * sizeof(float));
+	}
+
+	//	the buffer was just written, so applying the gain ramp and quantizing, which are a single
+	//	pass, come out of the cache
+	float theQuantizeScale = SyncAudioEngine_GetQuantizeScale(ioEngine, ioEngine->mReadGain, inGain);
+	if(theQuantizeScale != 0.0f)
+	{
+		uint32_t theSampleCount = inFrameCount * ioEngine->mRing.mChannelCount;
+		float theGainStep = (theSampleCount > 0) ? (inGain - ioEngine->mReadGain) / (float)theSampleCount : 0.0f;
+		ioEngine->mRing.mKernels->mCopyScaledQuantized(outData, outData, theSampleCount, ioEngine->mReadGain, theGainStep, theQuantizeScale, ioEngine->mDither);
+		ioEngine->mReadGain = inGain;
+	}
+	else
+	{
+		SyncAudioEngine_ScaleOutput(ioEngine, outData, inFrameCount, inGain, &ioEngine->mReadGain);
+	}
+	return theResult;
+}
+
+uint32_t	SyncAudioEngine_ReadInput(SyncAudioEngine* ioEngine, int64_t inSampleTime, float inGain, void* outData, uint32_t inFrameCount)
+{
+	//	the read quantizes as it copies, so all that is left for an integer format is to pack what
+	//	it wrote, while it is still in the cache
+	uint32_t theResult;
+	if(ioEngine->mSource != NULL)
+	{
+		theResult = SyncAudioEngine_ReadSource(ioEngine, inSampleTime, inGain, outData, inFrameCount);
+	}
+	else
+	{
+		int64_t theWriteTime = atomic_load_explicit(&ioEngine->mRing.mWriteTime, memory_order_relaxed);
+		int64_t theReadTime = 0;
+		theResult = SyncAudioEngine_ReadRing(ioEngine, &ioEngine->mRing, inSampleTime, inGain, &ioEngine->mReadGain, outData, inFrameCount, &theReadTime);
+		SyncAudioEngine_UpdateJitter(ioEngine, theWriteTime, theReadTime, theResult, inFrameCount);
+	}
+	SyncAudioEngine_PackSamples(ioEngine, outData, inFrameCount);
+	return theResult;
+}
+
+void	SyncAudioEngine_ConvertInput(const SyncAudioEngine* inEngine, void* ioData, uint32_t inFrameCount)
+{
+	//	A float never reaches back past the packed sample it comes from, so going from back to front
+	//	reads every packed sample before anything is written over it.
+	uint32_t theBits = inEngine->mSampleBits;
+	if(theBits != 0)
+	{
+		uint8_t* theData = (uint8_t*)ioData;
+		uint32_t theBytesPerSample = theBits / 8;
+		uint32_t theSampleCount = inFrameCount * inEngine->mRing.mChannelCount;
+		double theStep = 1.0 / (double)(1ULL << (theBits - 1));
+		for(uint32_t theIndex = theSampleCount; theIndex > 0; --theIndex)
+		{
+			const uint8_t* theSource = theData + ((theIndex - 1) * theBytesPerSample);
+			int32_t theInteger;
+			if(theBits == 16)
+			{
+				int16_t theShort;
+				memcpy(&theShort, theSource, sizeof(theShort));
+				theInteger = theShort;
+			}
+			else if(theBits == 24)
+			{
+				//	put the three bytes at the top of the word and shift them back down with their sign
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+				theInteger = (int32_t)(((uint32_t)theSource[0] << 24) | ((uint32_t)theSource[1] << 16) | ((uint32_t)theSource[2] << 8)) >> 8;
+#else
+				theInteger = (int32_t)(((uint32_t)theSource[2] << 24) | ((uint32_t)theSource[1] << 16) | ((uint32_t)theSource[0] << 8)) >> 8;
+#endif
+			}
+			else
+			{
+				memcpy(&theInteger, theSource, sizeof(theInteger));
+			}
+			float theSample = (float)((double)theInteger * theStep);
+			memcpy(theData + ((theIndex - 1) * sizeof(float)), &theSample, sizeof(float));
+		}
+	}
+}
+
+void	SyncAudioEngine_ConvertOutput(SyncAudioEngine* ioEngine, void* ioData, uint32_t inFrameCount)
+{
+	//	the same dither as the input's, in place, and then the samples are on the integer grid
+	if(ioEngine->mQuantizeScale != 0.0f)
+	{
+		uint32_t theSampleCount = inFrameCount * ioEngine->mRing.mChannelCount;
+		ioEngine->mRing.mKernels->mCopyScaledQuantized((const float*)ioData, (float*)ioData, theSampleCount, 1.0f, 0.0f, ioEngine->mQuantizeScale, ioEngine->mDither);
+	}
+	SyncAudioEngine_PackSamples(ioEngine, ioData, inFrameCount);
+}
+
+void	SyncAudioEngine_WriteMix(SyncAudioEngine* ioEngine, int64_t inSampleTime, void* ioData, uint32_t inFrameCount, uint64_t inCycle)
+{
+	//	a write that doesn't pick up where the last one ended leaves a gap no one will ever fill
+	if(inSampleTime > atomic_load_explicit(&ioEngine->mRing.mWriteTime, memory_order_relaxed))
+	{
+		ioEngine->mJitterSkipTime = inSampleTime;
+	}
+
+	//	the ring holds floats, so what ConvertOutput packed is unpacked again, in place like the
+	//	input's conversion
+	SyncAudioEngine_ConvertInput(ioEngine, ioData, inFrameCount);
+	SyncAudioRing_Mix(&ioEngine->mRing, inSampleTime, (const float*)ioData, inFrameCount, inCycle);
+}
+
+uint32_t	SyncAudioEngine_ReadBus(SyncAudioEngine* ioEngine, uint32_t inBus, int64_t inSampleTime, float inGain, float* ioReadGain, float* outData, uint32_t inFrameCount)
+{
+	int64_t theReadTime = 0;
+	return SyncAudioEngine_ReadRing(ioEngine, SyncAudioEngine_GetBusRing(ioEngine, inBus), inSampleTime, inGain, ioReadGain, outData, inFrameCount, &theReadTime);
+}
+
+void	SyncAudioEngine_WriteBus(SyncAudioEngine* ioEngine, uint32_t inBus, int64_t inSampleTime, const float* inData, uint32_t inFrameCount, uint64_t inCycle)
+{
+	SyncAudioRing_Mix(SyncAudioEngine_GetBusRing(ioEngine, inBus), inSampleTime, inData, inFrameCount, inCycle);
+}
+
+void	SyncAudioEngine_ScaleOutput(SyncAudioEngine* ioEngine, float* ioData, uint32_t inFrameCount, float inGain, float* ioGain)
+{
+	//	unity all the way through is by far the most common case and needs nothing done
+	float theGain = *ioGain;
+	if((theGain != 1.0f) || (inGain != 1.0f))
+	{
+		uint32_t theSampleCount = inFrameCount * ioEngine->mRing.mChannelCount;
+		float theGainStep = (theSampleCount > 0) ? (inGain - theGain) / (float)theSampleCount : 0.0f;
+		ioEngine->mRing.mKernels->mCopyScaled(ioData, ioData, theSampleCount, theGain, theGainStep);
+		*ioGain = inGain;
+	}
+}
+
+void	SyncAudioEngine_RecordOperation(SyncAudioEngine* ioEngine, uint32_t inOperation, uint64_t inStartHostTime, uint64_t inEndHostTime, uint64_t inTimeStampHostTime)
+{
+	SyncAudioEngineOperationStats* theStats = &ioEngine->mOperationStats[inOperation];
+	SyncAudioHistogram_Record(&theStats->mDuration, SyncAudioEngine_HostTicksToNanoseconds(ioEngine, inEndHostTime - inStartHostTime));
+
+	//	the jitter needs the operation before this one
+	if(theStats->mLastHostTime != 0)
+	{
+		int64_t theDeviation = (int64_t)((inStartHostTime - theStats->mLastHostTime) - (inTimeStampHostTime - theStats->mLastTimeStampHostTime));
+		uint64_t theJitter = (theDeviation < 0) ? (uint64_t)(-theDeviation) : (uint64_t)theDeviation;
+		SyncAudioHistogram_Record(&theStats->mJitter, SyncAudioEngine_HostTicksToNanoseconds(ioEngine, theJitter));
+	}
+	theStats->mLastHostTime = inStartHostTime;
+	theStats->mLastTimeStampHostTime = inTimeStampHostTime;
+}
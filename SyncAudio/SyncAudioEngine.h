@@ -0,0 +1,275 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+The loopback device's audio engine, independent of the HAL.
+*/
+
+/*==================================================================================================
+	SyncAudioEngine.h
+==================================================================================================*/
+#if !defined(__SyncAudioEngine_h__)
+#define __SyncAudioEngine_h__
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	System Includes
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+//	Local Includes
+#include "SyncAudioClock.h"
+#include "SyncAudioDrift.h"
+#include "SyncAudioPlatform.h"
+#include "SyncAudioResampler.h"
+#include "SyncAudioRing.h"
+#include "SyncAudioStats.h"
+
+//==================================================================================================
+#pragma mark -
+#pragma mark SyncAudioEngine
+//==================================================================================================
+
+//	SyncAudioEngine is everything the loopback device does that isn't talking to the HAL: the
+//	clock, the ring that carries the output back to the input, the delay line in front of the
+//	input and the gain ramp applied while reading it. It only depends on SyncAudioPlatform, so it
+//	builds and runs anywhere, and SyncAudio.c is an adapter that translates the HAL's calls into
+//	calls to it. The engine reads the host time through mHostClock, which is the platform's clock
+//	unless whoever hosts the engine provides another, so the whole IO cycle can also be driven
+//	from a virtual time line.
+//
+//	The control functions are called from whatever thread changes the device's state and must be
+//	serialized by the caller, which is what the HAL adapter's state mutex does. The IO functions
+//	are called from the IO thread only and never block, allocate or call the platform's storage.
+//	The two sides share the clock, the ring and mDelayFrames, which are all safe to use that way.
+//
+//	The delay is published to the IO thread as frames in 32.32 fixed point through a single atomic
+//	word so that retuning it never needs a lock. mDelayMilliseconds is the value that was set and
+//	is kept in the storage under kSyncAudioEngine_DelayStorageKey.
+//
+//	On top of the delay, the main ring and the buses are read mJitterFrames further back, which is
+//	the margin the IO thread keeps for a writer that is late. It starts at zero and is adjusted
+//	after each read of the main ring. A read that runs past what was written, and whose frames the
+//	writer goes on to write by the next read, grows it by the frames that were missing, up to
+//	kSyncAudioEngine_MaxJitterMilliseconds. A writer that skips ahead over them instead, as it does
+//	when IO starts or the IO thread stalls, never wrote them at all, so that doesn't count.
+//	mJitterSkipTime is where the writer last skipped to, which WriteMix keeps since it is the main
+//	ring's only writer. Every kSyncAudioEngine_JitterSettleSeconds of reads
+//	that found all their frames while the writer was writing shrinks it by a millisecond. A writer
+//	that has stopped underruns every read without ever catching up, so it leaves the margin alone.
+//	The margin is kept when IO restarts and is part of the input's latency. The input of an engine
+//	with a source is steered by the drift tracker instead and has no margin.
+//
+//	The engine also keeps statistics for each kind of IO operation, which the IO thread records
+//	with SyncAudioEngine_RecordOperation and anyone can read. mDuration is how long the operations
+//	took. mJitter is how far the time between two operations strayed from the time between the
+//	time stamps they were for, which is how late or early the IO thread woke up relative to the
+//	device's time line. Both are in nanoseconds and are cleared when IO starts. The underruns and
+//	overruns are counted by the ring. ProcessInput and ProcessOutput are done once for each client
+//	in a cycle, so their durations are per client, and the operations of the clients after the
+//	first in a cycle share its time stamp, which makes their jitter how long the clients before
+//	them took.
+//
+//	Besides mRing, which is bus 0, the engine has kSyncAudioEngine_MaxBusCount - 1 more buses
+//	for audio that is kept apart from the main mix, such as a single application's output. Their
+//	rings are the same size as mRing and are allocated by SyncAudioEngine_PrepareBus the first
+//	time something is routed through them, which is never on the IO thread. A bus's bit in mBusMask
+//	is published once its ring is ready, and the ring then lives until the engine is torn down.
+//	Reads of a bus go through the same delay line as reads of the main ring.
+//
+//	mRingFrameCapacity is how many frames the rings would hold at kSyncAudioEngine_MaxSampleRate.
+//	At any other rate they use the smallest power of two frames that covers the same span of time,
+//	so that the delay line reaches just as far back at every rate, and their storage is only
+//	allocated for mMaxSampleRate, the highest rate the engine is ever set to. The storage is wired
+//	for the life of the engine, so each ring costs a power of two frames times the channel count
+//	times 4 bytes at that rate, plus what SyncAudioRing_Initialize adds for the tags and a Float64
+//	mix, and a device that never goes above 48000 needs a quarter of what one at 192000 does. Changing the sample rate resizes them within their storage and
+//	empties them, so it must not race the IO functions, which the HAL sees to by stopping IO for
+//	the change.
+//
+//	When the device's physical format has fewer bits than a float's mantissa, the input and every
+//	bus read for a client's input are quantized to that resolution with dither as they are copied
+//	out of the ring, in the same pass that applies the gain, which leaves exactly the samples an
+//	integer stream would carry. Only a delay of a fraction of a frame, which has to interpolate
+//	first, or a source, which has to resample first, quantizes in a pass of its own. A buffer whose
+//	gain is zero all the way through, as it is when the input is muted, is left exactly silent
+//	without dither. mQuantizeScale is the
+//	number of steps per unit of the format, or zero for formats that need no quantizing, and
+//	mDither is the state of the dither generators, which only the IO thread touches after
+//	initialization. The resolution is part of the format, so it too must not change while IO is
+//	running.
+//
+//	mSampleBits is the size of the physical format's signed integer samples, or zero when the
+//	physical format is float. ReadInput and WriteMix work in the physical format, the way the HAL
+//	hands the main buffer to them, and SyncAudioEngine_ConvertInput and
+//	SyncAudioEngine_ConvertOutput convert between it and the floats everything else works in. The
+//	integers are packed and native endian, so 24 bit samples take three bytes. The conversions are
+//	done in place in a buffer with room for the frames as floats, which the HAL's main buffer
+//	always has. ReadInput has already quantized what it read, so packing it only changes how the
+//	samples are stored. The output has to be quantized with dither as it is packed, and is
+//	unpacked again as WriteMix copies it into the ring.
+//
+//	An engine can also take its input from another engine's main ring instead of its own, which
+//	lets one device play back what was written to another even when the two run at different
+//	sample rates. mSource is that engine, whose ring keeps the audio at the rate it was written at,
+//	and the input is read through mResampler. The frames to read are found by mapping the input's
+//	time line onto the source's through the host time, less the delay, so that the two devices
+//	stay lined up no matter when either one started. The source's ring gets a second reader that
+//	the source doesn't know about. It reads with SyncAudioRing_Peek, so the source's read cursor,
+//	its underrun and overrun counts and the margin worked out from them are the source's own
+//	reads' alone, and a read that races the source's own SyncAudioRing_Reset or
+//	SyncAudioRing_SetFrameCapacity, when it starts IO or changes its sample rate, comes back as
+//	silence rather than as frames laid out for another capacity. The source is set up along with
+//	the engines and must outlive this one.
+//
+//	Mapping through the host time only says where the source's frames should be. Where they are
+//	depends on when the source's IO thread writes them, so the read position is left to mDrift,
+//	which holds the input a steady distance behind what the source has written by steering the
+//	resampler's step a little, and re-anchors to the mapped position when the two jump apart.
+//	It starts over whenever this engine starts IO or changes its source, and its time constant is
+//	kSyncAudioEngine_DriftSeconds.
+#define	kSyncAudioEngine_MaxDelayMilliseconds	500.0
+#define	kSyncAudioEngine_MaxSampleRate			192000.0
+#define	kSyncAudioEngine_DriftSeconds			4.0
+#define	kSyncAudioEngine_MaxJitterMilliseconds	50.0
+#define	kSyncAudioEngine_JitterSettleSeconds	10.0
+#define	kSyncAudioEngine_DelayStorageKey		"delay milliseconds"
+#define	kSyncAudioEngine_MaxBusCount			4
+#define	kSyncAudioEngine_MainBus				0
+
+enum
+{
+	kSyncAudioEngine_ReadInputOperation		= 0,
+	kSyncAudioEngine_WriteMixOperation		= 1,
+	kSyncAudioEngine_ProcessInputOperation	= 2,
+	kSyncAudioEngine_ProcessOutputOperation	= 3,
+	kSyncAudioEngine_OperationCount			= 4
+};
+
+typedef struct SyncAudioEngineOperationStats
+{
+	SyncAudioHistogram	mDuration;
+	SyncAudioHistogram	mJitter;
+	uint64_t			mLastHostTime;
+	uint64_t			mLastTimeStampHostTime;
+} SyncAudioEngineOperationStats;
+
+typedef struct SyncAudioEngine
+{
+	SyncAudioRing		mRing;
+	SyncAudioRing		mBusRings[kSyncAudioEngine_MaxBusCount - 1];
+	_Atomic uint32_t	mBusMask;
+	uint32_t			mRingOptions;
+	SyncAudioClock		mClock;
+	SyncAudioStorage	mStorage;
+	SyncAudioHostClock	mHostClock;
+	double				mSampleRate;
+	double				mMaxSampleRate;
+	uint32_t			mRingFrameCapacity;
+	double				mDelayMilliseconds;
+	_Atomic uint64_t	mDelayFrames;
+	_Atomic uint32_t	mJitterFrames;
+	uint32_t			mMaxJitterFrames;
+	uint64_t			mJitterStableFrames;
+	int64_t				mJitterWriteTime;
+	int64_t				mJitterLateTime;
+	uint32_t			mJitterLateFrames;
+	int64_t				mJitterSkipTime;
+	float				mReadGain;
+	float				mQuantizeScale;
+	uint32_t			mSampleBits;
+	uint32_t			mDither[kSyncAudioKernels_DitherLaneCount];
+	struct SyncAudioEngine*	mSource;
+	SyncAudioResampler	mResampler;
+	SyncAudioDrift		mDrift;
+	SyncAudioEngineOperationStats	mOperationStats[kSyncAudioEngine_OperationCount];
+} SyncAudioEngine;
+
+//	Loads the settings from inStorage, which may be NULL, and allocates the ring. inHostClock may
+//	be NULL to use the platform's clock. inMaxSampleRate is the highest rate the engine will be set
+//	to, no higher than kSyncAudioEngine_MaxSampleRate. inRingFrameCapacity is the ring's capacity at
+//	kSyncAudioEngine_MaxSampleRate, a power of two, and inRingOptions is passed on to
+//	SyncAudioRing_Initialize.
+bool		SyncAudioEngine_Initialize(SyncAudioEngine* ioEngine, const SyncAudioStorage* inStorage, const SyncAudioHostClock* inHostClock, double inSampleRate, double inMaxSampleRate, uint32_t inChannelCount, uint32_t inRingFrameCapacity, uint32_t inZeroTimeStampPeriod, uint32_t inRingOptions);
+void		SyncAudioEngine_Teardown(SyncAudioEngine* ioEngine);
+
+//	Control functions. The caller serializes these. inSampleRate can be no higher than the
+//	engine's mMaxSampleRate and must not be changed while IO is running.
+void		SyncAudioEngine_SetSampleRate(SyncAudioEngine* ioEngine, double inSampleRate);
+double		SyncAudioEngine_GetDelayMilliseconds(const SyncAudioEngine* inEngine);
+
+//	The bytes of storage all the rings that have been allocated hold wired, which is the main ring
+//	plus one the size of it for each bus that has been prepared.
+size_t		SyncAudioEngine_GetRingByteSize(const SyncAudioEngine* inEngine);
+
+//	Makes the physical format inBits bit signed integers, which may be 16, 24 or 32, or floats if
+//	inBits is 0. The input is quantized to 16 and 24 bits, which a float can't hold exactly. Must
+//	not be changed while IO is running.
+void		SyncAudioEngine_SetPhysicalFormat(SyncAudioEngine* ioEngine, uint32_t inBits);
+
+//	The bytes a sample takes in the physical format.
+uint32_t	SyncAudioEngine_GetPhysicalBytesPerSample(const SyncAudioEngine* inEngine);
+
+//	Takes the input from inSource's main ring, converting it to this engine's sample rate with a
+//	resampler of the given kSyncAudioResampler_ quality, or from this engine's own ring again if
+//	inSource is NULL. inSource must have the same number of channels. Returns false if the resampler
+//	can't be set up, in which case the input is left alone. Must not be changed while IO is running.
+bool		SyncAudioEngine_SetSource(SyncAudioEngine* ioEngine, SyncAudioEngine* inSource, uint32_t inQuality);
+
+//	Clamps inDelayMilliseconds to [0, kSyncAudioEngine_MaxDelayMilliseconds] and returns whether
+//	that changed the delay, in which case it is also written to the storage.
+bool		SyncAudioEngine_SetDelayMilliseconds(SyncAudioEngine* ioEngine, double inDelayMilliseconds);
+
+//	Anchors the clock at the current host time, empties the rings, starts the drift tracking over
+//	and clears the statistics. The margin for a late writer is kept.
+void		SyncAudioEngine_StartIO(SyncAudioEngine* ioEngine);
+
+//	Allocates the ring of the given bus if it doesn't have one yet and returns whether it has one
+//	now. This can be called while IO is running.
+bool		SyncAudioEngine_PrepareBus(SyncAudioEngine* ioEngine, uint32_t inBus);
+
+//	The input's latency, which is the delay rounded up to a whole frame plus the margin for a late
+//	writer. Safe from any thread.
+uint32_t	SyncAudioEngine_GetInputLatency(const SyncAudioEngine* inEngine);
+
+//	IO functions, called from the IO thread only.
+uint64_t	SyncAudioEngine_GetHostTime(const SyncAudioEngine* inEngine);
+void		SyncAudioEngine_GetZeroTimeStamp(SyncAudioEngine* ioEngine, double* outSampleTime, uint64_t* outHostTime, uint64_t* outSeed);
+
+//	Fills outData with the frames written for inSampleTime less the delay and the margin, or the
+//	source's frames for the same time, ramping the gain from where the last read left it to inGain
+//	and quantizing them to the input's resolution, and adjusts the margin. The frames are left in
+//	the physical format, and outData must have room for them as floats. Returns the
+//	kSyncAudioRing_ flags of the read.
+uint32_t	SyncAudioEngine_ReadInput(SyncAudioEngine* ioEngine, int64_t inSampleTime, float inGain, void* outData, uint32_t inFrameCount);
+
+//	Converts the frames in ioData from the physical format to floats in place.
+void		SyncAudioEngine_ConvertInput(const SyncAudioEngine* inEngine, void* ioData, uint32_t inFrameCount);
+
+//	Converts the floats in ioData to the physical format in place, quantizing them with dither.
+void		SyncAudioEngine_ConvertOutput(SyncAudioEngine* ioEngine, void* ioData, uint32_t inFrameCount);
+
+//	Mixes ioData, which is in the physical format and is left as floats, into whatever else inCycle
+//	has written for inSampleTime.
+void		SyncAudioEngine_WriteMix(SyncAudioEngine* ioEngine, int64_t inSampleTime, void* ioData, uint32_t inFrameCount, uint64_t inCycle);
+
+//	The same as SyncAudioEngine_ReadInput and SyncAudioEngine_WriteMix for a bus that
+//	SyncAudioEngine_PrepareBus has prepared, but always in floats, since the HAL reads and writes
+//	the clients' buffers in the virtual format. Each reader of a bus keeps its own gain ramp in
+//	ioReadGain, and shares the quantizing with the input, so must be on the IO thread.
+uint32_t	SyncAudioEngine_ReadBus(SyncAudioEngine* ioEngine, uint32_t inBus, int64_t inSampleTime, float inGain, float* ioReadGain, float* outData, uint32_t inFrameCount);
+void		SyncAudioEngine_WriteBus(SyncAudioEngine* ioEngine, uint32_t inBus, int64_t inSampleTime, const float* inData, uint32_t inFrameCount, uint64_t inCycle);
+
+//	Scales inFrameCount frames of ioData in place, ramping the gain across them from ioGain to
+//	inGain, which is where ioGain is left. Each stream of audio being scaled keeps its own ramp.
+void		SyncAudioEngine_ScaleOutput(SyncAudioEngine* ioEngine, float* ioData, uint32_t inFrameCount, float inGain, float* ioGain);
+
+//	Records an operation of the given kind that ran from inStartHostTime to inEndHostTime for the
+//	time stamp whose host time is inTimeStampHostTime.
+void		SyncAudioEngine_RecordOperation(SyncAudioEngine* ioEngine, uint32_t inOperation, uint64_t inStartHostTime, uint64_t inEndHostTime, uint64_t inTimeStampHostTime);
+
+#endif	//	__SyncAudioEngine_h__
@@ -0,0 +1,615 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+The sample processing kernels used on the IO path.
+*/
+
+/*==================================================================================================
+	SyncAudioKernels.c
+==================================================================================================*/
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	Self Include
+#include "SyncAudioKernels.h"
+
+//	System Includes
+#include <math.h>
+#include <stddef.h>
+#if defined(__x86_64__) || defined(__i386__)
+	#include <immintrin.h>
+	#define	SyncAudioKernels_HasX86	1
+#elif defined(__ARM_NEON)
+	#include <arm_neon.h>
+	#define	SyncAudioKernels_HasNEON	1
+#endif
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Scalar
+//==================================================================================================
+
+//	The scalar kernels are the reference for the vector ones, which fall back to them for whatever
+//	doesn't fill a whole vector.
+//
+//	Every implementation of the interpolation is written once as an inline body that takes the
+//	channel count, and SyncAudioKernels_DefineInterpolateScaled builds the function for any channel
+//	count and the ones for each of kSyncAudioKernels_Widths out of it, with inTarget being the
+//	implementation's target attribute.
+
+#define	SyncAudioKernels_DefineInterpolateScaledWidth(inName, inTarget, inWidth)																\
+	inTarget static void	SyncAudioKernels_InterpolateScaled##inWidth##_##inName(float* ioData, const float* inPrevious, uint32_t inChannelCount, uint32_t inSampleCount, float inFraction, float inGain, float inGainStep)	\
+	{																																		\
+		(void)inChannelCount;																												\
+		SyncAudioKernels_InterpolateScaledBody_##inName(ioData, inPrevious, inWidth, inSampleCount, inFraction, inGain, inGainStep);		\
+	}
+
+#define	SyncAudioKernels_DefineInterpolateScaled(inName, inTarget)																			\
+	inTarget static void	SyncAudioKernels_InterpolateScaled_##inName(float* ioData, const float* inPrevious, uint32_t inChannelCount, uint32_t inSampleCount, float inFraction, float inGain, float inGainStep)	\
+	{																																		\
+		SyncAudioKernels_InterpolateScaledBody_##inName(ioData, inPrevious, inChannelCount, inSampleCount, inFraction, inGain, inGainStep);	\
+	}																																		\
+	SyncAudioKernels_DefineInterpolateScaledWidth(inName, inTarget, 1)																		\
+	SyncAudioKernels_DefineInterpolateScaledWidth(inName, inTarget, 2)																		\
+	SyncAudioKernels_DefineInterpolateScaledWidth(inName, inTarget, 6)																		\
+	SyncAudioKernels_DefineInterpolateScaledWidth(inName, inTarget, 8)
+
+//	The functions SyncAudioKernels_DefineInterpolateScaled built, in the order of a kernel table.
+#define	SyncAudioKernels_InterpolateScaledFunctions(inName)																					\
+	SyncAudioKernels_InterpolateScaled_##inName,																							\
+	{ SyncAudioKernels_InterpolateScaled1_##inName, SyncAudioKernels_InterpolateScaled2_##inName, SyncAudioKernels_InterpolateScaled6_##inName, SyncAudioKernels_InterpolateScaled8_##inName }
+
+static void	SyncAudioKernels_CopyScaled_Scalar(const float* inSource, float* outDest, uint32_t inSampleCount, float inGain, float inGainStep)
+{
+	for(uint32_t theIndex = 0; theIndex < inSampleCount; ++theIndex)
+	{
+		outDest[theIndex] = inSource[theIndex] * (inGain + (inGainStep * (float)theIndex));
+	}
+}
+
+//	The interpolation runs from the last sample down to the first so that every sample's
+//	predecessor in the buffer is still unmodified when it gets used. inStart is where the kernel
+//	was left off by a vector implementation, everything at and after it is already done.
+static inline void	SyncAudioKernels_InterpolateScaledFrom_Scalar(float* ioData, const float* inPrevious, uint32_t inChannelCount, uint32_t inStart, float inFraction, float inGain, float inGainStep)
+{
+	for(uint32_t theIndex = inStart; theIndex-- > 0; )
+	{
+		float theCurrent = ioData[theIndex];
+		float thePrevious = (theIndex >= inChannelCount) ? ioData[theIndex - inChannelCount] : inPrevious[theIndex];
+		ioData[theIndex] = (theCurrent + (inFraction * (thePrevious - theCurrent))) * (inGain + (inGainStep * (float)theIndex));
+	}
+}
+
+static inline __attribute__((always_inline)) void	SyncAudioKernels_InterpolateScaledBody_Scalar(float* ioData, const float* inPrevious, uint32_t inChannelCount, uint32_t inSampleCount, float inFraction, float inGain, float inGainStep)
+{
+	SyncAudioKernels_InterpolateScaledFrom_Scalar(ioData, inPrevious, inChannelCount, inSampleCount, inFraction, inGain, inGainStep);
+}
+
+SyncAudioKernels_DefineInterpolateScaled(Scalar, )
+
+static void	SyncAudioKernels_Mix_Scalar(const float* inSource, float* ioDest, uint32_t inSampleCount)
+{
+	for(uint32_t theIndex = 0; theIndex < inSampleCount; ++theIndex)
+	{
+		ioDest[theIndex] += inSource[theIndex];
+	}
+}
+
+static void	SyncAudioKernels_MixWide_Scalar(const float* inSource, double* ioSum, float* outDest, uint32_t inSampleCount)
+{
+	for(uint32_t theIndex = 0; theIndex < inSampleCount; ++theIndex)
+	{
+		ioSum[theIndex] += inSource[theIndex];
+		outDest[theIndex] = (float)ioSum[theIndex];
+	}
+}
+
+static inline uint32_t	SyncAudioKernels_NextDither(uint32_t inState)
+{
+	inState ^= inState << 13;
+	inState ^= inState >> 17;
+	inState ^= inState << 5;
+	return inState;
+}
+
+//	The vector kernels finish with this, so it advances only the first generator. The gain is
+//	folded into the scale to the quantizer's steps, so the ramp costs nothing more than the copy.
+static void	SyncAudioKernels_CopyScaledQuantized_Scalar(const float* inSource, float* outDest, uint32_t inSampleCount, float inGain, float inGainStep, float inScale, uint32_t* ioDither)
+{
+	float theMinimum = -inScale;
+	float theMaximum = inScale - 1.0f;
+	float theInverseScale = 1.0f / inScale;
+	uint32_t theDither = ioDither[0];
+	for(uint32_t theIndex = 0; theIndex < inSampleCount; ++theIndex)
+	{
+		theDither = SyncAudioKernels_NextDither(theDither);
+		float theNoise = ((float)(theDither >> 16) - (float)(theDither & 0xFFFF)) * (1.0f / 65536.0f);
+		float theValue = (inSource[theIndex] * ((inGain + (inGainStep * (float)theIndex)) * inScale)) + theNoise;
+		theValue = (theValue < theMinimum) ? theMinimum : ((theValue > theMaximum) ? theMaximum : theValue);
+		outDest[theIndex] = rintf(theValue) * theInverseScale;
+	}
+	ioDither[0] = theDither;
+}
+
+static float	SyncAudioKernels_Convolve_Scalar(const float* inSamples, const float* inTaps, const float* inNextTaps, float inFraction, uint32_t inTapCount)
+{
+	float theSum = 0.0f;
+	for(uint32_t theIndex = 0; theIndex < inTapCount; ++theIndex)
+	{
+		theSum += inSamples[theIndex] * (inTaps[theIndex] + (inFraction * (inNextTaps[theIndex] - inTaps[theIndex])));
+	}
+	return theSum;
+}
+
+static const SyncAudioKernels	kSyncAudioKernels_Scalar =
+{
+	"scalar",
+	SyncAudioKernels_CopyScaled_Scalar,
+	SyncAudioKernels_InterpolateScaledFunctions(Scalar),
+	SyncAudioKernels_Mix_Scalar,
+	SyncAudioKernels_MixWide_Scalar,
+	SyncAudioKernels_CopyScaledQuantized_Scalar,
+	SyncAudioKernels_Convolve_Scalar
+};
+
+//	The vector interpolation kernels need the number of samples that have their predecessor inside
+//	the buffer, rounded down to a whole number of vectors, and they handle the samples above that
+//	with the scalar kernel first.
+static inline uint32_t	SyncAudioKernels_VectorTop(uint32_t inChannelCount, uint32_t inSampleCount, uint32_t inVectorSize)
+{
+	uint32_t theAnswer = inChannelCount;
+	if(inSampleCount > inChannelCount)
+	{
+		theAnswer += ((inSampleCount - inChannelCount) / inVectorSize) * inVectorSize;
+	}
+	return theAnswer;
+}
+
+#if SyncAudioKernels_HasX86
+
+//==================================================================================================
+#pragma mark -
+#pragma mark SSE
+//==================================================================================================
+
+__attribute__((target("sse2")))
+static void	SyncAudioKernels_CopyScaled_SSE(const float* inSource, float* outDest, uint32_t inSampleCount, float inGain, float inGainStep)
+{
+	__m128 theStep = _mm_set1_ps(inGainStep);
+	__m128 theLanes = _mm_mul_ps(theStep, _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f));
+	uint32_t theIndex = 0;
+	for(; theIndex + 4 <= inSampleCount; theIndex += 4)
+	{
+		__m128 theGain = _mm_add_ps(_mm_set1_ps(inGain + (inGainStep * (float)theIndex)), theLanes);
+		_mm_storeu_ps(outDest + theIndex, _mm_mul_ps(_mm_loadu_ps(inSource + theIndex), theGain));
+	}
+	SyncAudioKernels_CopyScaled_Scalar(inSource + theIndex, outDest + theIndex, inSampleCount - theIndex, inGain + (inGainStep * (float)theIndex), inGainStep);
+}
+
+__attribute__((target("sse2")))
+static inline __attribute__((always_inline)) void	SyncAudioKernels_InterpolateScaledBody_SSE(float* ioData, const float* inPrevious, uint32_t inChannelCount, uint32_t inSampleCount, float inFraction, float inGain, float inGainStep)
+{
+	uint32_t theTop = SyncAudioKernels_VectorTop(inChannelCount, inSampleCount, 4);
+	for(uint32_t theIndex = inSampleCount; theIndex-- > theTop; )
+	{
+		float theCurrent = ioData[theIndex];
+		ioData[theIndex] = (theCurrent + (inFraction * (ioData[theIndex - inChannelCount] - theCurrent))) * (inGain + (inGainStep * (float)theIndex));
+	}
+	__m128 theFraction = _mm_set1_ps(inFraction);
+	__m128 theLanes = _mm_mul_ps(_mm_set1_ps(inGainStep), _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f));
+	for(uint32_t theIndex = theTop; theIndex > inChannelCount; )
+	{
+		theIndex -= 4;
+		__m128 theCurrent = _mm_loadu_ps(ioData + theIndex);
+		__m128 thePrevious = _mm_loadu_ps(ioData + theIndex - inChannelCount);
+		__m128 theGain = _mm_add_ps(_mm_set1_ps(inGain + (inGainStep * (float)theIndex)), theLanes);
+		__m128 theValue = _mm_add_ps(theCurrent, _mm_mul_ps(theFraction, _mm_sub_ps(thePrevious, theCurrent)));
+		_mm_storeu_ps(ioData + theIndex, _mm_mul_ps(theValue, theGain));
+	}
+	SyncAudioKernels_InterpolateScaledFrom_Scalar(ioData, inPrevious, inChannelCount, (inSampleCount < inChannelCount) ? inSampleCount : inChannelCount, inFraction, inGain, inGainStep);
+}
+
+SyncAudioKernels_DefineInterpolateScaled(SSE, __attribute__((target("sse2"))))
+
+__attribute__((target("sse2")))
+static void	SyncAudioKernels_Mix_SSE(const float* inSource, float* ioDest, uint32_t inSampleCount)
+{
+	uint32_t theIndex = 0;
+	for(; theIndex + 4 <= inSampleCount; theIndex += 4)
+	{
+		_mm_storeu_ps(ioDest + theIndex, _mm_add_ps(_mm_loadu_ps(ioDest + theIndex), _mm_loadu_ps(inSource + theIndex)));
+	}
+	SyncAudioKernels_Mix_Scalar(inSource + theIndex, ioDest + theIndex, inSampleCount - theIndex);
+}
+
+__attribute__((target("sse2")))
+static void	SyncAudioKernels_MixWide_SSE(const float* inSource, double* ioSum, float* outDest, uint32_t inSampleCount)
+{
+	uint32_t theIndex = 0;
+	for(; theIndex + 4 <= inSampleCount; theIndex += 4)
+	{
+		__m128 theSource = _mm_loadu_ps(inSource + theIndex);
+		__m128d theLow = _mm_add_pd(_mm_loadu_pd(ioSum + theIndex), _mm_cvtps_pd(theSource));
+		__m128d theHigh = _mm_add_pd(_mm_loadu_pd(ioSum + theIndex + 2), _mm_cvtps_pd(_mm_movehl_ps(theSource, theSource)));
+		_mm_storeu_pd(ioSum + theIndex, theLow);
+		_mm_storeu_pd(ioSum + theIndex + 2, theHigh);
+		_mm_storeu_ps(outDest + theIndex, _mm_movelh_ps(_mm_cvtpd_ps(theLow), _mm_cvtpd_ps(theHigh)));
+	}
+	SyncAudioKernels_MixWide_Scalar(inSource + theIndex, ioSum + theIndex, outDest + theIndex, inSampleCount - theIndex);
+}
+
+__attribute__((target("sse2")))
+static void	SyncAudioKernels_CopyScaledQuantized_SSE(const float* inSource, float* outDest, uint32_t inSampleCount, float inGain, float inGainStep, float inScale, uint32_t* ioDither)
+{
+	__m128i theDither = _mm_loadu_si128((const __m128i*)ioDither);
+	__m128i theLowMask = _mm_set1_epi32(0xFFFF);
+	__m128 theNoiseScale = _mm_set1_ps(1.0f / 65536.0f);
+	__m128 theScale = _mm_set1_ps(inScale);
+	__m128 theLanes = _mm_mul_ps(_mm_set1_ps(inGainStep), _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f));
+	__m128 theMinimum = _mm_set1_ps(-inScale);
+	__m128 theMaximum = _mm_set1_ps(inScale - 1.0f);
+	__m128 theInverseScale = _mm_set1_ps(1.0f / inScale);
+	uint32_t theIndex = 0;
+	for(; theIndex + 4 <= inSampleCount; theIndex += 4)
+	{
+		theDither = _mm_xor_si128(theDither, _mm_slli_epi32(theDither, 13));
+		theDither = _mm_xor_si128(theDither, _mm_srli_epi32(theDither, 17));
+		theDither = _mm_xor_si128(theDither, _mm_slli_epi32(theDither, 5));
+		__m128 theNoise = _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(_mm_srli_epi32(theDither, 16)), _mm_cvtepi32_ps(_mm_and_si128(theDither, theLowMask))), theNoiseScale);
+		__m128 theGain = _mm_mul_ps(_mm_add_ps(_mm_set1_ps(inGain + (inGainStep * (float)theIndex)), theLanes), theScale);
+		__m128 theValue = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(inSource + theIndex), theGain), theNoise);
+		theValue = _mm_min_ps(_mm_max_ps(theValue, theMinimum), theMaximum);
+		_mm_storeu_ps(outDest + theIndex, _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtps_epi32(theValue)), theInverseScale));
+	}
+	_mm_storeu_si128((__m128i*)ioDither, theDither);
+	SyncAudioKernels_CopyScaledQuantized_Scalar(inSource + theIndex, outDest + theIndex, inSampleCount - theIndex, inGain + (inGainStep * (float)theIndex), inGainStep, inScale, ioDither);
+}
+
+__attribute__((target("sse2")))
+static float	SyncAudioKernels_Convolve_SSE(const float* inSamples, const float* inTaps, const float* inNextTaps, float inFraction, uint32_t inTapCount)
+{
+	__m128 theFraction = _mm_set1_ps(inFraction);
+	__m128 theSum = _mm_setzero_ps();
+	uint32_t theIndex = 0;
+	for(; theIndex + 4 <= inTapCount; theIndex += 4)
+	{
+		__m128 theTaps = _mm_loadu_ps(inTaps + theIndex);
+		theTaps = _mm_add_ps(theTaps, _mm_mul_ps(theFraction, _mm_sub_ps(_mm_loadu_ps(inNextTaps + theIndex), theTaps)));
+		theSum = _mm_add_ps(theSum, _mm_mul_ps(_mm_loadu_ps(inSamples + theIndex), theTaps));
+	}
+	theSum = _mm_add_ps(theSum, _mm_movehl_ps(theSum, theSum));
+	theSum = _mm_add_ss(theSum, _mm_shuffle_ps(theSum, theSum, 1));
+	return _mm_cvtss_f32(theSum) + SyncAudioKernels_Convolve_Scalar(inSamples + theIndex, inTaps + theIndex, inNextTaps + theIndex, inFraction, inTapCount - theIndex);
+}
+
+static const SyncAudioKernels	kSyncAudioKernels_SSE =
+{
+	"sse",
+	SyncAudioKernels_CopyScaled_SSE,
+	SyncAudioKernels_InterpolateScaledFunctions(SSE),
+	SyncAudioKernels_Mix_SSE,
+	SyncAudioKernels_MixWide_SSE,
+	SyncAudioKernels_CopyScaledQuantized_SSE,
+	SyncAudioKernels_Convolve_SSE
+};
+
+//==================================================================================================
+#pragma mark -
+#pragma mark AVX2
+//==================================================================================================
+
+__attribute__((target("avx2,fma")))
+static void	SyncAudioKernels_CopyScaled_AVX2(const float* inSource, float* outDest, uint32_t inSampleCount, float inGain, float inGainStep)
+{
+	__m256 theStep = _mm256_set1_ps(inGainStep);
+	__m256 theLanes = _mm256_set_ps(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f);
+	uint32_t theIndex = 0;
+	for(; theIndex + 8 <= inSampleCount; theIndex += 8)
+	{
+		__m256 theGain = _mm256_fmadd_ps(theStep, theLanes, _mm256_set1_ps(inGain + (inGainStep * (float)theIndex)));
+		_mm256_storeu_ps(outDest + theIndex, _mm256_mul_ps(_mm256_loadu_ps(inSource + theIndex), theGain));
+	}
+	SyncAudioKernels_CopyScaled_Scalar(inSource + theIndex, outDest + theIndex, inSampleCount - theIndex, inGain + (inGainStep * (float)theIndex), inGainStep);
+}
+
+__attribute__((target("avx2,fma")))
+static inline __attribute__((always_inline)) void	SyncAudioKernels_InterpolateScaledBody_AVX2(float* ioData, const float* inPrevious, uint32_t inChannelCount, uint32_t inSampleCount, float inFraction, float inGain, float inGainStep)
+{
+	uint32_t theTop = SyncAudioKernels_VectorTop(inChannelCount, inSampleCount, 8);
+	for(uint32_t theIndex = inSampleCount; theIndex-- > theTop; )
+	{
+		float theCurrent = ioData[theIndex];
+		ioData[theIndex] = (theCurrent + (inFraction * (ioData[theIndex - inChannelCount] - theCurrent))) * (inGain + (inGainStep * (float)theIndex));
+	}
+	__m256 theFraction = _mm256_set1_ps(inFraction);
+	__m256 theStep = _mm256_set1_ps(inGainStep);
+	__m256 theLanes = _mm256_set_ps(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f);
+	for(uint32_t theIndex = theTop; theIndex > inChannelCount; )
+	{
+		theIndex -= 8;
+		__m256 theCurrent = _mm256_loadu_ps(ioData + theIndex);
+		__m256 thePrevious = _mm256_loadu_ps(ioData + theIndex - inChannelCount);
+		__m256 theGain = _mm256_fmadd_ps(theStep, theLanes, _mm256_set1_ps(inGain + (inGainStep * (float)theIndex)));
+		__m256 theValue = _mm256_fmadd_ps(theFraction, _mm256_sub_ps(thePrevious, theCurrent), theCurrent);
+		_mm256_storeu_ps(ioData + theIndex, _mm256_mul_ps(theValue, theGain));
+	}
+	SyncAudioKernels_InterpolateScaledFrom_Scalar(ioData, inPrevious, inChannelCount, (inSampleCount < inChannelCount) ? inSampleCount : inChannelCount, inFraction, inGain, inGainStep);
+}
+
+SyncAudioKernels_DefineInterpolateScaled(AVX2, __attribute__((target("avx2,fma"))))
+
+__attribute__((target("avx2,fma")))
+static void	SyncAudioKernels_Mix_AVX2(const float* inSource, float* ioDest, uint32_t inSampleCount)
+{
+	uint32_t theIndex = 0;
+	for(; theIndex + 8 <= inSampleCount; theIndex += 8)
+	{
+		_mm256_storeu_ps(ioDest + theIndex, _mm256_add_ps(_mm256_loadu_ps(ioDest + theIndex), _mm256_loadu_ps(inSource + theIndex)));
+	}
+	SyncAudioKernels_Mix_Scalar(inSource + theIndex, ioDest + theIndex, inSampleCount - theIndex);
+}
+
+__attribute__((target("avx2,fma")))
+static void	SyncAudioKernels_MixWide_AVX2(const float* inSource, double* ioSum, float* outDest, uint32_t inSampleCount)
+{
+	uint32_t theIndex = 0;
+	for(; theIndex + 4 <= inSampleCount; theIndex += 4)
+	{
+		__m256d theSum = _mm256_add_pd(_mm256_loadu_pd(ioSum + theIndex), _mm256_cvtps_pd(_mm_loadu_ps(inSource + theIndex)));
+		_mm256_storeu_pd(ioSum + theIndex, theSum);
+		_mm_storeu_ps(outDest + theIndex, _mm256_cvtpd_ps(theSum));
+	}
+	SyncAudioKernels_MixWide_Scalar(inSource + theIndex, ioSum + theIndex, outDest + theIndex, inSampleCount - theIndex);
+}
+
+__attribute__((target("avx2,fma")))
+static void	SyncAudioKernels_CopyScaledQuantized_AVX2(const float* inSource, float* outDest, uint32_t inSampleCount, float inGain, float inGainStep, float inScale, uint32_t* ioDither)
+{
+	__m256i theDither = _mm256_loadu_si256((const __m256i*)ioDither);
+	__m256i theLowMask = _mm256_set1_epi32(0xFFFF);
+	__m256 theNoiseScale = _mm256_set1_ps(1.0f / 65536.0f);
+	__m256 theScale = _mm256_set1_ps(inScale);
+	__m256 theLanes = _mm256_mul_ps(_mm256_set1_ps(inGainStep), _mm256_set_ps(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f));
+	__m256 theMinimum = _mm256_set1_ps(-inScale);
+	__m256 theMaximum = _mm256_set1_ps(inScale - 1.0f);
+	__m256 theInverseScale = _mm256_set1_ps(1.0f / inScale);
+	uint32_t theIndex = 0;
+	for(; theIndex + 8 <= inSampleCount; theIndex += 8)
+	{
+		theDither = _mm256_xor_si256(theDither, _mm256_slli_epi32(theDither, 13));
+		theDither = _mm256_xor_si256(theDither, _mm256_srli_epi32(theDither, 17));
+		theDither = _mm256_xor_si256(theDither, _mm256_slli_epi32(theDither, 5));
+		__m256 theNoise = _mm256_mul_ps(_mm256_sub_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(theDither, 16)), _mm256_cvtepi32_ps(_mm256_and_si256(theDither, theLowMask))), theNoiseScale);
+		__m256 theGain = _mm256_mul_ps(_mm256_add_ps(_mm256_set1_ps(inGain + (inGainStep * (float)theIndex)), theLanes), theScale);
+		__m256 theValue = _mm256_fmadd_ps(_mm256_loadu_ps(inSource + theIndex), theGain, theNoise);
+		theValue = _mm256_min_ps(_mm256_max_ps(theValue, theMinimum), theMaximum);
+		_mm256_storeu_ps(outDest + theIndex, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtps_epi32(theValue)), theInverseScale));
+	}
+	_mm256_storeu_si256((__m256i*)ioDither, theDither);
+	SyncAudioKernels_CopyScaledQuantized_Scalar(inSource + theIndex, outDest + theIndex, inSampleCount - theIndex, inGain + (inGainStep * (float)theIndex), inGainStep, inScale, ioDither);
+}
+
+__attribute__((target("avx2,fma")))
+static float	SyncAudioKernels_Convolve_AVX2(const float* inSamples, const float* inTaps, const float* inNextTaps, float inFraction, uint32_t inTapCount)
+{
+	__m256 theFraction = _mm256_set1_ps(inFraction);
+	__m256 theSum = _mm256_setzero_ps();
+	uint32_t theIndex = 0;
+	for(; theIndex + 8 <= inTapCount; theIndex += 8)
+	{
+		__m256 theTaps = _mm256_loadu_ps(inTaps + theIndex);
+		theTaps = _mm256_fmadd_ps(theFraction, _mm256_sub_ps(_mm256_loadu_ps(inNextTaps + theIndex), theTaps), theTaps);
+		theSum = _mm256_fmadd_ps(_mm256_loadu_ps(inSamples + theIndex), theTaps, theSum);
+	}
+	__m128 theHalf = _mm_add_ps(_mm256_castps256_ps128(theSum), _mm256_extractf128_ps(theSum, 1));
+	theHalf = _mm_add_ps(theHalf, _mm_movehl_ps(theHalf, theHalf));
+	theHalf = _mm_add_ss(theHalf, _mm_shuffle_ps(theHalf, theHalf, 1));
+	return _mm_cvtss_f32(theHalf) + SyncAudioKernels_Convolve_Scalar(inSamples + theIndex, inTaps + theIndex, inNextTaps + theIndex, inFraction, inTapCount - theIndex);
+}
+
+static const SyncAudioKernels	kSyncAudioKernels_AVX2 =
+{
+	"avx2",
+	SyncAudioKernels_CopyScaled_AVX2,
+	SyncAudioKernels_InterpolateScaledFunctions(AVX2),
+	SyncAudioKernels_Mix_AVX2,
+	SyncAudioKernels_MixWide_AVX2,
+	SyncAudioKernels_CopyScaledQuantized_AVX2,
+	SyncAudioKernels_Convolve_AVX2
+};
+
+#endif	//	SyncAudioKernels_HasX86
+
+#if SyncAudioKernels_HasNEON
+
+//==================================================================================================
+#pragma mark -
+#pragma mark NEON
+//==================================================================================================
+
+static void	SyncAudioKernels_CopyScaled_NEON(const float* inSource, float* outDest, uint32_t inSampleCount, float inGain, float inGainStep)
+{
+	static const float kLanes[4] = { 0.0f, 1.0f, 2.0f, 3.0f };
+	float32x4_t theLanes = vmulq_n_f32(vld1q_f32(kLanes), inGainStep);
+	uint32_t theIndex = 0;
+	for(; theIndex + 4 <= inSampleCount; theIndex += 4)
+	{
+		float32x4_t theGain = vaddq_f32(vdupq_n_f32(inGain + (inGainStep * (float)theIndex)), theLanes);
+		vst1q_f32(outDest + theIndex, vmulq_f32(vld1q_f32(inSource + theIndex), theGain));
+	}
+	SyncAudioKernels_CopyScaled_Scalar(inSource + theIndex, outDest + theIndex, inSampleCount - theIndex, inGain + (inGainStep * (float)theIndex), inGainStep);
+}
+
+static inline __attribute__((always_inline)) void	SyncAudioKernels_InterpolateScaledBody_NEON(float* ioData, const float* inPrevious, uint32_t inChannelCount, uint32_t inSampleCount, float inFraction, float inGain, float inGainStep)
+{
+	static const float kLanes[4] = { 0.0f, 1.0f, 2.0f, 3.0f };
+	uint32_t theTop = SyncAudioKernels_VectorTop(inChannelCount, inSampleCount, 4);
+	for(uint32_t theIndex = inSampleCount; theIndex-- > theTop; )
+	{
+		float theCurrent = ioData[theIndex];
+		ioData[theIndex] = (theCurrent + (inFraction * (ioData[theIndex - inChannelCount] - theCurrent))) * (inGain + (inGainStep * (float)theIndex));
+	}
+	float32x4_t theLanes = vmulq_n_f32(vld1q_f32(kLanes), inGainStep);
+	for(uint32_t theIndex = theTop; theIndex > inChannelCount; )
+	{
+		theIndex -= 4;
+		float32x4_t theCurrent = vld1q_f32(ioData + theIndex);
+		float32x4_t thePrevious = vld1q_f32(ioData + theIndex - inChannelCount);
+		float32x4_t theGain = vaddq_f32(vdupq_n_f32(inGain + (inGainStep * (float)theIndex)), theLanes);
+		float32x4_t theValue = vmlaq_n_f32(theCurrent, vsubq_f32(thePrevious, theCurrent), inFraction);
+		vst1q_f32(ioData + theIndex, vmulq_f32(theValue, theGain));
+	}
+	SyncAudioKernels_InterpolateScaledFrom_Scalar(ioData, inPrevious, inChannelCount, (inSampleCount < inChannelCount) ? inSampleCount : inChannelCount, inFraction, inGain, inGainStep);
+}
+
+SyncAudioKernels_DefineInterpolateScaled(NEON, )
+
+static void	SyncAudioKernels_Mix_NEON(const float* inSource, float* ioDest, uint32_t inSampleCount)
+{
+	uint32_t theIndex = 0;
+	for(; theIndex + 4 <= inSampleCount; theIndex += 4)
+	{
+		vst1q_f32(ioDest + theIndex, vaddq_f32(vld1q_f32(ioDest + theIndex), vld1q_f32(inSource + theIndex)));
+	}
+	SyncAudioKernels_Mix_Scalar(inSource + theIndex, ioDest + theIndex, inSampleCount - theIndex);
+}
+
+static float	SyncAudioKernels_Convolve_NEON(const float* inSamples, const float* inTaps, const float* inNextTaps, float inFraction, uint32_t inTapCount)
+{
+	float32x4_t theSum = vdupq_n_f32(0.0f);
+	uint32_t theIndex = 0;
+	for(; theIndex + 4 <= inTapCount; theIndex += 4)
+	{
+		float32x4_t theTaps = vld1q_f32(inTaps + theIndex);
+		theTaps = vmlaq_n_f32(theTaps, vsubq_f32(vld1q_f32(inNextTaps + theIndex), theTaps), inFraction);
+		theSum = vmlaq_f32(theSum, vld1q_f32(inSamples + theIndex), theTaps);
+	}
+	float32x2_t theHalf = vadd_f32(vget_low_f32(theSum), vget_high_f32(theSum));
+	return vget_lane_f32(vpadd_f32(theHalf, theHalf), 0) + SyncAudioKernels_Convolve_Scalar(inSamples + theIndex, inTaps + theIndex, inNextTaps + theIndex, inFraction, inTapCount - theIndex);
+}
+
+#if defined(__aarch64__)
+static void	SyncAudioKernels_MixWide_NEON(const float* inSource, double* ioSum, float* outDest, uint32_t inSampleCount)
+{
+	uint32_t theIndex = 0;
+	for(; theIndex + 4 <= inSampleCount; theIndex += 4)
+	{
+		float32x4_t theSource = vld1q_f32(inSource + theIndex);
+		float64x2_t theLow = vaddq_f64(vld1q_f64(ioSum + theIndex), vcvt_f64_f32(vget_low_f32(theSource)));
+		float64x2_t theHigh = vaddq_f64(vld1q_f64(ioSum + theIndex + 2), vcvt_high_f64_f32(theSource));
+		vst1q_f64(ioSum + theIndex, theLow);
+		vst1q_f64(ioSum + theIndex + 2, theHigh);
+		vst1q_f32(outDest + theIndex, vcvt_high_f32_f64(vcvt_f32_f64(theLow), theHigh));
+	}
+	SyncAudioKernels_MixWide_Scalar(inSource + theIndex, ioSum + theIndex, outDest + theIndex, inSampleCount - theIndex);
+}
+
+static void	SyncAudioKernels_CopyScaledQuantized_NEON(const float* inSource, float* outDest, uint32_t inSampleCount, float inGain, float inGainStep, float inScale, uint32_t* ioDither)
+{
+	static const float kLanes[4] = { 0.0f, 1.0f, 2.0f, 3.0f };
+	uint32x4_t theDither = vld1q_u32(ioDither);
+	uint32x4_t theLowMask = vdupq_n_u32(0xFFFF);
+	float32x4_t theLanes = vmulq_n_f32(vld1q_f32(kLanes), inGainStep);
+	float32x4_t theMinimum = vdupq_n_f32(-inScale);
+	float32x4_t theMaximum = vdupq_n_f32(inScale - 1.0f);
+	float theInverseScale = 1.0f / inScale;
+	uint32_t theIndex = 0;
+	for(; theIndex + 4 <= inSampleCount; theIndex += 4)
+	{
+		theDither = veorq_u32(theDither, vshlq_n_u32(theDither, 13));
+		theDither = veorq_u32(theDither, vshrq_n_u32(theDither, 17));
+		theDither = veorq_u32(theDither, vshlq_n_u32(theDither, 5));
+		float32x4_t theNoise = vmulq_n_f32(vsubq_f32(vcvtq_f32_u32(vshrq_n_u32(theDither, 16)), vcvtq_f32_u32(vandq_u32(theDither, theLowMask))), 1.0f / 65536.0f);
+		float32x4_t theGain = vmulq_n_f32(vaddq_f32(vdupq_n_f32(inGain + (inGainStep * (float)theIndex)), theLanes), inScale);
+		float32x4_t theValue = vmlaq_f32(theNoise, vld1q_f32(inSource + theIndex), theGain);
+		theValue = vminq_f32(vmaxq_f32(theValue, theMinimum), theMaximum);
+		vst1q_f32(outDest + theIndex, vmulq_n_f32(vcvtq_f32_s32(vcvtnq_s32_f32(theValue)), theInverseScale));
+	}
+	vst1q_u32(ioDither, theDither);
+	SyncAudioKernels_CopyScaledQuantized_Scalar(inSource + theIndex, outDest + theIndex, inSampleCount - theIndex, inGain + (inGainStep * (float)theIndex), inGainStep, inScale, ioDither);
+}
+#else
+	//	32 bit NEON has no double precision lanes and only rounds toward zero
+	#define	SyncAudioKernels_MixWide_NEON	SyncAudioKernels_MixWide_Scalar
+	#define	SyncAudioKernels_CopyScaledQuantized_NEON	SyncAudioKernels_CopyScaledQuantized_Scalar
+#endif
+
+static const SyncAudioKernels	kSyncAudioKernels_NEON =
+{
+	"neon",
+	SyncAudioKernels_CopyScaled_NEON,
+	SyncAudioKernels_InterpolateScaledFunctions(NEON),
+	SyncAudioKernels_Mix_NEON,
+	SyncAudioKernels_MixWide_NEON,
+	SyncAudioKernels_CopyScaledQuantized_NEON,
+	SyncAudioKernels_Convolve_NEON
+};
+
+#endif	//	SyncAudioKernels_HasNEON
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Selection
+//==================================================================================================
+
+const SyncAudioKernels*	SyncAudioKernels_Select(void)
+{
+	const SyncAudioKernels* theAnswer = &kSyncAudioKernels_Scalar;
+#if SyncAudioKernels_HasX86
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+	{
+		theAnswer = &kSyncAudioKernels_AVX2;
+	}
+	else if(__builtin_cpu_supports("sse2"))
+	{
+		theAnswer = &kSyncAudioKernels_SSE;
+	}
+#elif SyncAudioKernels_HasNEON
+	//	NEON is part of every processor this can run on
+	theAnswer = &kSyncAudioKernels_NEON;
+#endif
+	return theAnswer;
+}
+
+SyncAudioKernelsInterpolateScaledFunction	SyncAudioKernels_GetInterpolateScaled(const SyncAudioKernels* inKernels, uint32_t inChannelCount)
+{
+	static const uint32_t kWidths[kSyncAudioKernels_WidthCount] = kSyncAudioKernels_Widths;
+	SyncAudioKernelsInterpolateScaledFunction theAnswer = inKernels->mInterpolateScaled;
+	for(uint32_t theWidth = 0; theWidth < kSyncAudioKernels_WidthCount; ++theWidth)
+	{
+		if(kWidths[theWidth] == inChannelCount)
+		{
+			theAnswer = inKernels->mInterpolateScaledWidths[theWidth];
+		}
+	}
+	return theAnswer;
+}
+
+uint32_t	SyncAudioKernels_GetSupported(const SyncAudioKernels** outKernels, uint32_t inMaxCount)
+{
+	const SyncAudioKernels* theSupported[3] = { &kSyncAudioKernels_Scalar, NULL, NULL };
+	uint32_t theSupportedCount = 1;
+#if SyncAudioKernels_HasX86
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("sse2"))
+	{
+		theSupported[theSupportedCount++] = &kSyncAudioKernels_SSE;
+	}
+	if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+	{
+		theSupported[theSupportedCount++] = &kSyncAudioKernels_AVX2;
+	}
+#elif SyncAudioKernels_HasNEON
+	theSupported[theSupportedCount++] = &kSyncAudioKernels_NEON;
+#endif
+	uint32_t theAnswer = (theSupportedCount < inMaxCount) ? theSupportedCount : inMaxCount;
+	for(uint32_t theIndex = 0; theIndex < theAnswer; ++theIndex)
+	{
+		outKernels[theIndex] = theSupported[theIndex];
+	}
+	return theAnswer;
+}
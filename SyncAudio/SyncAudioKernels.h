@@ -0,0 +1,101 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+The sample processing kernels used on the IO path.
+*/
+
+/*==================================================================================================
+	SyncAudioKernels.h
+==================================================================================================*/
+#if !defined(__SyncAudioKernels_h__)
+#define __SyncAudioKernels_h__
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	System Includes
+#include <stdint.h>
+
+//==================================================================================================
+#pragma mark -
+#pragma mark SyncAudioKernels
+//==================================================================================================
+
+//	SyncAudioKernels is a table of the inner loops that touch every sample on the IO path. Each
+//	kernel does all of its work in a single pass so that a buffer is only streamed through the
+//	cache once. There is a scalar implementation of every kernel along with SSE, AVX2 and NEON
+//	ones, and SyncAudioKernels_Select picks the best one the processor supports. The selection
+//	checks the processor, so it should be done once outside of the IO path and the table kept.
+//
+//	Gains are ramped linearly across a buffer, sample by sample: sample i is scaled by
+//	inGain + (i * inGainStep). A mute is a ramp to zero, which keeps it from clicking.
+//
+//	Dither comes from kSyncAudioKernels_DitherLaneCount xorshift generators, one per vector lane,
+//	whose states the caller keeps between buffers. Each step of a generator makes one sample's
+//	noise out of the difference of its two halves, which has a triangular distribution one step of
+//	the quantizer wide on either side.
+//
+//	The convolution is the inner loop of the sample rate converter. It works on one channel's
+//	samples laid out one after the other, so that the samples and the taps line up lane for lane.
+//
+//	The interpolation is the only kernel that needs to know where one frame ends and the next
+//	starts, and its stride to the previous frame is the channel count. Every implementation of it
+//	is also built for each of the channel counts a device can have, kSyncAudioKernels_Widths, with
+//	the count as a constant the compiler can fold into the strides and the loop bounds.
+//	SyncAudioKernels_GetInterpolateScaled picks the one to keep for a given channel count. The
+//	other kernels walk flat runs of samples and do the same work per sample at any width.
+
+#define	kSyncAudioKernels_DitherLaneCount	8
+#define	kSyncAudioKernels_WidthCount		4
+#define	kSyncAudioKernels_Widths			{ 1, 2, 6, 8 }
+
+typedef void	(*SyncAudioKernelsInterpolateScaledFunction)(float* ioData, const float* inPrevious, uint32_t inChannelCount, uint32_t inSampleCount, float inFraction, float inGain, float inGainStep);
+
+typedef struct SyncAudioKernels
+{
+	const char*	mName;
+
+	//	outDest[i] = inSource[i] * gain(i). The buffers must either be the same or not overlap at all.
+	void		(*mCopyScaled)(const float* inSource, float* outDest, uint32_t inSampleCount, float inGain, float inGainStep);
+
+	//	Moves every frame of interleaved ioData inFraction of the way toward the frame before it
+	//	and scales the result by gain(i), in place. The frame before the first one is inPrevious.
+	SyncAudioKernelsInterpolateScaledFunction	mInterpolateScaled;
+
+	//	mInterpolateScaled for each of kSyncAudioKernels_Widths, where inChannelCount has to be the
+	//	width's.
+	SyncAudioKernelsInterpolateScaledFunction	mInterpolateScaledWidths[kSyncAudioKernels_WidthCount];
+
+	//	ioDest[i] += inSource[i].
+	void		(*mMix)(const float* inSource, float* ioDest, uint32_t inSampleCount);
+
+	//	ioSum[i] += inSource[i], then outDest[i] = ioSum[i], for mixing many sources without
+	//	losing precision to the running sum.
+	void		(*mMixWide)(const float* inSource, double* ioSum, float* outDest, uint32_t inSampleCount);
+
+	//	mCopyScaled, but with dither added to every sample and the result rounded to the nearest
+	//	multiple of 1 / inScale within [-1, 1 - (1 / inScale)], which is what converting it to
+	//	integer samples with inScale steps per unit and back does. With a gain of one and the same
+	//	buffer on both sides, it quantizes in place. ioDither holds the generators' states, none of
+	//	which may be zero.
+	void		(*mCopyScaledQuantized)(const float* inSource, float* outDest, uint32_t inSampleCount, float inGain, float inGainStep, float inScale, uint32_t* ioDither);
+
+	//	Returns the sum of inSamples[i] * (inTaps[i] + (inFraction * (inNextTaps[i] - inTaps[i]))),
+	//	which is one output sample of a filter whose taps are blended between two of its phases.
+	float		(*mConvolve)(const float* inSamples, const float* inTaps, const float* inNextTaps, float inFraction, uint32_t inTapCount);
+} SyncAudioKernels;
+
+const SyncAudioKernels*	SyncAudioKernels_Select(void);
+
+//	Returns the interpolation of inKernels built for inChannelCount channels, or the one for any
+//	channel count if there isn't one.
+SyncAudioKernelsInterpolateScaledFunction	SyncAudioKernels_GetInterpolateScaled(const SyncAudioKernels* inKernels, uint32_t inChannelCount);
+
+//	Stores up to inMaxCount of the kernels the processor supports in outKernels, starting with the
+//	scalar ones and ending with the ones SyncAudioKernels_Select picks, and returns how many it
+//	stored. This is for comparing them with each other in tests and benchmarks.
+uint32_t				SyncAudioKernels_GetSupported(const SyncAudioKernels** outKernels, uint32_t inMaxCount);
+
+#endif	//	__SyncAudioKernels_h__
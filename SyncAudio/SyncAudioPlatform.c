@@ -0,0 +1,99 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+The few services the SyncAudio core needs from the platform it runs on.
+*/
+
+/*==================================================================================================
+	SyncAudioPlatform.c
+==================================================================================================*/
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	Ask for POSIX, which has clock_gettime, when building with a strict C standard
+#if !defined(__APPLE__) && !defined(_POSIX_C_SOURCE)
+	#define	_POSIX_C_SOURCE	200809L
+#endif
+
+//	Self Include
+#include "SyncAudioPlatform.h"
+
+//	System Includes
+#include <stddef.h>
+#include <sys/resource.h>
+#if defined(__APPLE__)
+	#include <mach/mach_time.h>
+#else
+	#include <time.h>
+#endif
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Clock
+//==================================================================================================
+
+uint64_t	SyncAudioPlatform_GetHostTime(void)
+{
+#if defined(__APPLE__)
+	return mach_absolute_time();
+#else
+	struct timespec theTime;
+	clock_gettime(CLOCK_MONOTONIC, &theTime);
+	return ((uint64_t)theTime.tv_sec * 1000000000ULL) + (uint64_t)theTime.tv_nsec;
+#endif
+}
+
+void	SyncAudioPlatform_GetHostTicksPerSecond(uint64_t* outNumerator, uint64_t* outDenominator)
+{
+#if defined(__APPLE__)
+	//	a tick is numer / denom nanoseconds
+	struct mach_timebase_info theTimeBaseInfo;
+	mach_timebase_info(&theTimeBaseInfo);
+	*outNumerator = 1000000000ULL * theTimeBaseInfo.denom;
+	*outDenominator = theTimeBaseInfo.numer;
+#else
+	*outNumerator = 1000000000ULL;
+	*outDenominator = 1;
+#endif
+}
+
+static uint64_t	SyncAudioPlatform_GetHostTimeForContext(void* inContext)
+{
+	(void)inContext;
+	return SyncAudioPlatform_GetHostTime();
+}
+
+void	SyncAudioPlatform_GetHostClock(SyncAudioHostClock* outHostClock)
+{
+	outHostClock->mContext = NULL;
+	outHostClock->mGetHostTime = SyncAudioPlatform_GetHostTimeForContext;
+	SyncAudioPlatform_GetHostTicksPerSecond(&outHostClock->mTicksPerSecondNumerator, &outHostClock->mTicksPerSecondDenominator);
+}
+
+uint64_t	SyncAudioPlatform_GetPageFaultCount(void)
+{
+	struct rusage theUsage;
+	getrusage(RUSAGE_SELF, &theUsage);
+	return (uint64_t)theUsage.ru_minflt + (uint64_t)theUsage.ru_majflt;
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Storage
+//==================================================================================================
+
+bool	SyncAudioStorage_CopyNumber(const SyncAudioStorage* inStorage, const char* inKey, double* outValue)
+{
+	return (inStorage != NULL) && (inStorage->mCopyNumber != NULL) && inStorage->mCopyNumber(inStorage->mContext, inKey, outValue);
+}
+
+void	SyncAudioStorage_WriteNumber(const SyncAudioStorage* inStorage, const char* inKey, double inValue)
+{
+	if((inStorage != NULL) && (inStorage->mWriteNumber != NULL))
+	{
+		inStorage->mWriteNumber(inStorage->mContext, inKey, inValue);
+	}
+}
@@ -0,0 +1,75 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+The few services the SyncAudio core needs from the platform it runs on.
+*/
+
+/*==================================================================================================
+	SyncAudioPlatform.h
+==================================================================================================*/
+#if !defined(__SyncAudioPlatform_h__)
+#define __SyncAudioPlatform_h__
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	System Includes
+#include <stdbool.h>
+#include <stdint.h>
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Clock
+//==================================================================================================
+
+//	The host clock is mach_absolute_time on Apple platforms and CLOCK_MONOTONIC in nanoseconds
+//	everywhere else. Its frequency is given as an exact ratio so that the clock can do its
+//	arithmetic in integers.
+
+uint64_t	SyncAudioPlatform_GetHostTime(void);
+void		SyncAudioPlatform_GetHostTicksPerSecond(uint64_t* outNumerator, uint64_t* outDenominator);
+
+//	SyncAudioHostClock is the host clock as the core sees it. SyncAudioPlatform_GetHostClock
+//	returns the real one, and anything that hosts the core in place of the HAL, such as a
+//	simulator that runs the IO cycle on a virtual time line, can pass its own instead so that the
+//	clock only moves when it says so.
+
+typedef struct SyncAudioHostClock
+{
+	void*		mContext;
+	uint64_t	(*mGetHostTime)(void* inContext);
+	uint64_t	mTicksPerSecondNumerator;
+	uint64_t	mTicksPerSecondDenominator;
+} SyncAudioHostClock;
+
+void	SyncAudioPlatform_GetHostClock(SyncAudioHostClock* outHostClock);
+
+//	The number of page faults the process has taken so far, for checking that the IO path doesn't
+//	take any. This is a system call, so it is only for diagnostics.
+uint64_t	SyncAudioPlatform_GetPageFaultCount(void);
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Storage
+//==================================================================================================
+
+//	SyncAudioStorage is where the core keeps the settings that outlive the process. The HAL
+//	adapter backs it with the host's storage and anything else can back it with whatever it likes,
+//	or leave the callbacks NULL to keep nothing. The keys are C strings and the values are numbers.
+//	Neither callback is ever called on the IO path.
+
+typedef struct SyncAudioStorage
+{
+	void*	mContext;
+
+	//	Returns false if there is no number stored for inKey.
+	bool	(*mCopyNumber)(void* inContext, const char* inKey, double* outValue);
+	void	(*mWriteNumber)(void* inContext, const char* inKey, double inValue);
+} SyncAudioStorage;
+
+bool	SyncAudioStorage_CopyNumber(const SyncAudioStorage* inStorage, const char* inKey, double* outValue);
+void	SyncAudioStorage_WriteNumber(const SyncAudioStorage* inStorage, const char* inKey, double inValue);
+
+#endif	//	__SyncAudioPlatform_h__
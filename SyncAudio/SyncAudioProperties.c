@@ -0,0 +1,77 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+The registry the plug-in looks its properties up in.
+*/
+
+/*==================================================================================================
+	SyncAudioProperties.c
+==================================================================================================*/
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	Self Include
+#include "SyncAudioProperties.h"
+
+//	System Includes
+#include <string.h>
+
+//==================================================================================================
+#pragma mark -
+#pragma mark SyncAudioPropertyRegistry
+//==================================================================================================
+
+static inline uint32_t	SyncAudioPropertyRegistry_Hash(uint32_t inObjectKind, uint32_t inSelector)
+{
+	return ((inSelector ^ (inObjectKind << 28)) * 0x9E3779B1U) >> (32 - kSyncAudioPropertyRegistry_SlotShift);
+}
+
+bool	SyncAudioPropertyRegistry_Initialize(SyncAudioPropertyRegistry* ioRegistry, const SyncAudioPropertyInfo* inProperties, uint32_t inPropertyCount)
+{
+	memset(ioRegistry, 0, sizeof(SyncAudioPropertyRegistry));
+	ioRegistry->mProperties = inProperties;
+	bool theAnswer = inPropertyCount <= kSyncAudioPropertyRegistry_MaxCount;
+	for(uint32_t theIndex = 0; theAnswer && (theIndex < inPropertyCount); ++theIndex)
+	{
+		const SyncAudioPropertyInfo* theInfo = &inProperties[theIndex];
+		theAnswer = SyncAudioPropertyRegistry_Find(ioRegistry, theInfo->mObjectKind, theInfo->mSelector) == NULL;
+		if(theAnswer)
+		{
+			uint32_t theSlot = SyncAudioPropertyRegistry_Hash(theInfo->mObjectKind, theInfo->mSelector);
+			while(ioRegistry->mSlots[theSlot] != 0)
+			{
+				theSlot = (theSlot + 1) & (kSyncAudioPropertyRegistry_SlotCount - 1);
+			}
+			ioRegistry->mSlots[theSlot] = (uint16_t)(theIndex + 1);
+		}
+	}
+
+	if(theAnswer)
+	{
+		ioRegistry->mPropertyCount = inPropertyCount;
+	}
+	else
+	{
+		memset(ioRegistry->mSlots, 0, sizeof(ioRegistry->mSlots));
+	}
+	return theAnswer;
+}
+
+const SyncAudioPropertyInfo*	SyncAudioPropertyRegistry_Find(const SyncAudioPropertyRegistry* inRegistry, uint32_t inObjectKind, uint32_t inSelector)
+{
+	const SyncAudioPropertyInfo* theAnswer = NULL;
+	uint32_t theSlot = SyncAudioPropertyRegistry_Hash(inObjectKind, inSelector);
+	while((theAnswer == NULL) && (inRegistry->mSlots[theSlot] != 0))
+	{
+		const SyncAudioPropertyInfo* theInfo = &inRegistry->mProperties[inRegistry->mSlots[theSlot] - 1];
+		if((theInfo->mObjectKind == inObjectKind) && (theInfo->mSelector == inSelector))
+		{
+			theAnswer = theInfo;
+		}
+		theSlot = (theSlot + 1) & (kSyncAudioPropertyRegistry_SlotCount - 1);
+	}
+	return theAnswer;
+}
@@ -0,0 +1,66 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+The registry the plug-in looks its properties up in.
+*/
+
+/*==================================================================================================
+	SyncAudioProperties.h
+==================================================================================================*/
+#if !defined(__SyncAudioProperties_h__)
+#define __SyncAudioProperties_h__
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	System Includes
+#include <stdbool.h>
+#include <stdint.h>
+
+//==================================================================================================
+#pragma mark -
+#pragma mark SyncAudioPropertyRegistry
+//==================================================================================================
+
+//	SyncAudioPropertyRegistry finds the entry for a property given the kind of object it is asked
+//	of and its selector. The entries are a static table that whoever owns the registry lists every
+//	property in once, and what mObjectKind and mFlags mean is up to them. The HAL adapter's table
+//	is kPropertyRegistry_Properties in SyncAudio.c.
+//
+//	The lookup is a hash of the object kind and the selector into mSlots, an open addressed table
+//	with linear probing that SyncAudioPropertyRegistry_Initialize fills in from the entries. The
+//	table is kept at most half full, so a lookup touches one or two slots no matter how many
+//	properties there are. Each slot holds the index of an entry plus one, and zero when it's empty.
+//	Once it is initialized, the registry is only read, so any number of threads can look things up
+//	in it at once.
+
+#define	kSyncAudioPropertyRegistry_SlotShift	8
+#define	kSyncAudioPropertyRegistry_SlotCount	(1 << kSyncAudioPropertyRegistry_SlotShift)
+#define	kSyncAudioPropertyRegistry_MaxCount		(kSyncAudioPropertyRegistry_SlotCount / 2)
+
+typedef struct SyncAudioPropertyInfo
+{
+	uint32_t	mObjectKind;
+	uint32_t	mSelector;
+	uint32_t	mFlags;
+	uint32_t	mDataSize;
+} SyncAudioPropertyInfo;
+
+typedef struct SyncAudioPropertyRegistry
+{
+	const SyncAudioPropertyInfo*	mProperties;
+	uint32_t						mPropertyCount;
+	uint16_t						mSlots[kSyncAudioPropertyRegistry_SlotCount];
+} SyncAudioPropertyRegistry;
+
+//	inProperties must outlive the registry. Returns false, leaving the registry empty, if there are
+//	more than kSyncAudioPropertyRegistry_MaxCount of them or if two have the same kind and selector.
+bool	SyncAudioPropertyRegistry_Initialize(SyncAudioPropertyRegistry* ioRegistry, const SyncAudioPropertyInfo* inProperties, uint32_t inPropertyCount);
+
+//	Returns the entry for the given selector on the given kind of object, or NULL if that kind of
+//	object doesn't have that property.
+const SyncAudioPropertyInfo*	SyncAudioPropertyRegistry_Find(const SyncAudioPropertyRegistry* inRegistry, uint32_t inObjectKind, uint32_t inSelector);
+
+#endif	//	__SyncAudioProperties_h__
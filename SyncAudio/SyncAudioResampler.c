@@ -0,0 +1,289 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+The sample rate converter that reads one time line's ring at another time line's rate.
+*/
+
+/*==================================================================================================
+	SyncAudioResampler.c
+==================================================================================================*/
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	Ask for POSIX, which has posix_memalign and mlock, when building with a strict C standard
+#if !defined(__APPLE__) && !defined(_POSIX_C_SOURCE)
+	#define	_POSIX_C_SOURCE	200809L
+#endif
+
+//	Self Include
+#include "SyncAudioResampler.h"
+
+//	System Includes
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Filter Design
+//==================================================================================================
+
+#define	kSyncAudioResampler_Pi	3.14159265358979323846
+
+//	The qualities trade the width of the filter against the CPU it costs. The cutoff is where the
+//	filter is down 6 dB, as a fraction of the Nyquist frequency, and the window's beta sets the
+//	stop band's attenuation, which the width then turns into the width of the transition band.
+typedef struct SyncAudioResamplerQuality
+{
+	uint32_t	mTapCount;
+	double		mBeta;
+	double		mCutoff;
+} SyncAudioResamplerQuality;
+
+static const SyncAudioResamplerQuality	kSyncAudioResampler_Qualities[kSyncAudioResampler_QualityCount] =
+{
+	{ 8,	5.0,	0.70 },
+	{ 16,	6.5,	0.82 },
+	{ 32,	8.5,	0.90 },
+	{ kSyncAudioResampler_MaxTapCount,	10.5,	0.94 }
+};
+
+//	The zeroth order modified Bessel function of the first kind, from its power series, which
+//	converges quickly for the betas the qualities use.
+static double	SyncAudioResampler_BesselI0(double inX)
+{
+	double theAnswer = 1.0;
+	double theTerm = 1.0;
+	double theHalfX = inX / 2.0;
+	for(uint32_t theIndex = 1; theTerm > (theAnswer * 1e-12); ++theIndex)
+	{
+		theTerm *= (theHalfX / theIndex) * (theHalfX / theIndex);
+		theAnswer += theTerm;
+	}
+	return theAnswer;
+}
+
+//	The filter's impulse response inX frames from its center, which reaches zero at half its
+//	width. Its area is one, so it has unity gain at DC.
+static double	SyncAudioResampler_Filter(const SyncAudioResamplerQuality* inQuality, double inX)
+{
+	double theAnswer = 0.0;
+	double theHalfWidth = inQuality->mTapCount / 2;
+	if(fabs(inX) < theHalfWidth)
+	{
+		double theSinc = inQuality->mCutoff;
+		if(inX != 0.0)
+		{
+			theSinc = sin(kSyncAudioResampler_Pi * inQuality->mCutoff * inX) / (kSyncAudioResampler_Pi * inX);
+		}
+		double theWindow = inX / theHalfWidth;
+		theAnswer = theSinc * SyncAudioResampler_BesselI0(inQuality->mBeta * sqrt(1.0 - (theWindow * theWindow))) / SyncAudioResampler_BesselI0(inQuality->mBeta);
+	}
+	return theAnswer;
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Life Cycle
+//==================================================================================================
+
+bool	SyncAudioResampler_Initialize(SyncAudioResampler* ioResampler, uint32_t inQuality, uint32_t inChannelCount)
+{
+	bool theAnswer = false;
+	void* theStorage = NULL;
+
+	if((inQuality < kSyncAudioResampler_QualityCount) && (inChannelCount > 0) && (inChannelCount <= kSyncAudioRing_MaxChannelCount))
+	{
+		//	The prototype is one side of the filter, sampled kSyncAudioResampler_PhaseCount times per
+		//	frame with a zero on the end to interpolate toward. The phases are the whole filter at
+		//	each of those offsets plus the next frame's, the taps are the stretched filter's taps
+		//	for one frame, and the frames and planes are what the convolution runs over.
+		const SyncAudioResamplerQuality* theQuality = &kSyncAudioResampler_Qualities[inQuality];
+		size_t thePrototypeCount = ((size_t)(theQuality->mTapCount / 2) * kSyncAudioResampler_PhaseCount) + 2;
+		size_t thePhaseCount = (size_t)(kSyncAudioResampler_PhaseCount + 1) * theQuality->mTapCount;
+		size_t theTapCount = (size_t)kSyncAudioResampler_MaxTapCount * kSyncAudioResampler_MaxStep;
+		size_t theFrameCount = (size_t)kSyncAudioResampler_FrameCapacity * inChannelCount;
+		size_t thePageSize = (size_t)sysconf(_SC_PAGESIZE);
+		size_t theByteSize = (thePrototypeCount + thePhaseCount + theTapCount + (2 * theFrameCount)) * sizeof(float);
+		theByteSize = ((theByteSize + thePageSize - 1) / thePageSize) * thePageSize;
+		if(posix_memalign(&theStorage, thePageSize, theByteSize) == 0)
+		{
+			//	back and wire the pages the same way the ring does
+			memset(theStorage, 0, theByteSize);
+			ioResampler->mKernels = SyncAudioKernels_Select();
+			ioResampler->mQuality = inQuality;
+			ioResampler->mTapCount = theQuality->mTapCount;
+			ioResampler->mChannelCount = inChannelCount;
+			ioResampler->mPrototype = (float*)theStorage;
+			ioResampler->mPhases = ioResampler->mPrototype + thePrototypeCount;
+			ioResampler->mTaps = ioResampler->mPhases + thePhaseCount;
+			ioResampler->mFrames = ioResampler->mTaps + theTapCount;
+			ioResampler->mPlanes = ioResampler->mFrames + theFrameCount;
+			ioResampler->mStorage = theStorage;
+			ioResampler->mStorageByteSize = theByteSize;
+			ioResampler->mStorageIsLocked = mlock(theStorage, theByteSize) == 0;
+
+			//	tabulate the filter
+			for(size_t theIndex = 0; theIndex + 1 < thePrototypeCount; ++theIndex)
+			{
+				ioResampler->mPrototype[theIndex] = (float)SyncAudioResampler_Filter(theQuality, (double)theIndex / kSyncAudioResampler_PhaseCount);
+			}
+
+			//	Phase p puts tap k at (k - (width / 2) + 1 - (p / phase count)) frames from the
+			//	center, which always lands exactly on the prototype.
+			int32_t theHalfWidth = (int32_t)(theQuality->mTapCount / 2);
+			for(int32_t thePhase = 0; thePhase <= kSyncAudioResampler_PhaseCount; ++thePhase)
+			{
+				float* theTaps = ioResampler->mPhases + ((size_t)thePhase * theQuality->mTapCount);
+				for(int32_t theTap = 0; theTap < (int32_t)theQuality->mTapCount; ++theTap)
+				{
+					int32_t theOffset = ((theTap - theHalfWidth + 1) * kSyncAudioResampler_PhaseCount) - thePhase;
+					theTaps[theTap] = ioResampler->mPrototype[(theOffset < 0) ? -theOffset : theOffset];
+				}
+			}
+			theAnswer = true;
+		}
+	}
+	return theAnswer;
+}
+
+void	SyncAudioResampler_Teardown(SyncAudioResampler* ioResampler)
+{
+	if(ioResampler->mStorageIsLocked)
+	{
+		munlock(ioResampler->mStorage, ioResampler->mStorageByteSize);
+	}
+	free(ioResampler->mStorage);
+	ioResampler->mStorage = NULL;
+	ioResampler->mPrototype = NULL;
+	ioResampler->mPhases = NULL;
+	ioResampler->mTaps = NULL;
+	ioResampler->mFrames = NULL;
+	ioResampler->mPlanes = NULL;
+	ioResampler->mStorageByteSize = 0;
+	ioResampler->mStorageIsLocked = false;
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark IO Operations
+//==================================================================================================
+
+//	Works out the taps of the filter stretched by 1 / inCutoff for a frame inFraction past a frame
+//	of the ring, by interpolating the prototype.
+static void	SyncAudioResampler_StretchTaps(SyncAudioResampler* ioResampler, uint32_t inHalfWidth, float inCutoff, float inFraction)
+{
+	uint32_t theLastIndex = ((ioResampler->mTapCount / 2) * kSyncAudioResampler_PhaseCount) + 1;
+	float theScale = inCutoff * (float)kSyncAudioResampler_PhaseCount;
+	for(uint32_t theTap = 0; theTap < (2 * inHalfWidth); ++theTap)
+	{
+		float thePosition = fabsf(((float)theTap - (float)inHalfWidth + 1.0f) - inFraction) * theScale;
+		uint32_t theIndex = (uint32_t)thePosition;
+		float theTapValue = 0.0f;
+		if(theIndex < theLastIndex)
+		{
+			float theBlend = thePosition - (float)theIndex;
+			theTapValue = inCutoff * (ioResampler->mPrototype[theIndex] + (theBlend * (ioResampler->mPrototype[theIndex + 1] - ioResampler->mPrototype[theIndex])));
+		}
+		ioResampler->mTaps[theTap] = theTapValue;
+	}
+}
+
+uint32_t	SyncAudioResampler_Read(SyncAudioResampler* ioResampler, const SyncAudioRing* inRing, int64_t inSampleTime, uint32_t inFraction, uint64_t inStep, float* outData, uint32_t inFrameCount)
+{
+	uint32_t theAnswer = kSyncAudioRing_NoError;
+	uint32_t theChannelCount = ioResampler->mChannelCount;
+	if((inStep == 0) || (inStep > ((uint64_t)kSyncAudioResampler_MaxStep << 32)))
+	{
+		//	the rates are too far apart to convert between
+		memset(outData, 0, (size_t)inFrameCount * theChannelCount * sizeof(float));
+		theAnswer = kSyncAudioRing_Underrun;
+		inFrameCount = 0;
+	}
+
+	//	Reading slower than the ring is written means stretching the filter to cut off below the
+	//	reader's Nyquist frequency, which widens it by the same ratio. Only the drift correction
+	//	never gets it there.
+	bool isStretched = inStep > kSyncAudioResampler_StretchStep;
+	uint32_t theHalfWidth = ioResampler->mTapCount / 2;
+	float theCutoff = 1.0f;
+	if(isStretched)
+	{
+		theHalfWidth = (uint32_t)((((uint64_t)theHalfWidth * inStep) + 0xFFFFFFFFULL) >> 32);
+		theCutoff = (float)(4294967296.0 / (double)inStep);
+	}
+	uint32_t theTapCount = 2 * theHalfWidth;
+
+	//	the most frames whose taps all fit in the frames fetched at once
+	uint32_t theMaxFrameCount = (uint32_t)(((uint64_t)(kSyncAudioResampler_FrameCapacity - theTapCount - 1) << 32) / inStep) + 1;
+
+	int64_t theSampleTime = inSampleTime;
+	uint64_t theOffset = inFraction;
+	for(uint32_t theFrameIndex = 0; theFrameIndex < inFrameCount; )
+	{
+		uint32_t theFrameCount = inFrameCount - theFrameIndex;
+		if(theFrameCount > theMaxFrameCount)
+		{
+			theFrameCount = theMaxFrameCount;
+		}
+
+		//	fetch the frames under the taps of this run, and split them into channels
+		int64_t theFirst = theSampleTime - theHalfWidth + 1;
+		int64_t theLast = theSampleTime + (int64_t)((theOffset + ((uint64_t)(theFrameCount - 1) * inStep)) >> 32) + theHalfWidth + 1;
+		uint32_t theFetchCount = (uint32_t)(theLast - theFirst);
+		theAnswer |= SyncAudioRing_Peek(inRing, theFirst, ioResampler->mFrames, theFetchCount);
+		const float* thePlanes = ioResampler->mFrames;
+		if(theChannelCount > 1)
+		{
+			for(uint32_t theChannel = 0; theChannel < theChannelCount; ++theChannel)
+			{
+				float* thePlane = ioResampler->mPlanes + ((size_t)theChannel * kSyncAudioResampler_FrameCapacity);
+				for(uint32_t theIndex = 0; theIndex < theFetchCount; ++theIndex)
+				{
+					thePlane[theIndex] = ioResampler->mFrames[(theIndex * theChannelCount) + theChannel];
+				}
+			}
+			thePlanes = ioResampler->mPlanes;
+		}
+
+		//	filter each frame from the frames around its position
+		float* theOutput = outData + ((size_t)theFrameIndex * theChannelCount);
+		for(uint32_t theIndex = 0; theIndex < theFrameCount; ++theIndex)
+		{
+			uint64_t thePosition = theOffset + ((uint64_t)theIndex * inStep);
+			uint32_t theStart = (uint32_t)(thePosition >> 32);
+			uint32_t theFraction = (uint32_t)thePosition;
+			const float* theTaps = ioResampler->mTaps;
+			const float* theNextTaps = ioResampler->mTaps;
+			float theBlend = 0.0f;
+			if(isStretched)
+			{
+				SyncAudioResampler_StretchTaps(ioResampler, theHalfWidth, theCutoff, (float)theFraction * (1.0f / 4294967296.0f));
+			}
+			else
+			{
+				uint64_t thePhase = (uint64_t)theFraction * kSyncAudioResampler_PhaseCount;
+				theTaps = ioResampler->mPhases + ((thePhase >> 32) * theTapCount);
+				theNextTaps = theTaps + theTapCount;
+				theBlend = (float)(uint32_t)thePhase * (1.0f / 4294967296.0f);
+			}
+			for(uint32_t theChannel = 0; theChannel < theChannelCount; ++theChannel)
+			{
+				const float* theSamples = thePlanes + ((size_t)theChannel * kSyncAudioResampler_FrameCapacity) + theStart;
+				theOutput[(theIndex * theChannelCount) + theChannel] = ioResampler->mKernels->mConvolve(theSamples, theTaps, theNextTaps, theBlend, theTapCount);
+			}
+		}
+
+		//	move on to the next run
+		theOffset += (uint64_t)theFrameCount * inStep;
+		theSampleTime += (int64_t)(theOffset >> 32);
+		theOffset &= 0xFFFFFFFFULL;
+		theFrameIndex += theFrameCount;
+	}
+	return theAnswer;
+}
@@ -0,0 +1,105 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+The sample rate converter that reads one time line's ring at another time line's rate.
+*/
+
+/*==================================================================================================
+	SyncAudioResampler.h
+==================================================================================================*/
+#if !defined(__SyncAudioResampler_h__)
+#define __SyncAudioResampler_h__
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	System Includes
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+//	Local Includes
+#include "SyncAudioKernels.h"
+#include "SyncAudioRing.h"
+
+//==================================================================================================
+#pragma mark -
+#pragma mark SyncAudioResampler
+//==================================================================================================
+
+//	SyncAudioResampler reads frames out of a ring whose time line runs at a different rate than
+//	the reader's. The reader asks for a run of frames by giving the position of the first one on
+//	the ring's time line and the distance between them, both in units of 2^-32 frames, so the
+//	resampler itself keeps no state between reads and a discontinuity on either time line costs
+//	nothing but the frames that straddle it.
+//
+//	Each output frame is a windowed sinc interpolation of the ring's frames around its position.
+//	The filter is a Kaiser windowed sinc whose width, window and cutoff are set by the quality,
+//	and it is tabulated once, when the resampler is initialized, as kSyncAudioResampler_PhaseCount
+//	phases of mTapCount taps each. A frame's taps are blended between the two phases on either
+//	side of its position, in the same pass as the convolution. When the reader's rate is lower
+//	than the ring's by more than kSyncAudioResampler_StretchStep allows, the filter is stretched by the ratio of the rates to move its cutoff below
+//	the reader's Nyquist frequency, and its taps are worked out from the table for every frame.
+//
+//	The ring's frames are fetched into mFrames and split into one plane per channel in mPlanes,
+//	so that the convolution kernel runs over contiguous samples. Both are kSyncAudioResampler_
+//	FrameCapacity frames long, and a read that needs more than that is done in pieces. Everything
+//	is allocated, touched and wired down by SyncAudioResampler_Initialize, so
+//	SyncAudioResampler_Read never allocates or takes a page fault. The positions that are read
+//	are subject to the ring's usual underrun and overrun checks.
+
+#define	kSyncAudioResampler_PhaseCount		256
+#define	kSyncAudioResampler_FrameCapacity	2048
+#define	kSyncAudioResampler_MaxTapCount		64
+
+//	The reader can't be more than this many times slower than the ring.
+#define	kSyncAudioResampler_MaxStep			8
+
+//	The step, in units of 2^-32 frames, past which the filter is stretched. It is about twice the
+//	most SyncAudioDrift ever steers a step away from the ratio of the rates, so a reader following a
+//	ring at the same nominal rate stays on the tabulated phases however the drift moves it, rather
+//	than flipping to the stretched filter, and its different response and cost, every time the
+//	correction crosses zero. The filters' cutoffs leave more room than that below Nyquist, and the
+//	closest pair of different rates a device has, 44.1 and 48 kHz, is 8.8% apart.
+#define	kSyncAudioResampler_StretchStep		((1ULL << 32) + (1ULL << 23))
+
+enum
+{
+	kSyncAudioResampler_QualityLow		= 0,
+	kSyncAudioResampler_QualityMedium	= 1,
+	kSyncAudioResampler_QualityHigh		= 2,
+	kSyncAudioResampler_QualityBest		= 3,
+	kSyncAudioResampler_QualityCount	= 4
+};
+
+typedef struct SyncAudioResampler
+{
+	const SyncAudioKernels*	mKernels;
+	uint32_t			mQuality;
+	uint32_t			mTapCount;
+	uint32_t			mChannelCount;
+	float*				mPrototype;
+	float*				mPhases;
+	float*				mTaps;
+	float*				mFrames;
+	float*				mPlanes;
+	void*				mStorage;
+	size_t				mStorageByteSize;
+	bool				mStorageIsLocked;
+} SyncAudioResampler;
+
+//	inQuality is one of the kSyncAudioResampler_Quality constants and inChannelCount is no larger
+//	than kSyncAudioRing_MaxChannelCount.
+bool		SyncAudioResampler_Initialize(SyncAudioResampler* ioResampler, uint32_t inQuality, uint32_t inChannelCount);
+void		SyncAudioResampler_Teardown(SyncAudioResampler* ioResampler);
+
+//	Called by any reader of the ring. Fills outData with inFrameCount frames of inRing, which
+//	must have the resampler's channel count, the first at inSampleTime plus inFraction and each
+//	after that inStep further along, and returns the kSyncAudioRing_ flags of the reads. A step
+//	of zero or more than kSyncAudioResampler_MaxStep frames returns silence. The frames are fetched
+//	with SyncAudioRing_Peek, so the read leaves the ring's cursor and counts to its consumer.
+uint32_t	SyncAudioResampler_Read(SyncAudioResampler* ioResampler, const SyncAudioRing* inRing, int64_t inSampleTime, uint32_t inFraction, uint64_t inStep, float* outData, uint32_t inFrameCount);
+
+#endif	//	__SyncAudioResampler_h__
@@ -0,0 +1,567 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+The loopback ring that carries audio from the output stream to the input stream.
+*/
+
+/*==================================================================================================
+	SyncAudioRing.c
+==================================================================================================*/
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	Ask for POSIX, which has posix_memalign and mlock, when building with a strict C standard
+#if !defined(__APPLE__) && !defined(_POSIX_C_SOURCE)
+	#define	_POSIX_C_SOURCE	200809L
+#endif
+
+//	Self Include
+#include "SyncAudioRing.h"
+
+//	System Includes
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Frame Operations
+//==================================================================================================
+
+//	These move frames between the ring and a linear buffer, splitting the transfer in two when it
+//	wraps around the end of the ring. The caller is responsible for inFrameCount being no larger
+//	than the capacity.
+
+static inline int64_t	SyncAudioRing_Min(int64_t inA, int64_t inB)
+{
+	return (inA < inB) ? inA : inB;
+}
+
+static inline int64_t	SyncAudioRing_Max(int64_t inA, int64_t inB)
+{
+	return (inA > inB) ? inA : inB;
+}
+
+//	The capacity only changes under mSequence, and a reader that races the change loads it once
+//	and does all of its indexing with that, so that it never strays outside the storage.
+static inline uint32_t	SyncAudioRing_GetFrameCapacity(const SyncAudioRing* inRing)
+{
+	return atomic_load_explicit(&inRing->mFrameCapacity, memory_order_relaxed);
+}
+
+//	The capacity is a power of two, so a sample time maps to its frame by masking.
+static inline uint32_t	SyncAudioRing_FrameIndex(uint32_t inFrameCapacity, int64_t inSampleTime)
+{
+	return (uint32_t)((uint64_t)inSampleTime & (inFrameCapacity - 1));
+}
+
+static void	SyncAudioRing_StoreFrames(SyncAudioRing* ioRing, int64_t inSampleTime, const float* inData, uint32_t inFrameCount)
+{
+	uint32_t theCapacity = SyncAudioRing_GetFrameCapacity(ioRing);
+	uint32_t theStart = SyncAudioRing_FrameIndex(theCapacity, inSampleTime);
+	uint32_t theFirstPart = theCapacity - theStart;
+	if(theFirstPart > inFrameCount)
+	{
+		theFirstPart = inFrameCount;
+	}
+	memcpy(ioRing->mBuffer + (theStart * ioRing->mChannelCount), inData, theFirstPart * ioRing->mChannelCount * sizeof(float));
+	memcpy(ioRing->mBuffer, inData + (theFirstPart * ioRing->mChannelCount), (inFrameCount - theFirstPart) * ioRing->mChannelCount * sizeof(float));
+	if(ioRing->mMixBuffer != NULL)
+	{
+		//	keep the sums the mixes start from in step
+		uint32_t theSampleCount = inFrameCount * ioRing->mChannelCount;
+		uint32_t theRingIndex = theStart * ioRing->mChannelCount;
+		uint32_t theRingSampleCount = theCapacity * ioRing->mChannelCount;
+		for(uint32_t theIndex = 0; theIndex < theSampleCount; ++theIndex)
+		{
+			ioRing->mMixBuffer[theRingIndex] = inData[theIndex];
+			theRingIndex = (theRingIndex + 1 < theRingSampleCount) ? theRingIndex + 1 : 0;
+		}
+	}
+}
+
+static void	SyncAudioRing_MixFrames(SyncAudioRing* ioRing, int64_t inSampleTime, const float* inData, uint32_t inFrameCount)
+{
+	uint32_t theCapacity = SyncAudioRing_GetFrameCapacity(ioRing);
+	uint32_t theStart = SyncAudioRing_FrameIndex(theCapacity, inSampleTime);
+	uint32_t theFirstPart = theCapacity - theStart;
+	if(theFirstPart > inFrameCount)
+	{
+		theFirstPart = inFrameCount;
+	}
+	uint32_t theFirstSamples = theFirstPart * ioRing->mChannelCount;
+	uint32_t theSecondSamples = (inFrameCount - theFirstPart) * ioRing->mChannelCount;
+	uint32_t theRingIndex = theStart * ioRing->mChannelCount;
+	if(ioRing->mMixBuffer != NULL)
+	{
+		ioRing->mKernels->mMixWide(inData, ioRing->mMixBuffer + theRingIndex, ioRing->mBuffer + theRingIndex, theFirstSamples);
+		ioRing->mKernels->mMixWide(inData + theFirstSamples, ioRing->mMixBuffer, ioRing->mBuffer, theSecondSamples);
+	}
+	else
+	{
+		ioRing->mKernels->mMix(inData, ioRing->mBuffer + theRingIndex, theFirstSamples);
+		ioRing->mKernels->mMix(inData + theFirstSamples, ioRing->mBuffer, theSecondSamples);
+	}
+}
+
+//	Fetching applies the gain ramp on the way out of the ring unless it is unity, and quantizes in
+//	the same pass when there is an inQuantizeScale.
+static void	SyncAudioRing_FetchFrames(const SyncAudioRing* inRing, uint32_t inFrameCapacity, int64_t inSampleTime, float* outData, uint32_t inFrameCount, float inGain, float inGainStep, float inQuantizeScale, uint32_t* ioDither)
+{
+	uint32_t theStart = SyncAudioRing_FrameIndex(inFrameCapacity, inSampleTime);
+	uint32_t theFirstPart = inFrameCapacity - theStart;
+	if(theFirstPart > inFrameCount)
+	{
+		theFirstPart = inFrameCount;
+	}
+	uint32_t theFirstSamples = theFirstPart * inRing->mChannelCount;
+	uint32_t theSecondSamples = (inFrameCount - theFirstPart) * inRing->mChannelCount;
+	if(inQuantizeScale != 0.0f)
+	{
+		inRing->mKernels->mCopyScaledQuantized(inRing->mBuffer + (theStart * inRing->mChannelCount), outData, theFirstSamples, inGain, inGainStep, inQuantizeScale, ioDither);
+		inRing->mKernels->mCopyScaledQuantized(inRing->mBuffer, outData + theFirstSamples, theSecondSamples, inGain + (inGainStep * (float)theFirstSamples), inGainStep, inQuantizeScale, ioDither);
+	}
+	else if((inGain == 1.0f) && (inGainStep == 0.0f))
+	{
+		memcpy(outData, inRing->mBuffer + (theStart * inRing->mChannelCount), theFirstSamples * sizeof(float));
+		memcpy(outData + theFirstSamples, inRing->mBuffer, theSecondSamples * sizeof(float));
+	}
+	else
+	{
+		inRing->mKernels->mCopyScaled(inRing->mBuffer + (theStart * inRing->mChannelCount), outData, theFirstSamples, inGain, inGainStep);
+		inRing->mKernels->mCopyScaled(inRing->mBuffer, outData + theFirstSamples, theSecondSamples, inGain + (inGainStep * (float)theFirstSamples), inGainStep);
+	}
+}
+
+static void	SyncAudioRing_ClearFrames(SyncAudioRing* ioRing, int64_t inSampleTime, uint32_t inFrameCount)
+{
+	uint32_t theCapacity = SyncAudioRing_GetFrameCapacity(ioRing);
+	uint32_t theStart = SyncAudioRing_FrameIndex(theCapacity, inSampleTime);
+	uint32_t theFirstPart = theCapacity - theStart;
+	if(theFirstPart > inFrameCount)
+	{
+		theFirstPart = inFrameCount;
+	}
+	memset(ioRing->mBuffer + (theStart * ioRing->mChannelCount), 0, theFirstPart * ioRing->mChannelCount * sizeof(float));
+	memset(ioRing->mBuffer, 0, (inFrameCount - theFirstPart) * ioRing->mChannelCount * sizeof(float));
+}
+
+//	The block tags are read and written without ordering. The writer only changes the tag of a block
+//	it is about to overwrite, which is already covered by mWriteReserve, and the reader only trusts
+//	a tag for frames below the mWriteTime it acquired.
+
+static inline int64_t	SyncAudioRing_BlockIndex(int64_t inSampleTime)
+{
+	return inSampleTime >> kSyncAudioRing_BlockFrameShift;
+}
+
+static inline _Atomic int64_t*	SyncAudioRing_BlockTag(const SyncAudioRing* inRing, uint32_t inFrameCapacity, int64_t inBlockIndex)
+{
+	return inRing->mBlockTags + (uint32_t)((uint64_t)inBlockIndex & ((inFrameCapacity >> kSyncAudioRing_BlockFrameShift) - 1));
+}
+
+static void	SyncAudioRing_ResetBlockTags(SyncAudioRing* ioRing)
+{
+	//	No block of sample time ever has this index, so every block reads as never written. All of
+	//	the tags go, including the ones a smaller capacity doesn't use.
+	for(uint32_t theBlockIndex = 0; theBlockIndex < (ioRing->mMaxFrameCapacity >> kSyncAudioRing_BlockFrameShift); ++theBlockIndex)
+	{
+		atomic_store_explicit(ioRing->mBlockTags + theBlockIndex, INT64_MIN, memory_order_relaxed);
+	}
+}
+
+//	The reader works on the range [inSampleTime - 1, inSampleTime + n) where the frame before
+//	inSampleTime only exists for interpolation and lives in ioPrevious rather than in ioData. The
+//	gain ramp is relative to the first sample of ioData and is never applied to ioPrevious.
+
+static void	SyncAudioRing_FetchRange(const SyncAudioRing* inRing, uint32_t inFrameCapacity, int64_t inSampleTime, int64_t inFirst, int64_t inLast, float* ioData, float* ioPrevious, float inGain, float inGainStep, float inQuantizeScale, uint32_t* ioDither)
+{
+	if((inFirst < inSampleTime) && (inFirst < inLast))
+	{
+		SyncAudioRing_FetchFrames(inRing, inFrameCapacity, inFirst, ioPrevious, 1, 1.0f, 0.0f, 0.0f, NULL);
+		inFirst = inSampleTime;
+	}
+	if(inFirst < inLast)
+	{
+		uint32_t theOffset = (uint32_t)(inFirst - inSampleTime) * inRing->mChannelCount;
+		SyncAudioRing_FetchFrames(inRing, inFrameCapacity, inFirst, ioData + theOffset, (uint32_t)(inLast - inFirst), inGain + (inGainStep * (float)theOffset), inGainStep, inQuantizeScale, ioDither);
+	}
+}
+
+static void	SyncAudioRing_SilenceRange(const SyncAudioRing* inRing, int64_t inSampleTime, int64_t inFirst, int64_t inLast, float* ioData, float* ioPrevious)
+{
+	if((inFirst < inSampleTime) && (inFirst < inLast))
+	{
+		memset(ioPrevious, 0, inRing->mChannelCount * sizeof(float));
+		inFirst = inSampleTime;
+	}
+	if(inFirst < inLast)
+	{
+		memset(ioData + ((inFirst - inSampleTime) * inRing->mChannelCount), 0, (size_t)(inLast - inFirst) * inRing->mChannelCount * sizeof(float));
+	}
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Life Cycle
+//==================================================================================================
+
+bool	SyncAudioRing_Initialize(SyncAudioRing* ioRing, uint32_t inFrameCapacity, uint32_t inChannelCount, uint32_t inOptions)
+{
+	bool theAnswer = false;
+	void* theBuffer = NULL;
+
+	if((inFrameCapacity >= kSyncAudioRing_BlockFrameCount) && ((inFrameCapacity & (inFrameCapacity - 1)) == 0) && (inChannelCount > 0) && (inChannelCount <= kSyncAudioRing_MaxChannelCount))
+	{
+		//	allocate whole pages for the frames followed by the block tags and the mix sums
+		size_t thePageSize = (size_t)sysconf(_SC_PAGESIZE);
+		size_t theFrameByteSize = (size_t)inFrameCapacity * inChannelCount * sizeof(float);
+		size_t theTagByteSize = (inFrameCapacity / kSyncAudioRing_BlockFrameCount) * sizeof(_Atomic int64_t);
+		size_t theMixByteSize = (inOptions & kSyncAudioRing_MixInFloat64) ? (size_t)inFrameCapacity * inChannelCount * sizeof(double) : 0;
+		size_t theByteSize = theFrameByteSize + theTagByteSize + theMixByteSize;
+		theByteSize = ((theByteSize + thePageSize - 1) / thePageSize) * thePageSize;
+		if(posix_memalign(&theBuffer, thePageSize, theByteSize) == 0)
+		{
+			//	Touch every page so that they are all backed now rather than on the IO thread's
+			//	first pass, then wire them down. Not being allowed to lock the memory is not an
+			//	error, the pages are just left pageable.
+			memset(theBuffer, 0, theByteSize);
+			ioRing->mKernels = SyncAudioKernels_Select();
+			ioRing->mInterpolateScaled = SyncAudioKernels_GetInterpolateScaled(ioRing->mKernels, inChannelCount);
+			ioRing->mBuffer = theBuffer;
+			ioRing->mBlockTags = (_Atomic int64_t*)((char*)theBuffer + theFrameByteSize);
+			ioRing->mMixBuffer = (theMixByteSize > 0) ? (double*)((char*)theBuffer + theFrameByteSize + theTagByteSize) : NULL;
+			ioRing->mBufferByteSize = theByteSize;
+			ioRing->mBufferIsLocked = mlock(theBuffer, theByteSize) == 0;
+			ioRing->mMaxFrameCapacity = inFrameCapacity;
+			ioRing->mChannelCount = inChannelCount;
+			ioRing->mMixCycle = 0;
+			ioRing->mMixStart = 0;
+			ioRing->mMixEnd = 0;
+			SyncAudioRing_ResetBlockTags(ioRing);
+			atomic_init(&ioRing->mSequence, 0);
+			atomic_init(&ioRing->mFrameCapacity, inFrameCapacity);
+			atomic_init(&ioRing->mWriteOrigin, 0);
+			atomic_init(&ioRing->mWriteReserve, 0);
+			atomic_init(&ioRing->mWriteTime, 0);
+			atomic_init(&ioRing->mReadTime, 0);
+			atomic_init(&ioRing->mUnderrunCount, 0);
+			atomic_init(&ioRing->mOverrunCount, 0);
+			theAnswer = true;
+		}
+	}
+	return theAnswer;
+}
+
+void	SyncAudioRing_Teardown(SyncAudioRing* ioRing)
+{
+	if(ioRing->mBufferIsLocked)
+	{
+		munlock(ioRing->mBuffer, ioRing->mBufferByteSize);
+	}
+	free(ioRing->mBuffer);
+	ioRing->mBuffer = NULL;
+	ioRing->mBlockTags = NULL;
+	ioRing->mMixBuffer = NULL;
+	ioRing->mBufferByteSize = 0;
+	ioRing->mBufferIsLocked = false;
+}
+
+//	Reset and SetFrameCapacity make mSequence odd while they change the ring, the way the clock
+//	publishes its anchor, so that a reader other than the ring's own can tell it raced them.
+
+static void	SyncAudioRing_BeginChange(SyncAudioRing* ioRing)
+{
+	atomic_store_explicit(&ioRing->mSequence, atomic_load_explicit(&ioRing->mSequence, memory_order_relaxed) + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+}
+
+static void	SyncAudioRing_EndChange(SyncAudioRing* ioRing)
+{
+	atomic_store_explicit(&ioRing->mSequence, atomic_load_explicit(&ioRing->mSequence, memory_order_relaxed) + 1, memory_order_release);
+}
+
+static void	SyncAudioRing_Empty(SyncAudioRing* ioRing)
+{
+	//	The frames are left alone since nothing before the origin is ever returned, but the tags
+	//	have to go so that a block from before the reset can't pass for one written since.
+	SyncAudioRing_ResetBlockTags(ioRing);
+	ioRing->mMixStart = 0;
+	ioRing->mMixEnd = 0;
+	atomic_store_explicit(&ioRing->mWriteOrigin, 0, memory_order_relaxed);
+	atomic_store_explicit(&ioRing->mWriteReserve, 0, memory_order_relaxed);
+	atomic_store_explicit(&ioRing->mWriteTime, 0, memory_order_relaxed);
+	atomic_store_explicit(&ioRing->mReadTime, 0, memory_order_relaxed);
+	atomic_store_explicit(&ioRing->mUnderrunCount, 0, memory_order_relaxed);
+	atomic_store_explicit(&ioRing->mOverrunCount, 0, memory_order_relaxed);
+}
+
+void	SyncAudioRing_Reset(SyncAudioRing* ioRing)
+{
+	SyncAudioRing_BeginChange(ioRing);
+	SyncAudioRing_Empty(ioRing);
+	SyncAudioRing_EndChange(ioRing);
+}
+
+bool	SyncAudioRing_SetFrameCapacity(SyncAudioRing* ioRing, uint32_t inFrameCapacity)
+{
+	//	The frames, tags and sums are all indexed from the start of their part of the storage, so
+	//	using less of it is only a matter of masking with a smaller capacity. What was in the ring
+	//	was laid out for the old capacity, so it has to go.
+	bool theAnswer = (inFrameCapacity >= kSyncAudioRing_BlockFrameCount) && ((inFrameCapacity & (inFrameCapacity - 1)) == 0) && (inFrameCapacity <= ioRing->mMaxFrameCapacity);
+	if(theAnswer)
+	{
+		SyncAudioRing_BeginChange(ioRing);
+		atomic_store_explicit(&ioRing->mFrameCapacity, inFrameCapacity, memory_order_relaxed);
+		SyncAudioRing_Empty(ioRing);
+		SyncAudioRing_EndChange(ioRing);
+	}
+	return theAnswer;
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark IO Operations
+//==================================================================================================
+
+void	SyncAudioRing_Write(SyncAudioRing* ioRing, int64_t inSampleTime, const float* inData, uint32_t inFrameCount)
+{
+	int64_t theCapacity = SyncAudioRing_GetFrameCapacity(ioRing);
+
+	//	Only the writer changes mWriteTime so it can be read without ordering. Writes for times
+	//	older than what the ring can hold any longer are dropped.
+	int64_t theWriteTime = atomic_load_explicit(&ioRing->mWriteTime, memory_order_relaxed);
+	if((inFrameCount > 0) && (atomic_load_explicit(&ioRing->mWriteOrigin, memory_order_relaxed) == theWriteTime))
+	{
+		//	the ring is empty, so this write starts it. The reader picks up the new origin along
+		//	with the write time that publishes it.
+		theWriteTime = inSampleTime;
+		atomic_store_explicit(&ioRing->mWriteOrigin, inSampleTime, memory_order_relaxed);
+	}
+	int64_t theNewWriteTime = SyncAudioRing_Max(theWriteTime, inSampleTime + inFrameCount);
+	int64_t theFirst = SyncAudioRing_Max(inSampleTime, theNewWriteTime - theCapacity);
+	int64_t theLast = inSampleTime + inFrameCount;
+	if(theFirst < theLast)
+	{
+		//	Announce how far we are about to go before touching any frames. Claiming the block the
+		//	write ends in clears the rest of it, so when it isn't claimed yet the reservation goes
+		//	to the end of it. The reservation never goes backwards.
+		int64_t theReserve = SyncAudioRing_Max(theNewWriteTime, atomic_load_explicit(&ioRing->mWriteReserve, memory_order_relaxed));
+		if(atomic_load_explicit(SyncAudioRing_BlockTag(ioRing, (uint32_t)theCapacity, SyncAudioRing_BlockIndex(theLast - 1)), memory_order_relaxed) != SyncAudioRing_BlockIndex(theLast - 1))
+		{
+			theReserve = SyncAudioRing_Max(theReserve, (SyncAudioRing_BlockIndex(theLast - 1) + 1) << kSyncAudioRing_BlockFrameShift);
+		}
+		atomic_store_explicit(&ioRing->mWriteReserve, theReserve, memory_order_relaxed);
+		atomic_thread_fence(memory_order_release);
+
+		//	When skipping ahead, the rest of the block the last write ended in still holds audio
+		//	from an earlier lap but is tagged as current, so it has to be cleared. The blocks
+		//	after it keep their old tags and read as silence without being touched.
+		int64_t theGapStart = SyncAudioRing_Max(theWriteTime, theNewWriteTime - theCapacity);
+		int64_t theGapEnd = SyncAudioRing_Min(theFirst, (SyncAudioRing_BlockIndex(theGapStart - 1) + 1) << kSyncAudioRing_BlockFrameShift);
+		if(theGapStart < theGapEnd)
+		{
+			SyncAudioRing_ClearFrames(ioRing, theGapStart, (uint32_t)(theGapEnd - theGapStart));
+		}
+		
+		//	claim the blocks being written, clearing whatever part of a newly claimed block this
+		//	write doesn't cover
+		for(int64_t theBlockIndex = SyncAudioRing_BlockIndex(theFirst); theBlockIndex <= SyncAudioRing_BlockIndex(theLast - 1); ++theBlockIndex)
+		{
+			_Atomic int64_t* theTag = SyncAudioRing_BlockTag(ioRing, (uint32_t)theCapacity, theBlockIndex);
+			if(atomic_load_explicit(theTag, memory_order_relaxed) != theBlockIndex)
+			{
+				int64_t theBlockStart = theBlockIndex << kSyncAudioRing_BlockFrameShift;
+				int64_t theBlockEnd = theBlockStart + kSyncAudioRing_BlockFrameCount;
+				if(theBlockStart < theFirst)
+				{
+					SyncAudioRing_ClearFrames(ioRing, theBlockStart, (uint32_t)(theFirst - theBlockStart));
+				}
+				if(theLast < theBlockEnd)
+				{
+					SyncAudioRing_ClearFrames(ioRing, theLast, (uint32_t)(theBlockEnd - theLast));
+				}
+				atomic_store_explicit(theTag, theBlockIndex, memory_order_relaxed);
+			}
+		}
+
+		//	store the frames and publish them
+		SyncAudioRing_StoreFrames(ioRing, theFirst, inData + ((theFirst - inSampleTime) * ioRing->mChannelCount), (uint32_t)(theLast - theFirst));
+		atomic_store_explicit(&ioRing->mWriteTime, theNewWriteTime, memory_order_release);
+	}
+}
+
+void	SyncAudioRing_Mix(SyncAudioRing* ioRing, int64_t inSampleTime, const float* inData, uint32_t inFrameCount, uint64_t inCycle)
+{
+	uint32_t theChannelCount = ioRing->mChannelCount;
+	int64_t theLast = inSampleTime + inFrameCount;
+
+	//	figure out which of the frames were already written in this cycle
+	int64_t theMixStart = inSampleTime;
+	int64_t theMixEnd = inSampleTime;
+	if(inCycle == ioRing->mMixCycle)
+	{
+		theMixStart = SyncAudioRing_Max(inSampleTime, ioRing->mMixStart);
+		theMixEnd = SyncAudioRing_Min(theLast, ioRing->mMixEnd);
+		if(theMixEnd <= theMixStart)
+		{
+			theMixStart = theMixEnd = inSampleTime;
+		}
+	}
+
+	//	the frames on either side of those are the first to be written this cycle
+	if(inSampleTime < theMixStart)
+	{
+		SyncAudioRing_Write(ioRing, inSampleTime, inData, (uint32_t)(theMixStart - inSampleTime));
+	}
+	if(theMixEnd < theLast)
+	{
+		SyncAudioRing_Write(ioRing, theMixEnd, inData + ((theMixEnd - inSampleTime) * theChannelCount), (uint32_t)(theLast - theMixEnd));
+	}
+
+	//	the rest get added in
+	if(theMixStart < theMixEnd)
+	{
+		SyncAudioRing_MixFrames(ioRing, theMixStart, inData + ((theMixStart - inSampleTime) * theChannelCount), (uint32_t)(theMixEnd - theMixStart));
+	}
+
+	//	Grow the range written in this cycle. A write that doesn't touch it starts a new one,
+	//	which only forgets frames that nothing else in the cycle is going to write.
+	if((inCycle == ioRing->mMixCycle) && (inSampleTime <= ioRing->mMixEnd) && (theLast >= ioRing->mMixStart))
+	{
+		ioRing->mMixStart = SyncAudioRing_Min(ioRing->mMixStart, inSampleTime);
+		ioRing->mMixEnd = SyncAudioRing_Max(ioRing->mMixEnd, theLast);
+	}
+	else
+	{
+		ioRing->mMixCycle = inCycle;
+		ioRing->mMixStart = inSampleTime;
+		ioRing->mMixEnd = theLast;
+	}
+}
+
+//	Everything a read does short of publishing anything, so that it can also be done by a reader
+//	that isn't the ring's consumer.
+static uint32_t	SyncAudioRing_Fetch(const SyncAudioRing* inRing, int64_t inSampleTime, float inFraction, float inGain, float inGainStep, float inQuantizeScale, uint32_t* ioDither, float* outData, uint32_t inFrameCount)
+{
+	uint32_t theAnswer = kSyncAudioRing_NoError;
+	uint32_t theChannelCount = inRing->mChannelCount;
+	uint32_t theSequence = atomic_load_explicit(&inRing->mSequence, memory_order_acquire);
+	uint32_t theFrameCapacity = SyncAudioRing_GetFrameCapacity(inRing);
+	int64_t theCapacity = theFrameCapacity;
+	float thePrevious[kSyncAudioRing_MaxChannelCount] = { 0 };
+
+	//	the range of frames we need, including the one before the first when interpolating
+	int64_t theFirst = inSampleTime - ((inFraction > 0) ? 1 : 0);
+	int64_t theLast = inSampleTime + inFrameCount;
+
+	//	figure out which of them the writer has completely stored and not yet lapped
+	int64_t theWriteTime = atomic_load_explicit(&inRing->mWriteTime, memory_order_acquire);
+	int64_t theWriteOrigin = atomic_load_explicit(&inRing->mWriteOrigin, memory_order_relaxed);
+	int64_t theValidStart = SyncAudioRing_Max(theFirst, SyncAudioRing_Max(theWriteTime - theCapacity, theWriteOrigin));
+	int64_t theValidEnd = SyncAudioRing_Min(theLast, theWriteTime);
+	if(theValidEnd <= theValidStart)
+	{
+		//	nothing is readable, either because the writer hasn't got there yet or because it
+		//	has already lapped the whole range
+		theValidStart = theValidEnd = (theWriteTime <= theFirst) ? theFirst : theLast;
+	}
+	else
+	{
+		//	Copy them out and then make sure the writer didn't lap any of them while we did. When
+		//	there is no interpolation to do, the gain and the quantizing go on during the copy,
+		//	otherwise they go on after the interpolation below. Whatever is replaced with silence
+		//	is exactly zero, which needs no quantizing.
+		if(inFraction > 0)
+		{
+			SyncAudioRing_FetchRange(inRing, theFrameCapacity, inSampleTime, theValidStart, theValidEnd, outData, thePrevious, 1.0f, 0.0f, 0.0f, NULL);
+		}
+		else
+		{
+			SyncAudioRing_FetchRange(inRing, theFrameCapacity, inSampleTime, theValidStart, theValidEnd, outData, thePrevious, inGain, inGainStep, inQuantizeScale, ioDither);
+		}
+		atomic_thread_fence(memory_order_acquire);
+		int64_t theWriteReserve = atomic_load_explicit(&inRing->mWriteReserve, memory_order_relaxed);
+		theValidStart = SyncAudioRing_Max(theValidStart, SyncAudioRing_Min(theWriteReserve - theCapacity, theValidEnd));
+		
+		//	the blocks the writer skipped over were never written on this lap
+		for(int64_t theBlockIndex = SyncAudioRing_BlockIndex(theValidStart); (theValidStart < theValidEnd) && (theBlockIndex <= SyncAudioRing_BlockIndex(theValidEnd - 1)); ++theBlockIndex)
+		{
+			if(atomic_load_explicit(SyncAudioRing_BlockTag(inRing, theFrameCapacity, theBlockIndex), memory_order_relaxed) != theBlockIndex)
+			{
+				int64_t theBlockStart = SyncAudioRing_Max(theValidStart, theBlockIndex << kSyncAudioRing_BlockFrameShift);
+				int64_t theBlockEnd = SyncAudioRing_Min(theValidEnd, (theBlockIndex + 1) << kSyncAudioRing_BlockFrameShift);
+				SyncAudioRing_SilenceRange(inRing, inSampleTime, theBlockStart, theBlockEnd, outData, thePrevious);
+				theAnswer |= kSyncAudioRing_Underrun;
+			}
+		}
+	}
+
+	//	whatever was lapped or not written yet is silence, where the frames before the origin were
+	//	never written at all
+	if(theFirst < theValidStart)
+	{
+		SyncAudioRing_SilenceRange(inRing, inSampleTime, theFirst, theValidStart, outData, thePrevious);
+		theAnswer |= (theValidStart <= theWriteOrigin) ? kSyncAudioRing_Underrun : kSyncAudioRing_Overrun;
+	}
+	if(theValidEnd < theLast)
+	{
+		SyncAudioRing_SilenceRange(inRing, inSampleTime, theValidEnd, theLast, outData, thePrevious);
+		theAnswer |= kSyncAudioRing_Underrun;
+	}
+
+	//	blend each frame with the one before it for the fractional part of the position and apply
+	//	the gain in the same pass, then quantize what came out of it in a pass of its own, which
+	//	only a delay of a fraction of a frame costs
+	if(inFraction > 0)
+	{
+		inRing->mInterpolateScaled(outData, thePrevious, theChannelCount, inFrameCount * theChannelCount, inFraction, inGain, inGainStep);
+		if(inQuantizeScale != 0.0f)
+		{
+			inRing->mKernels->mCopyScaledQuantized(outData, outData, inFrameCount * theChannelCount, 1.0f, 0.0f, inQuantizeScale, ioDither);
+		}
+	}
+
+	//	A read that overlapped a reset or a change of capacity may have mixed frames from before it
+	//	with tags and times from after it, so all of it is thrown away. Only a reader other than
+	//	the ring's own can get here, the owner never calls either while it is reading.
+	atomic_thread_fence(memory_order_acquire);
+	if(((theSequence & 1) != 0) || (theSequence != atomic_load_explicit(&inRing->mSequence, memory_order_relaxed)))
+	{
+		memset(outData, 0, (size_t)inFrameCount * theChannelCount * sizeof(float));
+		theAnswer = kSyncAudioRing_Underrun;
+	}
+
+	return theAnswer;
+}
+
+uint32_t	SyncAudioRing_Read(SyncAudioRing* ioRing, int64_t inSampleTime, float inFraction, float inGain, float inGainStep, float* outData, uint32_t inFrameCount)
+{
+	return SyncAudioRing_ReadQuantized(ioRing, inSampleTime, inFraction, inGain, inGainStep, 0.0f, NULL, outData, inFrameCount);
+}
+
+uint32_t	SyncAudioRing_ReadQuantized(SyncAudioRing* ioRing, int64_t inSampleTime, float inFraction, float inGain, float inGainStep, float inQuantizeScale, uint32_t* ioDither, float* outData, uint32_t inFrameCount)
+{
+	uint32_t theAnswer = SyncAudioRing_Fetch(ioRing, inSampleTime, inFraction, inGain, inGainStep, inQuantizeScale, ioDither, outData, inFrameCount);
+
+	//	publish the read cursor and account for the errors
+	atomic_store_explicit(&ioRing->mReadTime, inSampleTime + inFrameCount, memory_order_release);
+	if(theAnswer & kSyncAudioRing_Underrun)
+	{
+		atomic_fetch_add_explicit(&ioRing->mUnderrunCount, 1, memory_order_relaxed);
+	}
+	if(theAnswer & kSyncAudioRing_Overrun)
+	{
+		atomic_fetch_add_explicit(&ioRing->mOverrunCount, 1, memory_order_relaxed);
+	}
+	return theAnswer;
+}
+
+uint32_t	SyncAudioRing_Peek(const SyncAudioRing* inRing, int64_t inSampleTime, float* outData, uint32_t inFrameCount)
+{
+	return SyncAudioRing_Fetch(inRing, inSampleTime, 0.0f, 1.0f, 0.0f, 0.0f, NULL, outData, inFrameCount);
+}
@@ -0,0 +1,170 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+The loopback ring that carries audio from the output stream to the input stream.
+*/
+
+/*==================================================================================================
+	SyncAudioRing.h
+==================================================================================================*/
+#if !defined(__SyncAudioRing_h__)
+#define __SyncAudioRing_h__
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	System Includes
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+//	Local Includes
+#include "SyncAudioKernels.h"
+
+//==================================================================================================
+#pragma mark -
+#pragma mark SyncAudioRing
+//==================================================================================================
+
+//	SyncAudioRing is a single producer, single consumer ring of interleaved 32 bit float frames that
+//	is addressed by sample time rather than by position. It has no dependency on CoreAudio so that
+//	it can be built and exercised on any platform.
+//
+//	The writer owns two cursors. mWriteReserve is published before any frame is stored and
+//	mWriteTime after all of them are, so the frames in [mWriteTime - capacity, mWriteTime) are
+//	always complete. The reader checks its range against mWriteTime before copying to find the
+//	frames that were not written yet (an underrun) and against mWriteReserve after copying to find
+//	the frames the writer lapped while it was copying (an overrun). Both are detected exactly and
+//	the affected frames are returned as silence. mReadTime is the reader's cursor and is published
+//	for whoever wants to observe how far behind the writer it runs. It, along with mUnderrunCount
+//	and mOverrunCount, belongs to the ring's consumer, so other readers use SyncAudioRing_Peek,
+//	which checks its frames the same way but publishes nothing.
+//
+//	mWriteOrigin is the first sample time written since the ring was last reset. The ring is empty
+//	while it equals mWriteTime, and nothing before it is ever returned, which is what lets
+//	SyncAudioRing_Reset skip clearing the storage.
+//
+//	The storage is also divided into blocks of kSyncAudioRing_BlockFrameCount frames, each tagged
+//	with the index of the block of sample time it currently holds. When the writer skips ahead, the
+//	blocks it skips keep the tags of an earlier lap and the reader returns them as silence, so a
+//	gap costs nothing to clear. The writer only ever zeroes the unwritten part of the blocks at the
+//	edges of a write, which bounds the clearing done in an IO cycle to less than two blocks. Since
+//	that clears frames past the end of the write, mWriteReserve covers the whole of the last block
+//	a write claims, so up to a block less than the capacity is readable behind mWriteTime.
+//
+//	SyncAudioRing_Mix lets several sources write the same stretch of sample time in one cycle. The
+//	writer remembers the range written during the current cycle: the first write to a frame in a
+//	cycle stores it and later ones add to it. With kSyncAudioRing_MixInFloat64, the ring keeps a
+//	double precision copy of every frame to sum into, at the cost of twice the ring's memory again.
+//	Mixing changes frames that are already published, so a reader that reads the frames of the
+//	cycle being mixed sees a partial mix. The HAL never does that since it reads the input and
+//	writes the mix one after the other on the IO thread.
+//
+//	Neither side ever blocks or allocates. The storage is allocated once by SyncAudioRing_Initialize,
+//	which also touches every page and wires it down when the system allows so that the IO functions
+//	never take a page fault. Only SyncAudioRing_Initialize and SyncAudioRing_Teardown touch the
+//	allocator, and they must not race the IO functions.
+//
+//	SyncAudioRing_Reset and SyncAudioRing_SetFrameCapacity must not race the producer or the
+//	ring's own consumer either, but a reader of someone else's ring, like a resampler reading the
+//	ring of the device it follows, can't know when they happen. They make mSequence odd while they
+//	change the ring, and a read that overlaps one comes back as silence flagged with
+//	kSyncAudioRing_Underrun, the way a read of a ring nothing has been written to yet does. The
+//	read loads mFrameCapacity once and indexes everything with it, so it stays inside the storage
+//	whichever capacity it saw.
+//
+//	The frames themselves are plain floats copied with memcpy, memset and the kernels, not atomics,
+//	so a reader that copies frames the writer is overwriting races it on purpose, the way the data
+//	of any seqlock does. What the reader copied is only trusted after mWriteReserve, the block tags
+//	and mSequence have been checked again behind a fence, and frames that fail the check are
+//	replaced with silence, so a torn frame never reaches the caller. Copying through atomics would
+//	cost the kernels their vector loads and stores for nothing. ThreadSanitizer can't see that
+//	argument and reports the copies, so Tests/SyncAudioRing.tsan.supp suppresses races in the
+//	functions that touch the frames and nowhere else; the cursors, tags and counts have to stay
+//	clean without it.
+//
+//	mMaxFrameCapacity is the capacity the storage was allocated for and mFrameCapacity the part of
+//	it that is in use, which SyncAudioRing_SetFrameCapacity can change without reallocating. That
+//	is what lets a ring cover the same span of time at every sample rate.
+//
+//	mInterpolateScaled is the interpolation of mKernels built for mChannelCount.
+
+#define kSyncAudioRing_MaxChannelCount	8
+#define kSyncAudioRing_BlockFrameShift	6
+#define kSyncAudioRing_BlockFrameCount	(1 << kSyncAudioRing_BlockFrameShift)
+
+enum
+{
+	kSyncAudioRing_MixInFloat64	= (1 << 0)
+};
+
+enum
+{
+	kSyncAudioRing_NoError	= 0,
+	kSyncAudioRing_Underrun	= (1 << 0),
+	kSyncAudioRing_Overrun	= (1 << 1)
+};
+
+typedef struct SyncAudioRing
+{
+	const SyncAudioKernels*	mKernels;
+	SyncAudioKernelsInterpolateScaledFunction	mInterpolateScaled;
+	float*				mBuffer;
+	_Atomic int64_t*	mBlockTags;
+	double*				mMixBuffer;
+	size_t				mBufferByteSize;
+	bool				mBufferIsLocked;
+	_Atomic uint32_t	mSequence;
+	_Atomic uint32_t	mFrameCapacity;
+	uint32_t			mMaxFrameCapacity;
+	uint32_t			mChannelCount;
+	uint64_t			mMixCycle;
+	int64_t				mMixStart;
+	int64_t				mMixEnd;
+	_Atomic int64_t		mWriteOrigin;
+	_Atomic int64_t		mWriteReserve;
+	_Atomic int64_t		mWriteTime;
+	_Atomic int64_t		mReadTime;
+	_Atomic uint64_t	mUnderrunCount;
+	_Atomic uint64_t	mOverrunCount;
+} SyncAudioRing;
+
+//	inFrameCapacity must be a power of two no smaller than kSyncAudioRing_BlockFrameCount. inOptions is made of the
+//	kSyncAudioRing_MixInFloat64 flag.
+bool		SyncAudioRing_Initialize(SyncAudioRing* ioRing, uint32_t inFrameCapacity, uint32_t inChannelCount, uint32_t inOptions);
+void		SyncAudioRing_Teardown(SyncAudioRing* ioRing);
+void		SyncAudioRing_Reset(SyncAudioRing* ioRing);
+
+//	Uses inFrameCapacity frames of the storage, which must be a power of two no smaller than
+//	kSyncAudioRing_BlockFrameCount and no larger than mMaxFrameCapacity, and empties the ring.
+//	Returns false, leaving the ring alone, for any other capacity.
+bool		SyncAudioRing_SetFrameCapacity(SyncAudioRing* ioRing, uint32_t inFrameCapacity);
+
+//	Called by the producer only. Stores inFrameCount frames starting at inSampleTime.
+void		SyncAudioRing_Write(SyncAudioRing* ioRing, int64_t inSampleTime, const float* inData, uint32_t inFrameCount);
+
+//	Called by the producer only. Like SyncAudioRing_Write except that the frames inCycle has
+//	already written are added to rather than replaced.
+void		SyncAudioRing_Mix(SyncAudioRing* ioRing, int64_t inSampleTime, const float* inData, uint32_t inFrameCount, uint64_t inCycle);
+
+//	Called by the consumer only. Fetches inFrameCount frames starting inFraction of a frame before
+//	inSampleTime, interpolating between neighbouring frames and applying a gain ramp in the manner
+//	of SyncAudioKernels, and returns the kSyncAudioRing_ flags for anything that had to be replaced
+//	with silence.
+uint32_t	SyncAudioRing_Read(SyncAudioRing* ioRing, int64_t inSampleTime, float inFraction, float inGain, float inGainStep, float* outData, uint32_t inFrameCount);
+
+//	Called by the consumer only. Like SyncAudioRing_Read except that, when inQuantizeScale isn't
+//	zero, the frames are quantized with dither in the manner of SyncAudioKernels'
+//	mCopyScaledQuantized as they are copied out, or right after the interpolation when there is a
+//	fraction.
+uint32_t	SyncAudioRing_ReadQuantized(SyncAudioRing* ioRing, int64_t inSampleTime, float inFraction, float inGain, float inGainStep, float inQuantizeScale, uint32_t* ioDither, float* outData, uint32_t inFrameCount);
+
+//	Called by any reader. Fetches inFrameCount frames starting at inSampleTime like
+//	SyncAudioRing_Read with no fraction and unity gain, but leaves mReadTime and the counts alone,
+//	so it doesn't disturb the consumer's view of the ring.
+uint32_t	SyncAudioRing_Peek(const SyncAudioRing* inRing, int64_t inSampleTime, float* outData, uint32_t inFrameCount);
+
+#endif	//	__SyncAudioRing_h__
@@ -0,0 +1,177 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+The table of a device's clients and how their audio is routed and scaled.
+*/
+
+/*==================================================================================================
+	SyncAudioRoutes.c
+==================================================================================================*/
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	Self Include
+#include "SyncAudioRoutes.h"
+
+//==================================================================================================
+#pragma mark -
+#pragma mark SyncAudioRoute
+//==================================================================================================
+
+bool	SyncAudioRoute_NeedsOutputProcessing(SyncAudioRoute* inRoute)
+{
+	return (inRoute->mOutputBus != 0) || (atomic_load_explicit(&inRoute->mOutputLevel, memory_order_relaxed) != 1.0f);
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark SyncAudioRouteTable
+//==================================================================================================
+
+static inline uint32_t	SyncAudioRouteTable_FirstSlot(uint32_t inClientID)
+{
+	return inClientID & (kSyncAudioRouteTable_SlotCount - 1);
+}
+
+static inline uint32_t	SyncAudioRouteTable_NextSlot(uint32_t inSlot)
+{
+	return (inSlot + 1) & (kSyncAudioRouteTable_SlotCount - 1);
+}
+
+static SyncAudioRouteSlot*	SyncAudioRouteTable_FindSlot(SyncAudioRouteTable* ioTable, uint32_t inClientID)
+{
+	uint32_t theSlot = SyncAudioRouteTable_FirstSlot(inClientID);
+	for(uint32_t theProbe = 0; theProbe < kSyncAudioRouteTable_SlotCount; ++theProbe)
+	{
+		SyncAudioRouteSlot* theCandidate = &ioTable->mSlots[theSlot];
+		uint32_t theState = atomic_load_explicit(&theCandidate->mState, memory_order_acquire);
+		if(theState == kSyncAudioRouteTable_SlotEmpty)
+		{
+			break;
+		}
+		if((theState == kSyncAudioRouteTable_SlotOccupied) && (atomic_load_explicit(&theCandidate->mClientID, memory_order_relaxed) == inClientID))
+		{
+			return theCandidate;
+		}
+		theSlot = SyncAudioRouteTable_NextSlot(theSlot);
+	}
+	return NULL;
+}
+
+void	SyncAudioRouteTable_Initialize(SyncAudioRouteTable* ioTable)
+{
+	for(uint32_t theSlot = 0; theSlot < kSyncAudioRouteTable_SlotCount; ++theSlot)
+	{
+		atomic_init(&ioTable->mSlots[theSlot].mState, kSyncAudioRouteTable_SlotEmpty);
+		atomic_init(&ioTable->mSlots[theSlot].mClientID, 0);
+		ioTable->mSlots[theSlot].mRoute = (SyncAudioRoute){ 0, 0, 0, false, false, 1.0f, 1.0f, 1.0f, 0.0f, false };
+	}
+}
+
+bool	SyncAudioRouteTable_Add(SyncAudioRouteTable* ioTable, uint32_t inClientID, const SyncAudioRoute* inRoute)
+{
+	//	look for the client while remembering the first slot that could take it
+	SyncAudioRouteSlot* theFreeSlot = NULL;
+	uint32_t theSlot = SyncAudioRouteTable_FirstSlot(inClientID);
+	for(uint32_t theProbe = 0; theProbe < kSyncAudioRouteTable_SlotCount; ++theProbe)
+	{
+		SyncAudioRouteSlot* theCandidate = &ioTable->mSlots[theSlot];
+		uint32_t theState = atomic_load_explicit(&theCandidate->mState, memory_order_relaxed);
+		if(theState == kSyncAudioRouteTable_SlotOccupied)
+		{
+			if(atomic_load_explicit(&theCandidate->mClientID, memory_order_relaxed) == inClientID)
+			{
+				//	the HAL doesn't do IO for a client it is adding, so the route can be replaced
+				//	in place
+				theCandidate->mRoute = *inRoute;
+				atomic_store_explicit(&theCandidate->mState, kSyncAudioRouteTable_SlotOccupied, memory_order_release);
+				return true;
+			}
+		}
+		else
+		{
+			if(theFreeSlot == NULL)
+			{
+				theFreeSlot = theCandidate;
+			}
+			if(theState == kSyncAudioRouteTable_SlotEmpty)
+			{
+				//	nothing is stored past an empty slot
+				break;
+			}
+		}
+		theSlot = SyncAudioRouteTable_NextSlot(theSlot);
+	}
+
+	//	fill out the slot before publishing it
+	if(theFreeSlot != NULL)
+	{
+		atomic_store_explicit(&theFreeSlot->mClientID, inClientID, memory_order_relaxed);
+		theFreeSlot->mRoute = *inRoute;
+		atomic_store_explicit(&theFreeSlot->mState, kSyncAudioRouteTable_SlotOccupied, memory_order_release);
+	}
+	return theFreeSlot != NULL;
+}
+
+void	SyncAudioRouteTable_Remove(SyncAudioRouteTable* ioTable, uint32_t inClientID)
+{
+	SyncAudioRouteSlot* theSlot = SyncAudioRouteTable_FindSlot(ioTable, inClientID);
+	if(theSlot != NULL)
+	{
+		//	leave a tombstone so that the lookups of the clients stored past it still find them
+		atomic_store_explicit(&theSlot->mState, kSyncAudioRouteTable_SlotRemoved, memory_order_release);
+	}
+}
+
+SyncAudioRoute*	SyncAudioRouteTable_Find(SyncAudioRouteTable* ioTable, uint32_t inClientID)
+{
+	SyncAudioRouteSlot* theSlot = SyncAudioRouteTable_FindSlot(ioTable, inClientID);
+	return (theSlot != NULL) ? &theSlot->mRoute : NULL;
+}
+
+uint32_t	SyncAudioRouteTable_SetOutputLevel(SyncAudioRouteTable* ioTable, int32_t inProcessID, float inVolume, bool inMute)
+{
+	uint32_t theNumberClients = 0;
+	for(uint32_t theSlot = 0; theSlot < kSyncAudioRouteTable_SlotCount; ++theSlot)
+	{
+		SyncAudioRouteSlot* theCandidate = &ioTable->mSlots[theSlot];
+		if((atomic_load_explicit(&theCandidate->mState, memory_order_relaxed) == kSyncAudioRouteTable_SlotOccupied) && (theCandidate->mRoute.mProcessID == inProcessID))
+		{
+			theCandidate->mRoute.mOutputVolume = inVolume;
+			theCandidate->mRoute.mOutputMute = inMute;
+			atomic_store_explicit(&theCandidate->mRoute.mOutputLevel, inMute ? 0.0f : inVolume, memory_order_relaxed);
+			++theNumberClients;
+		}
+	}
+	return theNumberClients;
+}
+
+bool	SyncAudioRouteTable_HasUnprocessedOutput(SyncAudioRouteTable* ioTable, int32_t inProcessID)
+{
+	bool theAnswer = false;
+	for(uint32_t theSlot = 0; !theAnswer && (theSlot < kSyncAudioRouteTable_SlotCount); ++theSlot)
+	{
+		SyncAudioRouteSlot* theCandidate = &ioTable->mSlots[theSlot];
+		if((atomic_load_explicit(&theCandidate->mState, memory_order_relaxed) == kSyncAudioRouteTable_SlotOccupied) && (theCandidate->mRoute.mProcessID == inProcessID))
+		{
+			theAnswer = SyncAudioRoute_NeedsOutputProcessing(&theCandidate->mRoute) && !atomic_load_explicit(&theCandidate->mRoute.mProcessesOutput, memory_order_relaxed);
+		}
+	}
+	return theAnswer;
+}
+
+SyncAudioRoute*	SyncAudioRouteTable_FindProcess(SyncAudioRouteTable* ioTable, int32_t inProcessID)
+{
+	for(uint32_t theSlot = 0; theSlot < kSyncAudioRouteTable_SlotCount; ++theSlot)
+	{
+		SyncAudioRouteSlot* theCandidate = &ioTable->mSlots[theSlot];
+		if((atomic_load_explicit(&theCandidate->mState, memory_order_relaxed) == kSyncAudioRouteTable_SlotOccupied) && (theCandidate->mRoute.mProcessID == inProcessID))
+		{
+			return &theCandidate->mRoute;
+		}
+	}
+	return NULL;
+}
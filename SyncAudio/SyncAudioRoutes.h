@@ -0,0 +1,125 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+The table of a device's clients and how their audio is routed and scaled.
+*/
+
+/*==================================================================================================
+	SyncAudioRoutes.h
+==================================================================================================*/
+#if !defined(__SyncAudioRoutes_h__)
+#define __SyncAudioRoutes_h__
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	System Includes
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+//==================================================================================================
+#pragma mark -
+#pragma mark SyncAudioRoute
+//==================================================================================================
+
+//	SyncAudioRoute says how a client's audio goes through a device. mOutputBus is the bus the
+//	client's output is copied to before the HAL mixes it, and mDivertOutput takes it out of that mix
+//	so that it only reaches mOutputBus. mInputBus is the bus the client's input is played from
+//	instead of the main one. Bus 0 is the device's main ring.
+//
+//	mOutputVolume and mOutputMute are the client's own output level, which is shared by all the
+//	clients of the process mProcessID. They are only touched by the writers, which publish the gain
+//	they add up to in mOutputLevel for the IO thread to scale the client's output by.
+//
+//	mOutputGain and mInputGain are where the IO thread keeps the gains its last scaling of the
+//	output and its last read of mInputBus ended on, so that it can ramp from them. Nothing else
+//	touches them.
+//
+//	The HAL only hands the client's output to the plug-in before mixing it, which costs a call and a
+//	pass over the buffer, if it was told that it would have to when the client's IO started.
+//	mProcessesOutput is what it was told, and a writer that gives a client that wasn't a reason to
+//	be processed has to get the HAL to ask again.
+
+typedef struct SyncAudioRoute
+{
+	int32_t			mProcessID;
+	uint32_t		mOutputBus;
+	uint32_t		mInputBus;
+	bool			mDivertOutput;
+	bool			mOutputMute;
+	float			mOutputVolume;
+	_Atomic float	mOutputLevel;
+	float			mOutputGain;
+	float			mInputGain;
+	_Atomic bool	mProcessesOutput;
+} SyncAudioRoute;
+
+//	Whether the client's output has to be processed before the HAL mixes it, which is when it goes
+//	to a bus of its own or its level isn't unity. Safe from any thread.
+bool			SyncAudioRoute_NeedsOutputProcessing(SyncAudioRoute* inRoute);
+
+//==================================================================================================
+#pragma mark -
+#pragma mark SyncAudioRouteTable
+//==================================================================================================
+
+//	SyncAudioRouteTable holds the routes of a device's clients by client ID. The routes are worked
+//	out when the client is added, so all the IO thread has to do is look the client up, which
+//	starts at the slot its ID indexes and probes linearly from there. The HAL hands out client IDs
+//	in sequence, so the first slot is almost always the right one.
+//
+//	A slot's route is stored before its state is published as occupied, so a lookup that finds the
+//	client always sees the whole route. Removing a client leaves a tombstone that later lookups
+//	probe past and later adds reuse. The HAL never does IO for a client while it is being added or
+//	removed, so a lookup never sees the slot of the client it is looking for change underneath it.
+//	Adds and removes must be serialized by the caller.
+
+#define	kSyncAudioRouteTable_SlotCount	64
+
+enum
+{
+	kSyncAudioRouteTable_SlotEmpty		= 0,
+	kSyncAudioRouteTable_SlotRemoved	= 1,
+	kSyncAudioRouteTable_SlotOccupied	= 2
+};
+
+typedef struct SyncAudioRouteSlot
+{
+	_Atomic uint32_t	mState;
+	_Atomic uint32_t	mClientID;
+	SyncAudioRoute		mRoute;
+} SyncAudioRouteSlot;
+
+typedef struct SyncAudioRouteTable
+{
+	SyncAudioRouteSlot	mSlots[kSyncAudioRouteTable_SlotCount];
+} SyncAudioRouteTable;
+
+void			SyncAudioRouteTable_Initialize(SyncAudioRouteTable* ioTable);
+
+//	Writers. The caller serializes these. SyncAudioRouteTable_Add replaces the route of a client
+//	that is already in the table and returns false if the table is full.
+bool			SyncAudioRouteTable_Add(SyncAudioRouteTable* ioTable, uint32_t inClientID, const SyncAudioRoute* inRoute);
+void			SyncAudioRouteTable_Remove(SyncAudioRouteTable* ioTable, uint32_t inClientID);
+
+//	Writer. The caller serializes this. Sets the output level of all of the clients of the given
+//	process and returns how many there were. The IO thread ramps to the new level on its next cycle.
+uint32_t		SyncAudioRouteTable_SetOutputLevel(SyncAudioRouteTable* ioTable, int32_t inProcessID, float inVolume, bool inMute);
+
+//	Returns whether one of the clients of the given process needs its output processed while the
+//	HAL was told that it wouldn't. The caller serializes this with the writers.
+bool			SyncAudioRouteTable_HasUnprocessedOutput(SyncAudioRouteTable* ioTable, int32_t inProcessID);
+
+//	Returns the route of one of the clients of the given process, or NULL if it has none. The
+//	caller serializes this with the writers.
+SyncAudioRoute*	SyncAudioRouteTable_FindProcess(SyncAudioRouteTable* ioTable, int32_t inProcessID);
+
+//	Reader. Safe from any thread, including the IO thread. Returns NULL for a client that isn't in
+//	the table.
+SyncAudioRoute*	SyncAudioRouteTable_Find(SyncAudioRouteTable* ioTable, uint32_t inClientID);
+
+#endif	//	__SyncAudioRoutes_h__
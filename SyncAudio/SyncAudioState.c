@@ -0,0 +1,76 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+The device's control state, published so that it can be read without a lock.
+*/
+
+/*==================================================================================================
+	SyncAudioState.c
+==================================================================================================*/
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	Self Include
+#include "SyncAudioState.h"
+
+//	System Includes
+#include <string.h>
+
+//==================================================================================================
+#pragma mark -
+#pragma mark SyncAudioStateCell
+//==================================================================================================
+
+typedef union SyncAudioStateWords
+{
+	SyncAudioDeviceState	mState;
+	uint64_t				mWords[kSyncAudioState_WordCount];
+} SyncAudioStateWords;
+
+static void	SyncAudioState_Store(SyncAudioStateCell* ioCell, const SyncAudioDeviceState* inState)
+{
+	SyncAudioStateWords theWords;
+	memset(&theWords, 0, sizeof(theWords));
+	theWords.mState = *inState;
+	for(uint32_t theWord = 0; theWord < kSyncAudioState_WordCount; ++theWord)
+	{
+		atomic_store_explicit(&ioCell->mWords[theWord], theWords.mWords[theWord], memory_order_relaxed);
+	}
+}
+
+void	SyncAudioState_Initialize(SyncAudioStateCell* ioCell, const SyncAudioDeviceState* inState)
+{
+	atomic_init(&ioCell->mSequence, 0);
+	SyncAudioState_Store(ioCell, inState);
+}
+
+uint32_t	SyncAudioState_Load(const SyncAudioStateCell* inCell, SyncAudioDeviceState* outState)
+{
+	SyncAudioStateWords theWords;
+	uint32_t theSequence;
+	do
+	{
+		theSequence = atomic_load_explicit(&inCell->mSequence, memory_order_acquire);
+		for(uint32_t theWord = 0; theWord < kSyncAudioState_WordCount; ++theWord)
+		{
+			theWords.mWords[theWord] = atomic_load_explicit(&inCell->mWords[theWord], memory_order_relaxed);
+		}
+		atomic_thread_fence(memory_order_acquire);
+	}
+	while(((theSequence & 1) != 0) || (theSequence != atomic_load_explicit(&inCell->mSequence, memory_order_relaxed)));
+	*outState = theWords.mState;
+	return theSequence >> 1;
+}
+
+void	SyncAudioState_Publish(SyncAudioStateCell* ioCell, const SyncAudioDeviceState* inState)
+{
+	//	make the sequence odd while the words are inconsistent and even again once they are stored
+	uint32_t theSequence = atomic_load_explicit(&ioCell->mSequence, memory_order_relaxed);
+	atomic_store_explicit(&ioCell->mSequence, theSequence + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+	SyncAudioState_Store(ioCell, inState);
+	atomic_store_explicit(&ioCell->mSequence, theSequence + 2, memory_order_release);
+}
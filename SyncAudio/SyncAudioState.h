@@ -0,0 +1,77 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+The device's control state, published so that it can be read without a lock.
+*/
+
+/*==================================================================================================
+	SyncAudioState.h
+==================================================================================================*/
+#if !defined(__SyncAudioState_h__)
+#define __SyncAudioState_h__
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	System Includes
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+//==================================================================================================
+#pragma mark -
+#pragma mark SyncAudioDeviceState
+//==================================================================================================
+
+//	SyncAudioDeviceState holds the values of the device's settings and controls. It is a plain
+//	value: whoever wants to read it takes a copy, and whoever wants to change it changes a copy and
+//	publishes that as the new version.
+
+typedef struct SyncAudioDeviceState
+{
+	double		mSampleRate;
+	float		mInputVolume;
+	float		mOutputVolume;
+	uint32_t	mInputDataSource;
+	uint32_t	mOutputDataSource;
+	uint32_t	mPlayThruDestination;
+	uint32_t	mSampleFormat;
+	bool		mInputMute;
+	bool		mOutputMute;
+} SyncAudioDeviceState;
+
+//==================================================================================================
+#pragma mark -
+#pragma mark SyncAudioStateCell
+//==================================================================================================
+
+//	SyncAudioStateCell is where the current version of a SyncAudioDeviceState is published. The
+//	state is stored as atomic words behind a sequence lock in the same way as SyncAudioClock's
+//	anchor: a writer makes mSequence odd, stores the words and makes it even again, and a reader
+//	copies the words out and tries again if mSequence moved while it did. Readers never wait on a
+//	writer, and there is nothing to allocate or reclaim. The writers must be serialized by the
+//	caller. The version number returned by SyncAudioState_Load counts the publications, so a
+//	reader can tell whether the state changed since it last looked.
+//
+//	The cell fills a cache line of its own so that the IO thread's reads don't share a line with
+//	anything else that is written.
+
+#define	kSyncAudioState_WordCount	((sizeof(SyncAudioDeviceState) + sizeof(uint64_t) - 1) / sizeof(uint64_t))
+
+typedef struct SyncAudioStateCell
+{
+	_Alignas(64) _Atomic uint32_t	mSequence;
+	_Atomic uint64_t				mWords[kSyncAudioState_WordCount];
+} SyncAudioStateCell;
+
+void		SyncAudioState_Initialize(SyncAudioStateCell* ioCell, const SyncAudioDeviceState* inState);
+
+//	Reader. Safe from any thread, including the IO thread. Returns the version it copied.
+uint32_t	SyncAudioState_Load(const SyncAudioStateCell* inCell, SyncAudioDeviceState* outState);
+
+//	Writer. The caller serializes this.
+void		SyncAudioState_Publish(SyncAudioStateCell* ioCell, const SyncAudioDeviceState* inState);
+
+#endif	//	__SyncAudioState_h__
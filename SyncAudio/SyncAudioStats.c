@@ -0,0 +1,61 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+Lock free statistics recorded on the IO path.
+*/
+
+/*==================================================================================================
+	SyncAudioStats.c
+==================================================================================================*/
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	Self Include
+#include "SyncAudioStats.h"
+
+//==================================================================================================
+#pragma mark -
+#pragma mark SyncAudioHistogram
+//==================================================================================================
+
+static inline uint32_t	SyncAudioHistogram_GetBucket(uint64_t inValue)
+{
+	uint32_t theBucket = (inValue != 0) ? (uint32_t)(64 - __builtin_clzll(inValue)) : 0;
+	return (theBucket < kSyncAudioHistogram_BucketCount) ? theBucket : (kSyncAudioHistogram_BucketCount - 1);
+}
+
+static inline void	SyncAudioHistogram_Add(_Atomic uint64_t* ioCounter, uint64_t inValue)
+{
+	//	there is only one recorder, so this doesn't need to be a read-modify-write
+	atomic_store_explicit(ioCounter, atomic_load_explicit(ioCounter, memory_order_relaxed) + inValue, memory_order_relaxed);
+}
+
+void	SyncAudioHistogram_Reset(SyncAudioHistogram* ioHistogram)
+{
+	for(uint32_t theBucket = 0; theBucket < kSyncAudioHistogram_BucketCount; ++theBucket)
+	{
+		atomic_store_explicit(&ioHistogram->mBuckets[theBucket], 0, memory_order_relaxed);
+	}
+	atomic_store_explicit(&ioHistogram->mCount, 0, memory_order_relaxed);
+	atomic_store_explicit(&ioHistogram->mSum, 0, memory_order_relaxed);
+	atomic_store_explicit(&ioHistogram->mMaximum, 0, memory_order_relaxed);
+}
+
+void	SyncAudioHistogram_Record(SyncAudioHistogram* ioHistogram, uint64_t inValue)
+{
+	SyncAudioHistogram_Add(&ioHistogram->mBuckets[SyncAudioHistogram_GetBucket(inValue)], 1);
+	SyncAudioHistogram_Add(&ioHistogram->mCount, 1);
+	SyncAudioHistogram_Add(&ioHistogram->mSum, inValue);
+	if(inValue > atomic_load_explicit(&ioHistogram->mMaximum, memory_order_relaxed))
+	{
+		atomic_store_explicit(&ioHistogram->mMaximum, inValue, memory_order_relaxed);
+	}
+}
+
+uint64_t	SyncAudioHistogram_GetBucketFloor(uint32_t inBucket)
+{
+	return (inBucket != 0) ? (1ULL << (inBucket - 1)) : 0;
+}
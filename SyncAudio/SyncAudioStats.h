@@ -0,0 +1,53 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+Lock free statistics recorded on the IO path.
+*/
+
+/*==================================================================================================
+	SyncAudioStats.h
+==================================================================================================*/
+#if !defined(__SyncAudioStats_h__)
+#define __SyncAudioStats_h__
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	System Includes
+#include <stdatomic.h>
+#include <stdint.h>
+
+//==================================================================================================
+#pragma mark -
+#pragma mark SyncAudioHistogram
+//==================================================================================================
+
+//	SyncAudioHistogram counts values in power of two buckets: bucket 0 counts zeros and bucket i
+//	counts the values in [2^(i-1), 2^i), except for the last bucket, which also counts everything
+//	above it. Along with the buckets it keeps the number of values, their sum and the largest one.
+//
+//	There is a single recorder, normally the IO thread, so recording is a handful of relaxed loads
+//	and stores with no read-modify-write, lock or allocation. Any thread can read the fields at any
+//	time with relaxed loads. The fields aren't read as a unit, so a reader racing the recorder can
+//	see a count that is one off from the buckets, which doesn't matter for monitoring.
+//	SyncAudioHistogram_Reset must not race the recorder.
+
+#define	kSyncAudioHistogram_BucketCount	32
+
+typedef struct SyncAudioHistogram
+{
+	_Atomic uint64_t	mBuckets[kSyncAudioHistogram_BucketCount];
+	_Atomic uint64_t	mCount;
+	_Atomic uint64_t	mSum;
+	_Atomic uint64_t	mMaximum;
+} SyncAudioHistogram;
+
+void	SyncAudioHistogram_Reset(SyncAudioHistogram* ioHistogram);
+void	SyncAudioHistogram_Record(SyncAudioHistogram* ioHistogram, uint64_t inValue);
+
+//	The smallest value counted by the given bucket.
+uint64_t	SyncAudioHistogram_GetBucketFloor(uint32_t inBucket);
+
+#endif	//	__SyncAudioStats_h__
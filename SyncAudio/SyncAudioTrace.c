@@ -0,0 +1,214 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+A trace log that is safe to write from the IO thread.
+*/
+
+/*==================================================================================================
+	SyncAudioTrace.c
+==================================================================================================*/
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	Ask for POSIX, which has nanosleep, when building with a strict C standard
+#if !defined(__APPLE__) && !defined(_POSIX_C_SOURCE)
+	#define	_POSIX_C_SOURCE	200809L
+#endif
+
+//	Self Include
+#include "SyncAudioTrace.h"
+
+//	System Includes
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Queue
+//==================================================================================================
+
+//	how many records the drainer writes at a time and how long it sleeps when there are none
+#define	kSyncAudioTrace_DrainBatchSize			256
+#define	kSyncAudioTrace_DrainIntervalNanoseconds	10000000L
+
+bool	SyncAudioTrace_Initialize(SyncAudioTrace* ioTrace, uint32_t inRecordCount)
+{
+	bool theAnswer = false;
+	memset(ioTrace, 0, sizeof(SyncAudioTrace));
+	ioTrace->mFileDescriptor = -1;
+	if((inRecordCount != 0) && ((inRecordCount & (inRecordCount - 1)) == 0))
+	{
+		void* theSlots = NULL;
+		size_t theByteSize = (size_t)inRecordCount * sizeof(SyncAudioTraceSlot);
+		if(posix_memalign(&theSlots, 64, theByteSize) == 0)
+		{
+			//	touch every page now so that recording never faults, and give every slot the
+			//	sequence that lets the first lap write it
+			memset(theSlots, 0, theByteSize);
+			ioTrace->mSlots = (SyncAudioTraceSlot*)theSlots;
+			ioTrace->mSlotCount = inRecordCount;
+			for(uint32_t theSlot = 0; theSlot < inRecordCount; ++theSlot)
+			{
+				atomic_init(&ioTrace->mSlots[theSlot].mSequence, theSlot);
+			}
+			atomic_init(&ioTrace->mWriteIndex, 0);
+			atomic_init(&ioTrace->mDroppedCount, 0);
+			atomic_init(&ioTrace->mDrainerShouldStop, false);
+			theAnswer = true;
+		}
+	}
+	return theAnswer;
+}
+
+void	SyncAudioTrace_Teardown(SyncAudioTrace* ioTrace)
+{
+	SyncAudioTrace_StopDrainer(ioTrace);
+	free(ioTrace->mSlots);
+	ioTrace->mSlots = NULL;
+	ioTrace->mSlotCount = 0;
+}
+
+bool	SyncAudioTrace_Record(SyncAudioTrace* ioTrace, const SyncAudioTraceRecord* inRecord)
+{
+	if(ioTrace->mSlots == NULL)
+	{
+		return false;
+	}
+
+	uint64_t theIndex = atomic_load_explicit(&ioTrace->mWriteIndex, memory_order_relaxed);
+	for(;;)
+	{
+		SyncAudioTraceSlot* theSlot = &ioTrace->mSlots[theIndex & (ioTrace->mSlotCount - 1)];
+		uint64_t theSequence = atomic_load_explicit(&theSlot->mSequence, memory_order_acquire);
+		if(theSequence == theIndex)
+		{
+			//	the slot is free on this lap, so try to claim it
+			if(atomic_compare_exchange_weak_explicit(&ioTrace->mWriteIndex, &theIndex, theIndex + 1, memory_order_relaxed, memory_order_relaxed))
+			{
+				theSlot->mRecord = *inRecord;
+				atomic_store_explicit(&theSlot->mSequence, theIndex + 1, memory_order_release);
+				return true;
+			}
+		}
+		else if(theSequence < theIndex)
+		{
+			//	the drainer hasn't taken the record from the last lap yet
+			atomic_fetch_add_explicit(&ioTrace->mDroppedCount, 1, memory_order_relaxed);
+			return false;
+		}
+		else
+		{
+			//	another recorder claimed it first
+			theIndex = atomic_load_explicit(&ioTrace->mWriteIndex, memory_order_relaxed);
+		}
+	}
+}
+
+uint32_t	SyncAudioTrace_Drain(SyncAudioTrace* ioTrace, SyncAudioTraceRecord* outRecords, uint32_t inMaxCount)
+{
+	uint32_t theCount = 0;
+	while(theCount < inMaxCount)
+	{
+		SyncAudioTraceSlot* theSlot = &ioTrace->mSlots[ioTrace->mReadIndex & (ioTrace->mSlotCount - 1)];
+		if(atomic_load_explicit(&theSlot->mSequence, memory_order_acquire) != ioTrace->mReadIndex + 1)
+		{
+			//	the next record hasn't been finished yet
+			break;
+		}
+		outRecords[theCount] = theSlot->mRecord;
+		atomic_store_explicit(&theSlot->mSequence, ioTrace->mReadIndex + ioTrace->mSlotCount, memory_order_release);
+		++ioTrace->mReadIndex;
+		++theCount;
+	}
+	return theCount;
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Drainer
+//==================================================================================================
+
+static bool	SyncAudioTrace_WriteAll(int inFileDescriptor, const void* inData, size_t inByteSize)
+{
+	const char* theData = (const char*)inData;
+	while(inByteSize > 0)
+	{
+		ssize_t theBytesWritten = write(inFileDescriptor, theData, inByteSize);
+		if(theBytesWritten <= 0)
+		{
+			return false;
+		}
+		theData += theBytesWritten;
+		inByteSize -= (size_t)theBytesWritten;
+	}
+	return true;
+}
+
+static void*	SyncAudioTrace_Drainer(void* inTrace)
+{
+	SyncAudioTrace* theTrace = (SyncAudioTrace*)inTrace;
+	SyncAudioTraceRecord theRecords[kSyncAudioTrace_DrainBatchSize];
+	for(;;)
+	{
+		//	read the flag before draining so that nothing recorded before the stop is left behind
+		bool theShouldStop = atomic_load_explicit(&theTrace->mDrainerShouldStop, memory_order_acquire);
+		uint32_t theCount = SyncAudioTrace_Drain(theTrace, theRecords, kSyncAudioTrace_DrainBatchSize);
+		if(theCount > 0)
+		{
+			SyncAudioTrace_WriteAll(theTrace->mFileDescriptor, theRecords, theCount * sizeof(SyncAudioTraceRecord));
+		}
+		else if(theShouldStop)
+		{
+			break;
+		}
+		else
+		{
+			struct timespec theInterval = { 0, kSyncAudioTrace_DrainIntervalNanoseconds };
+			nanosleep(&theInterval, NULL);
+		}
+	}
+	return NULL;
+}
+
+bool	SyncAudioTrace_StartDrainer(SyncAudioTrace* ioTrace, const char* inPath, uint64_t inHostTicksPerSecondNumerator, uint64_t inHostTicksPerSecondDenominator)
+{
+	if((ioTrace->mSlots == NULL) || ioTrace->mDrainerIsRunning)
+	{
+		return false;
+	}
+
+	ioTrace->mFileDescriptor = open(inPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if(ioTrace->mFileDescriptor < 0)
+	{
+		return false;
+	}
+
+	SyncAudioTraceFileHeader theHeader = { kSyncAudioTrace_FileMagic, kSyncAudioTrace_FileVersion, sizeof(SyncAudioTraceRecord), 0, inHostTicksPerSecondNumerator, inHostTicksPerSecondDenominator };
+	atomic_store_explicit(&ioTrace->mDrainerShouldStop, false, memory_order_relaxed);
+	if(!SyncAudioTrace_WriteAll(ioTrace->mFileDescriptor, &theHeader, sizeof(theHeader)) || (pthread_create(&ioTrace->mDrainer, NULL, SyncAudioTrace_Drainer, ioTrace) != 0))
+	{
+		close(ioTrace->mFileDescriptor);
+		ioTrace->mFileDescriptor = -1;
+		return false;
+	}
+	ioTrace->mDrainerIsRunning = true;
+	return true;
+}
+
+void	SyncAudioTrace_StopDrainer(SyncAudioTrace* ioTrace)
+{
+	if(ioTrace->mDrainerIsRunning)
+	{
+		atomic_store_explicit(&ioTrace->mDrainerShouldStop, true, memory_order_release);
+		pthread_join(ioTrace->mDrainer, NULL);
+		close(ioTrace->mFileDescriptor);
+		ioTrace->mFileDescriptor = -1;
+		ioTrace->mDrainerIsRunning = false;
+	}
+}
@@ -0,0 +1,134 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+A trace log that is safe to write from the IO thread.
+*/
+
+/*==================================================================================================
+	SyncAudioTrace.h
+==================================================================================================*/
+#if !defined(__SyncAudioTrace_h__)
+#define __SyncAudioTrace_h__
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	System Includes
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+//==================================================================================================
+#pragma mark -
+#pragma mark SyncAudioTrace
+//==================================================================================================
+
+//	SyncAudioTrace is a bounded queue of fixed size binary records. Any number of threads can
+//	record into it, including the IO thread, and a single drainer takes the records out. Each slot
+//	carries a sequence number that says whose turn it is: a recorder claims the slot at the write
+//	index with a compare and swap, fills it in and hands it to the drainer by advancing its
+//	sequence, and the drainer hands it back the same way once it has copied it out. Recording
+//	never blocks, allocates or makes a system call. When the queue is full the record is dropped
+//	and counted in mDroppedCount rather than waiting for the drainer.
+//
+//	The slots are allocated and touched once by SyncAudioTrace_Initialize.
+//
+//	SyncAudioTrace_StartDrainer starts a thread that wakes up every few milliseconds and writes the
+//	records to a file. The file starts with a SyncAudioTraceFileHeader and is followed by the
+//	records exactly as they are laid out in memory, in the byte order of the machine that wrote
+//	them, which is little endian on every machine the plug-in runs on:
+//
+//		header	32 bytes	mMagic, mVersion, mRecordSize and mReserved as 32 bit integers, then the
+//							host clock's ticks per second as a 64 bit numerator and denominator
+//		record	40 bytes	mHostTime and mDuration in host ticks, mEvent and mObjectID as 32 bit
+//							integers, then mArgument0 and mArgument1, whose meaning depends on
+//							mEvent as listed below
+//
+//	The records are in the order they were drained, which is the order they were claimed in, and
+//	any that were dropped are simply missing. A file from a drainer that is still running can end
+//	with part of a record. Tools/SyncAudioTraceDecode turns a file into the Chrome trace event
+//	format that Perfetto opens, and is the reference for reading one.
+
+#define	kSyncAudioTrace_FileMagic	0x52544153	//	'SATR' in little endian
+#define	kSyncAudioTrace_FileVersion	1
+
+enum
+{
+	//	mObjectID is the device and mArgument0 the number of clients running IO afterwards
+	kSyncAudioTrace_StartIO				= 1,
+	kSyncAudioTrace_StopIO				= 2,
+
+	//	mObjectID is the stream, mArgument0 the operation ID in the high 32 bits and the frame count
+	//	in the low ones, mArgument1 the sample time and mDuration how long the operation took
+	kSyncAudioTrace_IOOperation			= 3,
+
+	//	mObjectID is the object, mArgument0 the selector in the high 32 bits and the scope in the
+	//	low ones, mArgument1 the element and mDuration how long the set took
+	kSyncAudioTrace_SetProperty			= 4,
+
+	//	mObjectID is the device and mArgument0 the change action
+	kSyncAudioTrace_ConfigurationChange	= 5,
+
+	//	mObjectID is the box
+	kSyncAudioTrace_Identify			= 6
+};
+
+typedef struct SyncAudioTraceRecord
+{
+	uint64_t	mHostTime;
+	uint64_t	mDuration;
+	uint32_t	mEvent;
+	uint32_t	mObjectID;
+	uint64_t	mArgument0;
+	uint64_t	mArgument1;
+} SyncAudioTraceRecord;
+
+typedef struct SyncAudioTraceFileHeader
+{
+	uint32_t	mMagic;
+	uint32_t	mVersion;
+	uint32_t	mRecordSize;
+	uint32_t	mReserved;
+	uint64_t	mHostTicksPerSecondNumerator;
+	uint64_t	mHostTicksPerSecondDenominator;
+} SyncAudioTraceFileHeader;
+
+typedef struct SyncAudioTraceSlot
+{
+	_Atomic uint64_t		mSequence;
+	SyncAudioTraceRecord	mRecord;
+} SyncAudioTraceSlot;
+
+typedef struct SyncAudioTrace
+{
+	SyncAudioTraceSlot*	mSlots;
+	uint32_t			mSlotCount;
+	_Atomic uint64_t	mWriteIndex;
+	uint64_t			mReadIndex;
+	_Atomic uint64_t	mDroppedCount;
+	pthread_t			mDrainer;
+	_Atomic bool		mDrainerShouldStop;
+	bool				mDrainerIsRunning;
+	int					mFileDescriptor;
+} SyncAudioTrace;
+
+//	inRecordCount must be a power of two.
+bool		SyncAudioTrace_Initialize(SyncAudioTrace* ioTrace, uint32_t inRecordCount);
+void		SyncAudioTrace_Teardown(SyncAudioTrace* ioTrace);
+
+//	Called from any thread. Returns false if the record was dropped.
+bool		SyncAudioTrace_Record(SyncAudioTrace* ioTrace, const SyncAudioTraceRecord* inRecord);
+
+//	Called by the drainer only. Copies out up to inMaxCount records and returns how many it did.
+uint32_t	SyncAudioTrace_Drain(SyncAudioTrace* ioTrace, SyncAudioTraceRecord* outRecords, uint32_t inMaxCount);
+
+//	Starts a thread that drains the trace into the file at inPath, replacing it, until
+//	SyncAudioTrace_StopDrainer or SyncAudioTrace_Teardown. The host clock's frequency is written
+//	to the header so that the times can be converted.
+bool		SyncAudioTrace_StartDrainer(SyncAudioTrace* ioTrace, const char* inPath, uint64_t inHostTicksPerSecondNumerator, uint64_t inHostTicksPerSecondDenominator);
+void		SyncAudioTrace_StopDrainer(SyncAudioTrace* ioTrace);
+
+#endif	//	__SyncAudioTrace_h__
@@ -0,0 +1,183 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+The tests of the device clock.
+*/
+
+/*==================================================================================================
+	SyncAudioClockTests.c
+==================================================================================================*/
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	Local Includes
+#include "SyncAudioClock.h"
+#include "SyncAudioTest.h"
+
+//	System Includes
+#include <math.h>
+#include <pthread.h>
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Long Runs
+//==================================================================================================
+
+//	Runs the clock for 30 days of zero time stamps, asking for one at a different point of every
+//	period, and checks every one of them bit for bit against a reference that adds up the host
+//	ticks per period as a whole part and a remainder, so it shares none of the clock's arithmetic.
+//	The double precision arithmetic the plug-in used to do is run alongside to show how far it
+//	would have drifted.
+
+#define	kSyncAudioClockTests_Period	4096
+#define	kSyncAudioClockTests_Days	30
+
+static void	SyncAudioClockTests_RunDays(uint64_t inHostTicksPerSecond, uint64_t inSampleRate)
+{
+	SyncAudioClock theClock;
+	SyncAudioClock_Initialize(&theClock, kSyncAudioClockTests_Period, inHostTicksPerSecond, inSampleRate);
+	uint64_t theAnchorHostTime = 123456789;
+	SyncAudioClock_Anchor(&theClock, theAnchorHostTime);
+
+	//	the host ticks per period are inTicksPerPeriod + (inRemainder / inSampleRate)
+	uint64_t theTicksPerPeriod = (kSyncAudioClockTests_Period * inHostTicksPerSecond) / inSampleRate;
+	uint64_t theRemainderPerPeriod = (kSyncAudioClockTests_Period * inHostTicksPerSecond) % inSampleRate;
+	double theDoubleTicksPerPeriod = (double)kSyncAudioClockTests_Period * (double)inHostTicksPerSecond / (double)inSampleRate;
+
+	uint64_t theReferenceHostTime = theAnchorHostTime;
+	uint64_t theReferenceRemainder = 0;
+	uint64_t theTimeStampCount = (kSyncAudioClockTests_Days * 86400ULL * inSampleRate) / kSyncAudioClockTests_Period;
+	uint64_t theMismatchCount = 0;
+	uint64_t theSeed = 0;
+	double theWorstDoubleError = 0.0;
+	for(uint64_t theTimeStamp = 0; theTimeStamp < theTimeStampCount; ++theTimeStamp)
+	{
+		uint64_t theNextHostTime = theReferenceHostTime + theTicksPerPeriod + (((theReferenceRemainder + theRemainderPerPeriod) >= inSampleRate) ? 1 : 0);
+
+		double theSampleTime = 0.0;
+		uint64_t theHostTime = 0;
+		uint64_t theCurrentHostTime = theReferenceHostTime + ((theTimeStamp * 7919) % (theNextHostTime - theReferenceHostTime));
+		SyncAudioClock_GetZeroTimeStamp(&theClock, theCurrentHostTime, &theSampleTime, &theHostTime, &theSeed);
+		theMismatchCount += ((theSampleTime == (double)(theTimeStamp * kSyncAudioClockTests_Period)) && (theHostTime == theReferenceHostTime)) ? 0 : 1;
+
+		double theDoubleError = fabs((double)(theAnchorHostTime + (uint64_t)((double)theTimeStamp * theDoubleTicksPerPeriod)) - (double)theReferenceHostTime);
+		theWorstDoubleError = (theDoubleError > theWorstDoubleError) ? theDoubleError : theWorstDoubleError;
+
+		theReferenceRemainder += theRemainderPerPeriod;
+		theReferenceHostTime += theTicksPerPeriod;
+		if(theReferenceRemainder >= inSampleRate)
+		{
+			theReferenceRemainder -= inSampleRate;
+			theReferenceHostTime += 1;
+		}
+	}
+	fprintf(stderr, "     %llu ticks/s at %llu Hz: %llu time stamps, double precision off by up to %.0f ticks\n", (unsigned long long)inHostTicksPerSecond, (unsigned long long)inSampleRate, (unsigned long long)theTimeStampCount, theWorstDoubleError);
+	SyncAudioTest_Check(theMismatchCount == 0);
+
+	//	the time line was never broken
+	SyncAudioTest_Check(theSeed == 2);
+}
+
+static void	SyncAudioClockTests_ThirtyDays(void)
+{
+	//	nanoseconds, and the 24 MHz ticks of Apple silicon, at the two common families of rates
+	SyncAudioClockTests_RunDays(1000000000ULL, 48000);
+	SyncAudioClockTests_RunDays(24000000ULL, 44100);
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Sequence Lock
+//==================================================================================================
+
+//	A writer thread switches the rate between 3 host ticks per frame and 5 ticks per 7 frames as
+//	fast as it can while the reader takes zero time stamps and maps positions. Every result has to
+//	come from one rate or the other. Half of one and half of the other, 3 over 7 or 5 over 1, would
+//	mean the reader used a torn snapshot. On a single processor the writer can only be caught part
+//	way through by being preempted there, so the test finds much less there than it does on several.
+
+#define	kSyncAudioClockTests_ReadCount	1000000
+
+typedef struct SyncAudioClockTests_ContentionState
+{
+	SyncAudioClock	mClock;
+	_Atomic bool	mIsDone;
+	uint64_t		mWriteCount;
+} SyncAudioClockTests_ContentionState;
+
+static void*	SyncAudioClockTests_ContentionWriter(void* inContention)
+{
+	SyncAudioClockTests_ContentionState* theContention = (SyncAudioClockTests_ContentionState*)inContention;
+	while(!atomic_load_explicit(&theContention->mIsDone, memory_order_relaxed))
+	{
+		bool isFirst = (theContention->mWriteCount & 1) == 0;
+		SyncAudioClock_SetHostTicksPerFrame(&theContention->mClock, isFirst ? 3 : 5, isFirst ? 1 : 7);
+		++theContention->mWriteCount;
+	}
+	return NULL;
+}
+
+static void	SyncAudioClockTests_Contention(void)
+{
+	SyncAudioClockTests_ContentionState theContention;
+	SyncAudioClock theReference;
+	atomic_init(&theContention.mIsDone, false);
+	theContention.mWriteCount = 0;
+	SyncAudioClock_Initialize(&theContention.mClock, 64, 3, 1);
+	SyncAudioClock_Anchor(&theContention.mClock, 0);
+	SyncAudioClock_Initialize(&theReference, 64, 1, 1);
+	SyncAudioClock_Anchor(&theReference, 0);
+
+	pthread_t theWriter;
+	if(pthread_create(&theWriter, NULL, SyncAudioClockTests_ContentionWriter, &theContention) == 0)
+	{
+		uint64_t theFirstStep = 3ULL << 32;
+		uint64_t theSecondStep = (5ULL << 32) / 7;
+		uint64_t theTornCount = 0;
+		uint64_t theFirstCount = 0;
+		for(uint32_t theRead = 0; theRead < kSyncAudioClockTests_ReadCount; ++theRead)
+		{
+			//	the host time of a time stamp is the anchor plus the ticks to its sample time
+			double theSampleTime = 0.0;
+			uint64_t theHostTime = 0;
+			uint64_t theSeed = 0;
+			SyncAudioClock_GetZeroTimeStamp(&theContention.mClock, (uint64_t)theRead * 16, &theSampleTime, &theHostTime, &theSeed);
+			uint64_t theFrames = (uint64_t)theSampleTime;
+			bool isFirst = theHostTime == (theFrames * 3);
+			bool isSecond = theHostTime == ((theFrames * 5) / 7);
+			theTornCount += (isFirst || isSecond) ? 0 : 1;
+
+			//	as is the ratio of the rates of two clocks
+			int64_t theMappedSampleTime = 0;
+			uint32_t theMappedFraction = 0;
+			uint64_t theStep = 0;
+			SyncAudioClock_MapPosition(&theContention.mClock, &theReference, theRead, 0, &theMappedSampleTime, &theMappedFraction, &theStep);
+			theTornCount += ((theStep == theFirstStep) || (theStep == theSecondStep)) ? 0 : 1;
+			theFirstCount += (theStep == theFirstStep) ? 1 : 0;
+		}
+		atomic_store(&theContention.mIsDone, true);
+		pthread_join(theWriter, NULL);
+
+		fprintf(stderr, "     %llu writes, %llu of %u reads at the first rate\n", (unsigned long long)theContention.mWriteCount, (unsigned long long)theFirstCount, kSyncAudioClockTests_ReadCount);
+		SyncAudioTest_Check(theTornCount == 0);
+	}
+	else
+	{
+		SyncAudioTest_Check(!"the writer thread could not be started");
+	}
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Main
+//==================================================================================================
+
+int	main(void)
+{
+	SyncAudioTest_Run(SyncAudioClockTests_Contention);
+	SyncAudioTest_Run(SyncAudioClockTests_ThirtyDays);
+	return SyncAudioTest_Result();
+}
@@ -0,0 +1,160 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+Tests of the loop that holds a converting reader a steady distance behind the writer.
+*/
+
+/*==================================================================================================
+	SyncAudioDriftTests.c
+==================================================================================================*/
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	Local Includes
+#include "SyncAudioDrift.h"
+#include "SyncAudioTest.h"
+
+//	System Includes
+#include <math.h>
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Helpers
+//==================================================================================================
+
+//	The tests run the loop with the engine's time constant at 48 kHz against a writer whose cursor
+//	moves a buffer at a time, at a rate the clocks don't know about. What they follow is the lead
+//	the reader really has, from the writer's exact position, averaged over a time constant at a
+//	time so that the writer's buffers beating against the reader's average out.
+
+#define	kSyncAudioDriftTests_TimeConstant		192000.0
+#define	kSyncAudioDriftTests_ReadFrames			512
+#define	kSyncAudioDriftTests_WriteFrames		441
+#define	kSyncAudioDriftTests_StartLead			1500.0
+
+typedef struct SyncAudioDriftTestsRun
+{
+	SyncAudioDrift	mDrift;
+	int64_t			mReaderSampleTime;
+	double			mWriterPosition;
+	double			mWriterRate;
+} SyncAudioDriftTestsRun;
+
+static void	SyncAudioDriftTests_Start(SyncAudioDriftTestsRun* ioRun, double inWriterRate)
+{
+	SyncAudioDrift_Reset(&ioRun->mDrift, kSyncAudioDriftTests_TimeConstant);
+	ioRun->mReaderSampleTime = 0;
+	ioRun->mWriterPosition = kSyncAudioDriftTests_StartLead;
+	ioRun->mWriterRate = inWriterRate;
+}
+
+//	Reads for a time constant, with the writer keeping up with its own clock to the last whole
+//	buffer, and returns the mean lead. outCorrection, which may be NULL, gets the mean correction.
+static double	SyncAudioDriftTests_Read(SyncAudioDriftTestsRun* ioRun, double* outCorrection)
+{
+	uint32_t theReadCount = (uint32_t)(kSyncAudioDriftTests_TimeConstant / kSyncAudioDriftTests_ReadFrames);
+	double theLead = 0.0;
+	double theCorrection = 0.0;
+	for(uint32_t theRead = 0; theRead < theReadCount; ++theRead)
+	{
+		ioRun->mWriterPosition += kSyncAudioDriftTests_ReadFrames * ioRun->mWriterRate;
+		int64_t theWriteTime = ((int64_t)ioRun->mWriterPosition / kSyncAudioDriftTests_WriteFrames) * kSyncAudioDriftTests_WriteFrames;
+		int64_t theSampleTime;
+		uint32_t theFraction;
+		uint64_t theStep;
+		SyncAudioDrift_Update(&ioRun->mDrift, ioRun->mReaderSampleTime, kSyncAudioDriftTests_ReadFrames, ioRun->mReaderSampleTime, 0, 1ULL << 32, theWriteTime, &theSampleTime, &theFraction, &theStep);
+		double theEnd = (double)theSampleTime + ((double)theFraction / 4294967296.0) + (kSyncAudioDriftTests_ReadFrames * (double)theStep / 4294967296.0);
+		theLead += ioRun->mWriterPosition - theEnd;
+		theCorrection += ioRun->mDrift.mCorrection;
+		ioRun->mReaderSampleTime += kSyncAudioDriftTests_ReadFrames;
+	}
+	if(outCorrection != NULL)
+	{
+		*outCorrection = theCorrection / theReadCount;
+	}
+	return theLead / theReadCount;
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Rate
+//==================================================================================================
+
+//	A writer that runs 200 ppm fast is followed by reading 200 ppm fast, and the lead stops moving.
+
+static void	SyncAudioDriftTests_Rate(void)
+{
+	SyncAudioDriftTestsRun theRun;
+	SyncAudioDriftTests_Start(&theRun, 1.0002);
+	for(uint32_t theIndex = 0; theIndex < 20; ++theIndex)
+	{
+		SyncAudioDriftTests_Read(&theRun, NULL);
+	}
+	double theCorrection = 0.0;
+	double theLead = SyncAudioDriftTests_Read(&theRun, &theCorrection);
+	double theNextLead = SyncAudioDriftTests_Read(&theRun, NULL);
+	SyncAudioTest_Check(theRun.mDrift.mIsSettled);
+	SyncAudioTest_Check(fabs(theCorrection - 0.0002) < 1e-5);
+	SyncAudioTest_Check(fabs(theNextLead - theLead) < 1.0);
+	SyncAudioTest_Check(atomic_load(&theRun.mDrift.mResyncCount) == 0);
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Step
+//==================================================================================================
+
+//	A writer that jumps ahead by a little is caught up with. The integral has to give back what it
+//	took in while the lead was long, so the lead dips below where it was once, but being critically
+//	damped with the smoothing in the loop means it then comes back without ringing.
+
+static void	SyncAudioDriftTests_Step(void)
+{
+	SyncAudioDriftTestsRun theRun;
+	SyncAudioDriftTests_Start(&theRun, 1.0);
+	for(uint32_t theIndex = 0; theIndex < 8; ++theIndex)
+	{
+		SyncAudioDriftTests_Read(&theRun, NULL);
+	}
+	double theSettledLead = SyncAudioDriftTests_Read(&theRun, NULL);
+	SyncAudioTest_Check(theRun.mDrift.mIsSettled);
+
+	//	count the times the lead crosses from one side of where it was to the other by more than a
+	//	frame
+	double theJump = 20.0;
+	theRun.mWriterPosition += theJump;
+	double theSmallestError = 0.0;
+	double theError = 0.0;
+	double theSide = 1.0;
+	uint32_t theCrossingCount = 0;
+	for(uint32_t theIndex = 0; theIndex < 24; ++theIndex)
+	{
+		theError = SyncAudioDriftTests_Read(&theRun, NULL) - theSettledLead;
+		theSmallestError = fmin(theSmallestError, theError);
+		if((theError * theSide) < -1.0)
+		{
+			++theCrossingCount;
+			theSide = -theSide;
+		}
+	}
+	fprintf(stderr, "     %.2f frames at worst the other way, %.2f at the end\n", theSmallestError, theError);
+	SyncAudioTest_Check(fabs(theError) < 1.0);
+	SyncAudioTest_Check(theSmallestError > -(0.35 * theJump));
+	SyncAudioTest_Check(theCrossingCount <= 1);
+	SyncAudioTest_Check(atomic_load(&theRun.mDrift.mResyncCount) == 0);
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Main
+//==================================================================================================
+
+int	main(void)
+{
+	SyncAudioTest_Run(SyncAudioDriftTests_Rate);
+	SyncAudioTest_Run(SyncAudioDriftTests_Step);
+	return SyncAudioTest_Result();
+}
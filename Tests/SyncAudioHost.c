@@ -0,0 +1,392 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+A stand-in for coreaudiod that drives the SyncAudio engine through its IO cycles off the HAL.
+*/
+
+/*==================================================================================================
+	SyncAudioHost.c
+==================================================================================================*/
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	Self Include
+#include "SyncAudioHost.h"
+
+//	System Includes
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Clock
+//==================================================================================================
+
+static uint64_t	SyncAudioHost_ReadHostTime(void* inContext)
+{
+	const SyncAudioHost* theHost = (const SyncAudioHost*)inContext;
+	return theHost->mIsRealTime ? SyncAudioPlatform_GetHostTime() : theHost->mHostTime;
+}
+
+static void	SyncAudioHost_WaitUntil(SyncAudioHost* ioHost, uint64_t inHostTime)
+{
+	if(!ioHost->mIsRealTime)
+	{
+		//	the virtual time line just moves on, but never backwards
+		if(ioHost->mHostTime < inHostTime)
+		{
+			ioHost->mHostTime = inHostTime;
+		}
+	}
+	else
+	{
+		uint64_t theNow = SyncAudioPlatform_GetHostTime();
+		if(theNow < inHostTime)
+		{
+			unsigned __int128 theNanoseconds = (unsigned __int128)(inHostTime - theNow) * ioHost->mHostClock.mTicksPerSecondDenominator * 1000000000ULL / ioHost->mHostClock.mTicksPerSecondNumerator;
+			struct timespec theDuration = { (time_t)(theNanoseconds / 1000000000ULL), (long)(theNanoseconds % 1000000000ULL) };
+			nanosleep(&theDuration, NULL);
+		}
+	}
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Storage
+//==================================================================================================
+
+static void	SyncAudioHost_MakeStorageKey(const SyncAudioHostDevice* inDevice, const char* inKey, char* outKey)
+{
+	//	each device's settings are kept under its UID, as the HAL adapter keeps them
+	snprintf(outKey, 2 * kSyncAudioHost_MaxKeyLength, "%s %s", inDevice->mUID, inKey);
+}
+
+static SyncAudioHostStorageItem*	SyncAudioHost_FindStorageItem(SyncAudioHost* ioHost, const char* inKey)
+{
+	SyncAudioHostStorageItem* theAnswer = NULL;
+	for(uint32_t theIndex = 0; (theAnswer == NULL) && (theIndex < ioHost->mStorageItemCount); ++theIndex)
+	{
+		if(strcmp(ioHost->mStorage[theIndex].mKey, inKey) == 0)
+		{
+			theAnswer = &ioHost->mStorage[theIndex];
+		}
+	}
+	return theAnswer;
+}
+
+static bool	SyncAudioHost_Storage_CopyNumber(void* inContext, const char* inKey, double* outValue)
+{
+	const SyncAudioHostDevice* theDevice = (const SyncAudioHostDevice*)inContext;
+	char theKey[2 * kSyncAudioHost_MaxKeyLength];
+	SyncAudioHost_MakeStorageKey(theDevice, inKey, theKey);
+	SyncAudioHostStorageItem* theItem = SyncAudioHost_FindStorageItem(theDevice->mHost, theKey);
+	if(theItem != NULL)
+	{
+		*outValue = theItem->mValue;
+	}
+	return theItem != NULL;
+}
+
+static void	SyncAudioHost_Storage_WriteNumber(void* inContext, const char* inKey, double inValue)
+{
+	const SyncAudioHostDevice* theDevice = (const SyncAudioHostDevice*)inContext;
+	SyncAudioHost* theHost = theDevice->mHost;
+	char theKey[2 * kSyncAudioHost_MaxKeyLength];
+	SyncAudioHost_MakeStorageKey(theDevice, inKey, theKey);
+	SyncAudioHostStorageItem* theItem = SyncAudioHost_FindStorageItem(theHost, theKey);
+	if((theItem == NULL) && (theHost->mStorageItemCount < kSyncAudioHost_MaxStorageItemCount))
+	{
+		theItem = &theHost->mStorage[theHost->mStorageItemCount++];
+		memcpy(theItem->mKey, theKey, sizeof(theKey));
+	}
+	if(theItem != NULL)
+	{
+		theItem->mValue = inValue;
+	}
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark IO Cycle
+//==================================================================================================
+
+static uint64_t	SyncAudioHostDevice_GetWakeTime(const SyncAudioHostDevice* inDevice)
+{
+	uint64_t theLateness = (inDevice->mLatenessProc != NULL) ? inDevice->mLatenessProc(inDevice->mLatenessProcContext, inDevice, inDevice->mCycle) : 0;
+	return SyncAudioHostDevice_GetHostTimeForSampleTime(inDevice, inDevice->mNextSampleTime) + theLateness;
+}
+
+static void	SyncAudioHostDevice_RunCycle(SyncAudioHostDevice* ioDevice)
+{
+	SyncAudioEngine* theEngine = &ioDevice->mEngine;
+
+	//	GetZeroTimeStamp, which the HAL calls every cycle to keep its time line up to date
+	double theZeroSampleTime;
+	uint64_t theZeroHostTime;
+	uint64_t theSeed;
+	SyncAudioEngine_GetZeroTimeStamp(theEngine, &theZeroSampleTime, &theZeroHostTime, &theSeed);
+	ioDevice->mZeroSampleTime = theZeroSampleTime;
+	ioDevice->mZeroHostTime = theZeroHostTime;
+	if(theSeed != ioDevice->mSeed)
+	{
+		//	a new seed means the time line moved, so the HAL picks it up again where it is now
+		ioDevice->mSeed = theSeed;
+		++ioDevice->mReanchorCount;
+		uint64_t theNow = SyncAudioEngine_GetHostTime(theEngine);
+		double theFrames = (double)(theNow - theZeroHostTime) * (double)ioDevice->mHost->mHostClock.mTicksPerSecondDenominator * theEngine->mSampleRate / (double)ioDevice->mHost->mHostClock.mTicksPerSecondNumerator;
+		ioDevice->mNextSampleTime = (int64_t)theZeroSampleTime + (int64_t)theFrames;
+	}
+
+	SyncAudioHostCycle theCycle;
+	theCycle.mCycle = ioDevice->mCycle;
+	theCycle.mInputSampleTime = ioDevice->mNextSampleTime - (int64_t)ioDevice->mBufferFrames - (int64_t)ioDevice->mInputSafetyOffset;
+	theCycle.mOutputSampleTime = ioDevice->mNextSampleTime + (int64_t)ioDevice->mOutputSafetyOffset;
+	theCycle.mFrameCount = ioDevice->mBufferFrames;
+
+	//	ReadInput, and the check the adapter makes to tell the HAL the latency changed
+	uint64_t theStartHostTime = SyncAudioEngine_GetHostTime(theEngine);
+	theCycle.mReadFlags = SyncAudioEngine_ReadInput(theEngine, theCycle.mInputSampleTime, ioDevice->mGain, ioDevice->mInput, theCycle.mFrameCount);
+	memcpy(ioDevice->mPhysicalInput, ioDevice->mInput, (size_t)theCycle.mFrameCount * theEngine->mRing.mChannelCount * SyncAudioEngine_GetPhysicalBytesPerSample(theEngine));
+	if(theCycle.mReadFlags != kSyncAudioRing_NoError)
+	{
+		++ioDevice->mShortReadCount;
+	}
+	uint32_t theJitterFrames = atomic_load_explicit(&theEngine->mJitterFrames, memory_order_relaxed);
+	if(theJitterFrames != ioDevice->mReportedJitterFrames)
+	{
+		ioDevice->mReportedJitterFrames = theJitterFrames;
+		++ioDevice->mLatencyChangeCount;
+	}
+	SyncAudioEngine_RecordOperation(theEngine, kSyncAudioEngine_ReadInputOperation, theStartHostTime, SyncAudioEngine_GetHostTime(theEngine), SyncAudioHostDevice_GetHostTimeForSampleTime(ioDevice, theCycle.mInputSampleTime));
+
+	//	ConvertInput, the clients and ConvertOutput
+	SyncAudioEngine_ConvertInput(theEngine, ioDevice->mInput, theCycle.mFrameCount);
+	memset(ioDevice->mOutput, 0, (size_t)theCycle.mFrameCount * theEngine->mRing.mChannelCount * sizeof(float));
+	if(ioDevice->mIOProc != NULL)
+	{
+		ioDevice->mIOProc(ioDevice->mIOProcContext, ioDevice, &theCycle, ioDevice->mInput, ioDevice->mOutput);
+	}
+	SyncAudioEngine_ConvertOutput(theEngine, ioDevice->mOutput, theCycle.mFrameCount);
+
+	//	WriteMix
+	theStartHostTime = SyncAudioEngine_GetHostTime(theEngine);
+	SyncAudioEngine_WriteMix(theEngine, theCycle.mOutputSampleTime, ioDevice->mOutput, theCycle.mFrameCount, theCycle.mCycle);
+	SyncAudioEngine_RecordOperation(theEngine, kSyncAudioEngine_WriteMixOperation, theStartHostTime, SyncAudioEngine_GetHostTime(theEngine), SyncAudioHostDevice_GetHostTimeForSampleTime(ioDevice, theCycle.mOutputSampleTime));
+
+	ioDevice->mNextSampleTime += (int64_t)ioDevice->mBufferFrames;
+	++ioDevice->mCycle;
+	++ioDevice->mCycleCount;
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark SyncAudioHost
+//==================================================================================================
+
+typedef struct SyncAudioHostRun
+{
+	SyncAudioHost*	mHost;
+	uint64_t		mEndHostTime;
+} SyncAudioHostRun;
+
+static void*	SyncAudioHost_RunUntil(void* inRun)
+{
+	const SyncAudioHostRun* theRun = (const SyncAudioHostRun*)inRun;
+	SyncAudioHost* theHost = theRun->mHost;
+	bool isDone = false;
+	while(!isDone)
+	{
+		//	the running device whose cycle is due first
+		SyncAudioHostDevice* theDevice = NULL;
+		uint64_t theWakeTime = 0;
+		for(uint32_t theIndex = 0; theIndex < theHost->mDeviceCount; ++theIndex)
+		{
+			if(theHost->mDevices[theIndex]->mIOIsRunning)
+			{
+				uint64_t theDeviceWakeTime = SyncAudioHostDevice_GetWakeTime(theHost->mDevices[theIndex]);
+				if((theDevice == NULL) || (theDeviceWakeTime < theWakeTime))
+				{
+					theDevice = theHost->mDevices[theIndex];
+					theWakeTime = theDeviceWakeTime;
+				}
+			}
+		}
+
+		isDone = (theDevice == NULL) || (theWakeTime > theRun->mEndHostTime);
+		if(!isDone)
+		{
+			SyncAudioHost_WaitUntil(theHost, theWakeTime);
+			SyncAudioHostDevice_RunCycle(theDevice);
+		}
+	}
+	SyncAudioHost_WaitUntil(theHost, theRun->mEndHostTime);
+	return NULL;
+}
+
+void	SyncAudioHost_Initialize(SyncAudioHost* ioHost, bool inIsRealTime)
+{
+	memset(ioHost, 0, sizeof(*ioHost));
+	ioHost->mIsRealTime = inIsRealTime;
+
+	//	the virtual time line is in the platform clock's ticks and starts a second in, so that no
+	//	time stamp is ever at zero
+	ioHost->mHostClock.mContext = ioHost;
+	ioHost->mHostClock.mGetHostTime = SyncAudioHost_ReadHostTime;
+	SyncAudioPlatform_GetHostTicksPerSecond(&ioHost->mHostClock.mTicksPerSecondNumerator, &ioHost->mHostClock.mTicksPerSecondDenominator);
+	ioHost->mHostTime = SyncAudioHost_SecondsToHostTicks(ioHost, 1.0);
+}
+
+uint64_t	SyncAudioHost_GetHostTime(const SyncAudioHost* inHost)
+{
+	return SyncAudioHost_ReadHostTime((void*)inHost);
+}
+
+uint64_t	SyncAudioHost_SecondsToHostTicks(const SyncAudioHost* inHost, double inSeconds)
+{
+	return (uint64_t)(inSeconds * (double)inHost->mHostClock.mTicksPerSecondNumerator / (double)inHost->mHostClock.mTicksPerSecondDenominator);
+}
+
+bool	SyncAudioHost_Run(SyncAudioHost* ioHost, double inSeconds)
+{
+	bool theAnswer = true;
+	SyncAudioHostRun theRun = { ioHost, SyncAudioHost_GetHostTime(ioHost) + SyncAudioHost_SecondsToHostTicks(ioHost, inSeconds) };
+	if(!ioHost->mIsRealTime)
+	{
+		SyncAudioHost_RunUntil(&theRun);
+	}
+	else
+	{
+		//	The HAL's IO threads are real-time threads. Most systems only give that to privileged
+		//	processes, so without it the cycles run on an ordinary thread.
+		pthread_t theThread;
+		pthread_attr_t theAttributes;
+		struct sched_param theParameters = { 0 };
+		theParameters.sched_priority = sched_get_priority_min(SCHED_FIFO);
+		pthread_attr_init(&theAttributes);
+		pthread_attr_setinheritsched(&theAttributes, PTHREAD_EXPLICIT_SCHED);
+		pthread_attr_setschedpolicy(&theAttributes, SCHED_FIFO);
+		pthread_attr_setschedparam(&theAttributes, &theParameters);
+		ioHost->mIsRealTimePriority = pthread_create(&theThread, &theAttributes, SyncAudioHost_RunUntil, &theRun) == 0;
+		pthread_attr_destroy(&theAttributes);
+		theAnswer = ioHost->mIsRealTimePriority || (pthread_create(&theThread, NULL, SyncAudioHost_RunUntil, &theRun) == 0);
+		if(theAnswer)
+		{
+			pthread_join(theThread, NULL);
+		}
+	}
+	return theAnswer;
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark SyncAudioHostDevice
+//==================================================================================================
+
+bool	SyncAudioHostDevice_Initialize(SyncAudioHostDevice* ioDevice, SyncAudioHost* ioHost, const char* inUID, double inSampleRate, uint32_t inChannelCount, uint32_t inBufferFrames)
+{
+	bool theAnswer = false;
+	memset(ioDevice, 0, sizeof(*ioDevice));
+	if((ioHost->mDeviceCount < kSyncAudioHost_MaxDeviceCount) && (inBufferFrames > 0) && (inBufferFrames <= kSyncAudioHost_MaxBufferFrames))
+	{
+		ioDevice->mHost = ioHost;
+		snprintf(ioDevice->mUID, sizeof(ioDevice->mUID), "%s", inUID);
+		ioDevice->mBufferFrames = inBufferFrames;
+		ioDevice->mGain = 1.0f;
+
+		size_t theBufferSamples = (size_t)kSyncAudioHost_MaxBufferFrames * inChannelCount;
+		ioDevice->mInput = (float*)calloc(theBufferSamples, sizeof(float));
+		ioDevice->mOutput = (float*)calloc(theBufferSamples, sizeof(float));
+		ioDevice->mPhysicalInput = (uint8_t*)calloc(theBufferSamples, sizeof(float));
+		SyncAudioStorage theStorage = { ioDevice, SyncAudioHost_Storage_CopyNumber, SyncAudioHost_Storage_WriteNumber };
+		theAnswer = (ioDevice->mInput != NULL) && (ioDevice->mOutput != NULL) && (ioDevice->mPhysicalInput != NULL) && SyncAudioEngine_Initialize(&ioDevice->mEngine, &theStorage, &ioHost->mHostClock, inSampleRate, kSyncAudioEngine_MaxSampleRate, inChannelCount, kSyncAudioHost_RingFrameCapacity, kSyncAudioHost_ZeroTimeStampPeriod, 0);
+		if(theAnswer)
+		{
+			ioHost->mDevices[ioHost->mDeviceCount++] = ioDevice;
+		}
+		else
+		{
+			free(ioDevice->mInput);
+			free(ioDevice->mOutput);
+			free(ioDevice->mPhysicalInput);
+			ioDevice->mInput = NULL;
+			ioDevice->mOutput = NULL;
+			ioDevice->mPhysicalInput = NULL;
+		}
+	}
+	return theAnswer;
+}
+
+void	SyncAudioHostDevice_Teardown(SyncAudioHostDevice* ioDevice)
+{
+	SyncAudioHost* theHost = ioDevice->mHost;
+	for(uint32_t theIndex = 0; theIndex < theHost->mDeviceCount; ++theIndex)
+	{
+		if(theHost->mDevices[theIndex] == ioDevice)
+		{
+			theHost->mDevices[theIndex] = theHost->mDevices[--theHost->mDeviceCount];
+		}
+	}
+	SyncAudioEngine_Teardown(&ioDevice->mEngine);
+	free(ioDevice->mInput);
+	free(ioDevice->mOutput);
+	free(ioDevice->mPhysicalInput);
+	ioDevice->mInput = NULL;
+	ioDevice->mOutput = NULL;
+	ioDevice->mPhysicalInput = NULL;
+}
+
+void	SyncAudioHostDevice_StartIO(SyncAudioHostDevice* ioDevice)
+{
+	if(!ioDevice->mIOIsRunning)
+	{
+		//	the HAL asks for the first zero time stamp right away, and the first cycle comes once
+		//	there is a whole buffer of input to read at sample time zero
+		SyncAudioEngine_StartIO(&ioDevice->mEngine);
+		SyncAudioEngine_GetZeroTimeStamp(&ioDevice->mEngine, &ioDevice->mZeroSampleTime, &ioDevice->mZeroHostTime, &ioDevice->mSeed);
+		ioDevice->mNextSampleTime = (int64_t)ioDevice->mZeroSampleTime + (int64_t)ioDevice->mBufferFrames + (int64_t)ioDevice->mInputSafetyOffset;
+		ioDevice->mCycle = 0;
+		ioDevice->mIOIsRunning = true;
+	}
+}
+
+void	SyncAudioHostDevice_StopIO(SyncAudioHostDevice* ioDevice)
+{
+	ioDevice->mIOIsRunning = false;
+}
+
+void	SyncAudioHostDevice_SetSampleRate(SyncAudioHostDevice* ioDevice, double inSampleRate)
+{
+	bool wasRunning = ioDevice->mIOIsRunning;
+	SyncAudioHostDevice_StopIO(ioDevice);
+	SyncAudioEngine_SetSampleRate(&ioDevice->mEngine, inSampleRate);
+	if(wasRunning)
+	{
+		SyncAudioHostDevice_StartIO(ioDevice);
+	}
+}
+
+void	SyncAudioHostDevice_SetPhysicalFormat(SyncAudioHostDevice* ioDevice, uint32_t inBits)
+{
+	bool wasRunning = ioDevice->mIOIsRunning;
+	SyncAudioHostDevice_StopIO(ioDevice);
+	SyncAudioEngine_SetPhysicalFormat(&ioDevice->mEngine, inBits);
+	if(wasRunning)
+	{
+		SyncAudioHostDevice_StartIO(ioDevice);
+	}
+}
+
+uint64_t	SyncAudioHostDevice_GetHostTimeForSampleTime(const SyncAudioHostDevice* inDevice, int64_t inSampleTime)
+{
+	const SyncAudioHostClock* theHostClock = &inDevice->mHost->mHostClock;
+	double theTicks = ((double)inSampleTime - inDevice->mZeroSampleTime) * (double)theHostClock->mTicksPerSecondNumerator / ((double)theHostClock->mTicksPerSecondDenominator * inDevice->mEngine.mSampleRate);
+	double theHostTime = (double)inDevice->mZeroHostTime + theTicks;
+	return (theHostTime > 0.0) ? (uint64_t)theHostTime : 0;
+}
@@ -0,0 +1,166 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+A stand-in for coreaudiod that drives the SyncAudio engine through its IO cycles off the HAL.
+*/
+
+/*==================================================================================================
+	SyncAudioHost.h
+==================================================================================================*/
+#if !defined(__SyncAudioHost_h__)
+#define __SyncAudioHost_h__
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	System Includes
+#include <stdbool.h>
+#include <stdint.h>
+
+//	Local Includes
+#include "SyncAudioEngine.h"
+
+//==================================================================================================
+#pragma mark -
+#pragma mark SyncAudioHost
+//==================================================================================================
+
+//	SyncAudioHost plays the part coreaudiod plays for the plug-in, for the engine that the plug-in's
+//	HAL adapter wraps. SyncAudio.c itself only builds against CoreAudio, CoreFoundation and
+//	dispatch, so the host calls the engine the way the adapter's entry points do instead:
+//
+//		StartIO			SyncAudioEngine_StartIO, then the first zero time stamp
+//		StopIO			nothing, the engine keeps its state until the next start
+//		GetZeroTimeStamp	SyncAudioEngine_GetZeroTimeStamp, where a new seed re-anchors the device
+//		ReadInput		SyncAudioEngine_ReadInput, then the latency check that sends the adapter's
+//						kAudioDevicePropertyLatency notification, then RecordOperation
+//		ConvertInput	SyncAudioEngine_ConvertInput
+//		ConvertOutput	SyncAudioEngine_ConvertOutput
+//		WriteMix		SyncAudioEngine_WriteMix, then RecordOperation
+//
+//	and it keeps the settings the engine writes in a table, as the host's CopyFromStorage and
+//	WriteToStorage do, under each device's UID as the adapter does.
+//
+//	Each IO cycle of a device happens when the host time reaches the host time of the device's next
+//	sample time, by its latest zero time stamp, plus however late the device's lateness callback
+//	says the cycle is. A cycle reads the input of the buffer that ended the input safety offset
+//	before the cycle's sample time, hands it to the device's IO callback, which plays the clients,
+//	and mixes what the callback wrote into the output buffer that starts the output safety offset
+//	after it, which is the arithmetic the HAL does to fill in AudioServerPlugInIOCycleInfo. The
+//	input and the mix are converted between the physical format and floats around the callback in
+//	the same buffers, and mPhysicalInput keeps a copy of the last input as ReadInput left it.
+//
+//	By default the host time is virtual. It is in the platform clock's ticks but only moves when
+//	the host moves it, so SyncAudioHost_Run takes no real time and every run is exactly repeatable,
+//	stalls included. A host that is real time reads the platform's clock and runs its devices'
+//	cycles on a thread of their own, at real-time priority where the system allows it, sleeping
+//	until each one is due, as the HAL's IO threads do.
+#define	kSyncAudioHost_MaxDeviceCount		4
+#define	kSyncAudioHost_MaxStorageItemCount	32
+#define	kSyncAudioHost_MaxKeyLength			64
+#define	kSyncAudioHost_MaxBufferFrames		4096
+#define	kSyncAudioHost_RingFrameCapacity	(1U << 18)
+#define	kSyncAudioHost_ZeroTimeStampPeriod	4096
+
+struct SyncAudioHost;
+struct SyncAudioHostDevice;
+
+//	What the HAL would pass in AudioServerPlugInIOCycleInfo, along with what the read returned.
+typedef struct SyncAudioHostCycle
+{
+	uint64_t	mCycle;
+	int64_t		mInputSampleTime;
+	int64_t		mOutputSampleTime;
+	uint32_t	mFrameCount;
+	uint32_t	mReadFlags;
+} SyncAudioHostCycle;
+
+//	Plays the clients of the device for a cycle: inInput is what ReadInput produced and outOutput,
+//	which starts out silent, is the mix to write.
+typedef void		(*SyncAudioHostDeviceIOProc)(void* inContext, struct SyncAudioHostDevice* ioDevice, const SyncAudioHostCycle* inCycle, const float* inInput, float* outOutput);
+
+//	How many host ticks late the device's IO thread wakes up for the given cycle.
+typedef uint64_t	(*SyncAudioHostDeviceLatenessProc)(void* inContext, const struct SyncAudioHostDevice* inDevice, uint64_t inCycle);
+
+typedef struct SyncAudioHostDevice
+{
+	struct SyncAudioHost*			mHost;
+	char							mUID[kSyncAudioHost_MaxKeyLength];
+	SyncAudioEngine					mEngine;
+	bool							mIOIsRunning;
+	uint32_t						mBufferFrames;
+	int32_t							mInputSafetyOffset;
+	int32_t							mOutputSafetyOffset;
+	float							mGain;
+	SyncAudioHostDeviceIOProc		mIOProc;
+	void*							mIOProcContext;
+	SyncAudioHostDeviceLatenessProc	mLatenessProc;
+	void*							mLatenessProcContext;
+
+	//	the device's time line as the HAL tracks it
+	uint64_t						mCycle;
+	int64_t							mNextSampleTime;
+	double							mZeroSampleTime;
+	uint64_t						mZeroHostTime;
+	uint64_t						mSeed;
+	uint32_t						mReportedJitterFrames;
+
+	//	what happened, for the tests to check
+	uint64_t						mCycleCount;
+	uint64_t						mReanchorCount;
+	uint64_t						mLatencyChangeCount;
+	uint64_t						mShortReadCount;
+
+	float*							mInput;
+	float*							mOutput;
+	uint8_t*						mPhysicalInput;
+} SyncAudioHostDevice;
+
+typedef struct SyncAudioHostStorageItem
+{
+	char	mKey[2 * kSyncAudioHost_MaxKeyLength];
+	double	mValue;
+} SyncAudioHostStorageItem;
+
+typedef struct SyncAudioHost
+{
+	bool						mIsRealTime;
+	uint64_t					mHostTime;
+	SyncAudioHostClock			mHostClock;
+	SyncAudioHostDevice*		mDevices[kSyncAudioHost_MaxDeviceCount];
+	uint32_t					mDeviceCount;
+	SyncAudioHostStorageItem	mStorage[kSyncAudioHost_MaxStorageItemCount];
+	uint32_t					mStorageItemCount;
+	bool						mIsRealTimePriority;
+} SyncAudioHost;
+
+void		SyncAudioHost_Initialize(SyncAudioHost* ioHost, bool inIsRealTime);
+uint64_t	SyncAudioHost_GetHostTime(const SyncAudioHost* inHost);
+uint64_t	SyncAudioHost_SecondsToHostTicks(const SyncAudioHost* inHost, double inSeconds);
+
+//	Runs the IO cycles of the running devices that fall in the next inSeconds of host time, after
+//	which the host time is at the end of that span. Returns false if a real-time host couldn't
+//	start its thread.
+bool		SyncAudioHost_Run(SyncAudioHost* ioHost, double inSeconds);
+
+//	Adds a device to the host, whose engine loads its settings from the host's storage. The
+//	callbacks and the gain start out NULL and unity and the safety offsets out at zero.
+bool		SyncAudioHostDevice_Initialize(SyncAudioHostDevice* ioDevice, SyncAudioHost* ioHost, const char* inUID, double inSampleRate, uint32_t inChannelCount, uint32_t inBufferFrames);
+void		SyncAudioHostDevice_Teardown(SyncAudioHostDevice* ioDevice);
+void		SyncAudioHostDevice_StartIO(SyncAudioHostDevice* ioDevice);
+void		SyncAudioHostDevice_StopIO(SyncAudioHostDevice* ioDevice);
+
+//	Changes the sample rate the way the HAL does a configuration change, stopping IO around it if
+//	it is running.
+void		SyncAudioHostDevice_SetSampleRate(SyncAudioHostDevice* ioDevice, double inSampleRate);
+
+//	Changes the physical format to inBits bit integers, or to floats if inBits is 0, stopping IO
+//	around it if it is running.
+void		SyncAudioHostDevice_SetPhysicalFormat(SyncAudioHostDevice* ioDevice, uint32_t inBits);
+
+//	The host time at which the given sample time happens by the device's latest zero time stamp.
+uint64_t	SyncAudioHostDevice_GetHostTimeForSampleTime(const SyncAudioHostDevice* inDevice, int64_t inSampleTime);
+
+#endif	//	__SyncAudioHost_h__
@@ -0,0 +1,629 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+Tests of the engine driven through whole IO cycles by the stand-in for coreaudiod.
+*/
+
+/*==================================================================================================
+	SyncAudioHostTests.c
+==================================================================================================*/
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	Local Includes
+#include "SyncAudioHost.h"
+#include "SyncAudioTest.h"
+
+//	System Includes
+#include <math.h>
+#include <string.h>
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Loopback
+//==================================================================================================
+
+//	The loopback client writes a sample to every frame that says which sample time and channel it
+//	was written for, and checks that the input brings each one back exactly at its sample time plus
+//	the latency the device reported before the read. A frame of silence is fine in a read the
+//	engine said came up short, and in the first cycles after IO starts, which read what was never
+//	written, but anything else is a frame that went missing.
+
+#define	kSyncAudioHostTests_ChannelCount	2
+#define	kSyncAudioHostTests_StartCycles		2
+
+typedef struct SyncAudioHostTests_LoopbackState
+{
+	uint32_t	mLatency;
+	uint64_t	mExactFrames;
+	uint64_t	mWrongFrames;
+	uint64_t	mMissingFrames;
+	uint64_t	mShortFrames;
+} SyncAudioHostTests_LoopbackState;
+
+static float	SyncAudioHostTests_Sample(int64_t inSampleTime, uint32_t inChannel)
+{
+	//	exact in a float and never zero
+	return (float)((((uint64_t)inSampleTime * 2 + inChannel) % 65536) + 1) / 65536.0f;
+}
+
+static void	SyncAudioHostTests_LoopbackIOProc(void* inContext, SyncAudioHostDevice* ioDevice, const SyncAudioHostCycle* inCycle, const float* inInput, float* outOutput)
+{
+	SyncAudioHostTests_LoopbackState* theLoopback = (SyncAudioHostTests_LoopbackState*)inContext;
+	uint32_t theChannelCount = ioDevice->mEngine.mRing.mChannelCount;
+	for(uint32_t theFrame = 0; theFrame < inCycle->mFrameCount; ++theFrame)
+	{
+		int64_t theSampleTime = inCycle->mInputSampleTime + theFrame - (int64_t)theLoopback->mLatency;
+		const float* theInput = &inInput[theFrame * theChannelCount];
+		uint32_t theExactCount = 0;
+		uint32_t theSilentCount = 0;
+		for(uint32_t theChannel = 0; theChannel < theChannelCount; ++theChannel)
+		{
+			theExactCount += (theInput[theChannel] == SyncAudioHostTests_Sample(theSampleTime, theChannel)) ? 1 : 0;
+			theSilentCount += (theInput[theChannel] == 0.0f) ? 1 : 0;
+		}
+
+		if(theExactCount == theChannelCount)
+		{
+			++theLoopback->mExactFrames;
+		}
+		else if(theSilentCount != theChannelCount)
+		{
+			++theLoopback->mWrongFrames;
+		}
+		else if(inCycle->mReadFlags != kSyncAudioRing_NoError)
+		{
+			++theLoopback->mShortFrames;
+		}
+		else if(inCycle->mCycle >= kSyncAudioHostTests_StartCycles)
+		{
+			++theLoopback->mMissingFrames;
+		}
+
+		for(uint32_t theChannel = 0; theChannel < theChannelCount; ++theChannel)
+		{
+			outOutput[theFrame * theChannelCount + theChannel] = SyncAudioHostTests_Sample(inCycle->mOutputSampleTime + theFrame, theChannel);
+		}
+	}
+
+	//	the latency the next read will use
+	theLoopback->mLatency = SyncAudioEngine_GetInputLatency(&ioDevice->mEngine);
+}
+
+static void	SyncAudioHostTests_AttachLoopback(SyncAudioHostDevice* ioDevice, SyncAudioHostTests_LoopbackState* outLoopback)
+{
+	*outLoopback = (SyncAudioHostTests_LoopbackState){ SyncAudioEngine_GetInputLatency(&ioDevice->mEngine), 0, 0, 0, 0 };
+	ioDevice->mIOProc = SyncAudioHostTests_LoopbackIOProc;
+	ioDevice->mIOProcContext = outLoopback;
+}
+
+static void	SyncAudioHostTests_Loopback(void)
+{
+	//	with no delay and with one of a whole number of frames, at a typical buffer size and offsets
+	static const double kDelays[] = { 0.0, 12.5 };
+	for(uint32_t theIndex = 0; theIndex < (sizeof(kDelays) / sizeof(kDelays[0])); ++theIndex)
+	{
+		SyncAudioHost theHost;
+		SyncAudioHost_Initialize(&theHost, false);
+		SyncAudioHostDevice theDevice;
+		SyncAudioTest_Check(SyncAudioHostDevice_Initialize(&theDevice, &theHost, "loopback", 48000.0, kSyncAudioHostTests_ChannelCount, 512));
+		theDevice.mInputSafetyOffset = 32;
+		theDevice.mOutputSafetyOffset = 16;
+		SyncAudioEngine_SetDelayMilliseconds(&theDevice.mEngine, kDelays[theIndex]);
+		SyncAudioHostTests_LoopbackState theLoopback;
+		SyncAudioHostTests_AttachLoopback(&theDevice, &theLoopback);
+		SyncAudioTest_Check(theLoopback.mLatency == (uint32_t)(kDelays[theIndex] * 48));
+
+		SyncAudioHostDevice_StartIO(&theDevice);
+		SyncAudioHost_Run(&theHost, 2.0);
+		SyncAudioHostDevice_StopIO(&theDevice);
+
+		//	about two seconds of cycles, every one of them exact once the ring had filled, and nothing
+		//	that would have made the HAL re-anchor or the adapter report a new latency
+		SyncAudioTest_Check((theDevice.mCycleCount >= 186) && (theDevice.mCycleCount <= 188));
+		SyncAudioTest_Check(theLoopback.mWrongFrames == 0);
+		SyncAudioTest_Check(theLoopback.mMissingFrames == 0);
+		SyncAudioTest_Check(theLoopback.mExactFrames >= ((theDevice.mCycleCount - kSyncAudioHostTests_StartCycles) * 512) - (uint64_t)(kDelays[theIndex] * 48));
+		SyncAudioTest_Check(theDevice.mReanchorCount == 0);
+		SyncAudioTest_Check(theDevice.mLatencyChangeCount == 0);
+		SyncAudioTest_Check(atomic_load(&theDevice.mEngine.mJitterFrames) == 0);
+		SyncAudioHostDevice_Teardown(&theDevice);
+	}
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Storage
+//==================================================================================================
+
+static void	SyncAudioHostTests_Storage(void)
+{
+	//	the delay outlives the device, as it outlives the plug-in in the host's storage, and each
+	//	device keeps its own
+	SyncAudioHost theHost;
+	SyncAudioHost_Initialize(&theHost, false);
+	SyncAudioHostDevice theDevice;
+	SyncAudioTest_Check(SyncAudioHostDevice_Initialize(&theDevice, &theHost, "first", 48000.0, kSyncAudioHostTests_ChannelCount, 512));
+	SyncAudioTest_Check(SyncAudioEngine_GetDelayMilliseconds(&theDevice.mEngine) == 0.0);
+	SyncAudioTest_Check(SyncAudioEngine_SetDelayMilliseconds(&theDevice.mEngine, 20.0));
+	SyncAudioTest_Check(!SyncAudioEngine_SetDelayMilliseconds(&theDevice.mEngine, 20.0));
+	SyncAudioHostDevice_Teardown(&theDevice);
+
+	SyncAudioTest_Check(SyncAudioHostDevice_Initialize(&theDevice, &theHost, "first", 48000.0, kSyncAudioHostTests_ChannelCount, 512));
+	SyncAudioTest_Check(SyncAudioEngine_GetDelayMilliseconds(&theDevice.mEngine) == 20.0);
+	SyncAudioTest_Check(SyncAudioEngine_GetInputLatency(&theDevice.mEngine) == 960);
+	SyncAudioHostDevice theOtherDevice;
+	SyncAudioTest_Check(SyncAudioHostDevice_Initialize(&theOtherDevice, &theHost, "second", 48000.0, kSyncAudioHostTests_ChannelCount, 512));
+	SyncAudioTest_Check(SyncAudioEngine_GetDelayMilliseconds(&theOtherDevice.mEngine) == 0.0);
+	SyncAudioTest_Check(theHost.mStorageItemCount == 1);
+	SyncAudioHostDevice_Teardown(&theOtherDevice);
+	SyncAudioHostDevice_Teardown(&theDevice);
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Stalls and Late Writers
+//==================================================================================================
+
+typedef struct SyncAudioHostTests_StallState
+{
+	uint64_t	mCycle;
+	uint64_t	mLateness;
+} SyncAudioHostTests_StallState;
+
+static uint64_t	SyncAudioHostTests_StallLatenessProc(void* inContext, const SyncAudioHostDevice* inDevice, uint64_t inCycle)
+{
+	(void)inDevice;
+	const SyncAudioHostTests_StallState* theStall = (const SyncAudioHostTests_StallState*)inContext;
+	return (inCycle == theStall->mCycle) ? theStall->mLateness : 0;
+}
+
+static void	SyncAudioHostTests_Stall(void)
+{
+	//	An IO thread that doesn't run for longer than a zero time stamp period leaves the clock to
+	//	jump to where the time line is, which makes the HAL re-anchor. The frames that were never
+	//	written in between come back as silence, and the loopback carries on exactly from there.
+	//	None of that is a late writer, so the latency stays where it was.
+	SyncAudioHost theHost;
+	SyncAudioHost_Initialize(&theHost, false);
+	SyncAudioHostDevice theDevice;
+	SyncAudioTest_Check(SyncAudioHostDevice_Initialize(&theDevice, &theHost, "stall", 48000.0, kSyncAudioHostTests_ChannelCount, 512));
+	theDevice.mInputSafetyOffset = 32;
+	theDevice.mOutputSafetyOffset = 16;
+	SyncAudioHostTests_StallState theStall = { 100, SyncAudioHost_SecondsToHostTicks(&theHost, 0.25) };
+	theDevice.mLatenessProc = SyncAudioHostTests_StallLatenessProc;
+	theDevice.mLatenessProcContext = &theStall;
+	SyncAudioHostTests_LoopbackState theLoopback;
+	SyncAudioHostTests_AttachLoopback(&theDevice, &theLoopback);
+
+	SyncAudioHostDevice_StartIO(&theDevice);
+	SyncAudioHost_Run(&theHost, 4.0);
+	SyncAudioTest_Check(theDevice.mReanchorCount == 1);
+	SyncAudioTest_Check(theLoopback.mWrongFrames == 0);
+	SyncAudioTest_Check(theLoopback.mMissingFrames == 0);
+	SyncAudioTest_Check(theDevice.mShortReadCount <= (kSyncAudioHostTests_StartCycles + 2));
+	SyncAudioTest_Check(theDevice.mLatencyChangeCount == 0);
+	SyncAudioTest_Check(atomic_load(&theDevice.mEngine.mJitterFrames) == 0);
+	SyncAudioHostDevice_Teardown(&theDevice);
+}
+
+static void	SyncAudioHostTests_LateWriter(void)
+{
+	//	A device whose input safety offset is too small for its output reads frames that the next
+	//	cycle goes on to write, which is a writer that is late by the difference. The margin grows by
+	//	that much, once, the adapter reports the new latency and the loopback is exact again.
+	SyncAudioHost theHost;
+	SyncAudioHost_Initialize(&theHost, false);
+	SyncAudioHostDevice theDevice;
+	SyncAudioTest_Check(SyncAudioHostDevice_Initialize(&theDevice, &theHost, "late", 48000.0, kSyncAudioHostTests_ChannelCount, 512));
+	theDevice.mInputSafetyOffset = -100;
+	SyncAudioHostTests_LoopbackState theLoopback;
+	SyncAudioHostTests_AttachLoopback(&theDevice, &theLoopback);
+
+	SyncAudioHostDevice_StartIO(&theDevice);
+	SyncAudioHost_Run(&theHost, 2.0);
+	SyncAudioTest_Check(atomic_load(&theDevice.mEngine.mJitterFrames) == 100);
+	SyncAudioTest_Check(theDevice.mLatencyChangeCount == 1);
+	SyncAudioTest_Check(theLoopback.mWrongFrames == 0);
+	SyncAudioTest_Check(theLoopback.mMissingFrames == 0);
+	SyncAudioTest_Check(theDevice.mShortReadCount <= (kSyncAudioHostTests_StartCycles + 1));
+
+	//	the margin is kept when IO restarts, so the next start is exact from the first write
+	SyncAudioHostDevice_StopIO(&theDevice);
+	uint64_t theShortReadCount = theDevice.mShortReadCount;
+	SyncAudioHostDevice_StartIO(&theDevice);
+	SyncAudioHost_Run(&theHost, 1.0);
+	SyncAudioTest_Check(theDevice.mLatencyChangeCount == 1);
+	SyncAudioTest_Check(theDevice.mShortReadCount <= (theShortReadCount + kSyncAudioHostTests_StartCycles));
+	SyncAudioTest_Check(theLoopback.mWrongFrames == 0);
+	SyncAudioHostDevice_Teardown(&theDevice);
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Configuration Changes
+//==================================================================================================
+
+static void	SyncAudioHostTests_SampleRate(void)
+{
+	//	the HAL stops IO around a change of sample rate, after which the ring covers the same time
+	//	at the new rate and the loopback is exact again
+	SyncAudioHost theHost;
+	SyncAudioHost_Initialize(&theHost, false);
+	SyncAudioHostDevice theDevice;
+	SyncAudioTest_Check(SyncAudioHostDevice_Initialize(&theDevice, &theHost, "rate", 48000.0, kSyncAudioHostTests_ChannelCount, 512));
+	theDevice.mInputSafetyOffset = 32;
+	theDevice.mOutputSafetyOffset = 16;
+	SyncAudioEngine_SetDelayMilliseconds(&theDevice.mEngine, 10.0);
+	SyncAudioHostTests_LoopbackState theLoopback;
+	SyncAudioHostTests_AttachLoopback(&theDevice, &theLoopback);
+
+	SyncAudioHostDevice_StartIO(&theDevice);
+	SyncAudioHost_Run(&theHost, 1.0);
+	uint32_t theFrameCapacity = theDevice.mEngine.mRing.mFrameCapacity;
+	uint64_t theCycleCount = theDevice.mCycleCount;
+
+	SyncAudioHostDevice_SetSampleRate(&theDevice, 96000.0);
+	theLoopback.mLatency = SyncAudioEngine_GetInputLatency(&theDevice.mEngine);
+	SyncAudioTest_Check(theLoopback.mLatency == 960);
+	SyncAudioTest_Check(theDevice.mEngine.mRing.mFrameCapacity == (2 * theFrameCapacity));
+	SyncAudioHost_Run(&theHost, 1.0);
+
+	//	twice as many cycles in the second second
+	SyncAudioTest_Check(((theDevice.mCycleCount - theCycleCount) >= ((2 * theCycleCount) - 2)) && ((theDevice.mCycleCount - theCycleCount) <= ((2 * theCycleCount) + 2)));
+	SyncAudioTest_Check(theLoopback.mWrongFrames == 0);
+	SyncAudioTest_Check(theLoopback.mMissingFrames == 0);
+	SyncAudioTest_Check(theDevice.mReanchorCount == 0);
+	SyncAudioTest_Check(theDevice.mLatencyChangeCount == 0);
+	SyncAudioHostDevice_Teardown(&theDevice);
+}
+
+static void	SyncAudioHostTests_RingStorage(void)
+{
+	//	an engine that never goes above 48000 only allocates what its rings use at 48000, and they
+	//	still cover the same time at every rate up to it
+	SyncAudioEngine theEngine;
+	SyncAudioTest_Check(SyncAudioEngine_Initialize(&theEngine, NULL, NULL, 44100.0, 48000.0, kSyncAudioHostTests_ChannelCount, 1 << 18, 512, 0));
+	SyncAudioTest_Check(theEngine.mRing.mMaxFrameCapacity == (1 << 16));
+	SyncAudioTest_Check(theEngine.mRing.mFrameCapacity == (1 << 16));
+	SyncAudioTest_Check(SyncAudioEngine_PrepareBus(&theEngine, 1));
+	SyncAudioTest_Check(theEngine.mBusRings[0].mMaxFrameCapacity == (1 << 16));
+	SyncAudioTest_Check(theEngine.mBusRings[0].mBufferByteSize == theEngine.mRing.mBufferByteSize);
+	SyncAudioTest_Check(SyncAudioEngine_GetRingByteSize(&theEngine) == (2 * theEngine.mRing.mBufferByteSize));
+	SyncAudioEngine_SetSampleRate(&theEngine, 48000.0);
+	SyncAudioTest_Check(theEngine.mRing.mFrameCapacity == (1 << 16));
+	SyncAudioEngine_SetSampleRate(&theEngine, 22050.0);
+	SyncAudioTest_Check(theEngine.mRing.mFrameCapacity == (1 << 15));
+	SyncAudioTest_Check(theEngine.mBusRings[0].mFrameCapacity == (1 << 15));
+	SyncAudioEngine_Teardown(&theEngine);
+}
+
+static bool	SyncAudioHostTests_IsQuantized(const float* inData, uint32_t inSampleCount, float inScale)
+{
+	bool theAnswer = true;
+	for(uint32_t theIndex = 0; theIndex < inSampleCount; ++theIndex)
+	{
+		theAnswer = theAnswer && ((inData[theIndex] * inScale) == rintf(inData[theIndex] * inScale));
+	}
+	return theAnswer;
+}
+
+static void	SyncAudioHostTests_Resolution(void)
+{
+	//	a 16 bit format quantizes what the input and a bus read, whether or not the delay is a whole
+	//	number of frames, and a muted read comes out exactly silent rather than dithered
+	enum { kFrameCount = 256, kSampleCount = kFrameCount * kSyncAudioHostTests_ChannelCount };
+	static float sData[kSampleCount];
+	static float sMix[kSampleCount];
+	static float sResult[kSampleCount];
+	for(uint32_t theIndex = 0; theIndex < kSampleCount; ++theIndex)
+	{
+		sData[theIndex] = 0.3f * sinf((float)theIndex * 0.01f) + 1.0e-6f;
+	}
+	SyncAudioEngine theEngine;
+	SyncAudioTest_Check(SyncAudioEngine_Initialize(&theEngine, NULL, NULL, 48000.0, 48000.0, kSyncAudioHostTests_ChannelCount, 1 << 18, 512, 0));
+	SyncAudioTest_Check(SyncAudioEngine_PrepareBus(&theEngine, 1));
+	SyncAudioEngine_SetPhysicalFormat(&theEngine, 16);
+	float theBusGain = 0.0f;
+	for(uint32_t theCycle = 0; theCycle < 8; ++theCycle)
+	{
+		int64_t theSampleTime = (int64_t)theCycle * kFrameCount;
+		memcpy(sMix, sData, sizeof(sMix));
+		SyncAudioEngine_ConvertOutput(&theEngine, sMix, kFrameCount);
+		SyncAudioEngine_WriteMix(&theEngine, theSampleTime, sMix, kFrameCount, theCycle);
+		SyncAudioEngine_WriteBus(&theEngine, 1, theSampleTime, sData, kFrameCount, theCycle);
+		if(theCycle == 4)
+		{
+			SyncAudioEngine_SetDelayMilliseconds(&theEngine, 0.01);
+		}
+		if(theCycle >= 2)
+		{
+			SyncAudioEngine_ReadInput(&theEngine, theSampleTime, 0.5f, sResult, kFrameCount);
+			SyncAudioEngine_ConvertInput(&theEngine, sResult, kFrameCount);
+			SyncAudioTest_Check(SyncAudioHostTests_IsQuantized(sResult, kSampleCount, 32768.0f));
+			SyncAudioEngine_ReadBus(&theEngine, 1, theSampleTime, 0.5f, &theBusGain, sResult, kFrameCount);
+			SyncAudioTest_Check(SyncAudioHostTests_IsQuantized(sResult, kSampleCount, 32768.0f));
+		}
+	}
+	for(uint32_t theCycle = 8; theCycle < 10; ++theCycle)
+	{
+		int64_t theSampleTime = (int64_t)theCycle * kFrameCount;
+		memcpy(sMix, sData, sizeof(sMix));
+		SyncAudioEngine_ConvertOutput(&theEngine, sMix, kFrameCount);
+		SyncAudioEngine_WriteMix(&theEngine, theSampleTime, sMix, kFrameCount, theCycle);
+		SyncAudioEngine_ReadInput(&theEngine, theSampleTime, 0.0f, sResult, kFrameCount);
+		SyncAudioEngine_ConvertInput(&theEngine, sResult, kFrameCount);
+	}
+	bool isSilent = true;
+	for(uint32_t theIndex = 0; theIndex < kSampleCount; ++theIndex)
+	{
+		isSilent = isSilent && (sResult[theIndex] == 0.0f);
+	}
+	SyncAudioTest_Check(isSilent);
+	SyncAudioEngine_Teardown(&theEngine);
+}
+
+//	A device whose physical format is 16 or 24 bit integers loops a sine back through the ring.
+//	ReadInput has to leave the input packed, native endian and two or three bytes a sample, which
+//	is what is checked: every sample taken from those bytes must be the one the client then gets
+//	from ConvertInput, and within a few steps of the sine the client wrote, since it was quantized
+//	with dither on the way out and on the way back in.
+
+#define	kSyncAudioHostTests_FormatSteps		3
+
+typedef struct SyncAudioHostTests_FormatState
+{
+	uint32_t	mLatency;
+	uint64_t	mCloseFrames;
+	uint64_t	mFarFrames;
+	uint64_t	mMismatchedSamples;
+} SyncAudioHostTests_FormatState;
+
+static float	SyncAudioHostTests_FormatSample(int64_t inSampleTime, uint32_t inChannel)
+{
+	return (float)(0.5 * sin((0.01 * (double)inSampleTime) + inChannel));
+}
+
+static int32_t	SyncAudioHostTests_GetPackedSample(const uint8_t* inData, uint32_t inIndex, uint32_t inBits)
+{
+	//	the integer at inIndex in a packed buffer of native endian inBits bit samples
+	int32_t theAnswer;
+	if(inBits == 16)
+	{
+		int16_t theShort;
+		memcpy(&theShort, inData + (2 * inIndex), sizeof(theShort));
+		theAnswer = theShort;
+	}
+	else
+	{
+		const uint8_t* theBytes = inData + (3 * inIndex);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+		uint32_t theWord = ((uint32_t)theBytes[0] << 16) | ((uint32_t)theBytes[1] << 8) | theBytes[2];
+#else
+		uint32_t theWord = ((uint32_t)theBytes[2] << 16) | ((uint32_t)theBytes[1] << 8) | theBytes[0];
+#endif
+		theAnswer = ((theWord & 0x800000) != 0) ? (int32_t)theWord - 0x1000000 : (int32_t)theWord;
+	}
+	return theAnswer;
+}
+
+static void	SyncAudioHostTests_FormatIOProc(void* inContext, SyncAudioHostDevice* ioDevice, const SyncAudioHostCycle* inCycle, const float* inInput, float* outOutput)
+{
+	SyncAudioHostTests_FormatState* theFormat = (SyncAudioHostTests_FormatState*)inContext;
+	uint32_t theChannelCount = ioDevice->mEngine.mRing.mChannelCount;
+	uint32_t theBits = ioDevice->mEngine.mSampleBits;
+	double theScale = (double)(1U << (theBits - 1));
+	for(uint32_t theFrame = 0; theFrame < inCycle->mFrameCount; ++theFrame)
+	{
+		int64_t theSampleTime = inCycle->mInputSampleTime + theFrame - (int64_t)theFormat->mLatency;
+		uint32_t theSilentCount = 0;
+		uint32_t theCloseCount = 0;
+		for(uint32_t theChannel = 0; theChannel < theChannelCount; ++theChannel)
+		{
+			uint32_t theIndex = (theFrame * theChannelCount) + theChannel;
+			int32_t theInteger = SyncAudioHostTests_GetPackedSample(ioDevice->mPhysicalInput, theIndex, theBits);
+			theFormat->mMismatchedSamples += ((double)inInput[theIndex] == ((double)theInteger / theScale)) ? 0 : 1;
+			theSilentCount += (theInteger == 0) ? 1 : 0;
+			theCloseCount += (fabs((double)theInteger - (SyncAudioHostTests_FormatSample(theSampleTime, theChannel) * theScale)) <= kSyncAudioHostTests_FormatSteps) ? 1 : 0;
+		}
+		if(theCloseCount == theChannelCount)
+		{
+			++theFormat->mCloseFrames;
+		}
+		else if((theSilentCount != theChannelCount) || (inCycle->mCycle >= kSyncAudioHostTests_StartCycles))
+		{
+			++theFormat->mFarFrames;
+		}
+
+		for(uint32_t theChannel = 0; theChannel < theChannelCount; ++theChannel)
+		{
+			outOutput[theFrame * theChannelCount + theChannel] = SyncAudioHostTests_FormatSample(inCycle->mOutputSampleTime + theFrame, theChannel);
+		}
+	}
+	theFormat->mLatency = SyncAudioEngine_GetInputLatency(&ioDevice->mEngine);
+}
+
+static void	SyncAudioHostTests_PhysicalFormat(void)
+{
+	static const uint32_t kBits[] = { 16, 24 };
+	for(uint32_t theIndex = 0; theIndex < (sizeof(kBits) / sizeof(kBits[0])); ++theIndex)
+	{
+		SyncAudioHost theHost;
+		SyncAudioHost_Initialize(&theHost, false);
+		SyncAudioHostDevice theDevice;
+		SyncAudioTest_Check(SyncAudioHostDevice_Initialize(&theDevice, &theHost, "format", 48000.0, kSyncAudioHostTests_ChannelCount, 512));
+		theDevice.mInputSafetyOffset = 32;
+		theDevice.mOutputSafetyOffset = 16;
+		SyncAudioEngine_SetDelayMilliseconds(&theDevice.mEngine, 5.0);
+		SyncAudioHostDevice_SetPhysicalFormat(&theDevice, kBits[theIndex]);
+		SyncAudioTest_Check(SyncAudioEngine_GetPhysicalBytesPerSample(&theDevice.mEngine) == (kBits[theIndex] / 8));
+		SyncAudioHostTests_FormatState theFormat = { SyncAudioEngine_GetInputLatency(&theDevice.mEngine), 0, 0, 0 };
+		theDevice.mIOProc = SyncAudioHostTests_FormatIOProc;
+		theDevice.mIOProcContext = &theFormat;
+
+		SyncAudioHostDevice_StartIO(&theDevice);
+		SyncAudioHost_Run(&theHost, 1.0);
+		SyncAudioHostDevice_StopIO(&theDevice);
+
+		fprintf(stderr, "     %u bits: %llu frames close, %llu far\n", kBits[theIndex], (unsigned long long)theFormat.mCloseFrames, (unsigned long long)theFormat.mFarFrames);
+		SyncAudioTest_Check(theFormat.mMismatchedSamples == 0);
+		SyncAudioTest_Check(theFormat.mFarFrames == 0);
+		SyncAudioTest_Check(theFormat.mCloseFrames >= ((theDevice.mCycleCount - kSyncAudioHostTests_StartCycles) * 512) - 240);
+		SyncAudioHostDevice_Teardown(&theDevice);
+	}
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Sources
+//==================================================================================================
+
+//	One device plays a tone that another device at a different sample rate takes as its input, with
+//	the source's IO thread waking up late now and then. Reading from a source has no margin for a
+//	late writer, so the listener is given a delay that covers the source's lateness, as a source
+//	has to be set up. After the drift tracker has settled, every read finds its frames and the tone
+//	comes out at the pitch it went in at.
+
+#define	kSyncAudioHostTests_ToneFrequency	1000.0
+
+typedef struct SyncAudioHostTests_ToneState
+{
+	double		mSettleSeconds;
+	uint64_t	mCrossingCount;
+	uint64_t	mShortReadCount;
+	uint64_t	mFrameCount;
+	float		mLastSample;
+} SyncAudioHostTests_ToneState;
+
+static void	SyncAudioHostTests_ToneIOProc(void* inContext, SyncAudioHostDevice* ioDevice, const SyncAudioHostCycle* inCycle, const float* inInput, float* outOutput)
+{
+	(void)inContext;
+	(void)inInput;
+	uint32_t theChannelCount = ioDevice->mEngine.mRing.mChannelCount;
+	for(uint32_t theFrame = 0; theFrame < inCycle->mFrameCount; ++theFrame)
+	{
+		double thePhase = 2.0 * M_PI * kSyncAudioHostTests_ToneFrequency * (double)(inCycle->mOutputSampleTime + theFrame) / ioDevice->mEngine.mSampleRate;
+		for(uint32_t theChannel = 0; theChannel < theChannelCount; ++theChannel)
+		{
+			outOutput[theFrame * theChannelCount + theChannel] = 0.5f * (float)sin(thePhase);
+		}
+	}
+}
+
+static void	SyncAudioHostTests_ListenIOProc(void* inContext, SyncAudioHostDevice* ioDevice, const SyncAudioHostCycle* inCycle, const float* inInput, float* outOutput)
+{
+	(void)outOutput;
+	SyncAudioHostTests_ToneState* theTone = (SyncAudioHostTests_ToneState*)inContext;
+	if(((double)inCycle->mInputSampleTime / ioDevice->mEngine.mSampleRate) >= theTone->mSettleSeconds)
+	{
+		theTone->mShortReadCount += (inCycle->mReadFlags != kSyncAudioRing_NoError) ? 1 : 0;
+		uint32_t theChannelCount = ioDevice->mEngine.mRing.mChannelCount;
+		for(uint32_t theFrame = 0; theFrame < inCycle->mFrameCount; ++theFrame)
+		{
+			float theSample = inInput[theFrame * theChannelCount];
+			theTone->mCrossingCount += ((theSample >= 0.0f) != (theTone->mLastSample >= 0.0f)) ? 1 : 0;
+			theTone->mLastSample = theSample;
+		}
+		theTone->mFrameCount += inCycle->mFrameCount;
+	}
+}
+
+static uint64_t	SyncAudioHostTests_JitterLatenessProc(void* inContext, const SyncAudioHostDevice* inDevice, uint64_t inCycle)
+{
+	(void)inDevice;
+	//	a few milliseconds late every so often, by the same amount each time the cycle comes around
+	const SyncAudioHost* theHost = (const SyncAudioHost*)inContext;
+	uint32_t theState = (uint32_t)inCycle * 2654435761U + 1;
+	uint32_t theRandom = SyncAudioTest_Random(&theState);
+	return ((theRandom % 16) == 0) ? SyncAudioHost_SecondsToHostTicks(theHost, (double)(theRandom % 5000) / 1000000.0) : 0;
+}
+
+static void	SyncAudioHostTests_Source(void)
+{
+	SyncAudioHost theHost;
+	SyncAudioHost_Initialize(&theHost, false);
+	SyncAudioHostDevice theSource;
+	SyncAudioHostDevice theDevice;
+	SyncAudioTest_Check(SyncAudioHostDevice_Initialize(&theSource, &theHost, "source", 44100.0, kSyncAudioHostTests_ChannelCount, 441));
+	SyncAudioTest_Check(SyncAudioHostDevice_Initialize(&theDevice, &theHost, "listener", 48000.0, kSyncAudioHostTests_ChannelCount, 256));
+	theSource.mOutputSafetyOffset = 24;
+	theSource.mIOProc = SyncAudioHostTests_ToneIOProc;
+	theSource.mLatenessProc = SyncAudioHostTests_JitterLatenessProc;
+	theSource.mLatenessProcContext = &theHost;
+	SyncAudioHostTests_ToneState theTone = { 5.0, 0, 0, 0, 0.0f };
+	theDevice.mIOProc = SyncAudioHostTests_ListenIOProc;
+	theDevice.mIOProcContext = &theTone;
+	SyncAudioTest_Check(SyncAudioEngine_SetSource(&theDevice.mEngine, &theSource.mEngine, kSyncAudioResampler_QualityMedium));
+	SyncAudioEngine_SetDelayMilliseconds(&theDevice.mEngine, 20.0);
+
+	//	the source starts a little after the listener, as two devices started by different clients do
+	SyncAudioHostDevice_StartIO(&theDevice);
+	SyncAudioHost_Run(&theHost, 0.0371);
+	SyncAudioHostDevice_StartIO(&theSource);
+	SyncAudioHost_Run(&theHost, 10.0);
+
+	//	two crossings a cycle of the tone, give or take the ends
+	double theSeconds = (double)theTone.mFrameCount / 48000.0;
+	double theCrossings = 2.0 * kSyncAudioHostTests_ToneFrequency * theSeconds;
+	SyncAudioTest_Check(theTone.mFrameCount > 0);
+	SyncAudioTest_Check(fabs((double)theTone.mCrossingCount - theCrossings) <= 2.0);
+	SyncAudioTest_Check(theTone.mShortReadCount == 0);
+	SyncAudioTest_Check(atomic_load(&theDevice.mEngine.mDrift.mResyncCount) == 0);
+	SyncAudioTest_Check(theDevice.mReanchorCount == 0);
+	SyncAudioTest_Check(theSource.mReanchorCount == 0);
+
+	SyncAudioHostDevice_Teardown(&theDevice);
+	SyncAudioHostDevice_Teardown(&theSource);
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Real Time
+//==================================================================================================
+
+static void	SyncAudioHostTests_RealTime(void)
+{
+	//	The same loopback on the platform's clock, on a thread that sleeps until each cycle is due.
+	//	How late that thread wakes up is up to the system, so this only checks that what came back
+	//	was exact and that most of the cycles ran, since a stall can make the device skip some.
+	SyncAudioHost theHost;
+	SyncAudioHost_Initialize(&theHost, true);
+	SyncAudioHostDevice theDevice;
+	SyncAudioTest_Check(SyncAudioHostDevice_Initialize(&theDevice, &theHost, "real time", 48000.0, kSyncAudioHostTests_ChannelCount, 256));
+	theDevice.mInputSafetyOffset = 32;
+	theDevice.mOutputSafetyOffset = 16;
+	SyncAudioHostTests_LoopbackState theLoopback;
+	SyncAudioHostTests_AttachLoopback(&theDevice, &theLoopback);
+
+	SyncAudioHostDevice_StartIO(&theDevice);
+	SyncAudioTest_Check(SyncAudioHost_Run(&theHost, 0.5));
+	SyncAudioHostDevice_StopIO(&theDevice);
+	fprintf(stderr, "     %llu cycles, %s real-time priority\n", (unsigned long long)theDevice.mCycleCount, theHost.mIsRealTimePriority ? "with" : "without");
+	SyncAudioTest_Check(theDevice.mCycleCount >= 45);
+	SyncAudioTest_Check(theLoopback.mWrongFrames == 0);
+	SyncAudioTest_Check(theLoopback.mExactFrames > 0);
+	SyncAudioHostDevice_Teardown(&theDevice);
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Main
+//==================================================================================================
+
+int	main(void)
+{
+	SyncAudioTest_Run(SyncAudioHostTests_Loopback);
+	SyncAudioTest_Run(SyncAudioHostTests_Storage);
+	SyncAudioTest_Run(SyncAudioHostTests_Stall);
+	SyncAudioTest_Run(SyncAudioHostTests_LateWriter);
+	SyncAudioTest_Run(SyncAudioHostTests_SampleRate);
+	SyncAudioTest_Run(SyncAudioHostTests_RingStorage);
+	SyncAudioTest_Run(SyncAudioHostTests_Resolution);
+	SyncAudioTest_Run(SyncAudioHostTests_PhysicalFormat);
+	SyncAudioTest_Run(SyncAudioHostTests_Source);
+	SyncAudioTest_Run(SyncAudioHostTests_RealTime);
+	return SyncAudioTest_Result();
+}
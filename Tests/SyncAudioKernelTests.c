@@ -0,0 +1,286 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+The tests of the sample processing kernels.
+*/
+
+/*==================================================================================================
+	SyncAudioKernelTests.c
+==================================================================================================*/
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	Local Includes
+#include "SyncAudioKernels.h"
+#include "SyncAudioTest.h"
+
+//	System Includes
+#include <math.h>
+#include <string.h>
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Helpers
+//==================================================================================================
+
+//	Every vector kernel has to agree with the scalar one, which is the reference, for every count
+//	of samples up to a few vectors past the widest one so that every way a buffer can end is
+//	covered. The kernels that only add agree exactly. The ones that multiply may differ in the last
+//	bit or so where the vector ones fuse a multiply and an add.
+
+#define	kSyncAudioKernelTests_MaxSampleCount	96
+#define	kSyncAudioKernelTests_Tolerance			1.0e-6f
+
+static const SyncAudioKernels*	gSyncAudioKernelTests_Kernels[4];
+static uint32_t					gSyncAudioKernelTests_KernelCount = 0;
+
+static void	SyncAudioKernelTests_Fill(float* outData, uint32_t inSampleCount, uint32_t inSeed)
+{
+	uint32_t theRandom = inSeed | 1;
+	for(uint32_t theIndex = 0; theIndex < inSampleCount; ++theIndex)
+	{
+		outData[theIndex] = ((float)(SyncAudioTest_Random(&theRandom) >> 8) / 8388608.0f) - 1.0f;
+	}
+}
+
+static bool	SyncAudioKernelTests_AreClose(const float* inA, const float* inB, uint32_t inSampleCount, float inTolerance)
+{
+	bool theAnswer = true;
+	for(uint32_t theIndex = 0; theIndex < inSampleCount; ++theIndex)
+	{
+		theAnswer = theAnswer && (fabsf(inA[theIndex] - inB[theIndex]) <= inTolerance);
+	}
+	return theAnswer;
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Tests
+//==================================================================================================
+
+static void	SyncAudioKernelTests_CopyScaled(void)
+{
+	float theSource[kSyncAudioKernelTests_MaxSampleCount];
+	float theReference[kSyncAudioKernelTests_MaxSampleCount];
+	float theResult[kSyncAudioKernelTests_MaxSampleCount];
+	static const float kGains[][2] = { { 1.0f, 0.0f }, { 0.5f, 0.0f }, { 0.0f, 0.0f }, { 1.0f, -1.0f / 96.0f }, { 0.25f, 0.5f / 96.0f } };
+	SyncAudioKernelTests_Fill(theSource, kSyncAudioKernelTests_MaxSampleCount, 1);
+	for(uint32_t theKernels = 1; theKernels < gSyncAudioKernelTests_KernelCount; ++theKernels)
+	{
+		for(uint32_t theGain = 0; theGain < (sizeof(kGains) / sizeof(kGains[0])); ++theGain)
+		{
+			for(uint32_t theCount = 0; theCount <= kSyncAudioKernelTests_MaxSampleCount; ++theCount)
+			{
+				memset(theReference, 0, sizeof(theReference));
+				memset(theResult, 0, sizeof(theResult));
+				gSyncAudioKernelTests_Kernels[0]->mCopyScaled(theSource, theReference, theCount, kGains[theGain][0], kGains[theGain][1]);
+				gSyncAudioKernelTests_Kernels[theKernels]->mCopyScaled(theSource, theResult, theCount, kGains[theGain][0], kGains[theGain][1]);
+				SyncAudioTest_Check(SyncAudioKernelTests_AreClose(theReference, theResult, kSyncAudioKernelTests_MaxSampleCount, kSyncAudioKernelTests_Tolerance));
+			}
+		}
+
+		//	in place is allowed too
+		memcpy(theResult, theSource, sizeof(theSource));
+		gSyncAudioKernelTests_Kernels[theKernels]->mCopyScaled(theResult, theResult, kSyncAudioKernelTests_MaxSampleCount, 0.5f, 0.0f);
+		gSyncAudioKernelTests_Kernels[0]->mCopyScaled(theSource, theReference, kSyncAudioKernelTests_MaxSampleCount, 0.5f, 0.0f);
+		SyncAudioTest_Check(SyncAudioKernelTests_AreClose(theReference, theResult, kSyncAudioKernelTests_MaxSampleCount, 0.0f));
+	}
+
+	//	a mute is exact silence
+	gSyncAudioKernelTests_Kernels[gSyncAudioKernelTests_KernelCount - 1]->mCopyScaled(theSource, theResult, kSyncAudioKernelTests_MaxSampleCount, 0.0f, 0.0f);
+	memset(theReference, 0, sizeof(theReference));
+	SyncAudioTest_Check(SyncAudioKernelTests_AreClose(theReference, theResult, kSyncAudioKernelTests_MaxSampleCount, 0.0f));
+}
+
+static void	SyncAudioKernelTests_InterpolateScaled(void)
+{
+	float theSource[kSyncAudioKernelTests_MaxSampleCount];
+	float thePrevious[8];
+	float theReference[kSyncAudioKernelTests_MaxSampleCount];
+	float theResult[kSyncAudioKernelTests_MaxSampleCount];
+	SyncAudioKernelTests_Fill(theSource, kSyncAudioKernelTests_MaxSampleCount, 2);
+	SyncAudioKernelTests_Fill(thePrevious, 8, 3);
+	for(uint32_t theKernels = 1; theKernels < gSyncAudioKernelTests_KernelCount; ++theKernels)
+	{
+		for(uint32_t theChannelCount = 1; theChannelCount <= 8; ++theChannelCount)
+		{
+			for(uint32_t theFrameCount = 0; (theFrameCount * theChannelCount) <= kSyncAudioKernelTests_MaxSampleCount; ++theFrameCount)
+			{
+				uint32_t theCount = theFrameCount * theChannelCount;
+				memcpy(theReference, theSource, sizeof(theSource));
+				memcpy(theResult, theSource, sizeof(theSource));
+				gSyncAudioKernelTests_Kernels[0]->mInterpolateScaled(theReference, thePrevious, theChannelCount, theCount, 0.375f, 0.75f, -0.25f / 96.0f);
+				gSyncAudioKernelTests_Kernels[theKernels]->mInterpolateScaled(theResult, thePrevious, theChannelCount, theCount, 0.375f, 0.75f, -0.25f / 96.0f);
+				SyncAudioTest_Check(SyncAudioKernelTests_AreClose(theReference, theResult, kSyncAudioKernelTests_MaxSampleCount, kSyncAudioKernelTests_Tolerance));
+			}
+		}
+	}
+
+	//	the ones built for a channel count do the same as the ones for any
+	static const uint32_t kWidths[kSyncAudioKernels_WidthCount] = kSyncAudioKernels_Widths;
+	for(uint32_t theKernels = 0; theKernels < gSyncAudioKernelTests_KernelCount; ++theKernels)
+	{
+		for(uint32_t theWidth = 0; theWidth < kSyncAudioKernels_WidthCount; ++theWidth)
+		{
+			uint32_t theChannelCount = kWidths[theWidth];
+			SyncAudioKernelsInterpolateScaledFunction theFunction = SyncAudioKernels_GetInterpolateScaled(gSyncAudioKernelTests_Kernels[theKernels], theChannelCount);
+			SyncAudioTest_Check(theFunction == gSyncAudioKernelTests_Kernels[theKernels]->mInterpolateScaledWidths[theWidth]);
+			for(uint32_t theFrameCount = 0; (theFrameCount * theChannelCount) <= kSyncAudioKernelTests_MaxSampleCount; ++theFrameCount)
+			{
+				uint32_t theCount = theFrameCount * theChannelCount;
+				memcpy(theReference, theSource, sizeof(theSource));
+				memcpy(theResult, theSource, sizeof(theSource));
+				gSyncAudioKernelTests_Kernels[0]->mInterpolateScaled(theReference, thePrevious, theChannelCount, theCount, 0.375f, 0.75f, -0.25f / 96.0f);
+				theFunction(theResult, thePrevious, theChannelCount, theCount, 0.375f, 0.75f, -0.25f / 96.0f);
+				SyncAudioTest_Check(SyncAudioKernelTests_AreClose(theReference, theResult, kSyncAudioKernelTests_MaxSampleCount, kSyncAudioKernelTests_Tolerance));
+			}
+		}
+		SyncAudioTest_Check(SyncAudioKernels_GetInterpolateScaled(gSyncAudioKernelTests_Kernels[theKernels], 3) == gSyncAudioKernelTests_Kernels[theKernels]->mInterpolateScaled);
+	}
+
+	//	and the scalar one is what it says it is
+	memcpy(theResult, theSource, sizeof(theSource));
+	gSyncAudioKernelTests_Kernels[0]->mInterpolateScaled(theResult, thePrevious, 2, kSyncAudioKernelTests_MaxSampleCount, 0.25f, 0.5f, 0.0f);
+	SyncAudioTest_Check(fabsf(theResult[0] - (0.5f * ((0.75f * theSource[0]) + (0.25f * thePrevious[0])))) <= kSyncAudioKernelTests_Tolerance);
+	SyncAudioTest_Check(fabsf(theResult[3] - (0.5f * ((0.75f * theSource[3]) + (0.25f * theSource[1])))) <= kSyncAudioKernelTests_Tolerance);
+}
+
+static void	SyncAudioKernelTests_Mix(void)
+{
+	float theSource[kSyncAudioKernelTests_MaxSampleCount];
+	float theReference[kSyncAudioKernelTests_MaxSampleCount];
+	float theResult[kSyncAudioKernelTests_MaxSampleCount];
+	double theReferenceSum[kSyncAudioKernelTests_MaxSampleCount];
+	double theSum[kSyncAudioKernelTests_MaxSampleCount];
+	SyncAudioKernelTests_Fill(theSource, kSyncAudioKernelTests_MaxSampleCount, 4);
+	for(uint32_t theKernels = 1; theKernels < gSyncAudioKernelTests_KernelCount; ++theKernels)
+	{
+		for(uint32_t theCount = 0; theCount <= kSyncAudioKernelTests_MaxSampleCount; ++theCount)
+		{
+			SyncAudioKernelTests_Fill(theReference, kSyncAudioKernelTests_MaxSampleCount, 5);
+			SyncAudioKernelTests_Fill(theResult, kSyncAudioKernelTests_MaxSampleCount, 5);
+			gSyncAudioKernelTests_Kernels[0]->mMix(theSource, theReference, theCount);
+			gSyncAudioKernelTests_Kernels[theKernels]->mMix(theSource, theResult, theCount);
+			SyncAudioTest_Check(SyncAudioKernelTests_AreClose(theReference, theResult, kSyncAudioKernelTests_MaxSampleCount, 0.0f));
+
+			for(uint32_t theIndex = 0; theIndex < kSyncAudioKernelTests_MaxSampleCount; ++theIndex)
+			{
+				theReferenceSum[theIndex] = theSum[theIndex] = 1.0 / 3.0;
+			}
+			gSyncAudioKernelTests_Kernels[0]->mMixWide(theSource, theReferenceSum, theReference, theCount);
+			gSyncAudioKernelTests_Kernels[theKernels]->mMixWide(theSource, theSum, theResult, theCount);
+			SyncAudioTest_Check(SyncAudioKernelTests_AreClose(theReference, theResult, kSyncAudioKernelTests_MaxSampleCount, 0.0f));
+			SyncAudioTest_Check(memcmp(theReferenceSum, theSum, sizeof(theSum)) == 0);
+		}
+	}
+}
+
+//	The generators are laid out differently by each kernel, so their noise can't be compared sample
+//	for sample. What every one of them has to do is land on the grid within a step of the scaled
+//	sample, give or take what the gain ramp may differ by, stay inside the range and, averaged, add
+//	nothing.
+static void	SyncAudioKernelTests_CopyScaledQuantized(void)
+{
+	float theSource[kSyncAudioKernelTests_MaxSampleCount];
+	float theResult[kSyncAudioKernelTests_MaxSampleCount];
+	SyncAudioKernelTests_Fill(theSource, kSyncAudioKernelTests_MaxSampleCount, 6);
+	theSource[0] = 1.0f;
+	theSource[1] = -1.0f;
+	for(uint32_t theKernels = 0; theKernels < gSyncAudioKernelTests_KernelCount; ++theKernels)
+	{
+		static const float kScales[] = { 128.0f, 32768.0f, 8388608.0f };
+		for(uint32_t theScale = 0; theScale < (sizeof(kScales) / sizeof(kScales[0])); ++theScale)
+		{
+			uint32_t theDither[kSyncAudioKernels_DitherLaneCount];
+			for(uint32_t theLane = 0; theLane < kSyncAudioKernels_DitherLaneCount; ++theLane)
+			{
+				theDither[theLane] = 0x9E3779B9 * (theLane + 1);
+			}
+			for(uint32_t theCount = 0; theCount <= kSyncAudioKernelTests_MaxSampleCount; ++theCount)
+			{
+				//	ramp from unity down to half, so the ends of the source stay at full scale
+				float theGainStep = (theCount > 0) ? -0.5f / (float)theCount : 0.0f;
+				memcpy(theResult, theSource, sizeof(theSource));
+				gSyncAudioKernelTests_Kernels[theKernels]->mCopyScaledQuantized(theSource, theResult, theCount, 1.0f, theGainStep, kScales[theScale], theDither);
+				bool isOnGrid = true;
+				for(uint32_t theIndex = 0; theIndex < theCount; ++theIndex)
+				{
+					float theSteps = theResult[theIndex] * kScales[theScale];
+					float theScaled = theSource[theIndex] * (1.0f + (theGainStep * (float)theIndex));
+					isOnGrid = isOnGrid && (theSteps == rintf(theSteps));
+					isOnGrid = isOnGrid && (theSteps >= -kScales[theScale]) && (theSteps <= (kScales[theScale] - 1.0f));
+					isOnGrid = isOnGrid && (fabsf(theSteps - (theScaled * kScales[theScale])) <= (1.5f + (fabsf(theScaled) * kScales[theScale] * kSyncAudioKernelTests_Tolerance)));
+				}
+				SyncAudioTest_Check(isOnGrid);
+				SyncAudioTest_Check(SyncAudioKernelTests_AreClose(theSource + theCount, theResult + theCount, kSyncAudioKernelTests_MaxSampleCount - theCount, 0.0f));
+			}
+			for(uint32_t theLane = 0; theLane < kSyncAudioKernels_DitherLaneCount; ++theLane)
+			{
+				SyncAudioTest_Check(theDither[theLane] != 0);
+			}
+		}
+
+		//	a constant half way between two steps comes out as both equally often
+		uint32_t theDither[kSyncAudioKernels_DitherLaneCount] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+		double theTotal = 0.0;
+		for(uint32_t theBuffer = 0; theBuffer < 1000; ++theBuffer)
+		{
+			for(uint32_t theIndex = 0; theIndex < kSyncAudioKernelTests_MaxSampleCount; ++theIndex)
+			{
+				theResult[theIndex] = 100.5f / 32768.0f;
+			}
+			gSyncAudioKernelTests_Kernels[theKernels]->mCopyScaledQuantized(theResult, theResult, kSyncAudioKernelTests_MaxSampleCount, 1.0f, 0.0f, 32768.0f, theDither);
+			for(uint32_t theIndex = 0; theIndex < kSyncAudioKernelTests_MaxSampleCount; ++theIndex)
+			{
+				theTotal += theResult[theIndex] * 32768.0;
+			}
+		}
+		SyncAudioTest_Check(fabs((theTotal / (1000.0 * kSyncAudioKernelTests_MaxSampleCount)) - 100.5) < 0.02);
+	}
+}
+
+static void	SyncAudioKernelTests_Convolve(void)
+{
+	float theSamples[kSyncAudioKernelTests_MaxSampleCount];
+	float theTaps[kSyncAudioKernelTests_MaxSampleCount];
+	float theNextTaps[kSyncAudioKernelTests_MaxSampleCount];
+	SyncAudioKernelTests_Fill(theSamples, kSyncAudioKernelTests_MaxSampleCount, 7);
+	SyncAudioKernelTests_Fill(theTaps, kSyncAudioKernelTests_MaxSampleCount, 8);
+	SyncAudioKernelTests_Fill(theNextTaps, kSyncAudioKernelTests_MaxSampleCount, 9);
+	for(uint32_t theKernels = 1; theKernels < gSyncAudioKernelTests_KernelCount; ++theKernels)
+	{
+		for(uint32_t theCount = 0; theCount <= kSyncAudioKernelTests_MaxSampleCount; ++theCount)
+		{
+			float theReference = gSyncAudioKernelTests_Kernels[0]->mConvolve(theSamples, theTaps, theNextTaps, 0.625f, theCount);
+			float theResult = gSyncAudioKernelTests_Kernels[theKernels]->mConvolve(theSamples, theTaps, theNextTaps, 0.625f, theCount);
+			SyncAudioTest_Check(fabsf(theReference - theResult) <= (1.0e-5f * (float)theCount));
+		}
+	}
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Main
+//==================================================================================================
+
+int	main(void)
+{
+	gSyncAudioKernelTests_KernelCount = SyncAudioKernels_GetSupported(gSyncAudioKernelTests_Kernels, 4);
+	fprintf(stderr, "     kernels:");
+	for(uint32_t theKernels = 0; theKernels < gSyncAudioKernelTests_KernelCount; ++theKernels)
+	{
+		fprintf(stderr, " %s", gSyncAudioKernelTests_Kernels[theKernels]->mName);
+	}
+	fprintf(stderr, "\n");
+	SyncAudioTest_Check(gSyncAudioKernelTests_Kernels[gSyncAudioKernelTests_KernelCount - 1] == SyncAudioKernels_Select());
+
+	SyncAudioTest_Run(SyncAudioKernelTests_CopyScaled);
+	SyncAudioTest_Run(SyncAudioKernelTests_InterpolateScaled);
+	SyncAudioTest_Run(SyncAudioKernelTests_Mix);
+	SyncAudioTest_Run(SyncAudioKernelTests_CopyScaledQuantized);
+	SyncAudioTest_Run(SyncAudioKernelTests_Convolve);
+	return SyncAudioTest_Result();
+}
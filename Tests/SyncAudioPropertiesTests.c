@@ -0,0 +1,84 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+Tests of the registry the plug-in looks its properties up in.
+*/
+
+/*==================================================================================================
+	SyncAudioPropertiesTests.c
+==================================================================================================*/
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	Local Includes
+#include "SyncAudioProperties.h"
+#include "SyncAudioTest.h"
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Find
+//==================================================================================================
+
+static void	SyncAudioPropertiesTests_Find(void)
+{
+	//	as many entries as fit, with selectors that collide in the hash as well as ones that don't,
+	//	are each found where they are and nothing else is
+	static SyncAudioPropertyInfo sProperties[kSyncAudioPropertyRegistry_MaxCount];
+	uint32_t theState = 0x5A17A0D1;
+	for(uint32_t theIndex = 0; theIndex < kSyncAudioPropertyRegistry_MaxCount; ++theIndex)
+	{
+		sProperties[theIndex].mObjectKind = (theIndex % 7) + 1;
+		sProperties[theIndex].mSelector = ((theIndex & 1) == 0) ? (theIndex << 24) : (SyncAudioTest_Random(&theState) | 1);
+		sProperties[theIndex].mFlags = theIndex;
+	}
+	SyncAudioPropertyRegistry theRegistry;
+	SyncAudioTest_Check(SyncAudioPropertyRegistry_Initialize(&theRegistry, sProperties, kSyncAudioPropertyRegistry_MaxCount));
+	for(uint32_t theIndex = 0; theIndex < kSyncAudioPropertyRegistry_MaxCount; ++theIndex)
+	{
+		const SyncAudioPropertyInfo* theInfo = SyncAudioPropertyRegistry_Find(&theRegistry, sProperties[theIndex].mObjectKind, sProperties[theIndex].mSelector);
+		SyncAudioTest_Check(theInfo == &sProperties[theIndex]);
+		SyncAudioTest_Check(SyncAudioPropertyRegistry_Find(&theRegistry, sProperties[theIndex].mObjectKind + 7, sProperties[theIndex].mSelector) == NULL);
+		SyncAudioTest_Check(SyncAudioPropertyRegistry_Find(&theRegistry, sProperties[theIndex].mObjectKind, sProperties[theIndex].mSelector + 2) == NULL);
+	}
+}
+
+static void	SyncAudioPropertiesTests_Invalid(void)
+{
+	//	a property listed twice, or more than fit, leaves a registry that finds nothing
+	static const SyncAudioPropertyInfo kProperties[] =
+	{
+		{ 1, 0x636C6173, 0, 4 },
+		{ 2, 0x636C6173, 0, 4 },
+		{ 1, 0x6F776E72, 0, 4 },
+		{ 1, 0x636C6173, 0, 8 }
+	};
+	SyncAudioPropertyRegistry theRegistry;
+	SyncAudioTest_Check(SyncAudioPropertyRegistry_Initialize(&theRegistry, kProperties, 3));
+	SyncAudioTest_Check(SyncAudioPropertyRegistry_Find(&theRegistry, 2, 0x636C6173) == &kProperties[1]);
+	SyncAudioTest_Check(!SyncAudioPropertyRegistry_Initialize(&theRegistry, kProperties, 4));
+	SyncAudioTest_Check(SyncAudioPropertyRegistry_Find(&theRegistry, 2, 0x636C6173) == NULL);
+
+	static SyncAudioPropertyInfo sProperties[kSyncAudioPropertyRegistry_MaxCount + 1];
+	for(uint32_t theIndex = 0; theIndex <= kSyncAudioPropertyRegistry_MaxCount; ++theIndex)
+	{
+		sProperties[theIndex].mObjectKind = 1;
+		sProperties[theIndex].mSelector = theIndex;
+	}
+	SyncAudioTest_Check(!SyncAudioPropertyRegistry_Initialize(&theRegistry, sProperties, kSyncAudioPropertyRegistry_MaxCount + 1));
+	SyncAudioTest_Check(SyncAudioPropertyRegistry_Find(&theRegistry, 1, 0) == NULL);
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Main
+//==================================================================================================
+
+int	main(void)
+{
+	SyncAudioTest_Run(SyncAudioPropertiesTests_Find);
+	SyncAudioTest_Run(SyncAudioPropertiesTests_Invalid);
+	return SyncAudioTest_Result();
+}
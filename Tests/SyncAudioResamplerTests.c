@@ -0,0 +1,200 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+Tests of the sample rate converter.
+*/
+
+/*==================================================================================================
+	SyncAudioResamplerTests.c
+==================================================================================================*/
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	Local Includes
+#include "SyncAudioResampler.h"
+#include "SyncAudioTest.h"
+
+//	System Includes
+#include <math.h>
+#include <string.h>
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Helpers
+//==================================================================================================
+
+#define	kSyncAudioResamplerTests_FrameCapacity	65536
+#define	kSyncAudioResamplerTests_ChannelCount	2
+#define	kSyncAudioResamplerTests_SourceFrames	40000
+#define	kSyncAudioResamplerTests_ReadFrames		16384
+#define	kSyncAudioResamplerTests_ReadStart		1024
+#define	kSyncAudioResamplerTests_Frequency		1000.0
+#define	kSyncAudioResamplerTests_Amplitude		0.5
+#define	kSyncAudioResamplerTests_Pi				3.14159265358979323846
+
+static float	gSyncAudioResamplerTests_Data[kSyncAudioResamplerTests_SourceFrames * kSyncAudioResamplerTests_ChannelCount];
+
+static uint64_t	SyncAudioResamplerTests_Step(double inSourceRate, double inReadRate)
+{
+	return (uint64_t)llround((inSourceRate / inReadRate) * 4294967296.0);
+}
+
+//	Fills a ring with a sine at inSourceRate on every channel, the second channel upside down.
+static bool	SyncAudioResamplerTests_WriteSine(SyncAudioRing* ioRing, double inSourceRate)
+{
+	bool theAnswer = SyncAudioRing_Initialize(ioRing, kSyncAudioResamplerTests_FrameCapacity, kSyncAudioResamplerTests_ChannelCount, 0);
+	if(theAnswer)
+	{
+		for(uint32_t theFrame = 0; theFrame < kSyncAudioResamplerTests_SourceFrames; ++theFrame)
+		{
+			double theSample = kSyncAudioResamplerTests_Amplitude * sin(2.0 * kSyncAudioResamplerTests_Pi * kSyncAudioResamplerTests_Frequency * theFrame / inSourceRate);
+			gSyncAudioResamplerTests_Data[(theFrame * kSyncAudioResamplerTests_ChannelCount) + 0] = (float)theSample;
+			gSyncAudioResamplerTests_Data[(theFrame * kSyncAudioResamplerTests_ChannelCount) + 1] = (float)-theSample;
+		}
+		SyncAudioRing_Write(ioRing, 0, gSyncAudioResamplerTests_Data, kSyncAudioResamplerTests_SourceFrames);
+	}
+	return theAnswer;
+}
+
+//	The THD+N of one channel of a sine of a known frequency, in dB: the power of what is left after
+//	taking away the best fit of a sine and a constant, relative to the power of the sine.
+static double	SyncAudioResamplerTests_Distortion(const float* inData, uint32_t inChannel, uint32_t inFrameCount, double inCyclesPerFrame)
+{
+	//	the least squares fit of a * sin + b * cos + c, from its normal equations, by Cramer's rule
+	double theSums[3][4] = { { 0 } };
+	for(uint32_t theFrame = 0; theFrame < inFrameCount; ++theFrame)
+	{
+		double theBasis[3] = { sin(2.0 * kSyncAudioResamplerTests_Pi * inCyclesPerFrame * theFrame), cos(2.0 * kSyncAudioResamplerTests_Pi * inCyclesPerFrame * theFrame), 1.0 };
+		double theSample = inData[(theFrame * kSyncAudioResamplerTests_ChannelCount) + inChannel];
+		for(uint32_t theRow = 0; theRow < 3; ++theRow)
+		{
+			for(uint32_t theColumn = 0; theColumn < 3; ++theColumn)
+			{
+				theSums[theRow][theColumn] += theBasis[theRow] * theBasis[theColumn];
+			}
+			theSums[theRow][3] += theBasis[theRow] * theSample;
+		}
+	}
+	double theCoefficients[3];
+	double theDeterminant = (theSums[0][0] * ((theSums[1][1] * theSums[2][2]) - (theSums[1][2] * theSums[2][1]))) - (theSums[0][1] * ((theSums[1][0] * theSums[2][2]) - (theSums[1][2] * theSums[2][0]))) + (theSums[0][2] * ((theSums[1][0] * theSums[2][1]) - (theSums[1][1] * theSums[2][0])));
+	for(uint32_t theUnknown = 0; theUnknown < 3; ++theUnknown)
+	{
+		double theMatrix[3][3];
+		for(uint32_t theRow = 0; theRow < 3; ++theRow)
+		{
+			for(uint32_t theColumn = 0; theColumn < 3; ++theColumn)
+			{
+				theMatrix[theRow][theColumn] = (theColumn == theUnknown) ? theSums[theRow][3] : theSums[theRow][theColumn];
+			}
+		}
+		theCoefficients[theUnknown] = ((theMatrix[0][0] * ((theMatrix[1][1] * theMatrix[2][2]) - (theMatrix[1][2] * theMatrix[2][1]))) - (theMatrix[0][1] * ((theMatrix[1][0] * theMatrix[2][2]) - (theMatrix[1][2] * theMatrix[2][0]))) + (theMatrix[0][2] * ((theMatrix[1][0] * theMatrix[2][1]) - (theMatrix[1][1] * theMatrix[2][0])))) / theDeterminant;
+	}
+
+	double theResidual = 0.0;
+	for(uint32_t theFrame = 0; theFrame < inFrameCount; ++theFrame)
+	{
+		double theFit = (theCoefficients[0] * sin(2.0 * kSyncAudioResamplerTests_Pi * inCyclesPerFrame * theFrame)) + (theCoefficients[1] * cos(2.0 * kSyncAudioResamplerTests_Pi * inCyclesPerFrame * theFrame)) + theCoefficients[2];
+		double theError = inData[(theFrame * kSyncAudioResamplerTests_ChannelCount) + inChannel] - theFit;
+		theResidual += theError * theError;
+	}
+	double theSignal = 0.5 * ((theCoefficients[0] * theCoefficients[0]) + (theCoefficients[1] * theCoefficients[1])) * inFrameCount;
+	return 10.0 * log10(theResidual / theSignal);
+}
+
+//	Resamples a sine from inSourceRate to inReadRate and returns the worse THD+N of the channels.
+static double	SyncAudioResamplerTests_Measure(uint32_t inQuality, double inSourceRate, double inReadRate)
+{
+	double theAnswer = 0.0;
+	SyncAudioRing theRing;
+	SyncAudioResampler theResampler;
+	if(SyncAudioResamplerTests_WriteSine(&theRing, inSourceRate))
+	{
+		if(SyncAudioResampler_Initialize(&theResampler, inQuality, kSyncAudioResamplerTests_ChannelCount))
+		{
+			static float sOutput[kSyncAudioResamplerTests_ReadFrames * kSyncAudioResamplerTests_ChannelCount];
+			uint32_t theFlags = SyncAudioResampler_Read(&theResampler, &theRing, kSyncAudioResamplerTests_ReadStart, 0, SyncAudioResamplerTests_Step(inSourceRate, inReadRate), sOutput, kSyncAudioResamplerTests_ReadFrames);
+			SyncAudioTest_Check(theFlags == kSyncAudioRing_NoError);
+			for(uint32_t theChannel = 0; theChannel < kSyncAudioResamplerTests_ChannelCount; ++theChannel)
+			{
+				double theDistortion = SyncAudioResamplerTests_Distortion(sOutput, theChannel, kSyncAudioResamplerTests_ReadFrames, kSyncAudioResamplerTests_Frequency / inReadRate);
+				theAnswer = (theChannel == 0) ? theDistortion : fmax(theAnswer, theDistortion);
+			}
+			SyncAudioResampler_Teardown(&theResampler);
+		}
+		SyncAudioRing_Teardown(&theRing);
+	}
+	return theAnswer;
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Quality
+//==================================================================================================
+
+//	The THD+N of a 1 kHz sine at half of full scale, converted each way between 44.1 and 48 kHz,
+//	must be at least as good as each quality is built for. Converting down stretches the filter and
+//	converting up doesn't, so both of the resampler's paths are covered.
+
+static const double	kSyncAudioResamplerTests_MaxDistortions[kSyncAudioResampler_QualityCount] = { -55.0, -70.0, -92.0, -108.0 };
+
+static void	SyncAudioResamplerTests_Quality(void)
+{
+	for(uint32_t theQuality = 0; theQuality < kSyncAudioResampler_QualityCount; ++theQuality)
+	{
+		double theDown = SyncAudioResamplerTests_Measure(theQuality, 48000.0, 44100.0);
+		double theUp = SyncAudioResamplerTests_Measure(theQuality, 44100.0, 48000.0);
+		fprintf(stderr, "     quality %u: %.1f dB from 48k to 44.1k, %.1f dB from 44.1k to 48k\n", theQuality, theDown, theUp);
+		SyncAudioTest_Check(theDown < kSyncAudioResamplerTests_MaxDistortions[theQuality]);
+		SyncAudioTest_Check(theUp < kSyncAudioResamplerTests_MaxDistortions[theQuality]);
+	}
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Stretch
+//==================================================================================================
+
+//	A frame only depends on its position and on the filter the step picks, so reading one frame
+//	with any step the drift correction can produce around the same rate must give exactly what a
+//	step of one does, and only a step past kSyncAudioResampler_StretchStep may change it.
+
+static void	SyncAudioResamplerTests_Stretch(void)
+{
+	SyncAudioRing theRing;
+	SyncAudioResampler theResampler;
+	if(SyncAudioResamplerTests_WriteSine(&theRing, 48000.0))
+	{
+		if(SyncAudioResampler_Initialize(&theResampler, kSyncAudioResampler_QualityHigh, kSyncAudioResamplerTests_ChannelCount))
+		{
+			static const double kSteps[] = { 0.999, 0.9995, 1.0005, 1.001, 1.0015 };
+			uint32_t theFraction = 0x5A5A5A5A;
+			float theUnity[kSyncAudioResamplerTests_ChannelCount];
+			float theFrame[kSyncAudioResamplerTests_ChannelCount];
+			SyncAudioResampler_Read(&theResampler, &theRing, kSyncAudioResamplerTests_ReadStart, theFraction, 1ULL << 32, theUnity, 1);
+			for(uint32_t theIndex = 0; theIndex < sizeof(kSteps) / sizeof(kSteps[0]); ++theIndex)
+			{
+				SyncAudioResampler_Read(&theResampler, &theRing, kSyncAudioResamplerTests_ReadStart, theFraction, SyncAudioResamplerTests_Step(kSteps[theIndex], 1.0), theFrame, 1);
+				SyncAudioTest_Check(memcmp(theFrame, theUnity, sizeof(theFrame)) == 0);
+			}
+			SyncAudioResampler_Read(&theResampler, &theRing, kSyncAudioResamplerTests_ReadStart, theFraction, kSyncAudioResampler_StretchStep + 1, theFrame, 1);
+			SyncAudioTest_Check(memcmp(theFrame, theUnity, sizeof(theFrame)) != 0);
+			SyncAudioResampler_Teardown(&theResampler);
+		}
+		SyncAudioRing_Teardown(&theRing);
+	}
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Main
+//==================================================================================================
+
+int	main(void)
+{
+	SyncAudioTest_Run(SyncAudioResamplerTests_Quality);
+	SyncAudioTest_Run(SyncAudioResamplerTests_Stretch);
+	return SyncAudioTest_Result();
+}
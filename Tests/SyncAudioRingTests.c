@@ -0,0 +1,403 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+The tests of the loopback ring.
+*/
+
+/*==================================================================================================
+	SyncAudioRingTests.c
+==================================================================================================*/
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	Local Includes
+#include "SyncAudioRing.h"
+#include "SyncAudioTest.h"
+
+//	System Includes
+#include <pthread.h>
+#include <string.h>
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Helpers
+//==================================================================================================
+
+#define	kSyncAudioRingTests_FrameCapacity	1024
+#define	kSyncAudioRingTests_ChannelCount	2
+#define	kSyncAudioRingTests_MaxFrames		512
+
+//	Every sample the tests write is a distinct, exactly representable and non-zero function of its
+//	sample time and channel, so a frame read back is either the right one, silence or a bug.
+static float	SyncAudioRingTests_Sample(int64_t inSampleTime, uint32_t inChannel)
+{
+	return (float)((((uint64_t)inSampleTime * kSyncAudioRingTests_ChannelCount) + inChannel) % 8000000 + 1);
+}
+
+static void	SyncAudioRingTests_Fill(float* outData, int64_t inSampleTime, uint32_t inFrameCount)
+{
+	for(uint32_t theFrame = 0; theFrame < inFrameCount; ++theFrame)
+	{
+		for(uint32_t theChannel = 0; theChannel < kSyncAudioRingTests_ChannelCount; ++theChannel)
+		{
+			outData[(theFrame * kSyncAudioRingTests_ChannelCount) + theChannel] = SyncAudioRingTests_Sample(inSampleTime + theFrame, theChannel);
+		}
+	}
+}
+
+//	Counts the frames that are exactly what was written and the ones that are silence. Anything
+//	else is neither.
+static void	SyncAudioRingTests_Classify(const float* inData, int64_t inSampleTime, uint32_t inFrameCount, uint32_t* outExactCount, uint32_t* outSilentCount)
+{
+	*outExactCount = 0;
+	*outSilentCount = 0;
+	for(uint32_t theFrame = 0; theFrame < inFrameCount; ++theFrame)
+	{
+		bool isExact = true;
+		bool isSilent = true;
+		for(uint32_t theChannel = 0; theChannel < kSyncAudioRingTests_ChannelCount; ++theChannel)
+		{
+			float theSample = inData[(theFrame * kSyncAudioRingTests_ChannelCount) + theChannel];
+			isExact = isExact && (theSample == SyncAudioRingTests_Sample(inSampleTime + theFrame, theChannel));
+			isSilent = isSilent && (theSample == 0.0f);
+		}
+		*outExactCount += isExact ? 1 : 0;
+		*outSilentCount += isSilent ? 1 : 0;
+	}
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Single Thread
+//==================================================================================================
+
+static void	SyncAudioRingTests_ReadBack(void)
+{
+	SyncAudioRing theRing;
+	float theData[kSyncAudioRingTests_MaxFrames * kSyncAudioRingTests_ChannelCount];
+	uint32_t theExactCount = 0;
+	uint32_t theSilentCount = 0;
+	if(SyncAudioRing_Initialize(&theRing, kSyncAudioRingTests_FrameCapacity, kSyncAudioRingTests_ChannelCount, 0))
+	{
+		//	an empty ring has nothing to read
+		SyncAudioTest_Check(SyncAudioRing_Read(&theRing, 0, 0.0f, 1.0f, 0.0f, theData, 64) == kSyncAudioRing_Underrun);
+
+		//	write across the end of the ring a few times and read each write back
+		for(int64_t theSampleTime = 1024; theSampleTime < 4864; theSampleTime += 256)
+		{
+			SyncAudioRingTests_Fill(theData, theSampleTime, 256);
+			SyncAudioRing_Write(&theRing, theSampleTime, theData, 256);
+			memset(theData, 0xFF, sizeof(theData));
+			SyncAudioTest_Check(SyncAudioRing_Read(&theRing, theSampleTime, 0.0f, 1.0f, 0.0f, theData, 256) == kSyncAudioRing_NoError);
+			SyncAudioRingTests_Classify(theData, theSampleTime, 256, &theExactCount, &theSilentCount);
+			SyncAudioTest_Check(theExactCount == 256);
+		}
+
+		//	the write time is now 4864, so reading past it is an underrun for the frames it hasn't
+		//	reached, which come back as silence
+		SyncAudioTest_Check(SyncAudioRing_Read(&theRing, 4764, 0.0f, 1.0f, 0.0f, theData, 200) == kSyncAudioRing_Underrun);
+		SyncAudioRingTests_Classify(theData, 4764, 100, &theExactCount, &theSilentCount);
+		SyncAudioTest_Check(theExactCount == 100);
+		SyncAudioRingTests_Classify(theData + (100 * kSyncAudioRingTests_ChannelCount), 4864, 100, &theExactCount, &theSilentCount);
+		SyncAudioTest_Check(theSilentCount == 100);
+
+		//	and reading further back than the capacity is an overrun for the frames that were lapped
+		SyncAudioTest_Check(SyncAudioRing_Read(&theRing, 4864 - kSyncAudioRingTests_FrameCapacity - 100, 0.0f, 1.0f, 0.0f, theData, 200) == kSyncAudioRing_Overrun);
+		SyncAudioRingTests_Classify(theData, 4864 - kSyncAudioRingTests_FrameCapacity - 100, 100, &theExactCount, &theSilentCount);
+		SyncAudioTest_Check(theSilentCount == 100);
+		SyncAudioRingTests_Classify(theData + (100 * kSyncAudioRingTests_ChannelCount), 4864 - kSyncAudioRingTests_FrameCapacity, 100, &theExactCount, &theSilentCount);
+		SyncAudioTest_Check(theExactCount == 100);
+
+		//	A write that ends part way into a block it hasn't claimed yet clears the rest of that
+		//	block, whose frames from the lap before are then reported lapped rather than returned.
+		SyncAudioRingTests_Fill(theData, 4864, 10);
+		SyncAudioRing_Write(&theRing, 4864, theData, 10);
+		SyncAudioTest_Check(SyncAudioRing_Read(&theRing, 4874 - kSyncAudioRingTests_FrameCapacity, 0.0f, 1.0f, 0.0f, theData, 64) == kSyncAudioRing_Overrun);
+		SyncAudioRingTests_Classify(theData, 4874 - kSyncAudioRingTests_FrameCapacity, 54, &theExactCount, &theSilentCount);
+		SyncAudioTest_Check(theSilentCount == 54);
+		SyncAudioRingTests_Classify(theData + (54 * kSyncAudioRingTests_ChannelCount), 4928 - kSyncAudioRingTests_FrameCapacity, 10, &theExactCount, &theSilentCount);
+		SyncAudioTest_Check(theExactCount == 10);
+		SyncAudioTest_Check(atomic_load(&theRing.mUnderrunCount) == 2);
+		SyncAudioTest_Check(atomic_load(&theRing.mOverrunCount) == 2);
+
+		//	a reader that isn't the consumer gets the same frames and flags without moving the
+		//	consumer's cursor or counts
+		int64_t theReadTime = atomic_load(&theRing.mReadTime);
+		SyncAudioTest_Check(SyncAudioRing_Peek(&theRing, 4824, theData, 100) == kSyncAudioRing_Underrun);
+		SyncAudioRingTests_Classify(theData, 4824, 50, &theExactCount, &theSilentCount);
+		SyncAudioTest_Check(theExactCount == 50);
+		SyncAudioRingTests_Classify(theData + (50 * kSyncAudioRingTests_ChannelCount), 4874, 50, &theExactCount, &theSilentCount);
+		SyncAudioTest_Check(theSilentCount == 50);
+		SyncAudioTest_Check(SyncAudioRing_Peek(&theRing, 4874 - kSyncAudioRingTests_FrameCapacity, theData, 64) == kSyncAudioRing_Overrun);
+		SyncAudioTest_Check(atomic_load(&theRing.mReadTime) == theReadTime);
+		SyncAudioTest_Check(atomic_load(&theRing.mUnderrunCount) == 2);
+		SyncAudioTest_Check(atomic_load(&theRing.mOverrunCount) == 2);
+
+		//	nothing written before the reset is read after it
+		SyncAudioRing_Reset(&theRing);
+		SyncAudioTest_Check(SyncAudioRing_Read(&theRing, 4800, 0.0f, 1.0f, 0.0f, theData, 100) == kSyncAudioRing_Underrun);
+		SyncAudioRingTests_Classify(theData, 4800, 100, &theExactCount, &theSilentCount);
+		SyncAudioTest_Check(theSilentCount == 100);
+
+		SyncAudioRing_Teardown(&theRing);
+	}
+	else
+	{
+		SyncAudioTest_Check(!"the ring could not be allocated");
+	}
+}
+
+//	When the writer skips ahead, the frames it skipped read as silence and an underrun even though
+//	the storage still holds the laps before, and the blocks the writes start and end in only hold
+//	what was written to them this lap.
+static void	SyncAudioRingTests_Gap(void)
+{
+	SyncAudioRing theRing;
+	float theData[kSyncAudioRingTests_MaxFrames * kSyncAudioRingTests_ChannelCount];
+	uint32_t theExactCount = 0;
+	uint32_t theSilentCount = 0;
+	if(SyncAudioRing_Initialize(&theRing, kSyncAudioRingTests_FrameCapacity, kSyncAudioRingTests_ChannelCount, 0))
+	{
+		//	fill the ring twice over so every frame of the storage holds audio
+		for(int64_t theSampleTime = 0; theSampleTime < (2 * kSyncAudioRingTests_FrameCapacity); theSampleTime += 256)
+		{
+			SyncAudioRingTests_Fill(theData, theSampleTime, 256);
+			SyncAudioRing_Write(&theRing, theSampleTime, theData, 256);
+		}
+
+		//	stop part way into a block and come back part way into another one more than a lap of
+		//	the blocks in between later
+		int64_t theStopTime = (2 * kSyncAudioRingTests_FrameCapacity) + 10;
+		int64_t theResumeTime = theStopTime + kSyncAudioRingTests_FrameCapacity - 40;
+		SyncAudioRingTests_Fill(theData, 2 * kSyncAudioRingTests_FrameCapacity, 10);
+		SyncAudioRing_Write(&theRing, 2 * kSyncAudioRingTests_FrameCapacity, theData, 10);
+		SyncAudioRingTests_Fill(theData, theResumeTime, 100);
+		SyncAudioRing_Write(&theRing, theResumeTime, theData, 100);
+
+		//	everything from the stop to the resume is silence, a piece at a time
+		for(int64_t theSampleTime = theStopTime; theSampleTime < theResumeTime; theSampleTime += 100)
+		{
+			uint32_t theFrameCount = (uint32_t)(((theResumeTime - theSampleTime) < 100) ? (theResumeTime - theSampleTime) : 100);
+			SyncAudioTest_Check(SyncAudioRing_Read(&theRing, theSampleTime, 0.0f, 1.0f, 0.0f, theData, theFrameCount) != kSyncAudioRing_NoError);
+			SyncAudioRingTests_Classify(theData, theSampleTime, theFrameCount, &theExactCount, &theSilentCount);
+			SyncAudioTest_Check(theSilentCount == theFrameCount);
+		}
+
+		//	while what was written on either side of the gap is still there
+		SyncAudioTest_Check(SyncAudioRing_Read(&theRing, theResumeTime, 0.0f, 1.0f, 0.0f, theData, 100) == kSyncAudioRing_NoError);
+		SyncAudioRingTests_Classify(theData, theResumeTime, 100, &theExactCount, &theSilentCount);
+		SyncAudioTest_Check(theExactCount == 100);
+
+		SyncAudioRing_Teardown(&theRing);
+	}
+	else
+	{
+		SyncAudioTest_Check(!"the ring could not be allocated");
+	}
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Two Threads
+//==================================================================================================
+
+//	The writer and the reader run flat out on their own threads. The writer stores the stream in
+//	pieces of random sizes, and the reader reads pieces of random sizes at random distances behind
+//	the writer, from well inside the ring to past its capacity, and now and then a little ahead of
+//	it. Every read must return exactly what was written, except for frames it flags as having been
+//	lapped or not written yet, which must be silence. A torn frame, a frame from the wrong lap or
+//	one the flags don't account for fails the test.
+
+#define	kSyncAudioRingTests_StressReadCount	400000
+
+typedef struct SyncAudioRingTests_StressState
+{
+	SyncAudioRing	mRing;
+	_Atomic bool	mIsDone;
+	uint64_t		mWriteCount;
+} SyncAudioRingTests_StressState;
+
+static void*	SyncAudioRingTests_StressWriter(void* inStress)
+{
+	SyncAudioRingTests_StressState* theStress = (SyncAudioRingTests_StressState*)inStress;
+	float theData[kSyncAudioRingTests_MaxFrames * kSyncAudioRingTests_ChannelCount];
+	uint32_t theRandom = 0x9E3779B9;
+	int64_t theSampleTime = 0;
+	while(!atomic_load_explicit(&theStress->mIsDone, memory_order_relaxed))
+	{
+		uint32_t theFrameCount = 1 + (SyncAudioTest_Random(&theRandom) % kSyncAudioRingTests_MaxFrames);
+		SyncAudioRingTests_Fill(theData, theSampleTime, theFrameCount);
+		SyncAudioRing_Write(&theStress->mRing, theSampleTime, theData, theFrameCount);
+		theSampleTime += theFrameCount;
+		++theStress->mWriteCount;
+	}
+	return NULL;
+}
+
+static void	SyncAudioRingTests_Stress(void)
+{
+	SyncAudioRingTests_StressState theStress;
+	atomic_init(&theStress.mIsDone, false);
+	theStress.mWriteCount = 0;
+	if(SyncAudioRing_Initialize(&theStress.mRing, kSyncAudioRingTests_FrameCapacity, kSyncAudioRingTests_ChannelCount, 0))
+	{
+		pthread_t theWriter;
+		if(pthread_create(&theWriter, NULL, SyncAudioRingTests_StressWriter, &theStress) == 0)
+		{
+			float theData[kSyncAudioRingTests_MaxFrames * kSyncAudioRingTests_ChannelCount];
+			uint32_t theRandom = 0x2545F491;
+			uint64_t theCleanCount = 0;
+			uint64_t theUnderrunCount = 0;
+			uint64_t theOverrunCount = 0;
+			uint64_t theBadCount = 0;
+			for(uint32_t theRead = 0; theRead < kSyncAudioRingTests_StressReadCount; ++theRead)
+			{
+				int64_t theWriteTime = atomic_load_explicit(&theStress.mRing.mWriteTime, memory_order_relaxed);
+				uint32_t theFrameCount = 1 + (SyncAudioTest_Random(&theRandom) % kSyncAudioRingTests_MaxFrames);
+				int64_t theSampleTime = theWriteTime - (SyncAudioTest_Random(&theRandom) % (kSyncAudioRingTests_FrameCapacity + (kSyncAudioRingTests_FrameCapacity / 2)));
+				if((SyncAudioTest_Random(&theRandom) % 16) == 0)
+				{
+					theSampleTime = theWriteTime + (SyncAudioTest_Random(&theRandom) % 64) - 32;
+				}
+				theSampleTime = (theSampleTime < 0) ? 0 : theSampleTime;
+
+				uint32_t theFlags = SyncAudioRing_Read(&theStress.mRing, theSampleTime, 0.0f, 1.0f, 0.0f, theData, theFrameCount);
+				uint32_t theExactCount = 0;
+				uint32_t theSilentCount = 0;
+				SyncAudioRingTests_Classify(theData, theSampleTime, theFrameCount, &theExactCount, &theSilentCount);
+				if(theFlags == kSyncAudioRing_NoError)
+				{
+					theBadCount += (theExactCount == theFrameCount) ? 0 : 1;
+					++theCleanCount;
+				}
+				else
+				{
+					theBadCount += ((theExactCount + theSilentCount) == theFrameCount) ? 0 : 1;
+					theUnderrunCount += (theFlags & kSyncAudioRing_Underrun) ? 1 : 0;
+					theOverrunCount += (theFlags & kSyncAudioRing_Overrun) ? 1 : 0;
+				}
+			}
+			atomic_store(&theStress.mIsDone, true);
+			pthread_join(theWriter, NULL);
+
+			fprintf(stderr, "     %llu writes, %llu clean reads, %llu underruns, %llu overruns\n", (unsigned long long)theStress.mWriteCount, (unsigned long long)theCleanCount, (unsigned long long)theUnderrunCount, (unsigned long long)theOverrunCount);
+			SyncAudioTest_Check(theBadCount == 0);
+			SyncAudioTest_Check(theCleanCount > 0);
+			SyncAudioTest_Check(atomic_load(&theStress.mRing.mUnderrunCount) == theUnderrunCount);
+			SyncAudioTest_Check(atomic_load(&theStress.mRing.mOverrunCount) == theOverrunCount);
+		}
+		else
+		{
+			SyncAudioTest_Check(!"the writer thread could not be started");
+		}
+		SyncAudioRing_Teardown(&theStress.mRing);
+	}
+	else
+	{
+		SyncAudioTest_Check(!"the ring could not be allocated");
+	}
+}
+
+//	The resize test has a reader that isn't the ring's own, like a resampler following another
+//	device, read while the writer keeps resetting the ring to another capacity, as a device that
+//	changes its sample rate does. The writer's sample times start over near zero after each change,
+//	as a device's do when it starts IO again, so the frames a read is copying out can be replaced
+//	by earlier ones laid out for the other capacity without the write time ever passing them.
+//	Every read must still be exactly what was written or silence that is flagged.
+
+#define	kSyncAudioRingTests_ResizeReadCount		200000
+#define	kSyncAudioRingTests_ResizeWriteCount	64
+
+static void*	SyncAudioRingTests_ResizeWriter(void* inStress)
+{
+	SyncAudioRingTests_StressState* theStress = (SyncAudioRingTests_StressState*)inStress;
+	float theData[kSyncAudioRingTests_MaxFrames * kSyncAudioRingTests_ChannelCount];
+	uint32_t theRandom = 0x7F4A7C15;
+	int64_t theSampleTime = 0;
+	while(!atomic_load_explicit(&theStress->mIsDone, memory_order_relaxed))
+	{
+		uint32_t theFrameCapacity = ((theStress->mWriteCount / kSyncAudioRingTests_ResizeWriteCount) % 2 == 0) ? kSyncAudioRingTests_FrameCapacity : (kSyncAudioRingTests_FrameCapacity / 2);
+		if((theStress->mWriteCount % kSyncAudioRingTests_ResizeWriteCount) == 0)
+		{
+			SyncAudioRing_SetFrameCapacity(&theStress->mRing, theFrameCapacity);
+			theSampleTime = SyncAudioTest_Random(&theRandom) % kSyncAudioRingTests_FrameCapacity;
+		}
+		uint32_t theFrameCount = 1 + (SyncAudioTest_Random(&theRandom) % kSyncAudioRingTests_MaxFrames);
+		SyncAudioRingTests_Fill(theData, theSampleTime, theFrameCount);
+		SyncAudioRing_Write(&theStress->mRing, theSampleTime, theData, theFrameCount);
+		theSampleTime += theFrameCount;
+		++theStress->mWriteCount;
+	}
+	return NULL;
+}
+
+static void	SyncAudioRingTests_Resize(void)
+{
+	SyncAudioRingTests_StressState theStress;
+	atomic_init(&theStress.mIsDone, false);
+	theStress.mWriteCount = 0;
+	if(SyncAudioRing_Initialize(&theStress.mRing, kSyncAudioRingTests_FrameCapacity, kSyncAudioRingTests_ChannelCount, 0))
+	{
+		pthread_t theWriter;
+		if(pthread_create(&theWriter, NULL, SyncAudioRingTests_ResizeWriter, &theStress) == 0)
+		{
+			float theData[kSyncAudioRingTests_MaxFrames * kSyncAudioRingTests_ChannelCount];
+			uint32_t theRandom = 0x5851F42D;
+			uint64_t theCleanCount = 0;
+			uint64_t theBadCount = 0;
+			for(uint32_t theRead = 0; theRead < kSyncAudioRingTests_ResizeReadCount; ++theRead)
+			{
+				int64_t theWriteTime = atomic_load_explicit(&theStress.mRing.mWriteTime, memory_order_relaxed);
+				uint32_t theFrameCount = 1 + (SyncAudioTest_Random(&theRandom) % kSyncAudioRingTests_MaxFrames);
+				int64_t theSampleTime = theWriteTime - (SyncAudioTest_Random(&theRandom) % kSyncAudioRingTests_FrameCapacity);
+				theSampleTime = (theSampleTime < 0) ? 0 : theSampleTime;
+
+				uint32_t theFlags = SyncAudioRing_Peek(&theStress.mRing, theSampleTime, theData, theFrameCount);
+				uint32_t theExactCount = 0;
+				uint32_t theSilentCount = 0;
+				SyncAudioRingTests_Classify(theData, theSampleTime, theFrameCount, &theExactCount, &theSilentCount);
+				if(theFlags == kSyncAudioRing_NoError)
+				{
+					theBadCount += (theExactCount == theFrameCount) ? 0 : 1;
+					++theCleanCount;
+				}
+				else
+				{
+					theBadCount += ((theExactCount + theSilentCount) == theFrameCount) ? 0 : 1;
+				}
+			}
+			atomic_store(&theStress.mIsDone, true);
+			pthread_join(theWriter, NULL);
+
+			fprintf(stderr, "     %llu writes, %llu changes, %llu clean reads\n", (unsigned long long)theStress.mWriteCount, (unsigned long long)(theStress.mWriteCount / kSyncAudioRingTests_ResizeWriteCount), (unsigned long long)theCleanCount);
+			SyncAudioTest_Check(theBadCount == 0);
+			SyncAudioTest_Check(theCleanCount > 0);
+		}
+		else
+		{
+			SyncAudioTest_Check(!"the writer thread could not be started");
+		}
+		SyncAudioRing_Teardown(&theStress.mRing);
+	}
+	else
+	{
+		SyncAudioTest_Check(!"the ring could not be allocated");
+	}
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Main
+//==================================================================================================
+
+int	main(void)
+{
+	SyncAudioTest_Run(SyncAudioRingTests_ReadBack);
+	SyncAudioTest_Run(SyncAudioRingTests_Gap);
+	SyncAudioTest_Run(SyncAudioRingTests_Stress);
+	SyncAudioTest_Run(SyncAudioRingTests_Resize);
+	return SyncAudioTest_Result();
+}
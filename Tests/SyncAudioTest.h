@@ -0,0 +1,63 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+The checks the SyncAudio core's tests are written with.
+*/
+
+/*==================================================================================================
+	SyncAudioTest.h
+==================================================================================================*/
+#if !defined(__SyncAudioTest_h__)
+#define __SyncAudioTest_h__
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	System Includes
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+//==================================================================================================
+#pragma mark -
+#pragma mark SyncAudioTest
+//==================================================================================================
+
+//	Each file of tests is its own executable whose main runs its tests with SyncAudioTest_Run and
+//	returns SyncAudioTest_Result. A failed check reports where it is and what failed and lets the
+//	test carry on, so that one run shows everything that is wrong.
+
+static uint32_t	gSyncAudioTest_FailureCount = 0;
+
+#define	SyncAudioTest_Check(inCondition)																\
+	do																									\
+	{																									\
+		if(!(inCondition))																				\
+		{																								\
+			fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #inCondition);			\
+			++gSyncAudioTest_FailureCount;																\
+		}																								\
+	} while(0)
+
+#define	SyncAudioTest_Run(inTest)																		\
+	do																									\
+	{																									\
+		uint32_t theFailureCount = gSyncAudioTest_FailureCount;											\
+		inTest();																						\
+		fprintf(stderr, "%s %s\n", (gSyncAudioTest_FailureCount == theFailureCount) ? "ok  " : "FAIL", #inTest);	\
+	} while(0)
+
+#define	SyncAudioTest_Result()	((gSyncAudioTest_FailureCount == 0) ? 0 : 1)
+
+//	A small, fast generator so that the tests are repeatable.
+static inline uint32_t	SyncAudioTest_Random(uint32_t* ioState)
+{
+	*ioState ^= *ioState << 13;
+	*ioState ^= *ioState >> 17;
+	*ioState ^= *ioState << 5;
+	return *ioState;
+}
+
+#endif	//	__SyncAudioTest_h__
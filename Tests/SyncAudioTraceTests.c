@@ -0,0 +1,173 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+Tests of the trace log and of the decoder that reads what it writes.
+*/
+
+/*==================================================================================================
+	SyncAudioTraceTests.c
+==================================================================================================*/
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	Local Includes
+#include "SyncAudioTrace.h"
+#include "SyncAudioTraceDecoder.h"
+#include "SyncAudioTest.h"
+
+//	System Includes
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Queue
+//==================================================================================================
+
+static void	SyncAudioTraceTests_Queue(void)
+{
+	//	records come out in the order they went in, and the ones that don't fit are dropped and
+	//	counted rather than waited for
+	SyncAudioTrace theTrace;
+	SyncAudioTest_Check(SyncAudioTrace_Initialize(&theTrace, 16));
+	for(uint32_t theIndex = 0; theIndex < 20; ++theIndex)
+	{
+		SyncAudioTraceRecord theRecord = { 1000 + theIndex, 0, kSyncAudioTrace_Identify, 1, theIndex, 0 };
+		SyncAudioTest_Check(SyncAudioTrace_Record(&theTrace, &theRecord) == (theIndex < 16));
+	}
+	SyncAudioTest_Check(atomic_load(&theTrace.mDroppedCount) == 4);
+
+	SyncAudioTraceRecord theRecords[32];
+	SyncAudioTest_Check(SyncAudioTrace_Drain(&theTrace, theRecords, 10) == 10);
+	SyncAudioTest_Check(SyncAudioTrace_Drain(&theTrace, &theRecords[10], 32) == 6);
+	for(uint32_t theIndex = 0; theIndex < 16; ++theIndex)
+	{
+		SyncAudioTest_Check(theRecords[theIndex].mArgument0 == theIndex);
+	}
+	SyncAudioTest_Check(SyncAudioTrace_Drain(&theTrace, theRecords, 32) == 0);
+	SyncAudioTrace_Teardown(&theTrace);
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Decoder
+//==================================================================================================
+
+static char*	SyncAudioTraceTests_Decode(const char* inPath, bool* outIsTrace, uint64_t* outRecordCount)
+{
+	//	the whole JSON document as a string
+	char* theAnswer = NULL;
+	FILE* theTrace = fopen(inPath, "rb");
+	FILE* theJSON = tmpfile();
+	if((theTrace != NULL) && (theJSON != NULL))
+	{
+		*outIsTrace = SyncAudioTraceDecoder_Convert(theTrace, theJSON, outRecordCount);
+		long theByteSize = ftell(theJSON);
+		theAnswer = (char*)calloc((size_t)theByteSize + 1, 1);
+		rewind(theJSON);
+		if((theAnswer != NULL) && (fread(theAnswer, 1, (size_t)theByteSize, theJSON) != (size_t)theByteSize))
+		{
+			theAnswer[0] = 0;
+		}
+	}
+	if(theTrace != NULL)
+	{
+		fclose(theTrace);
+	}
+	if(theJSON != NULL)
+	{
+		fclose(theJSON);
+	}
+	return theAnswer;
+}
+
+static void	SyncAudioTraceTests_Decoder(void)
+{
+	//	the layout the format promises
+	SyncAudioTest_Check(sizeof(SyncAudioTraceFileHeader) == 32);
+	SyncAudioTest_Check(sizeof(SyncAudioTraceRecord) == 40);
+
+	//	one of each kind of record, through the drainer to a file, at a millisecond a tick
+	char thePath[] = "/tmp/SyncAudioTraceTests.XXXXXX";
+	int theFileDescriptor = mkstemp(thePath);
+	SyncAudioTest_Check(theFileDescriptor >= 0);
+	close(theFileDescriptor);
+	SyncAudioTrace theTrace;
+	SyncAudioTest_Check(SyncAudioTrace_Initialize(&theTrace, 64));
+	SyncAudioTest_Check(SyncAudioTrace_StartDrainer(&theTrace, thePath, 1000, 1));
+	static const SyncAudioTraceRecord kRecords[] =
+	{
+		{ 5000, 0, kSyncAudioTrace_StartIO, 2, 1, 0 },
+		{ 5002, 1, kSyncAudioTrace_IOOperation, 3, (0x72656164ULL << 32) | 512, (uint64_t)-512 },
+		{ 5003, 2, kSyncAudioTrace_IOOperation, 4, (0x72697465ULL << 32) | 512, 1024 },
+		{ 5004, 3, kSyncAudioTrace_SetProperty, 2, (0x766D7663ULL << 32) | 0x676C6F62, 7 },
+		{ 5005, 0, kSyncAudioTrace_ConfigurationChange, 2, 9, 0 },
+		{ 5006, 0, kSyncAudioTrace_Identify, 1, 0, 0 },
+		{ 5007, 0, kSyncAudioTrace_StopIO, 2, 0, 0 },
+		{ 5008, 0, 99, 5, 11, 12 }
+	};
+	uint32_t theRecordCount = sizeof(kRecords) / sizeof(kRecords[0]);
+	for(uint32_t theIndex = 0; theIndex < theRecordCount; ++theIndex)
+	{
+		SyncAudioTest_Check(SyncAudioTrace_Record(&theTrace, &kRecords[theIndex]));
+	}
+	SyncAudioTrace_StopDrainer(&theTrace);
+	SyncAudioTrace_Teardown(&theTrace);
+
+	bool theIsTrace = false;
+	uint64_t theDecodedCount = 0;
+	char* theJSON = SyncAudioTraceTests_Decode(thePath, &theIsTrace, &theDecodedCount);
+	SyncAudioTest_Check(theIsTrace);
+	SyncAudioTest_Check(theDecodedCount == theRecordCount);
+	SyncAudioTest_Check((theJSON != NULL) && (strncmp(theJSON, "{ \"displayTimeUnit\": \"ns\", \"traceEvents\": [", 43) == 0));
+	SyncAudioTest_Check((theJSON != NULL) && (strstr(theJSON, "{ \"name\": \"StartIO\", \"cat\": \"SyncAudio\", \"pid\": 1, \"tid\": 2, \"ts\": 0.000, \"ph\": \"i\", \"s\": \"t\", \"args\": { \"clients\": 1 } }") != NULL));
+	SyncAudioTest_Check((theJSON != NULL) && (strstr(theJSON, "{ \"name\": \"ReadInput\", \"cat\": \"SyncAudio\", \"pid\": 1, \"tid\": 3, \"ts\": 2000.000, \"ph\": \"X\", \"dur\": 1000.000, \"args\": { \"operation\": \"read\", \"frames\": 512, \"sample_time\": -512 } }") != NULL));
+	SyncAudioTest_Check((theJSON != NULL) && (strstr(theJSON, "\"name\": \"WriteMix\"") != NULL));
+	SyncAudioTest_Check((theJSON != NULL) && (strstr(theJSON, "\"name\": \"SetProperty vmvc\"") != NULL) && (strstr(theJSON, "\"scope\": \"glob\", \"element\": 7") != NULL));
+	SyncAudioTest_Check((theJSON != NULL) && (strstr(theJSON, "\"name\": \"ConfigurationChange\"") != NULL) && (strstr(theJSON, "\"action\": 9") != NULL));
+	SyncAudioTest_Check((theJSON != NULL) && (strstr(theJSON, "\"name\": \"Identify\"") != NULL));
+	SyncAudioTest_Check((theJSON != NULL) && (strstr(theJSON, "\"name\": \"StopIO\"") != NULL));
+	SyncAudioTest_Check((theJSON != NULL) && (strstr(theJSON, "\"name\": \"Event 99\"") != NULL) && (strstr(theJSON, "\"argument0\": 11, \"argument1\": 12") != NULL));
+	SyncAudioTest_Check((theJSON != NULL) && (strlen(theJSON) > 5) && (strcmp(theJSON + strlen(theJSON) - 5, "\n] }\n") == 0));
+	free(theJSON);
+
+	//	part of a record at the end, as a file still being written has, is left out
+	FILE* theFile = fopen(thePath, "ab");
+	SyncAudioTest_Check((theFile != NULL) && (fwrite(kRecords, 1, 20, theFile) == 20));
+	if(theFile != NULL)
+	{
+		fclose(theFile);
+	}
+	theJSON = SyncAudioTraceTests_Decode(thePath, &theIsTrace, &theDecodedCount);
+	SyncAudioTest_Check(theIsTrace && (theDecodedCount == theRecordCount));
+	free(theJSON);
+
+	//	and anything that isn't a trace is turned away without writing anything
+	theFile = fopen(thePath, "wb");
+	SyncAudioTest_Check((theFile != NULL) && (fwrite(kRecords, sizeof(kRecords), 1, theFile) == 1));
+	if(theFile != NULL)
+	{
+		fclose(theFile);
+	}
+	theJSON = SyncAudioTraceTests_Decode(thePath, &theIsTrace, &theDecodedCount);
+	SyncAudioTest_Check(!theIsTrace && (theDecodedCount == 0));
+	SyncAudioTest_Check((theJSON != NULL) && (theJSON[0] == 0));
+	free(theJSON);
+	unlink(thePath);
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Main
+//==================================================================================================
+
+int	main(void)
+{
+	SyncAudioTest_Run(SyncAudioTraceTests_Queue);
+	SyncAudioTest_Run(SyncAudioTraceTests_Decoder);
+	return SyncAudioTest_Result();
+}
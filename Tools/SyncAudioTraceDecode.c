@@ -0,0 +1,87 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+The command line tool that turns the plug-in's trace into a file Perfetto can open.
+*/
+
+/*==================================================================================================
+	SyncAudioTraceDecode.c
+==================================================================================================*/
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	Local Includes
+#include "SyncAudioTraceDecoder.h"
+
+//	System Includes
+#include <stdio.h>
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Main
+//==================================================================================================
+
+//	SyncAudioTraceDecode [trace [json]] reads the trace, /tmp/SyncAudio.trace unless another is
+//	given, and writes the JSON to standard output unless a file is given.
+
+#define	kSyncAudioTraceDecode_DefaultTracePath	"/tmp/SyncAudio.trace"
+
+int	main(int argc, char** argv)
+{
+	int theAnswer = 0;
+	const char* theTracePath = (argc > 1) ? argv[1] : kSyncAudioTraceDecode_DefaultTracePath;
+	FILE* theTrace = NULL;
+	FILE* theJSON = stdout;
+	if(argc > 3)
+	{
+		fprintf(stderr, "usage: SyncAudioTraceDecode [trace [json]]\n");
+		theAnswer = 2;
+	}
+
+	if(theAnswer == 0)
+	{
+		theTrace = fopen(theTracePath, "rb");
+		if(theTrace == NULL)
+		{
+			fprintf(stderr, "SyncAudioTraceDecode: can't open %s\n", theTracePath);
+			theAnswer = 1;
+		}
+	}
+
+	if((theAnswer == 0) && (argc > 2))
+	{
+		theJSON = fopen(argv[2], "w");
+		if(theJSON == NULL)
+		{
+			fprintf(stderr, "SyncAudioTraceDecode: can't open %s\n", argv[2]);
+			theAnswer = 1;
+		}
+	}
+
+	if(theAnswer == 0)
+	{
+		uint64_t theRecordCount = 0;
+		if(SyncAudioTraceDecoder_Convert(theTrace, theJSON, &theRecordCount))
+		{
+			fprintf(stderr, "SyncAudioTraceDecode: %llu records\n", (unsigned long long)theRecordCount);
+		}
+		else
+		{
+			fprintf(stderr, "SyncAudioTraceDecode: %s isn't a SyncAudio trace this tool understands\n", theTracePath);
+			theAnswer = 1;
+		}
+	}
+
+	if(theTrace != NULL)
+	{
+		fclose(theTrace);
+	}
+	if((theJSON != NULL) && (theJSON != stdout))
+	{
+		fclose(theJSON);
+	}
+	return theAnswer;
+}
@@ -0,0 +1,167 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+Turns the trace the plug-in writes into the Chrome trace event format.
+*/
+
+/*==================================================================================================
+	SyncAudioTraceDecoder.c
+==================================================================================================*/
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	Self Include
+#include "SyncAudioTraceDecoder.h"
+
+//	Local Includes
+#include "SyncAudioTrace.h"
+
+//==================================================================================================
+#pragma mark -
+#pragma mark Helpers
+//==================================================================================================
+
+static void	SyncAudioTraceDecoder_GetCode(uint32_t inCode, char* outCode)
+{
+	//	four character codes are stored most significant byte first, and anything that isn't
+	//	printable or would need escaping in JSON becomes a '.'
+	for(uint32_t theIndex = 0; theIndex < 4; ++theIndex)
+	{
+		char theCharacter = (char)((inCode >> (24 - (8 * theIndex))) & 0xFF);
+		outCode[theIndex] = ((theCharacter >= ' ') && (theCharacter <= '~') && (theCharacter != '"') && (theCharacter != '\\')) ? theCharacter : '.';
+	}
+	outCode[4] = 0;
+}
+
+static const char*	SyncAudioTraceDecoder_GetOperationName(uint32_t inOperationID)
+{
+	//	the operations the plug-in does something for, by their four character codes
+	const char* theAnswer = NULL;
+	switch(inOperationID)
+	{
+		case 0x72656164:	//	'read'
+			theAnswer = "ReadInput";
+			break;
+
+		case 0x72697465:	//	'rite'
+			theAnswer = "WriteMix";
+			break;
+
+		case 0x70696E70:	//	'pinp'
+			theAnswer = "ProcessInput";
+			break;
+
+		case 0x706F7574:	//	'pout'
+			theAnswer = "ProcessOutput";
+			break;
+	}
+	return theAnswer;
+}
+
+static void	SyncAudioTraceDecoder_WriteEvent(FILE* outJSON, const SyncAudioTraceFileHeader* inHeader, uint64_t inFirstHostTime, const SyncAudioTraceRecord* inRecord, bool inIsFirst)
+{
+	//	host ticks to microseconds since the first record
+	double theMicrosecondsPerTick = 1000000.0 * (double)inHeader->mHostTicksPerSecondDenominator / (double)inHeader->mHostTicksPerSecondNumerator;
+	double theTime = (double)(int64_t)(inRecord->mHostTime - inFirstHostTime) * theMicrosecondsPerTick;
+	double theDuration = (double)inRecord->mDuration * theMicrosecondsPerTick;
+	char theCode[5];
+	char theName[64];
+	char theArguments[160];
+
+	switch(inRecord->mEvent)
+	{
+		case kSyncAudioTrace_StartIO:
+		case kSyncAudioTrace_StopIO:
+			snprintf(theName, sizeof(theName), "%s", (inRecord->mEvent == kSyncAudioTrace_StartIO) ? "StartIO" : "StopIO");
+			snprintf(theArguments, sizeof(theArguments), "\"clients\": %llu", (unsigned long long)inRecord->mArgument0);
+			break;
+
+		case kSyncAudioTrace_IOOperation:
+		{
+			uint32_t theOperationID = (uint32_t)(inRecord->mArgument0 >> 32);
+			const char* theOperationName = SyncAudioTraceDecoder_GetOperationName(theOperationID);
+			SyncAudioTraceDecoder_GetCode(theOperationID, theCode);
+			snprintf(theName, sizeof(theName), "%s", (theOperationName != NULL) ? theOperationName : theCode);
+			snprintf(theArguments, sizeof(theArguments), "\"operation\": \"%s\", \"frames\": %u, \"sample_time\": %lld", theCode, (uint32_t)(inRecord->mArgument0 & 0xFFFFFFFF), (long long)(int64_t)inRecord->mArgument1);
+			break;
+		}
+
+		case kSyncAudioTrace_SetProperty:
+		{
+			char theScope[5];
+			SyncAudioTraceDecoder_GetCode((uint32_t)(inRecord->mArgument0 >> 32), theCode);
+			SyncAudioTraceDecoder_GetCode((uint32_t)(inRecord->mArgument0 & 0xFFFFFFFF), theScope);
+			snprintf(theName, sizeof(theName), "SetProperty %s", theCode);
+			snprintf(theArguments, sizeof(theArguments), "\"selector\": \"%s\", \"scope\": \"%s\", \"element\": %llu", theCode, theScope, (unsigned long long)inRecord->mArgument1);
+			break;
+		}
+
+		case kSyncAudioTrace_ConfigurationChange:
+			snprintf(theName, sizeof(theName), "ConfigurationChange");
+			snprintf(theArguments, sizeof(theArguments), "\"action\": %llu", (unsigned long long)inRecord->mArgument0);
+			break;
+
+		case kSyncAudioTrace_Identify:
+			snprintf(theName, sizeof(theName), "Identify");
+			theArguments[0] = 0;
+			break;
+
+		default:
+			//	a kind of record from a newer plug-in, with everything there is to say about it
+			snprintf(theName, sizeof(theName), "Event %u", inRecord->mEvent);
+			snprintf(theArguments, sizeof(theArguments), "\"argument0\": %llu, \"argument1\": %llu", (unsigned long long)inRecord->mArgument0, (unsigned long long)inRecord->mArgument1);
+			break;
+	}
+
+	fprintf(outJSON, "%s\n\t{ \"name\": \"%s\", \"cat\": \"SyncAudio\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, ", inIsFirst ? "" : ",", theName, inRecord->mObjectID, theTime);
+	if(inRecord->mDuration != 0)
+	{
+		fprintf(outJSON, "\"ph\": \"X\", \"dur\": %.3f, ", theDuration);
+	}
+	else
+	{
+		fprintf(outJSON, "\"ph\": \"i\", \"s\": \"t\", ");
+	}
+	fprintf(outJSON, "\"args\": { %s } }", theArguments);
+}
+
+//==================================================================================================
+#pragma mark -
+#pragma mark SyncAudioTraceDecoder
+//==================================================================================================
+
+bool	SyncAudioTraceDecoder_Convert(FILE* inTrace, FILE* outJSON, uint64_t* outRecordCount)
+{
+	uint64_t theRecordCount = 0;
+	SyncAudioTraceFileHeader theHeader;
+	bool theAnswer = (fread(&theHeader, sizeof(theHeader), 1, inTrace) == 1) &&
+					 (theHeader.mMagic == kSyncAudioTrace_FileMagic) &&
+					 (theHeader.mVersion == kSyncAudioTrace_FileVersion) &&
+					 (theHeader.mRecordSize == sizeof(SyncAudioTraceRecord)) &&
+					 (theHeader.mHostTicksPerSecondNumerator != 0) &&
+					 (theHeader.mHostTicksPerSecondDenominator != 0);
+	if(theAnswer)
+	{
+		fprintf(outJSON, "{ \"displayTimeUnit\": \"ns\", \"traceEvents\": [");
+		SyncAudioTraceRecord theRecord;
+		uint64_t theFirstHostTime = 0;
+		while(fread(&theRecord, sizeof(theRecord), 1, inTrace) == 1)
+		{
+			if(theRecordCount == 0)
+			{
+				theFirstHostTime = theRecord.mHostTime;
+			}
+			SyncAudioTraceDecoder_WriteEvent(outJSON, &theHeader, theFirstHostTime, &theRecord, theRecordCount == 0);
+			++theRecordCount;
+		}
+		fprintf(outJSON, "\n] }\n");
+	}
+	if(outRecordCount != NULL)
+	{
+		*outRecordCount = theRecordCount;
+	}
+	return theAnswer;
+}
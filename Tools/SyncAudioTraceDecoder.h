@@ -0,0 +1,42 @@
+/*
+See LICENSE folder for this sample’s licensing information.
+
+Abstract:
+Turns the trace the plug-in writes into the Chrome trace event format.
+*/
+
+/*==================================================================================================
+	SyncAudioTraceDecoder.h
+==================================================================================================*/
+#if !defined(__SyncAudioTraceDecoder_h__)
+#define __SyncAudioTraceDecoder_h__
+
+//==================================================================================================
+//	Includes
+//==================================================================================================
+
+//	System Includes
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+//==================================================================================================
+#pragma mark -
+#pragma mark SyncAudioTraceDecoder
+//==================================================================================================
+
+//	SyncAudioTraceDecoder reads a file in the format SyncAudioTrace.h describes and writes it as a
+//	JSON document in the Chrome trace event format, which both Perfetto's UI and chrome://tracing
+//	open. Every record becomes an event on a track of its own object, so each stream's IO
+//	operations and each device's starts, stops and configuration changes line up on their own
+//	rows. Records that took time become complete events and the others instant ones. The times are
+//	in microseconds from the first record, and the arguments of each kind of record are spelled out
+//	under their own names, with the selectors and operation IDs as the four character codes they
+//	are.
+
+//	Returns false, having written nothing, if inTrace doesn't start with a header this decoder
+//	understands. A partial record at the end, which is what a trace still being written can have,
+//	is left out. outRecordCount, which may be NULL, is the number of records converted.
+bool	SyncAudioTraceDecoder_Convert(FILE* inTrace, FILE* outJSON, uint64_t* outRecordCount);
+
+#endif	//	__SyncAudioTraceDecoder_h__